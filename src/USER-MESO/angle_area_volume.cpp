@@ -0,0 +1,387 @@
+/* ----------------------------------------------------------------------
+   LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+   http://lammps.sandia.gov, Sandia National Laboratories
+   Steve Plimpton, sjplimp@sandia.gov
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+
+   See the README file in the top-level LAMMPS directory.
+------------------------------------------------------------------------- */
+
+/* ----------------------------------------------------------------------
+   host implementation of angle_style areavolume/meso
+   pass 1 sums the area and volume of every cell, per thread and then
+   over all procs, pass 2 computes the force of each owned atom from
+   the triangles it belongs to
+   unlike the GPU version the totals of the current step are used,
+   not those of the previous step
+------------------------------------------------------------------------- */
+
+#include "mpi.h"
+#include "math.h"
+#include "stdlib.h"
+#include "angle_area_volume.h"
+#include "atom.h"
+#include "comm.h"
+#include "domain.h"
+#include "force.h"
+#include "memory.h"
+#include "error.h"
+
+#if defined(_OPENMP)
+#include "omp.h"
+#endif
+
+using namespace LAMMPS_NS;
+
+#define MOLECULE_RBC 1000
+
+/* ---------------------------------------------------------------------- */
+
+AngleAreaVolume::AngleAreaVolume( LAMMPS *lmp ) : Angle( lmp )
+{
+    nm = 0;
+    nthreads = 0;
+    dath = NULL;
+    datt = NULL;
+}
+
+/* ---------------------------------------------------------------------- */
+
+AngleAreaVolume::~AngleAreaVolume()
+{
+    if( allocated ) {
+        memory->destroy( setflag );
+        memory->destroy( ka );
+        memory->destroy( a0 );
+        memory->destroy( kv );
+        memory->destroy( v0 );
+        memory->destroy( kl );
+    }
+    memory->destroy( dath );
+    memory->destroy( datt );
+}
+
+/* ---------------------------------------------------------------------- */
+
+void AngleAreaVolume::allocate()
+{
+    allocated = 1;
+    int n = atom->nangletypes;
+
+    memory->create( ka, n + 1, "angle:ka" );
+    memory->create( a0, n + 1, "angle:a0" );
+    memory->create( kv, n + 1, "angle:kv" );
+    memory->create( v0, n + 1, "angle:v0" );
+    memory->create( kl, n + 1, "angle:kl" );
+
+    memory->create( setflag, n + 1, "angle:setflag" );
+    for( int i = 1; i <= n; i++ ) setflag[i] = 0;
+}
+
+/* ---------------------------------------------------------------------- */
+
+void AngleAreaVolume::coeff( int narg, char **arg )
+{
+    if( narg != 6 ) error->all( FLERR, "Incorrect args for angle coefficients" );
+    if( !allocated ) allocate();
+
+    int ilo, ihi;
+    force->bounds( arg[0], atom->nangletypes, ilo, ihi );
+
+    double ka_one = force->numeric( FLERR, arg[1] );
+    double a0_one = force->numeric( FLERR, arg[2] );
+    double kv_one = force->numeric( FLERR, arg[3] );
+    double v0_one = force->numeric( FLERR, arg[4] );
+    double kl_one = force->numeric( FLERR, arg[5] );
+
+    int count = 0;
+    for( int i = ilo; i <= ihi; i++ ) {
+        ka[i] = ka_one;
+        a0[i] = a0_one;
+        kv[i] = kv_one;
+        v0[i] = v0_one;
+        kl[i] = kl_one;
+        setflag[i] = 1;
+        count++;
+    }
+
+    if( count == 0 ) error->all( FLERR, "Incorrect args for angle coefficients" );
+}
+
+/* ----------------------------------------------------------------------
+   size the per-cell buffers from the largest molecule-ID
+------------------------------------------------------------------------- */
+
+void AngleAreaVolume::init_style()
+{
+    if( force->newton_bond )
+        error->all( FLERR, "Angle areavolume requires newton_bond off" );
+    if( atom->angle_a0 == NULL )
+        error->all( FLERR, "Angle areavolume requires atom attribute angle_a0" );
+
+    int n_mol = 0;
+    for( int i = 0; i < atom->nlocal; i++ )
+        n_mol = MAX( n_mol, atom->molecule[i] - MOLECULE_RBC );
+    MPI_Allreduce( &n_mol, &nm, 1, MPI_INT, MPI_MAX, world );
+    if( nm <= 0 ) error->all( FLERR, "Angle areavolume requires RBC molecule-IDs > 1000" );
+
+    nthreads = comm->nthreads;
+    memory->destroy( dath );
+    memory->destroy( datt );
+    memory->create( dath, nthreads * 2 * nm, "angle:dath" );
+    memory->create( datt, 2 * nm, "angle:datt" );
+}
+
+/* ----------------------------------------------------------------------
+   area and volume of each cell from unwrapped coordinates
+   every triangle is stored by its 3 atoms, each adds 1/3 of it
+------------------------------------------------------------------------- */
+
+void AngleAreaVolume::compute_area_volume()
+{
+    double **x = atom->x;
+    tagint *image = atom->image;
+    int *molecule = atom->molecule;
+    int *num_angle = atom->num_angle;
+    int **angle_atom1 = atom->angle_atom1;
+    int **angle_atom2 = atom->angle_atom2;
+    int **angle_atom3 = atom->angle_atom3;
+    int nlocal = atom->nlocal;
+
+    int nmissing = 0;
+
+#if defined(_OPENMP)
+    #pragma omp parallel default(shared) reduction(+:nmissing)
+#endif
+    {
+#if defined(_OPENMP)
+        const int tid = omp_get_thread_num();
+#else
+        const int tid = 0;
+#endif
+        double *dath_thr = dath + tid * 2 * nm;
+
+#if defined(_OPENMP)
+        #pragma omp for schedule(static)
+#endif
+        for( int m = 0; m < nthreads * 2 * nm; m++ ) dath[m] = 0.0;
+
+#if defined(_OPENMP)
+        #pragma omp for schedule(static)
+#endif
+        for( int i = 0; i < nlocal; i++ ) {
+            int n = num_angle[i];
+            int m = molecule[i] - MOLECULE_RBC - 1;
+            if( n == 0 || m < 0 ) continue;         // skip fluid particles
+
+            double aa_sum = 0.0, vv_sum = 0.0;
+            for( int p = 0; p < n; p++ ) {
+                int i1 = atom->map( angle_atom1[i][p] );
+                int i2 = atom->map( angle_atom2[i][p] );
+                int i3 = atom->map( angle_atom3[i][p] );
+                if( i1 < 0 || i2 < 0 || i3 < 0 ) {
+                    nmissing++;
+                    continue;
+                }
+
+                double x1[3], x2[3], x3[3];
+                domain->unmap( x[i1], image[i1], x1 );
+                domain->unmap( x[i2], image[i2], x2 );
+                domain->unmap( x[i3], image[i3], x3 );
+
+                double d21x = x2[0] - x1[0];
+                double d21y = x2[1] - x1[1];
+                double d21z = x2[2] - x1[2];
+                double d31x = x3[0] - x1[0];
+                double d31y = x3[1] - x1[1];
+                double d31z = x3[2] - x1[2];
+
+                double nx = d21y * d31z - d31y * d21z;
+                double ny = d31x * d21z - d21x * d31z;
+                double nz = d21x * d31y - d31x * d21y;
+                double nn = sqrt( nx * nx + ny * ny + nz * nz );
+
+                double mx = x1[0] + x2[0] + x3[0];
+                double my = x1[1] + x2[1] + x3[1];
+                double mz = x1[2] + x2[2] + x3[2];
+
+                aa_sum += 0.5 * nn;
+                vv_sum += ( nx * mx + ny * my + nz * mz ) / 18.0;
+            }
+            dath_thr[m] += aa_sum / 3.0;
+            dath_thr[m + nm] += vv_sum / 3.0;
+        }
+
+        // fold thread buffers into the first one, cells split among threads
+
+#if defined(_OPENMP)
+        #pragma omp for schedule(static)
+#endif
+        for( int m = 0; m < 2 * nm; m++ )
+            for( int t = 1; t < nthreads; t++ ) dath[m] += dath[t * 2 * nm + m];
+    }
+
+    if( nmissing ) error->one( FLERR, "Angle atoms missing" );
+
+    MPI_Allreduce( dath, datt, 2 * nm, MPI_DOUBLE, MPI_SUM, world );
+}
+
+/* ---------------------------------------------------------------------- */
+
+void AngleAreaVolume::compute( int eflag, int vflag )
+{
+    if( eflag || vflag ) ev_setup( eflag, vflag );
+    else evflag = 0;
+
+    compute_area_volume();
+
+    double **x = atom->x;
+    double **f = atom->f;
+    tagint *image = atom->image;
+    int *molecule = atom->molecule;
+    int *num_angle = atom->num_angle;
+    int **angle_type = atom->angle_type;
+    int **angle_atom1 = atom->angle_atom1;
+    int **angle_atom2 = atom->angle_atom2;
+    int **angle_atom3 = atom->angle_atom3;
+    double **angle_a0 = atom->angle_a0;
+    int nlocal = atom->nlocal;
+
+#if defined(_OPENMP)
+    #pragma omp parallel for default(shared) schedule(static)
+#endif
+    for( int i = 0; i < nlocal; i++ ) {
+        int n = num_angle[i];
+        int m = molecule[i] - MOLECULE_RBC - 1;
+        if( n == 0 || m < 0 ) continue;
+        double fx = 0.0, fy = 0.0, fz = 0.0;
+
+        for( int p = 0; p < n; p++ ) {
+            int i1 = atom->map( angle_atom1[i][p] );
+            int i2 = atom->map( angle_atom2[i][p] );
+            int i3 = atom->map( angle_atom3[i][p] );
+            int type = angle_type[i][p];
+
+            double x1[3], x2[3], x3[3];
+            domain->unmap( x[i1], image[i1], x1 );
+            domain->unmap( x[i2], image[i2], x2 );
+            domain->unmap( x[i3], image[i3], x3 );
+
+            double d21x = x2[0] - x1[0];
+            double d21y = x2[1] - x1[1];
+            double d21z = x2[2] - x1[2];
+            double d31x = x3[0] - x1[0];
+            double d31y = x3[1] - x1[1];
+            double d31z = x3[2] - x1[2];
+            double d32x = x3[0] - x2[0];
+            double d32y = x3[1] - x2[1];
+            double d32z = x3[2] - x2[2];
+
+            double nx = d21y * d31z - d31y * d21z;
+            double ny = d31x * d21z - d21x * d31z;
+            double nz = d21x * d31y - d31x * d21y;
+            double nn = sqrt( nx * nx + ny * ny + nz * nz );
+
+            double mx = x1[0] + x2[0] + x3[0];
+            double my = x1[1] + x2[1] + x3[1];
+            double mz = x1[2] + x2[2] + x3[2];
+
+            // local area, global area and global volume constraints
+
+            double ar0 = angle_a0[i][p];
+            double coefl = 0.5 * kl[type] * ( ar0 - 0.5 * nn ) / ar0 / nn;
+            double coefa = 0.5 * ka[type] * ( a0[type] - datt[m] ) / a0[type] / nn;
+            double coefca = coefl + coefa;
+            double coefv = kv[type] * ( v0[type] - datt[m + nm] ) / v0[type] / 18.0;
+
+            // i can hold the same tag as i1, i2 or i3 only once
+
+            int itag = atom->tag[i];
+            if( itag == angle_atom1[i][p] ) {
+                fx += coefca * ( ny * d32z - nz * d32y ) + coefv * ( nx + d32z * my - d32y * mz );
+                fy += coefca * ( nz * d32x - nx * d32z ) + coefv * ( ny - d32z * mx + d32x * mz );
+                fz += coefca * ( nx * d32y - ny * d32x ) + coefv * ( nz + d32y * mx - d32x * my );
+            } else if( itag == angle_atom2[i][p] ) {
+                fx += coefca * ( nz * d31y - ny * d31z ) + coefv * ( nx - d31z * my + d31y * mz );
+                fy += coefca * ( nx * d31z - nz * d31x ) + coefv * ( ny + d31z * mx - d31x * mz );
+                fz += coefca * ( ny * d31x - nx * d31y ) + coefv * ( nz - d31y * mx + d31x * my );
+            } else {
+                fx += coefca * ( ny * d21z - nz * d21y ) + coefv * ( nx + d21z * my - d21y * mz );
+                fy += coefca * ( nz * d21x - nx * d21z ) + coefv * ( ny - d21z * mx + d21x * mz );
+                fz += coefca * ( nx * d21y - ny * d21x ) + coefv * ( nz + d21y * mx - d21x * my );
+            }
+        }
+
+        f[i][0] += fx;
+        f[i][1] += fy;
+        f[i][2] += fz;
+    }
+}
+
+/* ---------------------------------------------------------------------- */
+
+double AngleAreaVolume::equilibrium_angle( int i )
+{
+    return -1.0;
+}
+
+/* ----------------------------------------------------------------------
+   proc 0 writes out coeffs to restart file
+------------------------------------------------------------------------- */
+
+void AngleAreaVolume::write_restart( FILE *fp )
+{
+    int n = atom->nangletypes;
+    fwrite( &ka[1], sizeof( double ), n, fp );
+    fwrite( &a0[1], sizeof( double ), n, fp );
+    fwrite( &kv[1], sizeof( double ), n, fp );
+    fwrite( &v0[1], sizeof( double ), n, fp );
+    fwrite( &kl[1], sizeof( double ), n, fp );
+}
+
+/* ----------------------------------------------------------------------
+   proc 0 reads coeffs from restart file, bcasts them
+------------------------------------------------------------------------- */
+
+void AngleAreaVolume::read_restart( FILE *fp )
+{
+    allocate();
+
+    int n = atom->nangletypes;
+    if( comm->me == 0 ) {
+        fread( &ka[1], sizeof( double ), n, fp );
+        fread( &a0[1], sizeof( double ), n, fp );
+        fread( &kv[1], sizeof( double ), n, fp );
+        fread( &v0[1], sizeof( double ), n, fp );
+        fread( &kl[1], sizeof( double ), n, fp );
+    }
+    MPI_Bcast( &ka[1], n, MPI_DOUBLE, 0, world );
+    MPI_Bcast( &a0[1], n, MPI_DOUBLE, 0, world );
+    MPI_Bcast( &kv[1], n, MPI_DOUBLE, 0, world );
+    MPI_Bcast( &v0[1], n, MPI_DOUBLE, 0, world );
+    MPI_Bcast( &kl[1], n, MPI_DOUBLE, 0, world );
+
+    for( int i = 1; i <= n; i++ ) setflag[i] = 1;
+}
+
+/* ----------------------------------------------------------------------
+   the energy is a property of the whole cell, not of a single triangle
+------------------------------------------------------------------------- */
+
+double AngleAreaVolume::single( int type, int i1, int i2, int i3 )
+{
+    return 0.0;
+}
+
+/* ---------------------------------------------------------------------- */
+
+double AngleAreaVolume::memory_usage()
+{
+    double bytes = Angle::memory_usage();
+    bytes += ( nthreads + 1 ) * 2 * nm * sizeof( double );
+    return bytes;
+}
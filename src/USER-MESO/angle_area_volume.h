@@ -0,0 +1,75 @@
+#ifdef ANGLE_CLASS
+
+AngleStyle(areavolume,AngleAreaVolume)
+
+#else
+
+#ifndef LMP_ANGLE_AREAVOLUME
+#define LMP_ANGLE_AREAVOLUME
+
+#include "angle.h"
+
+namespace LAMMPS_NS {
+
+// host counterpart of areavolume/meso
+// triangles are the angles, molecule-ID 1001 and up labels the cells
+
+class AngleAreaVolume : public Angle
+{
+public:
+    AngleAreaVolume(class LAMMPS *);
+    ~AngleAreaVolume();
+    void compute(int, int);
+    void coeff(int, char **);
+    void init_style();
+    double equilibrium_angle(int);
+    void write_restart(FILE *);
+    void read_restart(FILE *);
+    double single(int, int, int, int);
+    double memory_usage();
+
+protected:
+    double *ka, *a0, *kv, *v0, *kl;
+    int nm;                         // number of cells
+    int nthreads;
+    double *dath;                   // per-thread area and volume of each cell
+    double *datt;                   // area and volume of each cell over all procs
+
+    void allocate();
+    void compute_area_volume();
+};
+
+}
+
+#endif
+
+#endif
+
+/* ERROR/WARNING messages:
+
+E: Incorrect args for angle coefficients
+
+Self-explanatory.  Check the input script or data file.
+
+E: Angle areavolume requires newton_bond off
+
+Each atom must store all of its triangles, use the newton command to
+turn bonded Newton's 3rd law off.
+
+E: Angle areavolume requires atom attribute angle_a0
+
+Use an atom style that stores the equilibrium area of each triangle,
+e.g. atom_style rbc.
+
+E: Angle areavolume requires RBC molecule-IDs > 1000
+
+Cells are identified by molecule-ID, starting from 1001.
+
+E: Angle atoms missing
+
+One or more of 3 atoms needed to compute a particular angle are
+missing on this processor.  Typically this is because the pairwise
+cutoff is set too short or the angle has blown apart and an atom is
+too far away.
+
+*/
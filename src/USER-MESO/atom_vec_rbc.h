@@ -1,3 +1,9 @@
+#ifdef ATOM_CLASS
+
+AtomStyle(rbc,AtomVecRBC)
+
+#else
+
 #ifndef LMP_MESO_ATOM_VEC_RBC_H
 #define LMP_MESO_ATOM_VEC_RBC_H
 
@@ -5,6 +11,10 @@
 
 namespace LAMMPS_NS {
 
+// host-only membrane style, also the base of dpd/rbc/meso and tdpd/rbc/meso
+// data file columns: atom-ID molecule-ID atom-type x y z
+// bond_r0 and angle_a0 are read as an extra column of Bonds and Angles
+
 class AtomVecRBC : public AtomVec {
 public:
     AtomVecRBC( class LAMMPS * );
@@ -59,3 +69,4 @@ protected:
 }
 
 #endif
+#endif
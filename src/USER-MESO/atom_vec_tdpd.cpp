@@ -0,0 +1,700 @@
+/* ----------------------------------------------------------------------
+   LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+   http://lammps.sandia.gov, Sandia National Laboratories
+   Steve Plimpton, sjplimp@sandia.gov
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+
+   See the README file in the top-level LAMMPS directory.
+------------------------------------------------------------------------- */
+
+#include "stdlib.h"
+#include "string.h"
+#include "atom_vec_tdpd.h"
+#include "atom.h"
+#include "comm.h"
+#include "domain.h"
+#include "modify.h"
+#include "fix.h"
+#include "force.h"
+#include "memory.h"
+#include "error.h"
+
+using namespace LAMMPS_NS;
+
+#define DELTA 10000
+
+/* ---------------------------------------------------------------------- */
+
+AtomVecTDPD::AtomVecTDPD( LAMMPS *lmp ) : AtomVec( lmp )
+{
+    molecular = 0;
+    mass_type = 1;
+
+    comm_x_only = 0;
+    comm_f_only = 1;
+    size_reverse = 3;
+    size_velocity = 3;
+    size_data_vel = 4;
+    xcol_data = 3;
+
+    n_species = 0;
+    CONC = CONF = NULL;
+}
+
+/* ----------------------------------------------------------------------
+   atom_style tdpd n_species
+------------------------------------------------------------------------- */
+
+void AtomVecTDPD::settings( int narg, char **arg )
+{
+    if( narg != 1 ) error->all( FLERR, "Illegal atom_style tdpd command" );
+    n_species = force->inumeric( FLERR, arg[0] );
+    if( n_species <= 0 ) error->all( FLERR, "Illegal atom_style tdpd command" );
+    atom->n_species = n_species;
+
+    size_forward   = 3 + n_species;
+    size_border    = 6 + n_species;
+    size_data_atom = 5 + n_species;
+}
+
+/* ----------------------------------------------------------------------
+   grow atom arrays
+   n = 0 grows arrays by DELTA
+   n > 0 allocates arrays to size n
+------------------------------------------------------------------------- */
+
+void AtomVecTDPD::grow( int n )
+{
+    int nmax_old = nmax;
+    if( n == 0 ) nmax += DELTA;
+    else nmax = n;
+    atom->nmax = nmax;
+    if( nmax < 0 || nmax > MAXSMALLINT )
+        error->one( FLERR, "Per-processor system is too big" );
+
+    tag = memory->grow( atom->tag, nmax, "atom:tag" );
+    type = memory->grow( atom->type, nmax, "atom:type" );
+    mask = memory->grow( atom->mask, nmax, "atom:mask" );
+    image = memory->grow( atom->image, nmax, "atom:image" );
+    x = memory->grow( atom->x, nmax, 3, "atom:x" );
+    v = memory->grow( atom->v, nmax, 3, "atom:v" );
+    f = memory->grow( atom->f, nmax * comm->nthreads, 3, "atom:f" );
+    CONC = memory->grow_soa( atom->CONC, n_species, nmax, nmax_old, "atom:CONC" );
+    CONF = memory->grow_soa( atom->CONF, n_species, nmax, nmax_old, "atom:CONF" );
+
+    if( atom->nextra_grow )
+        for( int iextra = 0; iextra < atom->nextra_grow; iextra++ )
+            modify->fix[atom->extra_grow[iextra]]->grow_arrays( nmax );
+}
+
+/* ----------------------------------------------------------------------
+   reset local array ptrs
+------------------------------------------------------------------------- */
+
+void AtomVecTDPD::grow_reset()
+{
+    tag = atom->tag;
+    type = atom->type;
+    mask = atom->mask;
+    image = atom->image;
+    x = atom->x;
+    v = atom->v;
+    f = atom->f;
+    CONC = atom->CONC;
+    CONF = atom->CONF;
+}
+
+/* ----------------------------------------------------------------------
+   copy atom I info to atom J
+------------------------------------------------------------------------- */
+
+void AtomVecTDPD::copy( int i, int j, int delflag )
+{
+    tag[j] = tag[i];
+    type[j] = type[i];
+    mask[j] = mask[i];
+    image[j] = image[i];
+    x[j][0] = x[i][0];
+    x[j][1] = x[i][1];
+    x[j][2] = x[i][2];
+    v[j][0] = v[i][0];
+    v[j][1] = v[i][1];
+    v[j][2] = v[i][2];
+    for( int k = 0; k < n_species; k++ )
+        CONC[k][j] = CONC[k][i];
+
+    if( atom->nextra_grow )
+        for( int iextra = 0; iextra < atom->nextra_grow; iextra++ )
+            modify->fix[atom->extra_grow[iextra]]->copy_arrays( i, j, delflag );
+}
+
+/* ---------------------------------------------------------------------- */
+
+int AtomVecTDPD::pack_comm( int n, int *list, double *buf,
+                            int pbc_flag, int *pbc )
+{
+    int i, j, k, m;
+    double dx, dy, dz;
+
+    m = 0;
+    if( pbc_flag == 0 ) {
+        dx = dy = dz = 0.0;
+    } else {
+        if( domain->triclinic == 0 ) {
+            dx = pbc[0] * domain->xprd;
+            dy = pbc[1] * domain->yprd;
+            dz = pbc[2] * domain->zprd;
+        } else {
+            dx = pbc[0] * domain->xprd + pbc[5] * domain->xy + pbc[4] * domain->xz;
+            dy = pbc[1] * domain->yprd + pbc[3] * domain->yz;
+            dz = pbc[2] * domain->zprd;
+        }
+    }
+    for( i = 0; i < n; i++ ) {
+        j = list[i];
+        buf[m++] = x[j][0] + dx;
+        buf[m++] = x[j][1] + dy;
+        buf[m++] = x[j][2] + dz;
+        for( k = 0; k < n_species; k++ )
+            buf[m++] = CONC[k][j];
+    }
+    return m;
+}
+
+/* ---------------------------------------------------------------------- */
+
+int AtomVecTDPD::pack_comm_vel( int n, int *list, double *buf,
+                                int pbc_flag, int *pbc )
+{
+    int i, j, k, m;
+    double dx, dy, dz, dvx, dvy, dvz;
+
+    m = 0;
+    dx = dy = dz = 0.0;
+    dvx = dvy = dvz = 0.0;
+    if( pbc_flag ) {
+        if( domain->triclinic == 0 ) {
+            dx = pbc[0] * domain->xprd;
+            dy = pbc[1] * domain->yprd;
+            dz = pbc[2] * domain->zprd;
+        } else {
+            dx = pbc[0] * domain->xprd + pbc[5] * domain->xy + pbc[4] * domain->xz;
+            dy = pbc[1] * domain->yprd + pbc[3] * domain->yz;
+            dz = pbc[2] * domain->zprd;
+        }
+        if( deform_vremap ) {
+            dvx = pbc[0] * h_rate[0] + pbc[5] * h_rate[5] + pbc[4] * h_rate[4];
+            dvy = pbc[1] * h_rate[1] + pbc[3] * h_rate[3];
+            dvz = pbc[2] * h_rate[2];
+        }
+    }
+    for( i = 0; i < n; i++ ) {
+        j = list[i];
+        buf[m++] = x[j][0] + dx;
+        buf[m++] = x[j][1] + dy;
+        buf[m++] = x[j][2] + dz;
+        if( mask[j] & deform_groupbit ) {
+            buf[m++] = v[j][0] + dvx;
+            buf[m++] = v[j][1] + dvy;
+            buf[m++] = v[j][2] + dvz;
+        } else {
+            buf[m++] = v[j][0];
+            buf[m++] = v[j][1];
+            buf[m++] = v[j][2];
+        }
+        for( k = 0; k < n_species; k++ )
+            buf[m++] = CONC[k][j];
+    }
+    return m;
+}
+
+/* ---------------------------------------------------------------------- */
+
+void AtomVecTDPD::unpack_comm( int n, int first, double *buf )
+{
+    int i, k, m, last;
+
+    m = 0;
+    last = first + n;
+    for( i = first; i < last; i++ ) {
+        x[i][0] = buf[m++];
+        x[i][1] = buf[m++];
+        x[i][2] = buf[m++];
+        for( k = 0; k < n_species; k++ )
+            CONC[k][i] = buf[m++];
+    }
+}
+
+/* ---------------------------------------------------------------------- */
+
+void AtomVecTDPD::unpack_comm_vel( int n, int first, double *buf )
+{
+    int i, k, m, last;
+
+    m = 0;
+    last = first + n;
+    for( i = first; i < last; i++ ) {
+        x[i][0] = buf[m++];
+        x[i][1] = buf[m++];
+        x[i][2] = buf[m++];
+        v[i][0] = buf[m++];
+        v[i][1] = buf[m++];
+        v[i][2] = buf[m++];
+        for( k = 0; k < n_species; k++ )
+            CONC[k][i] = buf[m++];
+    }
+}
+
+/* ---------------------------------------------------------------------- */
+
+int AtomVecTDPD::pack_reverse( int n, int first, double *buf )
+{
+    int i, m, last;
+
+    m = 0;
+    last = first + n;
+    for( i = first; i < last; i++ ) {
+        buf[m++] = f[i][0];
+        buf[m++] = f[i][1];
+        buf[m++] = f[i][2];
+    }
+    return m;
+}
+
+/* ---------------------------------------------------------------------- */
+
+void AtomVecTDPD::unpack_reverse( int n, int *list, double *buf )
+{
+    int i, j, m;
+
+    m = 0;
+    for( i = 0; i < n; i++ ) {
+        j = list[i];
+        f[j][0] += buf[m++];
+        f[j][1] += buf[m++];
+        f[j][2] += buf[m++];
+    }
+}
+
+/* ---------------------------------------------------------------------- */
+
+int AtomVecTDPD::pack_border( int n, int *list, double *buf,
+                              int pbc_flag, int *pbc )
+{
+    int i, j, k, m;
+    double dx, dy, dz;
+
+    m = 0;
+    if( pbc_flag == 0 ) {
+        dx = dy = dz = 0.0;
+    } else {
+        if( domain->triclinic == 0 ) {
+            dx = pbc[0] * domain->xprd;
+            dy = pbc[1] * domain->yprd;
+            dz = pbc[2] * domain->zprd;
+        } else {
+            dx = pbc[0];
+            dy = pbc[1];
+            dz = pbc[2];
+        }
+    }
+    for( i = 0; i < n; i++ ) {
+        j = list[i];
+        buf[m++] = x[j][0] + dx;
+        buf[m++] = x[j][1] + dy;
+        buf[m++] = x[j][2] + dz;
+        buf[m++] = tag[j];
+        buf[m++] = type[j];
+        buf[m++] = mask[j];
+        for( k = 0; k < n_species; k++ )
+            buf[m++] = CONC[k][j];
+    }
+
+    if( atom->nextra_border )
+        for( int iextra = 0; iextra < atom->nextra_border; iextra++ )
+            m += modify->fix[atom->extra_border[iextra]]->pack_border( n, list, &buf[m] );
+
+    return m;
+}
+
+/* ---------------------------------------------------------------------- */
+
+int AtomVecTDPD::pack_border_vel( int n, int *list, double *buf,
+                                  int pbc_flag, int *pbc )
+{
+    int i, j, k, m;
+    double dx, dy, dz, dvx, dvy, dvz;
+
+    m = 0;
+    dx = dy = dz = 0.0;
+    dvx = dvy = dvz = 0.0;
+    if( pbc_flag ) {
+        if( domain->triclinic == 0 ) {
+            dx = pbc[0] * domain->xprd;
+            dy = pbc[1] * domain->yprd;
+            dz = pbc[2] * domain->zprd;
+        } else {
+            dx = pbc[0];
+            dy = pbc[1];
+            dz = pbc[2];
+        }
+        if( deform_vremap ) {
+            dvx = pbc[0] * h_rate[0] + pbc[5] * h_rate[5] + pbc[4] * h_rate[4];
+            dvy = pbc[1] * h_rate[1] + pbc[3] * h_rate[3];
+            dvz = pbc[2] * h_rate[2];
+        }
+    }
+    for( i = 0; i < n; i++ ) {
+        j = list[i];
+        buf[m++] = x[j][0] + dx;
+        buf[m++] = x[j][1] + dy;
+        buf[m++] = x[j][2] + dz;
+        buf[m++] = tag[j];
+        buf[m++] = type[j];
+        buf[m++] = mask[j];
+        if( mask[j] & deform_groupbit ) {
+            buf[m++] = v[j][0] + dvx;
+            buf[m++] = v[j][1] + dvy;
+            buf[m++] = v[j][2] + dvz;
+        } else {
+            buf[m++] = v[j][0];
+            buf[m++] = v[j][1];
+            buf[m++] = v[j][2];
+        }
+        for( k = 0; k < n_species; k++ )
+            buf[m++] = CONC[k][j];
+    }
+
+    if( atom->nextra_border )
+        for( int iextra = 0; iextra < atom->nextra_border; iextra++ )
+            m += modify->fix[atom->extra_border[iextra]]->pack_border( n, list, &buf[m] );
+
+    return m;
+}
+
+/* ---------------------------------------------------------------------- */
+
+void AtomVecTDPD::unpack_border( int n, int first, double *buf )
+{
+    int i, k, m, last;
+
+    m = 0;
+    last = first + n;
+    for( i = first; i < last; i++ ) {
+        if( i == nmax ) grow( 0 );
+        x[i][0] = buf[m++];
+        x[i][1] = buf[m++];
+        x[i][2] = buf[m++];
+        tag[i] = static_cast<int>( buf[m++] );
+        type[i] = static_cast<int>( buf[m++] );
+        mask[i] = static_cast<int>( buf[m++] );
+        for( k = 0; k < n_species; k++ )
+            CONC[k][i] = buf[m++];
+    }
+
+    if( atom->nextra_border )
+        for( int iextra = 0; iextra < atom->nextra_border; iextra++ )
+            m += modify->fix[atom->extra_border[iextra]]->
+                 unpack_border( n, first, &buf[m] );
+}
+
+/* ---------------------------------------------------------------------- */
+
+void AtomVecTDPD::unpack_border_vel( int n, int first, double *buf )
+{
+    int i, k, m, last;
+
+    m = 0;
+    last = first + n;
+    for( i = first; i < last; i++ ) {
+        if( i == nmax ) grow( 0 );
+        x[i][0] = buf[m++];
+        x[i][1] = buf[m++];
+        x[i][2] = buf[m++];
+        tag[i] = static_cast<int>( buf[m++] );
+        type[i] = static_cast<int>( buf[m++] );
+        mask[i] = static_cast<int>( buf[m++] );
+        v[i][0] = buf[m++];
+        v[i][1] = buf[m++];
+        v[i][2] = buf[m++];
+        for( k = 0; k < n_species; k++ )
+            CONC[k][i] = buf[m++];
+    }
+
+    if( atom->nextra_border )
+        for( int iextra = 0; iextra < atom->nextra_border; iextra++ )
+            m += modify->fix[atom->extra_border[iextra]]->
+                 unpack_border( n, first, &buf[m] );
+}
+
+/* ----------------------------------------------------------------------
+   pack data for atom I for sending to another proc
+   xyz must be 1st 3 values, so comm::exchange() can test on them
+------------------------------------------------------------------------- */
+
+int AtomVecTDPD::pack_exchange( int i, double *buf )
+{
+    int m = 1;
+    buf[m++] = x[i][0];
+    buf[m++] = x[i][1];
+    buf[m++] = x[i][2];
+    buf[m++] = v[i][0];
+    buf[m++] = v[i][1];
+    buf[m++] = v[i][2];
+    buf[m++] = tag[i];
+    buf[m++] = type[i];
+    buf[m++] = mask[i];
+    buf[m] = 0.0;      // for valgrind
+    *( ( tagint * ) &buf[m++] ) = image[i];
+    for( int k = 0; k < n_species; k++ )
+        buf[m++] = CONC[k][i];
+
+    if( atom->nextra_grow )
+        for( int iextra = 0; iextra < atom->nextra_grow; iextra++ )
+            m += modify->fix[atom->extra_grow[iextra]]->pack_exchange( i, &buf[m] );
+
+    buf[0] = m;
+    return m;
+}
+
+/* ---------------------------------------------------------------------- */
+
+int AtomVecTDPD::unpack_exchange( double *buf )
+{
+    int nlocal = atom->nlocal;
+    if( nlocal == nmax ) grow( 0 );
+
+    int m = 1;
+    x[nlocal][0] = buf[m++];
+    x[nlocal][1] = buf[m++];
+    x[nlocal][2] = buf[m++];
+    v[nlocal][0] = buf[m++];
+    v[nlocal][1] = buf[m++];
+    v[nlocal][2] = buf[m++];
+    tag[nlocal] = static_cast<int>( buf[m++] );
+    type[nlocal] = static_cast<int>( buf[m++] );
+    mask[nlocal] = static_cast<int>( buf[m++] );
+    image[nlocal] = *( ( tagint * ) &buf[m++] );
+    for( int k = 0; k < n_species; k++ )
+        CONC[k][nlocal] = buf[m++];
+
+    if( atom->nextra_grow )
+        for( int iextra = 0; iextra < atom->nextra_grow; iextra++ )
+            m += modify->fix[atom->extra_grow[iextra]]->
+                 unpack_exchange( nlocal, &buf[m] );
+
+    atom->nlocal++;
+    return m;
+}
+
+/* ----------------------------------------------------------------------
+   size of restart data for all atoms owned by this proc
+   include extra data stored by fixes
+------------------------------------------------------------------------- */
+
+int AtomVecTDPD::size_restart()
+{
+    int i;
+
+    int nlocal = atom->nlocal;
+    int n = ( 11 + n_species ) * nlocal;
+
+    if( atom->nextra_restart )
+        for( int iextra = 0; iextra < atom->nextra_restart; iextra++ )
+            for( i = 0; i < nlocal; i++ )
+                n += modify->fix[atom->extra_restart[iextra]]->size_restart( i );
+
+    return n;
+}
+
+/* ----------------------------------------------------------------------
+   pack atom I's data for restart file including extra quantities
+   xyz must be 1st 3 values, so that read_restart can test on them
+------------------------------------------------------------------------- */
+
+int AtomVecTDPD::pack_restart( int i, double *buf )
+{
+    int m = 1;
+    buf[m++] = x[i][0];
+    buf[m++] = x[i][1];
+    buf[m++] = x[i][2];
+    buf[m++] = tag[i];
+    buf[m++] = type[i];
+    buf[m++] = mask[i];
+    buf[m] = 0.0;      // for valgrind
+    *( ( tagint * ) &buf[m++] ) = image[i];
+    buf[m++] = v[i][0];
+    buf[m++] = v[i][1];
+    buf[m++] = v[i][2];
+    for( int k = 0; k < n_species; k++ )
+        buf[m++] = CONC[k][i];
+
+    if( atom->nextra_restart )
+        for( int iextra = 0; iextra < atom->nextra_restart; iextra++ )
+            m += modify->fix[atom->extra_restart[iextra]]->pack_restart( i, &buf[m] );
+
+    buf[0] = m;
+    return m;
+}
+
+/* ----------------------------------------------------------------------
+   unpack data for one atom from restart file including extra quantities
+------------------------------------------------------------------------- */
+
+int AtomVecTDPD::unpack_restart( double *buf )
+{
+    int nlocal = atom->nlocal;
+    if( nlocal == nmax ) {
+        grow( 0 );
+        if( atom->nextra_store )
+            memory->grow( atom->extra, nmax, atom->nextra_store, "atom:extra" );
+    }
+
+    int m = 1;
+    x[nlocal][0] = buf[m++];
+    x[nlocal][1] = buf[m++];
+    x[nlocal][2] = buf[m++];
+    tag[nlocal] = static_cast<int>( buf[m++] );
+    type[nlocal] = static_cast<int>( buf[m++] );
+    mask[nlocal] = static_cast<int>( buf[m++] );
+    image[nlocal] = *( ( tagint * ) &buf[m++] );
+    v[nlocal][0] = buf[m++];
+    v[nlocal][1] = buf[m++];
+    v[nlocal][2] = buf[m++];
+    for( int k = 0; k < n_species; k++ )
+        CONC[k][nlocal] = buf[m++];
+
+    double **extra = atom->extra;
+    if( atom->nextra_store ) {
+        int size = static_cast<int>( buf[0] ) - m;
+        for( int i = 0; i < size; i++ ) extra[nlocal][i] = buf[m++];
+    }
+
+    atom->nlocal++;
+    return m;
+}
+
+/* ----------------------------------------------------------------------
+   create one atom of itype at coord
+   set other values to defaults
+------------------------------------------------------------------------- */
+
+void AtomVecTDPD::create_atom( int itype, double *coord )
+{
+    int nlocal = atom->nlocal;
+    if( nlocal == nmax ) grow( 0 );
+
+    tag[nlocal] = 0;
+    type[nlocal] = itype;
+    x[nlocal][0] = coord[0];
+    x[nlocal][1] = coord[1];
+    x[nlocal][2] = coord[2];
+    mask[nlocal] = 1;
+    image[nlocal] = ( ( tagint ) IMGMAX << IMG2BITS ) |
+                    ( ( tagint ) IMGMAX << IMGBITS ) | IMGMAX;
+    v[nlocal][0] = 0.0;
+    v[nlocal][1] = 0.0;
+    v[nlocal][2] = 0.0;
+    for( int k = 0; k < n_species; k++ )
+        CONC[k][nlocal] = 0.0f;
+
+    atom->nlocal++;
+}
+
+/* ----------------------------------------------------------------------
+   unpack one line from Atoms section of data file
+   columns are atom-ID atom-type x y z C_1 ... C_n, as for tdpd/atomic/meso
+------------------------------------------------------------------------- */
+
+void AtomVecTDPD::data_atom( double *coord, tagint imagetmp, char **values )
+{
+    int nlocal = atom->nlocal;
+    if( nlocal == nmax ) grow( 0 );
+
+    tag[nlocal] = atoi( values[0] );
+    if( tag[nlocal] <= 0 )
+        error->one( FLERR, "Invalid atom ID in Atoms section of data file" );
+
+    type[nlocal] = atoi( values[1] );
+    if( type[nlocal] <= 0 || type[nlocal] > atom->ntypes )
+        error->one( FLERR, "Invalid atom type in Atoms section of data file" );
+
+    x[nlocal][0] = coord[0];
+    x[nlocal][1] = coord[1];
+    x[nlocal][2] = coord[2];
+
+    for( int k = 0; k < n_species; k++ )
+        CONC[k][nlocal] = atof( values[5 + k] );
+
+    image[nlocal] = imagetmp;
+
+    mask[nlocal] = 1;
+    v[nlocal][0] = 0.0;
+    v[nlocal][1] = 0.0;
+    v[nlocal][2] = 0.0;
+
+    atom->nlocal++;
+}
+
+/* ----------------------------------------------------------------------
+   pack atom info for data file including 3 image flags
+------------------------------------------------------------------------- */
+
+void AtomVecTDPD::pack_data( double **buf )
+{
+    int nlocal = atom->nlocal;
+    for( int i = 0; i < nlocal; i++ ) {
+        buf[i][0] = tag[i];
+        buf[i][1] = type[i];
+        buf[i][2] = x[i][0];
+        buf[i][3] = x[i][1];
+        buf[i][4] = x[i][2];
+        for( int k = 0; k < n_species; k++ )
+            buf[i][5 + k] = CONC[k][i];
+        buf[i][5 + n_species] = ( image[i] & IMGMASK ) - IMGMAX;
+        buf[i][6 + n_species] = ( image[i] >> IMGBITS & IMGMASK ) - IMGMAX;
+        buf[i][7 + n_species] = ( image[i] >> IMG2BITS ) - IMGMAX;
+    }
+}
+
+/* ----------------------------------------------------------------------
+   write atom info to data file including 3 image flags
+------------------------------------------------------------------------- */
+
+void AtomVecTDPD::write_data( FILE *fp, int n, double **buf )
+{
+    for( int i = 0; i < n; i++ ) {
+        fprintf( fp, "%d %d %-1.16e %-1.16e %-1.16e",
+                 ( int ) buf[i][0], ( int ) buf[i][1], buf[i][2], buf[i][3], buf[i][4] );
+        for( int k = 0; k < n_species; k++ )
+            fprintf( fp, " %-1.8e", buf[i][5 + k] );
+        fprintf( fp, " %d %d %d\n",
+                 ( int ) buf[i][5 + n_species], ( int ) buf[i][6 + n_species],
+                 ( int ) buf[i][7 + n_species] );
+    }
+}
+
+/* ----------------------------------------------------------------------
+   return # of bytes of allocated memory
+------------------------------------------------------------------------- */
+
+bigint AtomVecTDPD::memory_usage()
+{
+    bigint bytes = 0;
+
+    if( atom->memcheck( "tag" ) ) bytes += memory->usage( tag, nmax );
+    if( atom->memcheck( "type" ) ) bytes += memory->usage( type, nmax );
+    if( atom->memcheck( "mask" ) ) bytes += memory->usage( mask, nmax );
+    if( atom->memcheck( "image" ) ) bytes += memory->usage( image, nmax );
+    if( atom->memcheck( "x" ) ) bytes += memory->usage( x, nmax, 3 );
+    if( atom->memcheck( "v" ) ) bytes += memory->usage( v, nmax, 3 );
+    if( atom->memcheck( "f" ) ) bytes += memory->usage( f, nmax * comm->nthreads, 3 );
+    if( atom->memcheck( "CONC" ) ) bytes += memory->usage( CONC, n_species, nmax );
+    if( atom->memcheck( "CONF" ) ) bytes += memory->usage( CONF, n_species, nmax );
+
+    return bytes;
+}
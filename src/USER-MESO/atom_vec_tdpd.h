@@ -0,0 +1,78 @@
+#ifdef ATOM_CLASS
+
+AtomStyle(tdpd,AtomVecTDPD)
+
+#else
+
+#ifndef LMP_ATOM_VEC_TDPD_H
+#define LMP_ATOM_VEC_TDPD_H
+
+#include "atom_vec.h"
+
+namespace LAMMPS_NS {
+
+// host-only counterpart of tdpd/atomic/meso
+// per-species concentration CONC and flux CONF are stored as SoA in Atom
+
+class AtomVecTDPD : public AtomVec {
+public:
+    AtomVecTDPD(class LAMMPS *);
+    virtual ~AtomVecTDPD() {}
+    void settings(int, char **);
+    void grow(int);
+    void grow_reset();
+    void copy(int, int, int);
+    int  pack_comm(int, int *, double *, int, int *);
+    int  pack_comm_vel(int, int *, double *, int, int *);
+    void unpack_comm(int, int, double *);
+    void unpack_comm_vel(int, int, double *);
+    int  pack_reverse(int, int, double *);
+    void unpack_reverse(int, int *, double *);
+    int  pack_border(int, int *, double *, int, int *);
+    int  pack_border_vel(int, int *, double *, int, int *);
+    void unpack_border(int, int, double *);
+    void unpack_border_vel(int, int, double *);
+    int  pack_exchange(int, double *);
+    int  unpack_exchange(double *);
+    int  size_restart();
+    int  pack_restart(int, double *);
+    int  unpack_restart(double *);
+    void create_atom(int, double *);
+    void data_atom(double *, tagint, char **);
+    void pack_data(double **);
+    void write_data(FILE *, int, double **);
+    bigint memory_usage();
+
+protected:
+    int *tag, *type, *mask;
+    tagint *image;
+    double **x, **v, **f;
+    float **CONC, **CONF;
+    int n_species;
+};
+
+}
+
+#endif
+#endif
+
+/* ERROR/WARNING messages:
+
+E: Illegal atom_style tdpd command
+
+The number of chemical species must be given and be positive.
+
+E: Per-processor system is too big
+
+The number of owned atoms plus ghost atoms on a single
+processor must fit in 32-bit integer.
+
+E: Invalid atom ID in Atoms section of data file
+
+Atom IDs must be positive integers.
+
+E: Invalid atom type in Atoms section of data file
+
+Atom types must range from 1 to specified # of types.
+
+*/
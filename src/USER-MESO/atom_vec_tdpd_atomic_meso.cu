@@ -30,6 +30,7 @@ AtomVecTDPDAtomic::AtomVecTDPDAtomic( LAMMPS *lmp ) :
 
     dev_CONC.set_d(n_species);
     dev_CONF.set_d(n_species);
+    atom->n_species = n_species;        // read by dump tdpd/meso
 
     comm_x_only    = 0;
     comm_f_only    = 0;
@@ -73,6 +73,7 @@ AtomVecTDPDRBC::AtomVecTDPDRBC( LAMMPS *lmp ) :
 
     dev_CONC.set_d(n_species);              // change the dimension here.
     dev_CONF.set_d(n_species);
+    atom->n_species = n_species;        // read by dump tdpd/meso
 
     cudable       = 1;
     comm_x_only    = 0;
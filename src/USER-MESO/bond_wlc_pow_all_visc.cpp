@@ -0,0 +1,328 @@
+/* ----------------------------------------------------------------------
+   LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+   http://lammps.sandia.gov, Sandia National Laboratories
+   Steve Plimpton, sjplimp@sandia.gov
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+
+   See the README file in the top-level LAMMPS directory.
+------------------------------------------------------------------------- */
+
+/* ----------------------------------------------------------------------
+   host implementation of bond_style wlc_pow_all_visc/meso
+   OpenMP threads over owned atoms, each atom only updates itself,
+   the bond partner computes the opposite force from its own copy
+------------------------------------------------------------------------- */
+
+#include "mpi.h"
+#include "math.h"
+#include "stdlib.h"
+#include "bond_wlc_pow_all_visc.h"
+#include "atom.h"
+#include "comm.h"
+#include "domain.h"
+#include "force.h"
+#include "update.h"
+#include "random_tea.h"
+#include "memory.h"
+#include "error.h"
+
+using namespace LAMMPS_NS;
+
+/* ---------------------------------------------------------------------- */
+
+BondWLCPowAllVisc::BondWLCPowAllVisc( LAMMPS *lmp ) : Bond( lmp )
+{
+    seed = 0;
+    nmax_key = 0;
+    rkey = NULL;
+}
+
+/* ---------------------------------------------------------------------- */
+
+BondWLCPowAllVisc::~BondWLCPowAllVisc()
+{
+    if( allocated ) {
+        memory->destroy( setflag );
+        memory->destroy( temp );
+        memory->destroy( r0 );
+        memory->destroy( mu_targ );
+        memory->destroy( qp );
+        memory->destroy( gamc );
+        memory->destroy( gamt );
+        memory->destroy( sigc );
+        memory->destroy( sigt );
+    }
+    memory->destroy( rkey );
+}
+
+/* ---------------------------------------------------------------------- */
+
+void BondWLCPowAllVisc::allocate()
+{
+    allocated = 1;
+    int n = atom->nbondtypes;
+
+    memory->create( temp,    n + 1, "bond:temp" );
+    memory->create( r0,      n + 1, "bond:r0" );
+    memory->create( mu_targ, n + 1, "bond:mu_targ" );
+    memory->create( qp,      n + 1, "bond:qp" );
+    memory->create( gamc,    n + 1, "bond:gamc" );
+    memory->create( gamt,    n + 1, "bond:gamt" );
+    memory->create( sigc,    n + 1, "bond:sigc" );
+    memory->create( sigt,    n + 1, "bond:sigt" );
+
+    memory->create( setflag, n + 1, "bond:setflag" );
+    for( int i = 1; i <= n; i++ ) setflag[i] = 0;
+}
+
+/* ---------------------------------------------------------------------- */
+
+void BondWLCPowAllVisc::compute( int eflag, int vflag )
+{
+    if( eflag || vflag ) ev_setup( eflag, vflag );
+    else evflag = 0;
+
+    double **x = atom->x;
+    double **v = atom->v;
+    double **f = atom->f;
+    int *tag = atom->tag;
+    int *num_bond = atom->num_bond;
+    int **bond_atom = atom->bond_atom;
+    int **bond_type = atom->bond_type;
+    double **bond_r0 = atom->bond_r0;
+    int nlocal = atom->nlocal;
+    int nall = nlocal + atom->nghost;
+    double dtinvsqrt = 1.0 / sqrt( update->dt );
+
+    if( nall > nmax_key ) {
+        nmax_key = atom->nmax;
+        memory->destroy( rkey );
+        memory->create( rkey, nmax_key, "bond:rkey" );
+    }
+    unsigned int seed_now = RandomTEA::premix<64>( seed, ( unsigned int ) update->ntimestep );
+
+    int nmissing = 0;
+
+#if defined(_OPENMP)
+    #pragma omp parallel default(shared) reduction(+:nmissing)
+#endif
+    {
+#if defined(_OPENMP)
+        #pragma omp for schedule(static)
+#endif
+        for( int i = 0; i < nall; i++ )
+            rkey[i] = RandomTEA::atom_key( tag[i], seed_now );
+
+#if defined(_OPENMP)
+        #pragma omp for schedule(static)
+#endif
+        for( int i = 0; i < nlocal; i++ ) {
+            double fxi = 0.0, fyi = 0.0, fzi = 0.0;
+
+            for( int p = 0; p < num_bond[i]; p++ ) {
+                int j = domain->closest_image( i, atom->map( bond_atom[i][p] ) );
+                if( j < 0 ) {
+                    nmissing++;
+                    continue;
+                }
+                int type = bond_type[i][p];
+
+                double delx = x[i][0] - x[j][0];
+                double dely = x[i][1] - x[j][1];
+                double delz = x[i][2] - x[j][2];
+                double dvx = v[i][0] - v[j][0];
+                double dvy = v[i][1] - v[j][1];
+                double dvz = v[i][2] - v[j][2];
+
+                // persistence and power term are rescaled so that the
+                // linear shear modulus matches mu_targ
+
+                double l0 = bond_r0[i][p];
+                double ra = sqrt( delx * delx + dely * dely + delz * delz );
+                double lmax = l0 * r0[type];
+                double rr = 1.0 / r0[type];
+                double kph = pow( l0, qp[type] ) * temp[type] * ( 0.25 / ( ( 1.0 - rr ) * ( 1.0 - rr ) ) - 0.25 + rr );
+                double mu = 0.25 * sqrt( 3.0 ) * ( temp[type] * ( -0.25 / ( ( 1.0 - rr ) * ( 1.0 - rr ) ) + 0.25 + 0.5 * rr / ( ( 1.0 - rr ) * ( 1.0 - rr ) * ( 1.0 - rr ) ) ) / ( lmax * rr ) + kph * ( qp[type] + 1.0 ) / pow( l0, qp[type] + 1.0 ) );
+                double lambda = mu / mu_targ[type];
+                kph = kph * mu_targ[type] / mu;
+                rr = ra / lmax;
+                double rlogarg = pow( ra, qp[type] + 1.0 );
+                double vv = ( delx * dvx + dely * dvy + delz * dvz ) / ra;
+
+                if( rr >= 0.99 ) rr = 0.99;
+                if( rlogarg < 0.01 ) rlogarg = 0.01;
+
+                // symmetric random matrix, identical from both ends of the bond
+
+                double ww[3][3];
+                for( int tes = 0; tes < 3; tes++ )
+                    for( int see = 0; see < 3; see++ )
+                        ww[tes][see] = RandomTEA::gaussian<4>( rkey[i] + tes, rkey[j] + see );
+
+                double trace = ( ww[0][0] + ww[1][1] + ww[2][2] ) / 3.0;
+                double wrx = ( ww[0][0] - trace ) * delx + 0.5 * ( ww[0][1] + ww[1][0] ) * dely + 0.5 * ( ww[0][2] + ww[2][0] ) * delz;
+                double wry = 0.5 * ( ww[1][0] + ww[0][1] ) * delx + ( ww[1][1] - trace ) * dely + 0.5 * ( ww[1][2] + ww[2][1] ) * delz;
+                double wrz = 0.5 * ( ww[2][0] + ww[0][2] ) * delx + 0.5 * ( ww[2][1] + ww[1][2] ) * dely + ( ww[2][2] - trace ) * delz;
+
+                double fforce = - temp[type] * ( 0.25 / ( 1.0 - rr ) / ( 1.0 - rr ) - 0.25 + rr ) / lambda / ra
+                                + kph / rlogarg
+                                + ( sigc[type] * dtinvsqrt * trace - gamc[type] * vv ) / ra;
+                fxi += delx * fforce - gamt[type] * dvx + sigt[type] * dtinvsqrt * wrx / ra;
+                fyi += dely * fforce - gamt[type] * dvy + sigt[type] * dtinvsqrt * wry / ra;
+                fzi += delz * fforce - gamt[type] * dvz + sigt[type] * dtinvsqrt * wrz / ra;
+            }
+
+            f[i][0] += fxi;
+            f[i][1] += fyi;
+            f[i][2] += fzi;
+        }
+    }
+
+    if( nmissing ) error->one( FLERR, "Bond atoms missing" );
+}
+
+/* ---------------------------------------------------------------------- */
+
+void BondWLCPowAllVisc::settings( int narg, char **arg )
+{
+    if( narg != 1 ) error->all( FLERR, "Illegal bond_style command" );
+    seed = force->inumeric( FLERR, arg[0] );
+    if( seed <= 0 ) error->all( FLERR, "Illegal bond_style command" );
+}
+
+/* ---------------------------------------------------------------------- */
+
+void BondWLCPowAllVisc::coeff( int narg, char **arg )
+{
+    if( narg != 7 ) error->all( FLERR, "Incorrect args for bond coefficients" );
+    if( !allocated ) allocate();
+
+    int ilo, ihi;
+    force->bounds( arg[0], atom->nbondtypes, ilo, ihi );
+
+    double temp_one = force->numeric( FLERR, arg[1] );
+    double r0_one   = force->numeric( FLERR, arg[2] );
+    double mu_one   = force->numeric( FLERR, arg[3] );
+    double qp_one   = force->numeric( FLERR, arg[4] );
+    double gamc_one = force->numeric( FLERR, arg[5] );
+    double gamt_one = force->numeric( FLERR, arg[6] );
+
+    if( gamt_one > 3.0 * gamc_one ) error->all( FLERR, "Gamma_t > 3*Gamma_c" );
+
+    int count = 0;
+    for( int i = ilo; i <= ihi; i++ ) {
+        temp[i] = temp_one;
+        r0[i] = r0_one;
+        mu_targ[i] = mu_one;
+        qp[i] = qp_one;
+        gamc[i] = gamc_one;
+        gamt[i] = gamt_one;
+        sigc[i] = sqrt( 2.0 * temp_one * ( 3.0 * gamc_one - gamt_one ) );
+        sigt[i] = 2.0 * sqrt( gamt_one * temp_one );
+        setflag[i] = 1;
+        count++;
+    }
+
+    if( count == 0 ) error->all( FLERR, "Incorrect args for bond coefficients" );
+}
+
+/* ---------------------------------------------------------------------- */
+
+void BondWLCPowAllVisc::init_style()
+{
+    if( force->newton_bond )
+        error->all( FLERR, "Bond wlc_pow_all_visc requires newton_bond off" );
+    if( atom->bond_r0 == NULL )
+        error->all( FLERR, "Bond wlc_pow_all_visc requires atom attribute bond_r0" );
+    if( comm->ghost_velocity == 0 )
+        error->all( FLERR, "Bond wlc_pow_all_visc requires ghost atoms store velocity" );
+}
+
+/* ---------------------------------------------------------------------- */
+
+double BondWLCPowAllVisc::equilibrium_distance( int i )
+{
+    return r0[i];
+}
+
+/* ----------------------------------------------------------------------
+   proc 0 writes out coeffs to restart file
+------------------------------------------------------------------------- */
+
+void BondWLCPowAllVisc::write_restart( FILE *fp )
+{
+    fwrite( &seed, sizeof( int ), 1, fp );
+    fwrite( &temp[1], sizeof( double ), atom->nbondtypes, fp );
+    fwrite( &r0[1], sizeof( double ), atom->nbondtypes, fp );
+    fwrite( &mu_targ[1], sizeof( double ), atom->nbondtypes, fp );
+    fwrite( &qp[1], sizeof( double ), atom->nbondtypes, fp );
+    fwrite( &gamc[1], sizeof( double ), atom->nbondtypes, fp );
+    fwrite( &gamt[1], sizeof( double ), atom->nbondtypes, fp );
+}
+
+/* ----------------------------------------------------------------------
+   proc 0 reads coeffs from restart file, bcasts them
+------------------------------------------------------------------------- */
+
+void BondWLCPowAllVisc::read_restart( FILE *fp )
+{
+    allocate();
+
+    int n = atom->nbondtypes;
+    if( comm->me == 0 ) {
+        fread( &seed, sizeof( int ), 1, fp );
+        fread( &temp[1], sizeof( double ), n, fp );
+        fread( &r0[1], sizeof( double ), n, fp );
+        fread( &mu_targ[1], sizeof( double ), n, fp );
+        fread( &qp[1], sizeof( double ), n, fp );
+        fread( &gamc[1], sizeof( double ), n, fp );
+        fread( &gamt[1], sizeof( double ), n, fp );
+    }
+    MPI_Bcast( &seed, 1, MPI_INT, 0, world );
+    MPI_Bcast( &temp[1], n, MPI_DOUBLE, 0, world );
+    MPI_Bcast( &r0[1], n, MPI_DOUBLE, 0, world );
+    MPI_Bcast( &mu_targ[1], n, MPI_DOUBLE, 0, world );
+    MPI_Bcast( &qp[1], n, MPI_DOUBLE, 0, world );
+    MPI_Bcast( &gamc[1], n, MPI_DOUBLE, 0, world );
+    MPI_Bcast( &gamt[1], n, MPI_DOUBLE, 0, world );
+
+    for( int i = 1; i <= n; i++ ) {
+        sigc[i] = sqrt( 2.0 * temp[i] * ( 3.0 * gamc[i] - gamt[i] ) );
+        sigt[i] = 2.0 * sqrt( gamt[i] * temp[i] );
+        setflag[i] = 1;
+    }
+}
+
+/* ----------------------------------------------------------------------
+   proc 0 writes to data file
+------------------------------------------------------------------------- */
+
+void BondWLCPowAllVisc::write_data( FILE *fp )
+{
+    for( int i = 1; i <= atom->nbondtypes; i++ )
+        fprintf( fp, "%d %g %g %g %g %g %g\n", i, temp[i], r0[i], mu_targ[i], qp[i], gamc[i], gamt[i] );
+}
+
+/* ----------------------------------------------------------------------
+   the potential depends on the per-bond length bond_r0,
+   which is not known from the bond type alone
+------------------------------------------------------------------------- */
+
+double BondWLCPowAllVisc::single( int type, double rsq, int i, int j, double &fforce )
+{
+    fforce = 0.0;
+    return 0.0;
+}
+
+/* ---------------------------------------------------------------------- */
+
+double BondWLCPowAllVisc::memory_usage()
+{
+    double bytes = Bond::memory_usage();
+    bytes += nmax_key * sizeof( unsigned int );
+    return bytes;
+}
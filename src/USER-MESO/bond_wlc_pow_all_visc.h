@@ -0,0 +1,85 @@
+#ifdef BOND_CLASS
+
+BondStyle(wlc_pow_all_visc,BondWLCPowAllVisc)
+
+#else
+
+#ifndef LMP_BOND_WLCPOWALLVISC
+#define LMP_BOND_WLCPOWALLVISC
+
+#include "bond.h"
+
+namespace LAMMPS_NS {
+
+// host counterpart of wlc_pow_all_visc/meso
+// every atom sums the forces of the bonds it owns, which needs newton_bond off
+
+class BondWLCPowAllVisc : public Bond
+{
+public:
+    BondWLCPowAllVisc(class LAMMPS *);
+    ~BondWLCPowAllVisc();
+
+    void settings(int, char **);
+    void coeff(int, char **);
+    void init_style();
+    void compute(int, int);
+    double equilibrium_distance(int);
+    void write_restart(FILE *);
+    void read_restart(FILE *);
+    void write_data(FILE *);
+    double single(int, double, int, int, double &);
+    double memory_usage();
+
+protected:
+    int seed;
+    double *temp, *r0, *mu_targ, *qp, *gamc, *gamt;
+    double *sigc, *sigt;            // random force prefactors without 1/sqrt(dt)
+
+    int nmax_key;
+    unsigned int *rkey;             // per-atom RNG key of current step
+
+    void allocate();
+};
+
+}
+
+#endif
+
+#endif
+
+/* ERROR/WARNING messages:
+
+E: Illegal bond_style command
+
+The random number seed must be given and be positive.
+
+E: Incorrect args for bond coefficients
+
+Self-explanatory.  Check the input script or data file.
+
+E: Gamma_t > 3*Gamma_c
+
+The dissipative parameters give an imaginary central random force.
+
+E: Bond wlc_pow_all_visc requires newton_bond off
+
+Each atom must store all of its bonds, use the newton command to
+turn bonded Newton's 3rd law off.
+
+E: Bond wlc_pow_all_visc requires atom attribute bond_r0
+
+Use an atom style that stores the equilibrium length of each bond,
+e.g. atom_style rbc.
+
+E: Bond wlc_pow_all_visc requires ghost atoms store velocity
+
+Use the communicate vel yes command to enable this.
+
+E: Bond atoms missing
+
+The second atom needed to compute a particular bond is missing on this
+processor.  Typically this is because the pairwise cutoff is set too
+short or the bond has blown apart and an atom is too far away.
+
+*/
@@ -269,6 +269,8 @@ void MesoComm::exchange() {
     MPI_Status status[2];
     AtomVec * avec = atom->avec;
 
+    if( tiled ) error->all( FLERR, "RCB tiled sub-domains are not supported by USER-MESO" );
+
     // clear global->local map for owned and ghost atoms
     // b/c atoms migrate to new procs in exchange() and
     //     new ghosts are created in borders()
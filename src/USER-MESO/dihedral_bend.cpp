@@ -0,0 +1,242 @@
+/* ----------------------------------------------------------------------
+   LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+   http://lammps.sandia.gov, Sandia National Laboratories
+   Steve Plimpton, sjplimp@sandia.gov
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+
+   See the README file in the top-level LAMMPS directory.
+------------------------------------------------------------------------- */
+
+/* ----------------------------------------------------------------------
+   host implementation of dihedral_style bend/meso
+   OpenMP threads over owned atoms, each atom only updates itself
+------------------------------------------------------------------------- */
+
+#include "mpi.h"
+#include "math.h"
+#include "stdlib.h"
+#include "dihedral_bend.h"
+#include "atom.h"
+#include "comm.h"
+#include "domain.h"
+#include "force.h"
+#include "math_const.h"
+#include "memory.h"
+#include "error.h"
+
+using namespace LAMMPS_NS;
+using namespace MathConst;
+
+#define SMALL 0.000001
+
+/* ---------------------------------------------------------------------- */
+
+DihedralBend::DihedralBend( LAMMPS *lmp ) : Dihedral( lmp ) {}
+
+/* ---------------------------------------------------------------------- */
+
+DihedralBend::~DihedralBend()
+{
+    if( allocated ) {
+        memory->destroy( setflag );
+        memory->destroy( k );
+        memory->destroy( theta0 );
+    }
+}
+
+/* ---------------------------------------------------------------------- */
+
+void DihedralBend::allocate()
+{
+    allocated = 1;
+    int n = atom->ndihedraltypes;
+
+    memory->create( k, n + 1, "dihedral:k" );
+    memory->create( theta0, n + 1, "dihedral:theta0" );
+
+    memory->create( setflag, n + 1, "dihedral:setflag" );
+    for( int i = 1; i <= n; i++ ) setflag[i] = 0;
+}
+
+/* ---------------------------------------------------------------------- */
+
+void DihedralBend::compute( int eflag, int vflag )
+{
+    if( eflag || vflag ) ev_setup( eflag, vflag );
+    else evflag = 0;
+
+    double **x = atom->x;
+    double **f = atom->f;
+    int *tag = atom->tag;
+    int *num_dihedral = atom->num_dihedral;
+    int **dihedral_type = atom->dihedral_type;
+    int **dihedral_atom1 = atom->dihedral_atom1;
+    int **dihedral_atom2 = atom->dihedral_atom2;
+    int **dihedral_atom3 = atom->dihedral_atom3;
+    int **dihedral_atom4 = atom->dihedral_atom4;
+    int nlocal = atom->nlocal;
+
+    int nmissing = 0;
+
+#if defined(_OPENMP)
+    #pragma omp parallel for default(shared) schedule(static) reduction(+:nmissing)
+#endif
+    for( int i = 0; i < nlocal; i++ ) {
+        double fx = 0.0, fy = 0.0, fz = 0.0;
+
+        for( int p = 0; p < num_dihedral[i]; p++ ) {
+            int i1 = domain->closest_image( i, atom->map( dihedral_atom1[i][p] ) );
+            int i2 = domain->closest_image( i, atom->map( dihedral_atom2[i][p] ) );
+            int i3 = domain->closest_image( i, atom->map( dihedral_atom3[i][p] ) );
+            int i4 = domain->closest_image( i, atom->map( dihedral_atom4[i][p] ) );
+            if( i1 < 0 || i2 < 0 || i3 < 0 || i4 < 0 ) {
+                nmissing++;
+                continue;
+            }
+            int type = dihedral_type[i][p];
+
+            double d21x = x[i2][0] - x[i1][0];
+            double d21y = x[i2][1] - x[i1][1];
+            double d21z = x[i2][2] - x[i1][2];
+            double d31x = x[i3][0] - x[i1][0];
+            double d31y = x[i3][1] - x[i1][1];
+            double d31z = x[i3][2] - x[i1][2];
+            double d32x = x[i3][0] - x[i2][0];
+            double d32y = x[i3][1] - x[i2][1];
+            double d32z = x[i3][2] - x[i2][2];
+            double d34x = x[i3][0] - x[i4][0];
+            double d34y = x[i3][1] - x[i4][1];
+            double d34z = x[i3][2] - x[i4][2];
+            double d24x = x[i2][0] - x[i4][0];
+            double d24y = x[i2][1] - x[i4][1];
+            double d24z = x[i2][2] - x[i4][2];
+            double d14x = x[i1][0] - x[i4][0];
+            double d14y = x[i1][1] - x[i4][1];
+            double d14z = x[i1][2] - x[i4][2];
+
+            // normals of the two triangles
+
+            double n1x = d21y * d31z - d31y * d21z;
+            double n1y = d31x * d21z - d21x * d31z;
+            double n1z = d21x * d31y - d31x * d21y;
+            double n2x = d34y * d24z - d24y * d34z;
+            double n2y = d24x * d34z - d34x * d24z;
+            double n2z = d34x * d24y - d24x * d34y;
+            double n1 = n1x * n1x + n1y * n1y + n1z * n1z;
+            double n2 = n2x * n2x + n2y * n2y + n2z * n2z;
+            double nn = sqrt( n1 * n2 );
+
+            double costheta = ( n1x * n2x + n1y * n2y + n1z * n2z ) / nn;
+            if( costheta > 1.0 ) costheta = 1.0;
+            if( costheta < -1.0 ) costheta = -1.0;
+            double sintheta = sqrt( 1.0 - costheta * costheta );
+            if( sintheta < SMALL ) sintheta = SMALL;
+            double mx = ( n1x - n2x ) * d14x + ( n1y - n2y ) * d14y + ( n1z - n2z ) * d14z;
+            if( mx < 0 ) sintheta = -sintheta;
+
+            double alfa = k[type] * ( cos( theta0[type] ) - costheta * sin( theta0[type] ) / sintheta );
+            double a11 = -alfa * costheta / n1;
+            double a12 = alfa / nn;
+            double a22 = -alfa * costheta / n2;
+
+            // force on whichever corner i is
+
+            int itag = tag[i];
+            if( itag == dihedral_atom1[i][p] ) {
+                fx += a11 * ( n1y * d32z - n1z * d32y ) + a12 * ( n2y * d32z - n2z * d32y );
+                fy += a11 * ( n1z * d32x - n1x * d32z ) + a12 * ( n2z * d32x - n2x * d32z );
+                fz += a11 * ( n1x * d32y - n1y * d32x ) + a12 * ( n2x * d32y - n2y * d32x );
+            } else if( itag == dihedral_atom2[i][p] ) {
+                fx += a11 * ( n1z * d31y - n1y * d31z ) + a22 * ( n2y * d34z - n2z * d34y ) +
+                      a12 * ( n2z * d31y - n2y * d31z + n1y * d34z - n1z * d34y );
+                fy += a11 * ( n1x * d31z - n1z * d31x ) + a22 * ( n2z * d34x - n2x * d34z ) +
+                      a12 * ( n2x * d31z - n2z * d31x + n1z * d34x - n1x * d34z );
+                fz += a11 * ( n1y * d31x - n1x * d31y ) + a22 * ( n2x * d34y - n2y * d34x ) +
+                      a12 * ( n2y * d31x - n2x * d31y + n1x * d34y - n1y * d34x );
+            } else if( itag == dihedral_atom3[i][p] ) {
+                fx += a11 * ( n1y * d21z - n1z * d21y ) + a22 * ( n2z * d24y - n2y * d24z ) +
+                      a12 * ( n2y * d21z - n2z * d21y + n1z * d24y - n1y * d24z );
+                fy += a11 * ( n1z * d21x - n1x * d21z ) + a22 * ( n2x * d24z - n2z * d24x ) +
+                      a12 * ( n2z * d21x - n2x * d21z + n1x * d24z - n1z * d24x );
+                fz += a11 * ( n1x * d21y - n1y * d21x ) + a22 * ( n2y * d24x - n2x * d24y ) +
+                      a12 * ( n2x * d21y - n2y * d21x + n1y * d24x - n1x * d24y );
+            } else {
+                fx += a22 * ( n2z * d32y - n2y * d32z ) + a12 * ( n1z * d32y - n1y * d32z );
+                fy += a22 * ( n2x * d32z - n2z * d32x ) + a12 * ( n1x * d32z - n1z * d32x );
+                fz += a22 * ( n2y * d32x - n2x * d32y ) + a12 * ( n1y * d32x - n1x * d32y );
+            }
+        }
+
+        f[i][0] += fx;
+        f[i][1] += fy;
+        f[i][2] += fz;
+    }
+
+    if( nmissing ) error->one( FLERR, "Dihedral atoms missing" );
+}
+
+/* ----------------------------------------------------------------------
+   K and theta0 in degrees, same as bend/meso
+------------------------------------------------------------------------- */
+
+void DihedralBend::coeff( int narg, char **arg )
+{
+    if( narg != 3 ) error->all( FLERR, "Incorrect args for dihedral coefficients" );
+    if( !allocated ) allocate();
+
+    int ilo, ihi;
+    force->bounds( arg[0], atom->ndihedraltypes, ilo, ihi );
+
+    double k_one = force->numeric( FLERR, arg[1] );
+    double theta0_one = force->numeric( FLERR, arg[2] );
+
+    int count = 0;
+    for( int i = ilo; i <= ihi; i++ ) {
+        k[i] = k_one;
+        theta0[i] = theta0_one * MY_PI / 180.0;
+        setflag[i] = 1;
+        count++;
+    }
+
+    if( count == 0 ) error->all( FLERR, "Incorrect args for dihedral coefficients" );
+}
+
+/* ---------------------------------------------------------------------- */
+
+void DihedralBend::init_style()
+{
+    if( force->newton_bond )
+        error->all( FLERR, "Dihedral bend requires newton_bond off" );
+}
+
+/* ----------------------------------------------------------------------
+   proc 0 writes out coeffs to restart file
+------------------------------------------------------------------------- */
+
+void DihedralBend::write_restart( FILE *fp )
+{
+    fwrite( &k[1], sizeof( double ), atom->ndihedraltypes, fp );
+    fwrite( &theta0[1], sizeof( double ), atom->ndihedraltypes, fp );
+}
+
+/* ----------------------------------------------------------------------
+   proc 0 reads coeffs from restart file, bcasts them
+------------------------------------------------------------------------- */
+
+void DihedralBend::read_restart( FILE *fp )
+{
+    allocate();
+
+    if( comm->me == 0 ) {
+        fread( &k[1], sizeof( double ), atom->ndihedraltypes, fp );
+        fread( &theta0[1], sizeof( double ), atom->ndihedraltypes, fp );
+    }
+    MPI_Bcast( &k[1], atom->ndihedraltypes, MPI_DOUBLE, 0, world );
+    MPI_Bcast( &theta0[1], atom->ndihedraltypes, MPI_DOUBLE, 0, world );
+
+    for( int i = 1; i <= atom->ndihedraltypes; i++ ) setflag[i] = 1;
+}
@@ -0,0 +1,58 @@
+#ifdef DIHEDRAL_CLASS
+
+DihedralStyle(bend,DihedralBend)
+
+#else
+
+#ifndef LMP_DIHEDRAL_BEND
+#define LMP_DIHEDRAL_BEND
+
+#include "dihedral.h"
+
+namespace LAMMPS_NS {
+
+// host counterpart of bend/meso
+// bending between the two triangles 1-2-3 and 2-3-4 sharing edge 2-3
+
+class DihedralBend : public Dihedral
+{
+public:
+    DihedralBend(class LAMMPS *);
+    ~DihedralBend();
+    void compute(int, int);
+    void coeff(int, char **);
+    void init_style();
+    void write_restart(FILE *);
+    void read_restart(FILE *);
+
+protected:
+    double *k, *theta0;
+
+    void allocate();
+};
+
+}
+
+#endif
+
+#endif
+
+/* ERROR/WARNING messages:
+
+E: Incorrect args for dihedral coefficients
+
+Self-explanatory.  Check the input script or data file.
+
+E: Dihedral bend requires newton_bond off
+
+Each atom must store all of its dihedrals, use the newton command to
+turn bonded Newton's 3rd law off.
+
+E: Dihedral atoms missing
+
+One or more of 4 atoms needed to compute a particular dihedral are
+missing on this processor.  Typically this is because the pairwise
+cutoff is set too short or the dihedral has blown apart and an atom is
+too far away.
+
+*/
@@ -1,14 +1,23 @@
 
 #include "string.h"
+#include "stdlib.h"
 #include "domain.h"
 #include "atom.h"
 #include "update.h"
 #include "group.h"
+#include "force.h"
+#include "async_writer.h"
 #include "error.h"
 
 #include "dump_tdpd_meso.h"
+#include "tdpd_binary.h"
+#include "lodepng_meso.h"
 
 using namespace LAMMPS_NS;
+using namespace TDPDBinary;
+
+#define CHUNK_DEFAULT 16384
+#define MAXQUEUE 2
 
 /* ---------------------------------------------------------------------- */
 
@@ -21,7 +30,35 @@ DumpTDPD::DumpTDPD(LAMMPS *lmp, int narg, char **arg) : Dump(lmp, narg, arg)
     unwrap_flag = 0;
     format_default = NULL;
 
-    nth_species = atoi(arg[5])-1;             // the chemical to dump
+    if (!strcmp(arg[5],"all")) {
+        all_species = 1;
+        nth_species = 0;
+    } else {
+        all_species = 0;
+        nth_species = atoi(arg[5])-1;         // the chemical to dump
+    }
+
+    // *.tdpd suffix selects the self-describing binary format
+
+    tdpd_flag = 0;
+    char *suffix = filename + strlen(filename) - strlen(".tdpd");
+    if (suffix > filename && strcmp(suffix,".tdpd") == 0) {
+        tdpd_flag = 1;
+        binary = 1;
+    }
+    coord_dtype = FLOAT64;
+    conc_dtype = FLOAT32;
+    compress_flag = 1;
+    chunk_max = CHUNK_DEFAULT;
+
+    frame = NULL;
+    fp_pending = NULL;
+    wfp = NULL;
+
+    // tdpd mode has its own background writer
+
+    if (tdpd_flag) async_allow = 0;
+
     for(int i=6; i<narg; i++) {
         if (!strcmp(arg[i],"image") ) {
             if (!strcmp(arg[i+1],"yes") ) {
@@ -50,10 +87,33 @@ DumpTDPD::DumpTDPD(LAMMPS *lmp, int narg, char **arg) : Dump(lmp, narg, arg)
     }
 }
 
+/* ----------------------------------------------------------------------
+   pending frames are written before the file is closed
+------------------------------------------------------------------------- */
+
+DumpTDPD::~DumpTDPD()
+{
+    delete writer;
+    writer = NULL;
+    delete frame;
+    if (wfp) fclose(wfp);
+    if (fp_pending) fclose(fp_pending);
+}
+
 /* ---------------------------------------------------------------------- */
 
 void DumpTDPD::init_style()
 {
+    if (all_species && !tdpd_flag)
+        error->all(FLERR,"Dump tdpd/meso species all requires a *.tdpd file");
+    if (!all_species && (nth_species < 0 || nth_species >= atom->n_species))
+        error->all(FLERR,"Dump tdpd/meso species index is out of range");
+
+    if (tdpd_flag) {
+        init_tdpd();
+        return;
+    }
+
     if (image_flag == 0) size_one = 6;
     else size_one = 9;
 
@@ -131,6 +191,86 @@ void DumpTDPD::init_style()
     if (multifile == 0) openfile();
 }
 
+/* ----------------------------------------------------------------------
+   columns of a *.tdpd frame: id type x y z [ix iy iz] c1 ... cN
+------------------------------------------------------------------------- */
+
+void DumpTDPD::init_tdpd()
+{
+    const char *xyz[3] = {"x","y","z"};
+    const char *img[3] = {"ix","iy","iz"};
+    char str[LABEL_LEN];
+
+    field_label.clear();
+    field_dtype.clear();
+
+    field_label.push_back("id");
+    field_dtype.push_back(INT32);
+    field_label.push_back("type");
+    field_dtype.push_back(INT32);
+    for (int d = 0; d < 3; d++) {
+        std::string label = xyz[d];
+        if (unwrap_flag) label += "u";
+        else if (scale_flag) label += "s";
+        field_label.push_back(label);
+        field_dtype.push_back(coord_dtype);
+    }
+    if (image_flag)
+        for (int d = 0; d < 3; d++) {
+            field_label.push_back(img[d]);
+            field_dtype.push_back(INT32);
+        }
+
+    int first = all_species ? 0 : nth_species;
+    int last = all_species ? atom->n_species : nth_species+1;
+    for (int k = first; k < last; k++) {
+        sprintf(str,"c%d",k+1);
+        field_label.push_back(str);
+        field_dtype.push_back(conc_dtype);
+    }
+
+    size_one = field_label.size();
+
+    header_choice = &DumpTDPD::header_tdpd;
+    pack_choice = &DumpTDPD::pack_tdpd;
+    write_choice = &DumpTDPD::write_tdpd;
+
+    if (filewriter && writer == NULL) writer = new AsyncWriter(lmp,MAXQUEUE);
+
+    // open single file, one time only
+
+    if (multifile == 0) openfile();
+}
+
+/* ----------------------------------------------------------------------
+   in tdpd mode a newly opened file travels to the writer with the next
+   frame, fp stays NULL so Dump never writes to or closes it
+------------------------------------------------------------------------- */
+
+void DumpTDPD::openfile()
+{
+    Dump::openfile();
+    if (tdpd_flag && fp) {
+        fp_pending = fp;
+        fp = NULL;
+    }
+}
+
+/* ---------------------------------------------------------------------- */
+
+void DumpTDPD::write()
+{
+    Dump::write();
+
+    if (tdpd_flag && filewriter) {
+        frame->flush = flush_flag;
+        frame->close = multifile;
+        frame->compress = compress_flag;
+        writer->submit(&DumpTDPD::write_frame,frame);
+        frame = NULL;
+    }
+}
+
 /* ---------------------------------------------------------------------- */
 
 int DumpTDPD::modify_param(int narg, char **arg)
@@ -147,6 +287,29 @@ int DumpTDPD::modify_param(int narg, char **arg)
         else if (strcmp(arg[1],"no") == 0) image_flag = 0;
         else error->all(FLERR,"Illegal dump_modify command");
         return 2;
+    } else if (strcmp(arg[0],"precision") == 0) {
+        if (narg < 2) error->all(FLERR,"Illegal dump_modify command");
+        if (strcmp(arg[1],"double") == 0) coord_dtype = FLOAT64;
+        else if (strcmp(arg[1],"single") == 0) coord_dtype = FLOAT32;
+        else error->all(FLERR,"Illegal dump_modify command");
+        return 2;
+    } else if (strcmp(arg[0],"cprecision") == 0) {
+        if (narg < 2) error->all(FLERR,"Illegal dump_modify command");
+        if (strcmp(arg[1],"single") == 0) conc_dtype = FLOAT32;
+        else if (strcmp(arg[1],"half") == 0) conc_dtype = FLOAT16;
+        else error->all(FLERR,"Illegal dump_modify command");
+        return 2;
+    } else if (strcmp(arg[0],"compress") == 0) {
+        if (narg < 2) error->all(FLERR,"Illegal dump_modify command");
+        if (strcmp(arg[1],"yes") == 0) compress_flag = 1;
+        else if (strcmp(arg[1],"no") == 0) compress_flag = 0;
+        else error->all(FLERR,"Illegal dump_modify command");
+        return 2;
+    } else if (strcmp(arg[0],"chunk") == 0) {
+        if (narg < 2) error->all(FLERR,"Illegal dump_modify command");
+        chunk_max = force->inumeric(FLERR,arg[1]);
+        if (chunk_max <= 0) error->all(FLERR,"Illegal dump_modify command");
+        return 2;
     }
     return 0;
 }
@@ -246,6 +409,36 @@ void DumpTDPD::header_item_triclinic(bigint ndump)
 
 /* ---------------------------------------------------------------------- */
 
+void DumpTDPD::header_tdpd(bigint ndump)
+{
+    delete frame;
+    frame = new Frame;
+
+    frame->dump = this;
+    frame->fp = fp_pending;
+    fp_pending = NULL;
+    frame->ntimestep = update->ntimestep;
+    frame->natoms = ndump;
+    frame->triclinic = domain->triclinic;
+    memcpy(frame->boundary,&domain->boundary[0][0],6*sizeof(int));
+
+    double *box = frame->box;
+    box[0] = boxxlo;
+    box[1] = boxxhi;
+    box[2] = domain->triclinic ? boxxy : 0.0;
+    box[3] = boxylo;
+    box[4] = boxyhi;
+    box[5] = domain->triclinic ? boxxz : 0.0;
+    box[6] = boxzlo;
+    box[7] = boxzhi;
+    box[8] = domain->triclinic ? boxyz : 0.0;
+
+    frame->label = field_label;
+    frame->dtype = field_dtype;
+}
+
+/* ---------------------------------------------------------------------- */
+
 void DumpTDPD::pack_unwrap(int *ids)
 {
     int m,n;
@@ -460,6 +653,62 @@ void DumpTDPD::pack_noscale_noimage(int *ids)
         }
 }
 
+/* ----------------------------------------------------------------------
+   one row per atom in the column order of init_tdpd()
+------------------------------------------------------------------------- */
+
+void DumpTDPD::pack_tdpd(int *ids)
+{
+    int m,n;
+
+    int *tag = atom->tag;
+    int *type = atom->type;
+    tagint *image = atom->image;
+    int *mask = atom->mask;
+    double **x = atom->x;
+    float **CONC = atom->CONC;
+    int nlocal = atom->nlocal;
+    int triclinic = domain->triclinic;
+
+    double invxprd = 1.0/domain->xprd;
+    double invyprd = 1.0/domain->yprd;
+    double invzprd = 1.0/domain->zprd;
+
+    int first = all_species ? 0 : nth_species;
+    int last = all_species ? atom->n_species : nth_species+1;
+
+    double coord[3];
+
+    m = n = 0;
+    for (int i = 0; i < nlocal; i++)
+        if (mask[i] & groupbit) {
+            buf[m++] = tag[i];
+            buf[m++] = type[i];
+            if (unwrap_flag) domain->unmap(x[i],image[i],coord);
+            else if (scale_flag && triclinic) domain->x2lamda(x[i],coord);
+            else if (scale_flag) {
+                coord[0] = (x[i][0] - boxxlo) * invxprd;
+                coord[1] = (x[i][1] - boxylo) * invyprd;
+                coord[2] = (x[i][2] - boxzlo) * invzprd;
+            } else {
+                coord[0] = x[i][0];
+                coord[1] = x[i][1];
+                coord[2] = x[i][2];
+            }
+            buf[m++] = coord[0];
+            buf[m++] = coord[1];
+            buf[m++] = coord[2];
+            if (image_flag) {
+                buf[m++] = (image[i] & IMGMASK) - IMGMAX;
+                buf[m++] = (image[i] >> IMGBITS & IMGMASK) - IMGMAX;
+                buf[m++] = (image[i] >> IMG2BITS) - IMGMAX;
+            }
+            for (int k = first; k < last; k++)
+                buf[m++] = CONC[k][i];
+            if (ids) ids[n++] = tag[i];
+        }
+}
+
 /* ---------------------------------------------------------------------- */
 
 void DumpTDPD::write_binary(int n, double *mybuf)
@@ -495,3 +744,156 @@ void DumpTDPD::write_noimage(int n, double *mybuf)
         m += size_one;
     }
 }
+
+/* ----------------------------------------------------------------------
+   append N rows of mybuf to the frame as chunks of at most chunk_max atoms
+   within a chunk each column is stored contiguously in its own type
+------------------------------------------------------------------------- */
+
+void DumpTDPD::write_tdpd(int n, double *mybuf)
+{
+    for (int start = 0; start < n; start += chunk_max) {
+        int nchunk = MIN(chunk_max,n-start);
+        bigint offset = frame->data.size();
+        bigint rawbytes = 0;
+        for (int j = 0; j < size_one; j++)
+            rawbytes += (bigint) nchunk * dtype_size(field_dtype[j]);
+
+        frame->chunk_natoms.push_back(nchunk);
+        frame->chunk_offset.push_back(offset);
+        frame->data.resize(offset+rawbytes);
+
+        unsigned char *ptr = &frame->data[offset];
+        double *row = mybuf + (bigint) start*size_one;
+
+        for (int j = 0; j < size_one; j++) {
+            int dtype = field_dtype[j];
+            double *src = row + j;
+            for (int i = 0; i < nchunk; i++, src += size_one) {
+                if (dtype == INT32) {
+                    int v = static_cast<int> (*src);
+                    memcpy(ptr,&v,sizeof(int));
+                    ptr += sizeof(int);
+                } else if (dtype == FLOAT64) {
+                    memcpy(ptr,src,sizeof(double));
+                    ptr += sizeof(double);
+                } else if (dtype == FLOAT32) {
+                    float v = *src;
+                    memcpy(ptr,&v,sizeof(float));
+                    ptr += sizeof(float);
+                } else {
+                    unsigned short v = float_to_half(*src);
+                    memcpy(ptr,&v,sizeof(unsigned short));
+                    ptr += sizeof(unsigned short);
+                }
+            }
+        }
+    }
+}
+
+/* ----------------------------------------------------------------------
+   encode and write one frame, runs on the writer thread
+   must not touch anything but the frame and the file it owns
+------------------------------------------------------------------------- */
+
+void DumpTDPD::write_frame(void *ptr)
+{
+    Frame *fr = (Frame *) ptr;
+    DumpTDPD *dump = fr->dump;
+
+    // compress each chunk, keep it raw if deflate does not pay off
+
+    int nchunk = fr->chunk_natoms.size();
+    int nfield = fr->label.size();
+    std::vector<int> codec(nchunk,RAW);
+    std::vector<bigint> rawbytes(nchunk),nbytes(nchunk);
+    std::vector<unsigned char *> zbuf(nchunk,(unsigned char *) NULL);
+    std::vector<unsigned char> shuffled;
+
+    for (int c = 0; c < nchunk; c++) {
+        bigint natoms = fr->chunk_natoms[c];
+        bigint end = (c+1 < nchunk) ? fr->chunk_offset[c+1] : fr->data.size();
+        rawbytes[c] = nbytes[c] = end - fr->chunk_offset[c];
+        if (!fr->compress || rawbytes[c] == 0) continue;
+
+        unsigned char *raw = &fr->data[fr->chunk_offset[c]];
+        shuffled.resize(rawbytes[c]);
+        bigint pos = 0;
+        for (int j = 0; j < nfield; j++) {
+            int size = dtype_size(fr->dtype[j]);
+            shuffle(raw+pos,&shuffled[pos],natoms,size);
+            pos += natoms*size;
+        }
+
+        size_t zsize = 0;
+        unsigned err = lodepng_zlib_compress(&zbuf[c],&zsize,&shuffled[0],
+                                             rawbytes[c],
+                                             &lodepng_default_compress_settings);
+        if (err == 0 && (bigint) zsize < rawbytes[c]) {
+            codec[c] = SHUFFLE_DEFLATE;
+            nbytes[c] = zsize;
+        } else {
+            free(zbuf[c]);
+            zbuf[c] = NULL;
+        }
+    }
+
+    // frame size after the nbytes field
+
+    bigint framebytes = sizeof(bigint) + 7*sizeof(int) + 9*sizeof(double) +
+        sizeof(int) + nfield*(LABEL_LEN+sizeof(int)) + sizeof(int);
+    for (int c = 0; c < nchunk; c++)
+        framebytes += 2*sizeof(int) + 2*sizeof(bigint) + nbytes[c];
+
+    if (fr->fp) {
+        if (dump->wfp) fclose(dump->wfp);
+        dump->wfp = fr->fp;
+    }
+    FILE *fp = dump->wfp;
+
+    int ok = 1;
+    if (fr->fp) {
+        ok &= fwrite(MAGIC,sizeof(MAGIC),1,fp) == 1;
+        ok &= fwrite(&VERSION,sizeof(int),1,fp) == 1;
+        ok &= fwrite(&ENDIAN,sizeof(int),1,fp) == 1;
+    }
+
+    ok &= fwrite(FRAME_TAG,sizeof(FRAME_TAG),1,fp) == 1;
+    ok &= fwrite(&fr->ntimestep,sizeof(bigint),1,fp) == 1;
+    ok &= fwrite(&framebytes,sizeof(bigint),1,fp) == 1;
+    ok &= fwrite(&fr->natoms,sizeof(bigint),1,fp) == 1;
+    ok &= fwrite(&fr->triclinic,sizeof(int),1,fp) == 1;
+    ok &= fwrite(fr->boundary,sizeof(int),6,fp) == 6;
+    ok &= fwrite(fr->box,sizeof(double),9,fp) == 9;
+
+    ok &= fwrite(&nfield,sizeof(int),1,fp) == 1;
+    for (int j = 0; j < nfield; j++) {
+        char label[LABEL_LEN];
+        memset(label,0,LABEL_LEN);
+        strncpy(label,fr->label[j].c_str(),LABEL_LEN-1);
+        ok &= fwrite(label,LABEL_LEN,1,fp) == 1;
+        ok &= fwrite(&fr->dtype[j],sizeof(int),1,fp) == 1;
+    }
+
+    ok &= fwrite(&nchunk,sizeof(int),1,fp) == 1;
+    for (int c = 0; c < nchunk; c++) {
+        ok &= fwrite(&fr->chunk_natoms[c],sizeof(int),1,fp) == 1;
+        ok &= fwrite(&codec[c],sizeof(int),1,fp) == 1;
+        ok &= fwrite(&rawbytes[c],sizeof(bigint),1,fp) == 1;
+        ok &= fwrite(&nbytes[c],sizeof(bigint),1,fp) == 1;
+        if (nbytes[c] == 0) continue;
+        if (codec[c] == RAW)
+            ok &= fwrite(&fr->data[fr->chunk_offset[c]],nbytes[c],1,fp) == 1;
+        else ok &= fwrite(zbuf[c],nbytes[c],1,fp) == 1;
+        free(zbuf[c]);
+    }
+
+    if (fr->flush) fflush(fp);
+    if (fr->close) {
+        fclose(fp);
+        dump->wfp = NULL;
+    }
+    if (!ok) dump->writer->fail("Error writing tdpd dump file");
+
+    delete fr;
+}
@@ -8,13 +8,22 @@ DumpStyle(tdpd/meso,DumpTDPD)
 #ifndef LMP_DUMP_TDPD_H
 #define LMP_DUMP_TDPD_H
 
+#include <vector>
+#include <string>
 #include "dump.h"
 
 namespace LAMMPS_NS {
 
+// a filename ending in .tdpd selects the self-describing binary format of
+// tdpd_binary.h: chunked SoA frames, optionally reduced precision and
+// deflate compressed, handed to a background AsyncWriter for encoding
+// and output, and readable with read_dump/rerun ... format tdpd
+
 class DumpTDPD : public Dump {
 public:
     DumpTDPD(LAMMPS *, int, char**);
+    ~DumpTDPD();
+    void write();
 
 private:
     int scale_flag;            // 1 if atom coords are scaled, 0 if no
@@ -24,8 +33,39 @@ private:
     char *columns;             // column labels
 
     int nth_species;                   // the chemical to dump
+    int all_species;                   // 1 if dumping every chemical
+
+    int tdpd_flag;                     // 1 if writing a *.tdpd file
+    int coord_dtype;                   // storage type of coords in *.tdpd
+    int conc_dtype;                    // storage type of concentrations
+    int compress_flag;                 // 1 if chunks are deflate compressed
+    int chunk_max;                     // max # of atoms per chunk
+
+    std::vector<std::string> field_label;   // per-column label in *.tdpd
+    std::vector<int> field_dtype;           // per-column storage type
+
+    struct Frame {                     // one snapshot for the writer thread
+        DumpTDPD *dump;
+        FILE *fp;                      // newly opened file, else NULL
+        int flush, close;              // flush or close file after frame
+        int compress;                  // 1 to try deflate on each chunk
+        bigint ntimestep, natoms;
+        int triclinic, boundary[6];
+        double box[9];
+        std::vector<std::string> label;
+        std::vector<int> dtype;
+        std::vector<int> chunk_natoms;
+        std::vector<bigint> chunk_offset;   // start of chunk in data
+        std::vector<unsigned char> data;    // raw chunks, columns in a row
+    };
+
+    Frame *frame;                      // frame being assembled
+    FILE *fp_pending;                  // opened file not yet handed over
+    FILE *wfp;                         // file owned by the writer thread
 
     void init_style();
+    void init_tdpd();
+    void openfile();
     int modify_param(int, char **);
     void write_header(bigint);
     void pack(int *);
@@ -37,6 +77,7 @@ private:
     void header_binary_triclinic(bigint);
     void header_item(bigint);
     void header_item_triclinic(bigint);
+    void header_tdpd(bigint);
 
     typedef void (DumpTDPD::*FnPtrPack)(int *);
     FnPtrPack pack_choice;               // ptr to pack functions
@@ -47,12 +88,16 @@ private:
     void pack_noscale_noimage(int *);
     void pack_scale_image_triclinic(int *);
     void pack_scale_noimage_triclinic(int *);
+    void pack_tdpd(int *);
 
     typedef void (DumpTDPD::*FnPtrData)(int, double *);
     FnPtrData write_choice;              // ptr to write data functions
     void write_binary(int, double *);
     void write_image(int, double *);
     void write_noimage(int, double *);
+    void write_tdpd(int, double *);
+
+    static void write_frame(void *);
 };
 
 }
@@ -68,4 +113,16 @@ Self-explanatory.  Check the input script syntax and compare to the
 documentation for the command.  You can use -echo screen as a
 command-line option when running LAMMPS to see the offending line.
 
+E: Dump tdpd/meso species all requires a *.tdpd file
+
+Dumping every species is only supported by the binary tdpd format.
+
+E: Dump tdpd/meso species index is out of range
+
+The species must be between 1 and the N of atom_style tdpd N.
+
+E: Error writing tdpd dump file
+
+The background writer could not write a frame, e.g. the disk is full.
+
 */
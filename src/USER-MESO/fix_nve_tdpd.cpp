@@ -0,0 +1,90 @@
+/* ----------------------------------------------------------------------
+   LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+   http://lammps.sandia.gov, Sandia National Laboratories
+   Steve Plimpton, sjplimp@sandia.gov
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+
+   See the README file in the top-level LAMMPS directory.
+------------------------------------------------------------------------- */
+
+#include "stdio.h"
+#include "string.h"
+#include "fix_nve_tdpd.h"
+#include "atom.h"
+#include "update.h"
+#include "error.h"
+
+using namespace LAMMPS_NS;
+using namespace FixConst;
+
+/* ---------------------------------------------------------------------- */
+
+FixNVETDPD::FixNVETDPD( LAMMPS *lmp, int narg, char **arg ) :
+    Fix( lmp, narg, arg ),
+    dtv( 0 )
+{
+    if( narg < 3 ) error->all( FLERR, "Illegal fix nve/tdpd command" );
+
+    time_integrate = 1;
+}
+
+/* ---------------------------------------------------------------------- */
+
+void FixNVETDPD::init()
+{
+    if( atom->CONC == NULL || atom->CONF == NULL )
+        error->all( FLERR, "Fix nve/tdpd requires atom_style tdpd" );
+
+    dtv = update->dt;
+}
+
+/* ---------------------------------------------------------------------- */
+
+int FixNVETDPD::setmask()
+{
+    int mask = 0;
+    mask |= FINAL_INTEGRATE;
+    return mask;
+}
+
+/* ----------------------------------------------------------------------
+   CONF holds the flux of the force evaluation of this step
+   integrated here, before exchange or sort can reorder the owned atoms,
+   since CONF is not carried along with them
+   concentrations are clipped at zero as on the GPU
+------------------------------------------------------------------------- */
+
+void FixNVETDPD::final_integrate()
+{
+    float **CONC = atom->CONC;
+    float **CONF = atom->CONF;
+    int *mask = atom->mask;
+    int nlocal = atom->nlocal;
+    int n_species = atom->n_species;
+    if( igroup == atom->firstgroup ) nlocal = atom->nfirst;
+
+    for( int k = 0; k < n_species; k++ ) {
+        float *c = CONC[k];
+        float *cf = CONF[k];
+#if defined(_OPENMP)
+        #pragma omp parallel for schedule(static)
+#endif
+        for( int i = 0; i < nlocal; i++ ) {
+            if( mask[i] & groupbit ) {
+                c[i] += cf[i] * dtv;
+                c[i] = c[i] > 0 ? c[i] : 0.0f;
+            }
+        }
+    }
+}
+
+/* ---------------------------------------------------------------------- */
+
+void FixNVETDPD::reset_dt()
+{
+    dtv = update->dt;
+}
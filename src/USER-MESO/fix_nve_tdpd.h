@@ -0,0 +1,45 @@
+#ifdef FIX_CLASS
+
+FixStyle(nve/tdpd,FixNVETDPD)
+
+#else
+
+#ifndef LMP_FIX_NVE_TDPD_H
+#define LMP_FIX_NVE_TDPD_H
+
+#include "fix.h"
+
+namespace LAMMPS_NS {
+
+// host counterpart of nve/tdpd/meso, explicit Euler step of the concentration
+
+class FixNVETDPD : public Fix
+{
+public:
+    FixNVETDPD(class LAMMPS *, int, char **);
+    virtual void init();
+    virtual int setmask();
+    virtual void final_integrate();
+    virtual void reset_dt();
+protected:
+    double dtv;
+};
+
+}
+
+#endif
+
+#endif
+
+/* ERROR/WARNING messages:
+
+E: Illegal fix nve/tdpd command
+
+Self-explanatory.  Check the input script syntax and compare to the
+documentation for the command.
+
+E: Fix nve/tdpd requires atom_style tdpd
+
+The per-species concentration arrays must be allocated on the host.
+
+*/
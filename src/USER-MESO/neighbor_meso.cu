@@ -56,6 +56,8 @@ MesoNeighbor::~MesoNeighbor()
 
 void MesoNeighbor::init()
 {
+    if( cacheflag ) error->all( FLERR, "<MESO> Neigh_modify cache not implemented in USER-MESO." );
+
     for( int i = 0; i < nrequest; i++ ) {
         if( requests[i]->cudable ) {
             if ( lists_device.find(i) != lists_device.end() ) delete lists_device[i];
@@ -0,0 +1,584 @@
+/* ----------------------------------------------------------------------
+   LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+   http://lammps.sandia.gov, Sandia National Laboratories
+   Steve Plimpton, sjplimp@sandia.gov
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+
+   See the README file in the top-level LAMMPS directory.
+------------------------------------------------------------------------- */
+
+/* ----------------------------------------------------------------------
+   host implementation of pair_style tdpd/meso
+   OpenMP threads over a full neighbor list, each I only updates itself,
+   so no reduction of forces or fluxes between threads is needed
+------------------------------------------------------------------------- */
+
+#include "mpi.h"
+#include "math.h"
+#include "stdio.h"
+#include "stdlib.h"
+#include "pair_tdpd.h"
+#include "atom.h"
+#include "comm.h"
+#include "update.h"
+#include "force.h"
+#include "neighbor.h"
+#include "neigh_list.h"
+#include "neigh_request.h"
+#include "random_tea.h"
+#include "memory.h"
+#include "error.h"
+
+using namespace LAMMPS_NS;
+using namespace TDPD_COEFFICIENTS;
+
+#define EPSILON    1.0e-10
+#define EPSILON_SQ 1.0e-20
+
+/* ---------------------------------------------------------------------- */
+
+PairTDPD::PairTDPD( LAMMPS *lmp ) : Pair( lmp ),
+    n_species( 1 )
+{
+    coeff_ready = false;
+    no_virial_fdotr_compute = 1;
+    nmax_key = 0;
+    rkey = NULL;
+}
+
+/* ---------------------------------------------------------------------- */
+
+PairTDPD::~PairTDPD()
+{
+    if( allocated ) {
+        memory->destroy( setflag );
+        memory->destroy( cut );
+        memory->destroy( cutsq );
+        memory->destroy( cutinv );
+        memory->destroy( a0 );
+        memory->destroy( gamma );
+        memory->destroy( sigma );
+        memory->destroy( s1 );
+        memory->destroy( cutc );
+        memory->destroy( kappa );
+        memory->destroy( s2 );
+    }
+    memory->destroy( rkey );
+}
+
+/* ---------------------------------------------------------------------- */
+
+void PairTDPD::allocate()
+{
+    allocated = 1;
+    int n = atom->ntypes;
+
+    memory->create( setflag, n + 1, n + 1, "pair:setflag" );
+    memory->create( cutsq,   n + 1, n + 1, "pair:cutsq" );
+    memory->create( cut,     n + 1, n + 1, "pair:cut" );
+    memory->create( cutinv,  n + 1, n + 1, "pair:cutinv" );
+    memory->create( a0,      n + 1, n + 1, "pair:a0" );
+    memory->create( gamma,   n + 1, n + 1, "pair:gamma" );
+    memory->create( sigma,   n + 1, n + 1, "pair:sigma" );
+    memory->create( s1,      n + 1, n + 1, "pair:weight_s1" );
+
+    memory->create( cutc,    n + 1, n + 1, n_species, "pair:cutc" );
+    memory->create( kappa,   n + 1, n + 1, n_species, "pair:kappa" );
+    memory->create( s2,      n + 1, n + 1, n_species, "pair:weight_s2" );
+
+    for( int i = 1; i <= n; i++ )
+        for( int j = i; j <= n; j++ )
+            setflag[i][j] = 0;
+}
+
+/* ----------------------------------------------------------------------
+   pack coefficients of all type pairs, same layout as MesoPairTDPD
+------------------------------------------------------------------------- */
+
+void PairTDPD::prepare_coeff()
+{
+    if( coeff_ready ) return;
+    if( !allocated ) allocate();
+
+    int n = atom->ntypes;
+    int stride = n_coeff + n_chemcoeff * n_species;
+    coeff_table.resize( n * n * stride );
+    for( int i = 1; i <= n; i++ ) {
+        for( int j = 1; j <= n; j++ ) {
+            double *coeff_ij = &coeff_table[ ( ( i - 1 ) * n + ( j - 1 ) ) * stride ];
+
+            coeff_ij[p_cut   ] = cut[i][j];
+            coeff_ij[p_cutsq ] = cut[i][j] * cut[i][j];
+            coeff_ij[p_cutinv] = cutinv[i][j];
+            coeff_ij[p_s1    ] = s1[i][j];
+            coeff_ij[p_a0    ] = a0[i][j];
+            coeff_ij[p_gamma ] = gamma[i][j];
+            coeff_ij[p_sigma ] = sigma[i][j];
+
+            for( int k = 0; k < n_species; k++ ) {
+                coeff_ij[p_cutc  + n_chemcoeff * k] = cutc[i][j][k];
+                coeff_ij[p_kappa + n_chemcoeff * k] = kappa[i][j][k];
+                coeff_ij[p_s2    + n_chemcoeff * k] = s2[i][j][k];
+            }
+        }
+    }
+    coeff_ready = true;
+}
+
+/* ---------------------------------------------------------------------- */
+
+void PairTDPD::compute( int eflag, int vflag )
+{
+    if( eflag || vflag ) ev_setup( eflag, vflag );
+    else evflag = vflag_fdotr = 0;
+
+    if( !coeff_ready ) prepare_coeff();
+
+    double **x = atom->x;
+    double **v = atom->v;
+    double **f = atom->f;
+    int *type = atom->type;
+    int *tag = atom->tag;
+    float **CONC = atom->CONC;
+    float **CONF = atom->CONF;
+    int nlocal = atom->nlocal;
+    int nall = nlocal + atom->nghost;
+    double *special_lj = force->special_lj;
+    double dtinvsqrt = 1.0 / sqrt( update->dt );
+
+    int inum = list->inum;
+    int *ilist = list->ilist;
+    int *numneigh = list->numneigh;
+    int **firstneigh = list->firstneigh;
+
+    const int ntype = atom->ntypes;
+    const int nspec = n_species;
+    const int stride = n_coeff + n_chemcoeff * n_species;
+    const double *coeffs = &coeff_table[0];
+
+    // per-atom keys of the stateless RNG for this step
+    // the random force of a pair only depends on (seed, step, tag I, tag J)
+
+    if( nall > nmax_key ) {
+        nmax_key = atom->nmax;
+        memory->destroy( rkey );
+        memory->create( rkey, nmax_key, "pair:rkey" );
+    }
+    unsigned int seed_step = seed_now();
+
+    // fluxes are accumulated into owned atoms only
+
+    for( int k = 0; k < nspec; k++ )
+        for( int i = 0; i < nlocal; i++ ) CONF[k][i] = 0.0f;
+
+    double evdwl_sum = 0.0;
+    double v0 = 0.0, v1 = 0.0, v2 = 0.0, v3 = 0.0, v4 = 0.0, v5 = 0.0;
+
+#if defined(_OPENMP)
+    #pragma omp parallel default(shared) reduction(+:evdwl_sum,v0,v1,v2,v3,v4,v5)
+#endif
+    {
+#if defined(_OPENMP)
+        #pragma omp for schedule(static)
+#endif
+        for( int i = 0; i < nall; i++ )
+            rkey[i] = RandomTEA::atom_key( tag[i], seed_step );
+
+#if defined(_OPENMP)
+        #pragma omp for schedule(static)
+#endif
+        for( int ii = 0; ii < inum; ii++ ) {
+            int i = ilist[ii];
+            double xtmp = x[i][0];
+            double ytmp = x[i][1];
+            double ztmp = x[i][2];
+            double vxtmp = v[i][0];
+            double vytmp = v[i][1];
+            double vztmp = v[i][2];
+            int itype = type[i];
+            int *jlist = firstneigh[i];
+            int jnum = numneigh[i];
+            const double *coeff_i = coeffs + ( itype - 1 ) * ntype * stride;
+
+            double fx = 0.0, fy = 0.0, fz = 0.0;
+
+            for( int jj = 0; jj < jnum; jj++ ) {
+                int j = jlist[jj];
+                double factor_dpd = special_lj[sbmask( j )];
+                j &= NEIGHMASK;
+
+                double delx = xtmp - x[j][0];
+                double dely = ytmp - x[j][1];
+                double delz = ztmp - x[j][2];
+                double rsq = delx * delx + dely * dely + delz * delz;
+                if( rsq < EPSILON_SQ ) continue;     // r can be 0.0 in DPD systems
+
+                const double *coeff_ij = coeff_i + ( type[j] - 1 ) * stride;
+                double r = sqrt( rsq );
+                double rinv = 1.0 / r;
+
+                // force ------------------------------------------------------
+
+                if( rsq < coeff_ij[p_cutsq] ) {
+                    double rn = RandomTEA::gaussian<4>( rkey[i], rkey[j] );
+                    double delvx = vxtmp - v[j][0];
+                    double delvy = vytmp - v[j][1];
+                    double delvz = vztmp - v[j][2];
+                    double dot = delx * delvx + dely * delvy + delz * delvz;
+                    double wc = 1.0 - r * coeff_ij[p_cutinv];
+                    double wr = pow( wc, 0.5 * coeff_ij[p_s1] );
+
+                    // Sigma and Gamma are directly given as parameters.
+                    double fpair = coeff_ij[p_a0] * wc
+                                   - coeff_ij[p_gamma] * wr * wr * dot * rinv
+                                   + coeff_ij[p_sigma] * wr * rn * dtinvsqrt;
+                    fpair *= factor_dpd * rinv;
+
+                    fx += delx * fpair;
+                    fy += dely * fpair;
+                    fz += delz * fpair;
+
+                    // each pair is visited from both sides, tally half
+
+                    if( evflag ) {
+                        double evdwl = 0.0;
+                        if( eflag ) {
+                            evdwl = 0.25 * coeff_ij[p_a0] * coeff_ij[p_cut] * wc * wc * factor_dpd;
+                            evdwl_sum += evdwl;
+                            if( eflag_atom ) eatom[i] += evdwl;
+                        }
+                        if( vflag_either ) {
+                            double vxx = 0.5 * delx * delx * fpair;
+                            double vyy = 0.5 * dely * dely * fpair;
+                            double vzz = 0.5 * delz * delz * fpair;
+                            double vxy = 0.5 * delx * dely * fpair;
+                            double vxz = 0.5 * delx * delz * fpair;
+                            double vyz = 0.5 * dely * delz * fpair;
+                            v0 += vxx; v1 += vyy; v2 += vzz;
+                            v3 += vxy; v4 += vxz; v5 += vyz;
+                            if( vflag_atom ) {
+                                vatom[i][0] += vxx;
+                                vatom[i][1] += vyy;
+                                vatom[i][2] += vzz;
+                                vatom[i][3] += vxy;
+                                vatom[i][4] += vxz;
+                                vatom[i][5] += vyz;
+                            }
+                        }
+                    }
+                }
+
+                // chemical concentration transport, one lane per species -----
+
+#if defined(_OPENMP) && _OPENMP >= 201307
+                #pragma omp simd
+#endif
+                for( int k = 0; k < nspec; k++ ) {
+                    const double *chem = coeff_ij + p_cutc + k * n_chemcoeff;
+                    double cutck = chem[0];
+                    if( rsq < cutck * cutck ) {
+                        double wcr = 1.0 - r / cutck;
+                        double wdc = pow( wcr, chem[p_s2 - p_cutc] );
+                        CONF[k][i] += static_cast<float>( -chem[p_kappa - p_cutc] * wdc ) *
+                                      ( CONC[k][i] - CONC[k][j] );
+                    }
+                }
+            }
+
+            f[i][0] += fx;
+            f[i][1] += fy;
+            f[i][2] += fz;
+        }
+    }
+
+    if( eflag_global ) eng_vdwl += evdwl_sum;
+    if( vflag_global ) {
+        virial[0] += v0;
+        virial[1] += v1;
+        virial[2] += v2;
+        virial[3] += v3;
+        virial[4] += v4;
+        virial[5] += v5;
+    }
+}
+
+/* ---------------------------------------------------------------------- */
+
+unsigned int PairTDPD::seed_now()
+{
+    return RandomTEA::premix<64>( seed, update->ntimestep );
+}
+
+/* ----------------------------------------------------------------------
+   global settings, same as tdpd/meso
+------------------------------------------------------------------------- */
+
+void PairTDPD::settings( int narg, char **arg )
+{
+    if( narg != 3 ) error->all( FLERR, "Illegal pair_style command" );
+
+    cut_global = force->numeric( FLERR, arg[0] );
+    seed = force->inumeric( FLERR, arg[1] );
+    int n_species_one = force->inumeric( FLERR, arg[2] );
+    if( n_species_one <= 0 ) error->all( FLERR, "Illegal pair_style command" );
+
+    // per-species coeff arrays are sized by n_species when allocated
+
+    if( allocated && n_species_one != n_species )
+        error->all( FLERR, "Pair tdpd/cpu species count cannot be changed" );
+    n_species = n_species_one;
+
+    if( allocated ) {
+        for( int i = 1; i <= atom->ntypes; i++ )
+            for( int j = i + 1; j <= atom->ntypes; j++ )
+                if( setflag[i][j] )
+                    cut[i][j] = cut_global, cutinv[i][j] = 1.0 / cut_global;
+    }
+}
+
+/* ----------------------------------------------------------------------
+   set coeffs for one or more type pairs
+------------------------------------------------------------------------- */
+
+void PairTDPD::coeff( int narg, char **arg )
+{
+    if( narg != 7 + n_chemcoeff * n_species )
+        error->all( FLERR, "Incorrect args for pair coefficients" );
+    if( !allocated ) allocate();
+
+    int ilo, ihi, jlo, jhi;
+    force->bounds( arg[0], atom->ntypes, ilo, ihi );
+    force->bounds( arg[1], atom->ntypes, jlo, jhi );
+
+    int p = 2;
+    double a0_one    = force->numeric( FLERR, arg[p++] );
+    double gamma_one = force->numeric( FLERR, arg[p++] );
+    double sigma_one = force->numeric( FLERR, arg[p++] );
+    double s1_one    = force->numeric( FLERR, arg[p++] );
+    double cut_one   = force->numeric( FLERR, arg[p++] );
+
+    std::vector<double> cut_two( n_species ), kappa_one( n_species ), s2_one( n_species );
+    for( int k = 0; k < n_species; k++ ) {
+        cut_two[k]   = force->numeric( FLERR, arg[p++] );
+        kappa_one[k] = force->numeric( FLERR, arg[p++] );
+        s2_one[k]    = force->numeric( FLERR, arg[p++] );
+    }
+
+    int count = 0;
+    for( int i = ilo; i <= ihi; i++ ) {
+        for( int j = MAX( jlo, i ); j <= jhi; j++ ) {
+            a0[i][j]     = a0_one;
+            gamma[i][j]  = gamma_one;
+            sigma[i][j]  = sigma_one;
+            s1[i][j]     = s1_one;
+            cut[i][j]    = cut_one;
+            cutinv[i][j] = 1.0 / cut_one;
+            setflag[i][j] = 1;
+
+            // species specific
+            for( int k = 0; k < n_species; k++ ) {
+                cutc[i][j][k]  = cut_two[k];
+                kappa[i][j][k] = kappa_one[k];
+                s2[i][j][k]    = s2_one[k];
+            }
+
+            count++;
+        }
+    }
+
+    coeff_ready = false;
+
+    if( count == 0 )
+        error->all( FLERR, "Incorrect args for pair coefficients" );
+}
+
+/* ----------------------------------------------------------------------
+   init specific to this pair style
+------------------------------------------------------------------------- */
+
+void PairTDPD::init_style()
+{
+    if( atom->CONC == NULL || atom->CONF == NULL )
+        error->all( FLERR, "Pair tdpd/cpu requires atom_style tdpd" );
+    if( atom->n_species != n_species )
+        error->all( FLERR, "Pair tdpd/cpu species count does not match atom_style" );
+    if( comm->ghost_velocity == 0 )
+        error->all( FLERR, "Pair tdpd/cpu requires ghost atoms store velocity" );
+
+    // full list, like newton = 2 on the GPU
+    // every I sums its own force and flux, J is visited from its own side
+
+    int irequest = neighbor->request( this );
+    neighbor->requests[irequest]->half = 0;
+    neighbor->requests[irequest]->full = 1;
+
+    coeff_ready = false;
+}
+
+/* ----------------------------------------------------------------------
+   init for one type pair i,j and corresponding j,i
+   neighbor cutoff covers the species cutoffs as well
+------------------------------------------------------------------------- */
+
+double PairTDPD::init_one( int i, int j )
+{
+    if( setflag[i][j] == 0 )
+        error->all( FLERR, "All pair coeffs are not set" );
+
+    cut[j][i]     = cut[i][j];
+    cutinv[j][i]  = cutinv[i][j];
+    a0[j][i]      = a0[i][j];
+    gamma[j][i]   = gamma[i][j];
+    sigma[j][i]   = sigma[i][j];
+    s1[j][i]      = s1[i][j];
+
+    double cut_max = cut[i][j];
+    for( int k = 0; k < n_species; k++ ) {
+        cutc[j][i][k]    = cutc[i][j][k];
+        kappa[j][i][k]   = kappa[i][j][k];
+        s2[j][i][k]      = s2[i][j][k];
+        cut_max = MAX( cut_max, cutc[i][j][k] );
+    }
+
+    return cut_max;
+}
+
+/* ----------------------------------------------------------------------
+   proc 0 writes to restart file
+------------------------------------------------------------------------- */
+
+void PairTDPD::write_restart( FILE *fp )
+{
+    write_restart_settings( fp );
+
+    for( int i = 1; i <= atom->ntypes; i++ ) {
+        for( int j = i; j <= atom->ntypes; j++ ) {
+            fwrite( &setflag[i][j], sizeof( int ), 1, fp );
+            if( setflag[i][j] ) {
+                fwrite( &a0[i][j], sizeof( double ), 1, fp );
+                fwrite( &gamma[i][j], sizeof( double ), 1, fp );
+                fwrite( &sigma[i][j], sizeof( double ), 1, fp );
+                fwrite( &s1[i][j], sizeof( double ), 1, fp );
+                fwrite( &cut[i][j], sizeof( double ), 1, fp );
+                for( int k = 0; k < n_species; k++ ) {
+                    fwrite( &cutc[i][j][k], sizeof( double ), 1, fp );
+                    fwrite( &kappa[i][j][k], sizeof( double ), 1, fp );
+                    fwrite( &s2[i][j][k], sizeof( double ), 1, fp );
+                }
+            }
+        }
+    }
+}
+
+/* ----------------------------------------------------------------------
+   proc 0 reads from restart file, bcasts
+------------------------------------------------------------------------- */
+
+void PairTDPD::read_restart( FILE *fp )
+{
+    read_restart_settings( fp );
+
+    allocate();
+
+    int i, j;
+    int me = comm->me;
+    for( i = 1; i <= atom->ntypes; i++ ) {
+        for( j = i; j <= atom->ntypes; j++ ) {
+            if( me == 0 )
+                fread( &setflag[i][j], sizeof( int ), 1, fp );
+            MPI_Bcast( &setflag[i][j], 1, MPI_INT, 0, world );
+            if( setflag[i][j] ) {
+                if( me == 0 ) {
+                    fread( &a0[i][j], sizeof( double ), 1, fp );
+                    fread( &gamma[i][j], sizeof( double ), 1, fp );
+                    fread( &sigma[i][j], sizeof( double ), 1, fp );
+                    fread( &s1[i][j], sizeof( double ), 1, fp );
+                    fread( &cut[i][j], sizeof( double ), 1, fp );
+                    for( int k = 0; k < n_species; k++ ) {
+                        fread( &cutc[i][j][k], sizeof( double ), 1, fp );
+                        fread( &kappa[i][j][k], sizeof( double ), 1, fp );
+                        fread( &s2[i][j][k], sizeof( double ), 1, fp );
+                    }
+                }
+                MPI_Bcast( &a0[i][j], 1, MPI_DOUBLE, 0, world );
+                MPI_Bcast( &gamma[i][j], 1, MPI_DOUBLE, 0, world );
+                MPI_Bcast( &sigma[i][j], 1, MPI_DOUBLE, 0, world );
+                MPI_Bcast( &s1[i][j], 1, MPI_DOUBLE, 0, world );
+                MPI_Bcast( &cut[i][j], 1, MPI_DOUBLE, 0, world );
+                for( int k = 0; k < n_species; k++ ) {
+                    MPI_Bcast( &cutc[i][j][k], 1, MPI_DOUBLE, 0, world );
+                    MPI_Bcast( &kappa[i][j][k], 1, MPI_DOUBLE, 0, world );
+                    MPI_Bcast( &s2[i][j][k], 1, MPI_DOUBLE, 0, world );
+                }
+                cutinv[i][j] = 1.0 / cut[i][j];
+            }
+        }
+    }
+    coeff_ready = false;
+}
+
+/* ----------------------------------------------------------------------
+   proc 0 writes to restart file
+------------------------------------------------------------------------- */
+
+void PairTDPD::write_restart_settings( FILE *fp )
+{
+    fwrite( &cut_global, sizeof( double ), 1, fp );
+    fwrite( &seed, sizeof( int ), 1, fp );
+    fwrite( &n_species, sizeof( int ), 1, fp );
+    fwrite( &mix_flag, sizeof( int ), 1, fp );
+}
+
+/* ----------------------------------------------------------------------
+   proc 0 reads from restart file, bcasts
+------------------------------------------------------------------------- */
+
+void PairTDPD::read_restart_settings( FILE *fp )
+{
+    if( comm->me == 0 ) {
+        fread( &cut_global, sizeof( double ), 1, fp );
+        fread( &seed, sizeof( int ), 1, fp );
+        fread( &n_species, sizeof( int ), 1, fp );
+        fread( &mix_flag, sizeof( int ), 1, fp );
+    }
+    MPI_Bcast( &cut_global, 1, MPI_DOUBLE, 0, world );
+    MPI_Bcast( &seed, 1, MPI_INT, 0, world );
+    MPI_Bcast( &n_species, 1, MPI_INT, 0, world );
+    MPI_Bcast( &mix_flag, 1, MPI_INT, 0, world );
+}
+
+/* ---------------------------------------------------------------------- */
+
+double PairTDPD::single( int i, int j, int itype, int jtype, double rsq,
+                         double factor_coul, double factor_dpd, double &fforce )
+{
+    double r, rinv, wr, phi;
+
+    r = sqrt( rsq );
+    if( r < EPSILON || r >= cut[itype][jtype] ) {
+        fforce = 0.0;
+        return 0.0;
+    }
+
+    rinv = 1.0 / r;
+
+    wr = 1.0 - r * cutinv[itype][jtype];
+    fforce = a0[itype][jtype] * wr * factor_dpd * rinv;
+
+    phi = 0.5 * a0[itype][jtype] * cut[itype][jtype] * wr * wr;
+    return factor_dpd * phi;
+}
+
+/* ---------------------------------------------------------------------- */
+
+double PairTDPD::memory_usage()
+{
+    double bytes = Pair::memory_usage();
+    bytes += nmax_key * sizeof( unsigned int );
+    bytes += coeff_table.size() * sizeof( double );
+    return bytes;
+}
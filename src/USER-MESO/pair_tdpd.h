@@ -0,0 +1,113 @@
+#ifdef PAIR_CLASS
+
+PairStyle(tdpd/cpu,PairTDPD)
+
+#else
+
+#ifndef LMP_PAIR_TDPD
+#define LMP_PAIR_TDPD
+
+#include "pair.h"
+#include <vector>
+
+namespace LAMMPS_NS {
+
+// layout of the packed per type-pair coefficient table
+// shared by the host (tdpd/cpu) and device (tdpd/meso) implementations
+
+namespace TDPD_COEFFICIENTS {
+const static int n_chemcoeff = 3;       // Number of specie-dependent coefficients.
+const static int n_coeff  = 7;
+const static int p_cut    = 0;
+const static int p_cutsq  = 1;
+const static int p_cutinv = 2;
+const static int p_s1     = 3;
+const static int p_a0     = 4;
+const static int p_gamma  = 5;
+const static int p_sigma  = 6;
+const static int p_cutc   = 7;          // species specific
+const static int p_kappa  = 8;          // species specific
+const static int p_s2     = 9;          // species specific
+}
+
+class PairTDPD : public Pair {
+public:
+    PairTDPD(class LAMMPS *);
+    ~PairTDPD();
+    void   compute(int, int);
+    void   settings(int, char **);
+    void   coeff(int, char **);
+    void   init_style();
+    double init_one(int, int);
+    void   write_restart(FILE *);
+    void   read_restart(FILE *);
+    void   write_restart_settings(FILE *);
+    void   read_restart_settings(FILE *);
+    double single(int, int, int, int, double, double, double, double &);
+    double memory_usage();
+
+protected:
+    int      seed;
+    bool     coeff_ready;
+    std::vector<double> coeff_table;
+
+    double   cut_global;
+    double **cut;
+    double **cutinv;
+    double **s1;
+    double **a0;
+    double **gamma;
+    double **sigma;
+    double ***cutc;                 // species specific
+    double ***kappa;                // species specific
+    double ***s2;                   // species specific
+    int n_species;                  // Number of Chemical Species.
+
+    int nmax_key;
+    unsigned int *rkey;             // per-atom RNG key of current step
+
+    virtual void allocate();
+    virtual void prepare_coeff();
+    virtual unsigned int seed_now();
+};
+
+}
+
+#endif
+
+#endif
+
+/* ERROR/WARNING messages:
+
+E: Illegal pair_style command
+
+Self-explanatory.  Check the input script syntax and compare to the
+documentation for the command.
+
+E: Incorrect args for pair coefficients
+
+Self-explanatory.  Check the input script or data file.
+
+E: Pair tdpd/cpu species count cannot be changed
+
+A pair_style tdpd/cpu command after pair_coeff must keep the number of
+species.  Use pair_style none first to start over.
+
+E: Pair tdpd/cpu requires atom_style tdpd
+
+The per-species concentration arrays must be allocated on the host.
+
+E: Pair tdpd/cpu species count does not match atom_style
+
+The third pair_style argument must equal the atom_style tdpd argument.
+
+E: Pair tdpd/cpu requires ghost atoms store velocity
+
+Use the communicate vel yes command to enable this.
+
+E: All pair coeffs are not set
+
+All pair coefficients must be set in the data file or by the
+pair_coeff command before running a simulation.
+
+*/
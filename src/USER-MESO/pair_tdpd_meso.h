@@ -10,24 +10,10 @@ PairStyle(tdpd/meso,MesoPairTDPD)
 
 #include "pair.h"
 #include "meso.h"
+#include "pair_tdpd.h"          // TDPD_COEFFICIENTS, shared with tdpd/cpu
 
 namespace LAMMPS_NS {
 
-namespace TDPD_COEFFICIENTS {
-const static int n_chemcoeff = 3;       // Number of specie-dependent coefficients.
-const static int n_coeff  = 7;
-const static int p_cut    = 0;
-const static int p_cutsq  = 1;
-const static int p_cutinv = 2;
-const static int p_s1     = 3;
-const static int p_a0     = 4;
-const static int p_gamma  = 5;
-const static int p_sigma  = 6;
-const static int p_cutc   = 7;          // species specific
-const static int p_kappa  = 8;          // species specific
-const static int p_s2     = 9;          // species specific
-}
-
 class MesoPairTDPD : public Pair, protected MesoPointers {
 public:
     MesoPairTDPD(class LAMMPS *);
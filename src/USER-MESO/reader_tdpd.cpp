@@ -0,0 +1,335 @@
+/* ----------------------------------------------------------------------
+   LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+   http://lammps.sandia.gov, Sandia National Laboratories
+   Steve Plimpton, sjplimp@sandia.gov
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+
+   See the README file in the top-level LAMMPS directory.
+------------------------------------------------------------------------- */
+
+#include "string.h"
+#include "stdlib.h"
+#include "reader_tdpd.h"
+#include "tdpd_binary.h"
+#include "lodepng_meso.h"
+#include "memory.h"
+#include "error.h"
+
+using namespace LAMMPS_NS;
+using namespace TDPDBinary;
+
+// also in read_dump.cpp
+
+enum{ID,TYPE,X,Y,Z,VX,VY,VZ,Q,IX,IY,IZ};
+enum{UNSET,NOSCALE_NOWRAP,NOSCALE_WRAP,SCALE_NOWRAP,SCALE_WRAP};
+
+/* ---------------------------------------------------------------------- */
+
+ReaderTDPD::ReaderTDPD(LAMMPS *lmp) : Reader(lmp)
+{
+    fieldindex = NULL;
+    frame_end = -1;
+    nchunk_left = chunk_natoms = chunk_pos = 0;
+}
+
+/* ---------------------------------------------------------------------- */
+
+ReaderTDPD::~ReaderTDPD()
+{
+    memory->destroy(fieldindex);
+}
+
+/* ----------------------------------------------------------------------
+   open file and check its header
+   only called by proc 0
+------------------------------------------------------------------------- */
+
+void ReaderTDPD::open_file(const char *file)
+{
+    if (fp != NULL) close_file();
+
+    compressed = 0;
+    fp = fopen(file,"rb");
+    if (fp == NULL) {
+        char str[128];
+        sprintf(str,"Cannot open file %s",file);
+        error->one(FLERR,str);
+    }
+
+    char magic[8];
+    int version,endian;
+    if (fread(magic,sizeof(magic),1,fp) != 1 ||
+        memcmp(magic,MAGIC,sizeof(magic)) != 0)
+        error->one(FLERR,"Dump file is not a tdpd binary file");
+    read_buf(&version,sizeof(int),1);
+    read_buf(&endian,sizeof(int),1);
+    if (version != VERSION || endian != ENDIAN)
+        error->one(FLERR,"Dump file has incompatible tdpd version or byte order");
+
+    frame_end = -1;
+}
+
+/* ----------------------------------------------------------------------
+   read and return time stamp from dump file
+   if first read reaches end-of-file, return 1 so caller can open next file
+   only called by proc 0
+------------------------------------------------------------------------- */
+
+int ReaderTDPD::read_time(bigint &ntimestep)
+{
+    // previous frame may have been read only partially
+
+    if (frame_end >= 0) fseek(fp,frame_end,SEEK_SET);
+
+    char tag[4];
+    if (fread(tag,sizeof(tag),1,fp) != 1) return 1;
+    if (memcmp(tag,FRAME_TAG,sizeof(tag)) != 0)
+        error->one(FLERR,"Dump file is incorrectly formatted");
+
+    bigint nbytes;
+    read_buf(&ntimestep,sizeof(bigint),1);
+    read_buf(&nbytes,sizeof(bigint),1);
+    frame_end = ftell(fp) + nbytes;
+
+    return 0;
+}
+
+/* ----------------------------------------------------------------------
+   skip snapshot from timestamp onward
+   only called by proc 0
+------------------------------------------------------------------------- */
+
+void ReaderTDPD::skip()
+{
+    fseek(fp,frame_end,SEEK_SET);
+}
+
+/* ----------------------------------------------------------------------
+   read remaining header info, same conventions as ReaderNative
+   column labels are stored in the frame, so fields are matched by name
+   only called by proc 0
+------------------------------------------------------------------------- */
+
+bigint ReaderTDPD::read_header(double box[3][3], int &triclinic,
+                               int fieldinfo, int nfield,
+                               int *fieldtype, char **fieldlabel,
+                               int scaleflag, int wrapflag, int &fieldflag,
+                               int &xflag, int &yflag, int &zflag)
+{
+    bigint natoms;
+    int boundary[6],nfield_file,nchunk;
+
+    read_buf(&natoms,sizeof(bigint),1);
+    read_buf(&triclinic,sizeof(int),1);
+    read_buf(boundary,sizeof(int),6);
+    read_buf(&box[0][0],sizeof(double),9);
+
+    read_buf(&nfield_file,sizeof(int),1);
+    if (nfield_file <= 0) error->one(FLERR,"Dump file is incorrectly formatted");
+    labels.resize(nfield_file);
+    dtypes.resize(nfield_file);
+    for (int j = 0; j < nfield_file; j++) {
+        char label[LABEL_LEN];
+        read_buf(label,LABEL_LEN,1);
+        label[LABEL_LEN-1] = '\0';
+        labels[j] = label;
+        read_buf(&dtypes[j],sizeof(int),1);
+        if (dtypes[j] < INT32 || dtypes[j] > FLOAT64)
+            error->one(FLERR,"Dump file is incorrectly formatted");
+    }
+
+    read_buf(&nchunk,sizeof(int),1);
+    nchunk_left = nchunk;
+    chunk_natoms = chunk_pos = 0;
+
+    // if no field info requested, just return
+
+    if (!fieldinfo) return natoms;
+
+    // match each field with a column of per-atom data
+    // if fieldlabel set, match with explicit column
+    // else infer column from fieldtype
+    // xyz flag set by scaleflag + wrapflag (if fieldlabel set) or column label
+
+    memory->destroy(fieldindex);
+    memory->create(fieldindex,nfield,"read_dump:fieldindex");
+
+    xflag = UNSET;
+    yflag = UNSET;
+    zflag = UNSET;
+
+    for (int i = 0; i < nfield; i++) {
+        if (fieldlabel[i]) {
+            fieldindex[i] = find_label(fieldlabel[i]);
+            if (fieldtype[i] == X) xflag = 2*scaleflag + wrapflag + 1;
+            else if (fieldtype[i] == Y) yflag = 2*scaleflag + wrapflag + 1;
+            else if (fieldtype[i] == Z) zflag = 2*scaleflag + wrapflag + 1;
+        }
+
+        else if (fieldtype[i] == ID) fieldindex[i] = find_label("id");
+        else if (fieldtype[i] == TYPE) fieldindex[i] = find_label("type");
+        else if (fieldtype[i] == X) fieldindex[i] = find_coord("x",xflag);
+        else if (fieldtype[i] == Y) fieldindex[i] = find_coord("y",yflag);
+        else if (fieldtype[i] == Z) fieldindex[i] = find_coord("z",zflag);
+        else if (fieldtype[i] == VX) fieldindex[i] = find_label("vx");
+        else if (fieldtype[i] == VY) fieldindex[i] = find_label("vy");
+        else if (fieldtype[i] == VZ) fieldindex[i] = find_label("vz");
+        else if (fieldtype[i] == Q) fieldindex[i] = find_label("q");
+        else if (fieldtype[i] == IX) fieldindex[i] = find_label("ix");
+        else if (fieldtype[i] == IY) fieldindex[i] = find_label("iy");
+        else if (fieldtype[i] == IZ) fieldindex[i] = find_label("iz");
+    }
+
+    // set fieldflag = -1 if any unfound fields
+
+    fieldflag = 0;
+    for (int i = 0; i < nfield; i++)
+        if (fieldindex[i] < 0) fieldflag = -1;
+
+    return natoms;
+}
+
+/* ----------------------------------------------------------------------
+   read N atoms from dump file, decoding chunks as needed
+   stores appropriate values in fields array
+   only called by proc 0
+------------------------------------------------------------------------- */
+
+void ReaderTDPD::read_atoms(int n, int nfield, double **fields)
+{
+    for (int i = 0; i < n; i++) {
+        if (chunk_pos == chunk_natoms) read_chunk();
+
+        for (int m = 0; m < nfield; m++) {
+            int j = fieldindex[m];
+            int dtype = dtypes[j];
+            const unsigned char *ptr =
+                &raw[col_offset[j] + (bigint) chunk_pos*dtype_size(dtype)];
+
+            if (dtype == INT32) {
+                int v;
+                memcpy(&v,ptr,sizeof(int));
+                fields[i][m] = v;
+            } else if (dtype == INT64) {
+                bigint v;
+                memcpy(&v,ptr,sizeof(bigint));
+                fields[i][m] = v;
+            } else if (dtype == FLOAT16) {
+                unsigned short v;
+                memcpy(&v,ptr,sizeof(unsigned short));
+                fields[i][m] = half_to_float(v);
+            } else if (dtype == FLOAT32) {
+                float v;
+                memcpy(&v,ptr,sizeof(float));
+                fields[i][m] = v;
+            } else memcpy(&fields[i][m],ptr,sizeof(double));
+        }
+        chunk_pos++;
+    }
+}
+
+/* ----------------------------------------------------------------------
+   read and decode the next chunk of the current frame into raw
+------------------------------------------------------------------------- */
+
+void ReaderTDPD::read_chunk()
+{
+    if (nchunk_left == 0) error->one(FLERR,"Unexpected end of dump file");
+
+    int codec;
+    bigint rawbytes,nbytes;
+    read_buf(&chunk_natoms,sizeof(int),1);
+    read_buf(&codec,sizeof(int),1);
+    read_buf(&rawbytes,sizeof(bigint),1);
+    read_buf(&nbytes,sizeof(bigint),1);
+    nchunk_left--;
+    chunk_pos = 0;
+
+    int nfield_file = dtypes.size();
+    col_offset.resize(nfield_file);
+    bigint expect = 0;
+    for (int j = 0; j < nfield_file; j++) {
+        col_offset[j] = expect;
+        expect += (bigint) chunk_natoms * dtype_size(dtypes[j]);
+    }
+    if (rawbytes != expect || chunk_natoms <= 0)
+        error->one(FLERR,"Dump file is incorrectly formatted");
+
+    raw.resize(rawbytes);
+
+    if (codec == RAW) {
+        if (nbytes != rawbytes)
+            error->one(FLERR,"Dump file is incorrectly formatted");
+        read_buf(&raw[0],rawbytes,1);
+        return;
+    }
+    if (codec != SHUFFLE_DEFLATE)
+        error->one(FLERR,"Dump file is incorrectly formatted");
+
+    packed.resize(nbytes);
+    read_buf(&packed[0],nbytes,1);
+
+    unsigned char *out = NULL;
+    size_t outsize = 0;
+    unsigned err = lodepng_zlib_decompress(&out,&outsize,&packed[0],nbytes,
+                                           &lodepng_default_decompress_settings);
+    if (err || (bigint) outsize != rawbytes) {
+        free(out);
+        error->one(FLERR,"Could not decompress tdpd dump chunk");
+    }
+
+    for (int j = 0; j < nfield_file; j++)
+        unshuffle(out+col_offset[j],&raw[col_offset[j]],chunk_natoms,
+                  dtype_size(dtypes[j]));
+    free(out);
+}
+
+/* ----------------------------------------------------------------------
+   read N items of given size, error on short read
+------------------------------------------------------------------------- */
+
+void ReaderTDPD::read_buf(void *ptr, size_t size, size_t n)
+{
+    if (fread(ptr,size,n,fp) != n)
+        error->one(FLERR,"Unexpected end of dump file");
+}
+
+/* ----------------------------------------------------------------------
+   match label to a column of the current frame
+   return index of match or -1 if no match
+------------------------------------------------------------------------- */
+
+int ReaderTDPD::find_label(const char *label)
+{
+    for (int j = 0; j < (int) labels.size(); j++)
+        if (labels[j] == label) return j;
+    return -1;
+}
+
+/* ----------------------------------------------------------------------
+   match coord dim to x, else first of xs, xu, xsu, set flag accordingly
+------------------------------------------------------------------------- */
+
+int ReaderTDPD::find_coord(const char *dim, int &flag)
+{
+    const char *suffix[4] = {"","s","u","su"};
+    const int style[4] = {NOSCALE_WRAP,SCALE_WRAP,NOSCALE_NOWRAP,SCALE_NOWRAP};
+    char label[8];
+
+    flag = NOSCALE_WRAP;
+    int index = -1;
+    for (int k = 0; k < 4; k++) {
+        sprintf(label,"%s%s",dim,suffix[k]);
+        int j = find_label(label);
+        if (j >= 0 && (index < 0 || j < index)) {
+            index = j;
+            flag = style[k];
+        }
+        if (k == 0 && index >= 0) break;
+    }
+    return index;
+}
@@ -0,0 +1,97 @@
+/* -*- c++ -*- ----------------------------------------------------------
+   LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+   http://lammps.sandia.gov, Sandia National Laboratories
+   Steve Plimpton, sjplimp@sandia.gov
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+
+   See the README file in the top-level LAMMPS directory.
+------------------------------------------------------------------------- */
+
+#ifdef READER_CLASS
+
+ReaderStyle(tdpd,ReaderTDPD)
+
+#else
+
+#ifndef LMP_READER_TDPD_H
+#define LMP_READER_TDPD_H
+
+#include <vector>
+#include <string>
+#include "reader.h"
+
+namespace LAMMPS_NS {
+
+// reads *.tdpd files written by dump tdpd/meso, see tdpd_binary.h
+// chunks are decoded one at a time as read_atoms() walks the frame
+
+class ReaderTDPD : public Reader {
+public:
+    ReaderTDPD(class LAMMPS *);
+    ~ReaderTDPD();
+
+    void open_file(const char *);
+    int read_time(bigint &);
+    void skip();
+    bigint read_header(double [3][3], int &, int, int, int *, char **,
+                       int, int, int &, int &, int &, int &);
+    void read_atoms(int, int, double **);
+
+private:
+    long frame_end;                    // file offset of the next frame
+
+    std::vector<std::string> labels;   // per-column label of current frame
+    std::vector<int> dtypes;           // per-column storage type
+    int *fieldindex;                   // column of each requested field
+
+    int nchunk_left;                   // # of chunks not yet decoded
+    int chunk_natoms;                  // # of atoms in decoded chunk
+    int chunk_pos;                     // next atom to return from it
+    std::vector<bigint> col_offset;    // start of each column in raw
+    std::vector<unsigned char> raw;    // decoded chunk
+    std::vector<unsigned char> packed; // chunk as stored in the file
+
+    void read_buf(void *, size_t, size_t);
+    void read_chunk();
+    int find_label(const char *);
+    int find_coord(const char *, int &);
+};
+
+}
+
+#endif
+#endif
+
+/* ERROR/WARNING messages:
+
+E: Cannot open file %s
+
+The specified file cannot be opened.  Check that the path and name are
+correct.
+
+E: Dump file is not a tdpd binary file
+
+The file does not start with the header written by dump tdpd/meso.
+
+E: Dump file has incompatible tdpd version or byte order
+
+The file was written by a newer version of dump tdpd/meso or on a
+machine with different endianness.
+
+E: Dump file is incorrectly formatted
+
+Self-explanatory.
+
+E: Unexpected end of dump file
+
+A read operation from the file failed.
+
+E: Could not decompress tdpd dump chunk
+
+A compressed chunk of the file is corrupted.
+
+*/
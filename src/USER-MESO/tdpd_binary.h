@@ -0,0 +1,112 @@
+/* -*- c++ -*- ----------------------------------------------------------
+   LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+   http://lammps.sandia.gov, Sandia National Laboratories
+   Steve Plimpton, sjplimp@sandia.gov
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+
+   See the README file in the top-level LAMMPS directory.
+------------------------------------------------------------------------- */
+
+#ifndef LMP_TDPD_BINARY_H
+#define LMP_TDPD_BINARY_H
+
+#include "lmptype.h"
+
+namespace LAMMPS_NS {
+
+// layout of the self-describing binary tDPD dump, shared by
+// dump tdpd/meso (*.tdpd files) and read_dump/rerun format tdpd
+//
+// file  = magic[8] version endian, then frames
+// frame = "FRME" ntimestep nbytes, then nbytes of
+//         natoms triclinic boundary[3][2] box[3][3] nfield
+//         nfield x {label[LABEL_LEN] dtype} nchunk nchunk x chunk
+// chunk = natoms codec rawbytes nbytes, then nbytes of data
+// raw chunk data stores the fields one after another, natoms values each
+// box[3][3] is lo,hi,tilt per dim as in Reader::read_header()
+// ints are 4 bytes, bigints 8 bytes, all in the writer's byte order
+
+namespace TDPDBinary {
+    static const char MAGIC[8] = {'L','M','P','T','D','P','D','\0'};
+    static const char FRAME_TAG[4] = {'F','R','M','E'};
+    static const int VERSION = 1;
+    static const int ENDIAN = 0x01020304;
+    static const int LABEL_LEN = 16;
+
+    enum{INT32,INT64,FLOAT16,FLOAT32,FLOAT64};   // per-field data types
+    enum{RAW,SHUFFLE_DEFLATE};                   // per-chunk codecs
+
+    inline int dtype_size( int dtype )
+    {
+        if( dtype == INT32 || dtype == FLOAT32 ) return 4;
+        if( dtype == FLOAT16 ) return 2;
+        return 8;
+    }
+
+    // IEEE 754 binary16 <-> binary32, round to nearest even
+
+    inline unsigned short float_to_half( float value )
+    {
+        union { float f; unsigned int u; } v;
+        v.f = value;
+        unsigned int sign = ( v.u >> 16 ) & 0x8000;
+        unsigned int absu = v.u & 0x7fffffff;
+
+        if( absu >= 0x7f800000 ) return sign | 0x7c00 | ( absu > 0x7f800000 ? 0x200 : 0 );
+        if( absu >= 0x477ff000 ) return sign | 0x7c00;
+        if( absu < 0x38800000 ) {
+            if( absu < 0x33000000 ) return sign;
+            int shift = 126 - ( absu >> 23 );
+            unsigned int mant = ( absu & 0x7fffff ) | 0x800000;
+            unsigned int h = mant >> shift;
+            unsigned int rem = mant & ( ( 1u << shift ) - 1 );
+            unsigned int halfway = 1u << ( shift - 1 );
+            if( rem > halfway || ( rem == halfway && ( h & 1 ) ) ) h++;
+            return sign | h;
+        }
+        unsigned int h = ( absu - 0x38000000 ) >> 13;
+        unsigned int rem = absu & 0x1fff;
+        if( rem > 0x1000 || ( rem == 0x1000 && ( h & 1 ) ) ) h++;
+        return sign | h;
+    }
+
+    inline float half_to_float( unsigned short h )
+    {
+        union { float f; unsigned int u; } v;
+        unsigned int sign = ( h & 0x8000 ) << 16;
+        unsigned int e = ( h >> 10 ) & 0x1f;
+        unsigned int m = h & 0x3ff;
+
+        if( e == 0 ) {
+            v.f = m * 5.9604644775390625e-08f;
+            v.u |= sign;
+        } else if( e == 31 ) v.u = sign | 0x7f800000 | ( m << 13 );
+        else v.u = sign | ( ( e + 112 ) << 23 ) | ( m << 13 );
+        return v.f;
+    }
+
+    // byte transpose of n values of size bytes each, groups the slowly
+    // varying high-order bytes of neighboring values before deflate
+
+    inline void shuffle( const unsigned char *in, unsigned char *out, bigint n, int size )
+    {
+        for( int k = 0; k < size; k++ )
+            for( bigint i = 0; i < n; i++ )
+                out[k * n + i] = in[i * size + k];
+    }
+
+    inline void unshuffle( const unsigned char *in, unsigned char *out, bigint n, int size )
+    {
+        for( int k = 0; k < size; k++ )
+            for( bigint i = 0; i < n; i++ )
+                out[i * size + k] = in[k * n + i];
+    }
+}
+
+}
+
+#endif
@@ -57,6 +57,7 @@ DumpMolfile::DumpMolfile(LAMMPS *lmp, int narg, char **arg)
 
   sort_flag = 1;
   sortcol = 0;
+  async_allow = 0;
 
   // storage for collected information
 
@@ -0,0 +1,186 @@
+/* ----------------------------------------------------------------------
+   LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+   http://lammps.sandia.gov, Sandia National Laboratories
+   Steve Plimpton, sjplimp@sandia.gov
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+
+   See the README file in the top-level LAMMPS directory.
+------------------------------------------------------------------------- */
+
+/* ----------------------------------------------------------------------
+   threaded variant of angle_style harmonic
+   each OpenMP thread takes a contiguous chunk of the angle list and
+   accumulates into its own force slab via ThrAccum
+   the chunk is processed in blocks of THR_BLOCK angles, whose bond vectors
+   and coeffs are packed as SoA so the force math vectorizes
+------------------------------------------------------------------------- */
+
+#include "math.h"
+#include "angle_harmonic_fast.h"
+#include "atom.h"
+#include "neighbor.h"
+#include "force.h"
+
+using namespace LAMMPS_NS;
+
+#define SMALL 0.001
+
+/* ---------------------------------------------------------------------- */
+
+AngleHarmonicFast::AngleHarmonicFast(LAMMPS *lmp) :
+  AngleHarmonic(lmp), ThrAccum(lmp) {}
+
+/* ---------------------------------------------------------------------- */
+
+void AngleHarmonicFast::compute(int eflag, int vflag)
+{
+  if (eflag || vflag) ev_setup(eflag,vflag);
+  else evflag = 0;
+
+  thr_compute(this,neighbor->nanglelist);
+}
+
+/* ----------------------------------------------------------------------
+   evaluate one block of angles with the matching instance of eval()
+------------------------------------------------------------------------- */
+
+int AngleHarmonicFast::thr_eval(int nfrom, int nto, ThrAccumData *thr)
+{
+  if (evflag) {
+    if (eflag_either) {
+      if (force->newton_bond) eval<1,1,1>(nfrom,nto,thr);
+      else eval<1,1,0>(nfrom,nto,thr);
+    } else {
+      if (force->newton_bond) eval<1,0,1>(nfrom,nto,thr);
+      else eval<1,0,0>(nfrom,nto,thr);
+    }
+  } else {
+    if (force->newton_bond) eval<0,0,1>(nfrom,nto,thr);
+    else eval<0,0,0>(nfrom,nto,thr);
+  }
+  return 0;
+}
+
+/* ---------------------------------------------------------------------- */
+
+template <int EVFLAG, int EFLAG, int NEWTON_BOND>
+void AngleHarmonicFast::eval(int nfrom, int nto, ThrAccumData *thr)
+{
+  int m,i1,i2,i3,type;
+  double f1[3],f3[3];
+  double delx1[THR_BLOCK],dely1[THR_BLOCK],delz1[THR_BLOCK];
+  double delx2[THR_BLOCK],dely2[THR_BLOCK],delz2[THR_BLOCK];
+  double ka[THR_BLOCK],theta0a[THR_BLOCK],eangle[THR_BLOCK];
+  double f1x[THR_BLOCK],f1y[THR_BLOCK],f1z[THR_BLOCK];
+  double f3x[THR_BLOCK],f3y[THR_BLOCK],f3z[THR_BLOCK];
+
+  double **x = atom->x;
+  double **f = thr->f;
+  int **anglelist = neighbor->anglelist;
+  int nlocal = atom->nlocal;
+
+  const int nn = nto - nfrom;
+
+  // pack bond vectors and coeffs of the block
+
+  for (m = 0; m < nn; m++) {
+    i1 = anglelist[nfrom+m][0];
+    i2 = anglelist[nfrom+m][1];
+    i3 = anglelist[nfrom+m][2];
+    type = anglelist[nfrom+m][3];
+
+    delx1[m] = x[i1][0] - x[i2][0];
+    dely1[m] = x[i1][1] - x[i2][1];
+    delz1[m] = x[i1][2] - x[i2][2];
+    delx2[m] = x[i3][0] - x[i2][0];
+    dely2[m] = x[i3][1] - x[i2][1];
+    delz2[m] = x[i3][2] - x[i2][2];
+    ka[m] = k[type];
+    theta0a[m] = theta0[type];
+  }
+
+  // force & energy, no dependence between angles
+
+#if defined(_OPENMP) && _OPENMP >= 201307
+#pragma omp simd
+#endif
+  for (m = 0; m < nn; m++) {
+    const double rsq1 = delx1[m]*delx1[m] + dely1[m]*dely1[m] +
+      delz1[m]*delz1[m];
+    const double r1 = sqrt(rsq1);
+    const double rsq2 = delx2[m]*delx2[m] + dely2[m]*dely2[m] +
+      delz2[m]*delz2[m];
+    const double r2 = sqrt(rsq2);
+
+    // angle (cos and sin)
+
+    double c = delx1[m]*delx2[m] + dely1[m]*dely2[m] + delz1[m]*delz2[m];
+    c /= r1*r2;
+
+    if (c > 1.0) c = 1.0;
+    if (c < -1.0) c = -1.0;
+
+    double s = sqrt(1.0 - c*c);
+    if (s < SMALL) s = SMALL;
+    s = 1.0/s;
+
+    const double dtheta = acos(c) - theta0a[m];
+    const double tk = ka[m] * dtheta;
+
+    if (EFLAG) eangle[m] = tk*dtheta;
+
+    const double a = -2.0 * tk * s;
+    const double a11 = a*c / rsq1;
+    const double a12 = -a / (r1*r2);
+    const double a22 = a*c / rsq2;
+
+    f1x[m] = a11*delx1[m] + a12*delx2[m];
+    f1y[m] = a11*dely1[m] + a12*dely2[m];
+    f1z[m] = a11*delz1[m] + a12*delz2[m];
+    f3x[m] = a22*delx2[m] + a12*delx1[m];
+    f3y[m] = a22*dely2[m] + a12*dely1[m];
+    f3z[m] = a22*delz2[m] + a12*delz1[m];
+  }
+
+  // apply force to each of 3 atoms
+
+  for (m = 0; m < nn; m++) {
+    i1 = anglelist[nfrom+m][0];
+    i2 = anglelist[nfrom+m][1];
+    i3 = anglelist[nfrom+m][2];
+
+    f1[0] = f1x[m];
+    f1[1] = f1y[m];
+    f1[2] = f1z[m];
+    f3[0] = f3x[m];
+    f3[1] = f3y[m];
+    f3[2] = f3z[m];
+
+    if (NEWTON_BOND || i1 < nlocal) {
+      f[i1][0] += f1[0];
+      f[i1][1] += f1[1];
+      f[i1][2] += f1[2];
+    }
+
+    if (NEWTON_BOND || i2 < nlocal) {
+      f[i2][0] -= f1[0] + f3[0];
+      f[i2][1] -= f1[1] + f3[1];
+      f[i2][2] -= f1[2] + f3[2];
+    }
+
+    if (NEWTON_BOND || i3 < nlocal) {
+      f[i3][0] += f3[0];
+      f[i3][1] += f3[1];
+      f[i3][2] += f3[2];
+    }
+
+    if (EVFLAG) ev_tally_thr(this,thr,i1,i2,i3,nlocal,NEWTON_BOND,
+                             EFLAG ? eangle[m] : 0.0,f1,f3,
+                             delx1[m],dely1[m],delz1[m],
+                             delx2[m],dely2[m],delz2[m]);
+  }
+}
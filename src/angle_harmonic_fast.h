@@ -0,0 +1,43 @@
+/* -*- c++ -*- ----------------------------------------------------------
+   LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+   http://lammps.sandia.gov, Sandia National Laboratories
+   Steve Plimpton, sjplimp@sandia.gov
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+
+   See the README file in the top-level LAMMPS directory.
+------------------------------------------------------------------------- */
+
+#ifdef ANGLE_CLASS
+
+AngleStyle(harmonic/fast,AngleHarmonicFast)
+
+#else
+
+#ifndef LMP_ANGLE_HARMONIC_FAST_H
+#define LMP_ANGLE_HARMONIC_FAST_H
+
+#include "angle_harmonic.h"
+#include "thr_accum.h"
+
+namespace LAMMPS_NS {
+
+class AngleHarmonicFast : public AngleHarmonic, public ThrAccum {
+ public:
+  AngleHarmonicFast(class LAMMPS *);
+  virtual ~AngleHarmonicFast() {}
+  virtual void compute(int, int);
+
+ protected:
+  int thr_eval(int, int, ThrAccumData *);
+  template <int EVFLAG, int EFLAG, int NEWTON_BOND>
+  void eval(int, int, ThrAccumData *);
+};
+
+}
+
+#endif
+#endif
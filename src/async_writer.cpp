@@ -0,0 +1,169 @@
+/* ----------------------------------------------------------------------
+   LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+   http://lammps.sandia.gov, Sandia National Laboratories
+   Steve Plimpton, sjplimp@sandia.gov
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+
+   See the README file in the top-level LAMMPS directory.
+------------------------------------------------------------------------- */
+
+#include "string.h"
+#include "async_writer.h"
+#include "error.h"
+
+using namespace LAMMPS_NS;
+
+/* ---------------------------------------------------------------------- */
+
+AsyncWriter::AsyncWriter(LAMMPS *lmp, int n) : Pointers(lmp)
+{
+  if (n < 1) error->one(FLERR,"Invalid async writer queue length");
+
+  maxqueue = n;
+  queue = new Job[maxqueue];
+  head = count = 0;
+  busy = stop = 0;
+  errflag = 0;
+  errmsg[0] = '\0';
+
+#if defined(LAMMPS_ASYNC_IO)
+  pthread_mutex_init(&mutex,NULL);
+  pthread_cond_init(&cond_job,NULL);
+  pthread_cond_init(&cond_done,NULL);
+  if (pthread_create(&thread,NULL,&AsyncWriter::worker,this))
+    error->one(FLERR,"Could not create async writer thread");
+#endif
+}
+
+/* ----------------------------------------------------------------------
+   finish all pending jobs, then stop the worker
+------------------------------------------------------------------------- */
+
+AsyncWriter::~AsyncWriter()
+{
+#if defined(LAMMPS_ASYNC_IO)
+  pthread_mutex_lock(&mutex);
+  stop = 1;
+  pthread_cond_signal(&cond_job);
+  pthread_mutex_unlock(&mutex);
+  pthread_join(thread,NULL);
+
+  pthread_cond_destroy(&cond_done);
+  pthread_cond_destroy(&cond_job);
+  pthread_mutex_destroy(&mutex);
+#endif
+
+  delete [] queue;
+}
+
+/* ----------------------------------------------------------------------
+   queue job fn(arg), arg is owned by the job from now on
+------------------------------------------------------------------------- */
+
+void AsyncWriter::submit(JobFn fn, void *arg)
+{
+#if defined(LAMMPS_ASYNC_IO)
+  pthread_mutex_lock(&mutex);
+  while (count == maxqueue) pthread_cond_wait(&cond_done,&mutex);
+  Job *job = &queue[(head+count) % maxqueue];
+  job->fn = fn;
+  job->arg = arg;
+  count++;
+  pthread_cond_signal(&cond_job);
+  pthread_mutex_unlock(&mutex);
+#else
+  fn(arg);
+#endif
+
+  check();
+}
+
+/* ----------------------------------------------------------------------
+   wait until all submitted jobs have completed
+------------------------------------------------------------------------- */
+
+void AsyncWriter::drain()
+{
+#if defined(LAMMPS_ASYNC_IO)
+  pthread_mutex_lock(&mutex);
+  while (count || busy) pthread_cond_wait(&cond_done,&mutex);
+  pthread_mutex_unlock(&mutex);
+#endif
+
+  check();
+}
+
+/* ----------------------------------------------------------------------
+   record a failure from inside a job, only the first one is kept
+------------------------------------------------------------------------- */
+
+void AsyncWriter::fail(const char *str)
+{
+#if defined(LAMMPS_ASYNC_IO)
+  pthread_mutex_lock(&mutex);
+#endif
+
+  if (!errflag) {
+    strncpy(errmsg,str,sizeof(errmsg)-1);
+    errmsg[sizeof(errmsg)-1] = '\0';
+    errflag = 1;
+  }
+
+#if defined(LAMMPS_ASYNC_IO)
+  pthread_mutex_unlock(&mutex);
+#endif
+}
+
+/* ---------------------------------------------------------------------- */
+
+void AsyncWriter::check()
+{
+  int flag;
+
+#if defined(LAMMPS_ASYNC_IO)
+  pthread_mutex_lock(&mutex);
+  flag = errflag;
+  pthread_mutex_unlock(&mutex);
+#else
+  flag = errflag;
+#endif
+
+  if (flag) error->one(FLERR,errmsg);
+}
+
+/* ---------------------------------------------------------------------- */
+
+#if defined(LAMMPS_ASYNC_IO)
+
+void *AsyncWriter::worker(void *ptr)
+{
+  AsyncWriter *w = (AsyncWriter *) ptr;
+
+  pthread_mutex_lock(&w->mutex);
+  while (1) {
+    while (w->count == 0 && !w->stop)
+      pthread_cond_wait(&w->cond_job,&w->mutex);
+    if (w->count == 0) break;
+
+    Job job = w->queue[w->head];
+    w->head = (w->head+1) % w->maxqueue;
+    w->count--;
+    w->busy = 1;
+    pthread_mutex_unlock(&w->mutex);
+
+    job.fn(job.arg);
+
+    pthread_mutex_lock(&w->mutex);
+    w->busy = 0;
+    pthread_cond_broadcast(&w->cond_done);
+  }
+  pthread_mutex_unlock(&w->mutex);
+
+  return NULL;
+}
+
+#endif
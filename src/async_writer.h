@@ -0,0 +1,81 @@
+/* -*- c++ -*- ----------------------------------------------------------
+   LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+   http://lammps.sandia.gov, Sandia National Laboratories
+   Steve Plimpton, sjplimp@sandia.gov
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+
+   See the README file in the top-level LAMMPS directory.
+------------------------------------------------------------------------- */
+
+#ifndef LMP_ASYNC_WRITER_H
+#define LMP_ASYNC_WRITER_H
+
+#include "pointers.h"
+
+#if defined(LAMMPS_ASYNC_IO)
+#include "pthread.h"
+#endif
+
+namespace LAMMPS_NS {
+
+// runs output jobs on a background thread in submission order
+// at most maxqueue jobs are pending, submit() blocks when the queue is full
+// without -DLAMMPS_ASYNC_IO jobs run synchronously inside submit()
+// a job reports failure via fail(), the error is raised on the
+//   calling thread by the next submit() or drain()
+
+class AsyncWriter : protected Pointers {
+ public:
+  typedef void (*JobFn)(void *);
+
+  AsyncWriter(class LAMMPS *, int);
+  ~AsyncWriter();
+  void submit(JobFn, void *);
+  void drain();
+  void fail(const char *);
+
+ private:
+  struct Job {
+    JobFn fn;
+    void *arg;
+  };
+
+  int maxqueue;                // capacity of queue
+  Job *queue;                  // ring buffer of pending jobs
+  int head,count;              // first pending job, # of pending jobs
+  int busy;                    // 1 while worker runs a job
+  int stop;                    // 1 when worker should exit
+  int errflag;                 // 1 if a job failed
+  char errmsg[256];
+
+#if defined(LAMMPS_ASYNC_IO)
+  pthread_t thread;
+  pthread_mutex_t mutex;
+  pthread_cond_t cond_job;     // signaled when a job is queued or stop set
+  pthread_cond_t cond_done;    // signaled when a job finishes
+
+  static void *worker(void *);
+#endif
+
+  void check();
+};
+
+}
+
+#endif
+
+/* ERROR/WARNING messages:
+
+E: Invalid async writer queue length
+
+Internal error: the queue must hold at least one job.
+
+E: Could not create async writer thread
+
+The pthread for background output could not be started.
+
+*/
@@ -17,6 +17,8 @@
 #include "stdlib.h"
 #include "string.h"
 #include "limits.h"
+#include <algorithm>
+#include <vector>
 #include "atom.h"
 #include "style_atom.h"
 #include "atom_vec.h"
@@ -24,6 +26,7 @@
 #include "comm.h"
 #include "neighbor.h"
 #include "force.h"
+#include "pair.h"
 #include "modify.h"
 #include "fix.h"
 #include "output.h"
@@ -45,6 +48,57 @@ using namespace LAMMPS_NS;
 #endif
 #define CUDA_CHUNK 3000
 #define MAXBODY 20       // max # of lines in one body, also in ReadData class
+#define SOA_ALIGN 64     // byte alignment of each SoA mirror component
+#define INBIN_BITS 10    // bits per dimension of the within-bin Morton key
+
+enum{LINEAR,MORTON,HILBERT};    // orderings of sort bins
+
+/* ----------------------------------------------------------------------
+   position along a space-filling curve of n-dim integer coords c
+   each coord has nbits bits, n*nbits must be < 64
+   Morton interleaves the bits, Hilbert first transposes the coords
+   with Skilling's algorithm (AIP Conf. Proc. 707, 381 (2004))
+------------------------------------------------------------------------- */
+
+static uint64_t interleave(unsigned int *c, int n, int nbits)
+{
+  uint64_t key = 0;
+  for (int q = nbits-1; q >= 0; q--)
+    for (int k = 0; k < n; k++) key = (key << 1) | ((c[k] >> q) & 1);
+  return key;
+}
+
+static uint64_t curve_key(int curve, unsigned int *c, int n, int nbits)
+{
+  if (curve == HILBERT && nbits > 0) {
+    unsigned int m = 1U << (nbits-1);
+    unsigned int p,q,t;
+
+    // inverse undo
+
+    for (q = m; q > 1; q >>= 1) {
+      p = q - 1;
+      for (int k = 0; k < n; k++) {
+        if (c[k] & q) c[0] ^= p;
+        else {
+          t = (c[0] ^ c[k]) & p;
+          c[0] ^= t;
+          c[k] ^= t;
+        }
+      }
+    }
+
+    // Gray encode
+
+    for (int k = 1; k < n; k++) c[k] ^= c[k-1];
+    t = 0;
+    for (q = m; q > 1; q >>= 1)
+      if (c[n-1] & q) t ^= q - 1;
+    for (int k = 0; k < n; k++) c[k] ^= t;
+  }
+
+  return interleave(c,n,nbits);
+}
 
 /* ---------------------------------------------------------------------- */
 
@@ -62,10 +116,18 @@ Atom::Atom(LAMMPS *lmp) : Pointers(lmp)
   sortfreq = 1000;
   nextsort = 0;
   userbinsize = 0.0;
+  sortcurve = LINEAR;
+  sortinbin = 0;
   maxbin = maxnext = 0;
   binhead = NULL;
+  binorder = NULL;
   next = permute = NULL;
 
+  soaflag = 0;
+  nmax_soa = 0;
+  soa_block = NULL;
+  for (int k = 0; k < 3; k++) xsoa[k] = vsoa[k] = NULL;
+
   // initialize atom arrays
   // customize by adding new array
 
@@ -91,6 +153,7 @@ Atom::Atom(LAMMPS *lmp) : Pointers(lmp)
   vest = NULL;
   T = Q = NULL;
   CONC = CONF = NULL;		// -Ansel
+  n_species = 0;
 
   maxspecial = 1;
   nspecial = NULL;
@@ -151,11 +214,12 @@ Atom::Atom(LAMMPS *lmp) : Pointers(lmp)
   map_style = 0;
   map_tag_max = 0;
   map_nhash = 0;
+  map_nbucket = map_nblock = 0;
 
   smax = 0;
   sametag = NULL;
   map_array = NULL;
-  map_bucket = NULL;
+  map_blockcount = NULL;
   map_hash = NULL;
 
   atom_style = NULL;
@@ -174,8 +238,10 @@ Atom::~Atom()
 
   delete [] firstgroupname;
   memory->destroy(binhead);
+  memory->destroy(binorder);
   memory->destroy(next);
   memory->destroy(permute);
+  memory->sfree(soa_block);
 
   // delete atom arrays
   // customize by adding new array
@@ -390,6 +456,11 @@ void Atom::init()
       error->all(FLERR,"Could not find atom_modify first group ID");
   } else firstgroup = -1;
 
+  // SoA mirror only if the pair style reads it
+
+  soaflag = 0;
+  if (force->pair && force->pair->soa_flag) soaflag = 1;
+
   // init AtomVec
 
   avec->init();
@@ -465,6 +536,25 @@ void Atom::modify_params(int narg, char **arg)
         error->all(FLERR,"Atom_modify sort and first options "
                    "cannot be used together");
       iarg += 3;
+
+      // optional keywords of sort: order of bins and within bins
+
+      while (iarg < narg) {
+        if (strcmp(arg[iarg],"curve") == 0) {
+          if (iarg+2 > narg) error->all(FLERR,"Illegal atom_modify command");
+          if (strcmp(arg[iarg+1],"linear") == 0) sortcurve = LINEAR;
+          else if (strcmp(arg[iarg+1],"morton") == 0) sortcurve = MORTON;
+          else if (strcmp(arg[iarg+1],"hilbert") == 0) sortcurve = HILBERT;
+          else error->all(FLERR,"Illegal atom_modify command");
+          iarg += 2;
+        } else if (strcmp(arg[iarg],"inbin") == 0) {
+          if (iarg+2 > narg) error->all(FLERR,"Illegal atom_modify command");
+          if (strcmp(arg[iarg+1],"yes") == 0) sortinbin = 1;
+          else if (strcmp(arg[iarg+1],"no") == 0) sortinbin = 0;
+          else error->all(FLERR,"Illegal atom_modify command");
+          iarg += 2;
+        } else break;
+      }
     } else error->all(FLERR,"Illegal atom_modify command");
   }
 }
@@ -554,9 +644,12 @@ int Atom::count_words(const char *line)
 /* ----------------------------------------------------------------------
    unpack n lines from Atom section of data file
    call style-specific routine to parse line
+   boxflag = 0: all procs see same lines, keep atoms in my sub-domain
+   boxflag = 1: each proc sees different lines, keep atoms in global box,
+     caller migrates them to their owning procs
 ------------------------------------------------------------------------- */
 
-void Atom::data_atoms(int n, char *buf)
+void Atom::data_atoms(int n, char *buf, int boxflag)
 {
   int m,xptr,iptr;
   tagint imagedata;
@@ -569,12 +662,14 @@ void Atom::data_atoms(int n, char *buf)
   int nwords = count_words(buf);
   *next = '\n';
 
-  if (nwords != avec->size_data_atom && nwords != avec->size_data_atom + 3)
+  if (nwords != avec->size_data_atom && nwords != avec->size_data_atom + 3) {
+    if (boxflag) error->one(FLERR,"Incorrect atom format in data file");
     error->all(FLERR,"Incorrect atom format in data file");
+  }
 
   char **values = new char*[nwords];
 
-  // set bounds for my proc
+  // set bounds for my proc, or for global box if boxflag
   // if periodic and I am lo/hi proc, adjust bounds by EPSILON
   // insures all data atoms will be owned even with round-off
 
@@ -589,7 +684,14 @@ void Atom::data_atoms(int n, char *buf)
   }
 
   double sublo[3],subhi[3];
-  if (triclinic == 0) {
+  if (boxflag && triclinic == 0) {
+    sublo[0] = domain->boxlo[0]; subhi[0] = domain->boxhi[0];
+    sublo[1] = domain->boxlo[1]; subhi[1] = domain->boxhi[1];
+    sublo[2] = domain->boxlo[2]; subhi[2] = domain->boxhi[2];
+  } else if (boxflag) {
+    sublo[0] = sublo[1] = sublo[2] = 0.0;
+    subhi[0] = subhi[1] = subhi[2] = 1.0;
+  } else if (triclinic == 0) {
     sublo[0] = domain->sublo[0]; subhi[0] = domain->subhi[0];
     sublo[1] = domain->sublo[1]; subhi[1] = domain->subhi[1];
     sublo[2] = domain->sublo[2]; subhi[2] = domain->subhi[2];
@@ -599,17 +701,36 @@ void Atom::data_atoms(int n, char *buf)
     sublo[2] = domain->sublo_lamda[2]; subhi[2] = domain->subhi_lamda[2];
   }
 
-  if (domain->xperiodic) {
-    if (comm->myloc[0] == 0) sublo[0] -= epsilon[0];
-    if (comm->myloc[0] == comm->procgrid[0]-1) subhi[0] += epsilon[0];
-  }
-  if (domain->yperiodic) {
-    if (comm->myloc[1] == 0) sublo[1] -= epsilon[1];
-    if (comm->myloc[1] == comm->procgrid[1]-1) subhi[1] += epsilon[1];
-  }
-  if (domain->zperiodic) {
-    if (comm->myloc[2] == 0) sublo[2] -= epsilon[2];
-    if (comm->myloc[2] == comm->procgrid[2]-1) subhi[2] += epsilon[2];
+  if (comm->tiled) {
+    double (*mysplit)[2] = comm->mysplit;
+    if (domain->xperiodic) {
+      if (boxflag || mysplit[0][0] == 0.0) sublo[0] -= epsilon[0];
+      if (boxflag || mysplit[0][1] == 1.0) subhi[0] += epsilon[0];
+    }
+    if (domain->yperiodic) {
+      if (boxflag || mysplit[1][0] == 0.0) sublo[1] -= epsilon[1];
+      if (boxflag || mysplit[1][1] == 1.0) subhi[1] += epsilon[1];
+    }
+    if (domain->zperiodic) {
+      if (boxflag || mysplit[2][0] == 0.0) sublo[2] -= epsilon[2];
+      if (boxflag || mysplit[2][1] == 1.0) subhi[2] += epsilon[2];
+    }
+  } else {
+    if (domain->xperiodic) {
+      if (boxflag || comm->myloc[0] == 0) sublo[0] -= epsilon[0];
+      if (boxflag || comm->myloc[0] == comm->procgrid[0]-1)
+        subhi[0] += epsilon[0];
+    }
+    if (domain->yperiodic) {
+      if (boxflag || comm->myloc[1] == 0) sublo[1] -= epsilon[1];
+      if (boxflag || comm->myloc[1] == comm->procgrid[1]-1)
+        subhi[1] += epsilon[1];
+    }
+    if (domain->zperiodic) {
+      if (boxflag || comm->myloc[2] == 0) sublo[2] -= epsilon[2];
+      if (boxflag || comm->myloc[2] == comm->procgrid[2]-1)
+        subhi[2] += epsilon[2];
+    }
   }
 
   // xptr = which word in line starts xyz coords
@@ -630,12 +751,11 @@ void Atom::data_atoms(int n, char *buf)
     next = strchr(buf,'\n');
 
     values[0] = strtok(buf," \t\n\r\f");
-    if (values[0] == NULL)
-      error->all(FLERR,"Incorrect atom format in data file");
-    for (m = 1; m < nwords; m++) {
+    for (m = 1; m < nwords && values[m-1]; m++)
       values[m] = strtok(NULL," \t\n\r\f");
-      if (values[m] == NULL)
-        error->all(FLERR,"Incorrect atom format in data file");
+    if (values[m-1] == NULL) {
+      if (boxflag) error->one(FLERR,"Incorrect atom format in data file");
+      error->all(FLERR,"Incorrect atom format in data file");
     }
 
     if (imageflag)
@@ -1168,6 +1288,47 @@ int Atom::shape_consistency(int itype,
   return 1;
 }
 
+/* ----------------------------------------------------------------------
+   copy x and v of atoms first to last-1 into the SoA mirror
+   default is all owned + ghost atoms
+   each component starts on a SOA_ALIGN boundary so that
+   pair styles can use aligned, contiguous vector loads
+------------------------------------------------------------------------- */
+
+void Atom::update_soa(int first, int last)
+{
+  if (nmax > nmax_soa) {
+    int stride = SOA_ALIGN/sizeof(double);
+    nmax_soa = (nmax + stride-1)/stride * stride;
+    memory->sfree(soa_block);
+    soa_block = (double *)
+      memory->smalloc((bigint) (6*nmax_soa+stride)*sizeof(double),
+                      "atom:soa_block");
+    double *base = (double *)
+      (((size_t) soa_block + SOA_ALIGN-1) & ~((size_t) SOA_ALIGN-1));
+    for (int k = 0; k < 3; k++) {
+      xsoa[k] = base + k*nmax_soa;
+      vsoa[k] = base + (k+3)*nmax_soa;
+    }
+  }
+
+  if (last < 0) last = nlocal + nghost;
+  double *xs = xsoa[0], *ys = xsoa[1], *zs = xsoa[2];
+  double *vxs = vsoa[0], *vys = vsoa[1], *vzs = vsoa[2];
+
+#if defined(_OPENMP)
+#pragma omp parallel for default(shared) schedule(static)
+#endif
+  for (int i = first; i < last; i++) {
+    xs[i] = x[i][0];
+    ys[i] = x[i][1];
+    zs[i] = x[i][2];
+    vxs[i] = v[i][0];
+    vys[i] = v[i][1];
+    vzs[i] = v[i][2];
+  }
+}
+
 /* ----------------------------------------------------------------------
    reorder owned atoms so those in firstgroup appear first
    called by comm->exchange() if atom_modify first group is set
@@ -1257,13 +1418,19 @@ void Atom::sort_local()
   // permute = desired permutation of atoms
   // permute[I] = J means Ith new atom will be Jth old atom
 
+  // bins are visited in curve order if requested
+  // atoms inside a bin keep their order unless inbin sorting is on
+
   n = 0;
   for (m = 0; m < nbins; m++) {
-    i = binhead[m];
+    ibin = binorder ? binorder[m] : m;
+    int nfirst = n;
+    i = binhead[ibin];
     while (i >= 0) {
       permute[n++] = i;
       i = next[i];
     }
+    if (sortinbin && n-nfirst > 1) sort_inbin(&permute[nfirst],n-nfirst,ibin);
   }
 
   // current = current permutation, just reuse next vector
@@ -1372,9 +1539,83 @@ void Atom::setup_sort_bins()
 
   if (nbins > maxbin) {
     memory->destroy(binhead);
+    memory->destroy(binorder);
+    binorder = NULL;
     maxbin = nbins;
     memory->create(binhead,maxbin,"atom:binhead");
   }
+
+  // order of bins along a Morton or Hilbert curve
+  // curve spans the smallest power-of-2 cube enclosing all bins,
+  // bins are then ranked by their position on it
+
+  if (sortcurve == LINEAR) {
+    memory->destroy(binorder);
+    binorder = NULL;
+    return;
+  }
+
+  int dim = domain->dimension;
+  int nbits = 0;
+  while ((1 << nbits) < MAX(MAX(nbinx,nbiny),nbinz)) nbits++;
+  if (dim*nbits > 63)
+    error->one(FLERR,"Too many atom sorting bins for space-filling curve");
+
+  if (binorder == NULL) memory->create(binorder,maxbin,"atom:binorder");
+
+  std::vector<std::pair<uint64_t,int> > keys(nbins);
+  unsigned int c[3];
+  for (int iz = 0; iz < nbinz; iz++)
+    for (int iy = 0; iy < nbiny; iy++)
+      for (int ix = 0; ix < nbinx; ix++) {
+        int ibin = iz*nbiny*nbinx + iy*nbinx + ix;
+        c[0] = ix;
+        c[1] = iy;
+        c[2] = iz;
+        keys[ibin].first = curve_key(sortcurve,c,dim,nbits);
+        keys[ibin].second = ibin;
+      }
+  std::sort(keys.begin(),keys.end());
+  for (int m = 0; m < nbins; m++) binorder[m] = keys[m].second;
+}
+
+/* ----------------------------------------------------------------------
+   order the n atoms in list, which all lie in sort bin ibin,
+   by a fine Morton key of their position inside the bin
+   ties keep the incoming order
+------------------------------------------------------------------------- */
+
+void Atom::sort_inbin(int *list, int n, int ibin)
+{
+  int ix = ibin % nbinx;
+  int iy = (ibin / nbinx) % nbiny;
+  int iz = ibin / (nbinx*nbiny);
+  double lo[3],scale[3];
+  lo[0] = bboxlo[0] + ix/bininvx;
+  lo[1] = bboxlo[1] + iy/bininvy;
+  lo[2] = bboxlo[2] + iz/bininvz;
+  scale[0] = bininvx * (1 << INBIN_BITS);
+  scale[1] = bininvy * (1 << INBIN_BITS);
+  scale[2] = bininvz * (1 << INBIN_BITS);
+
+  int dim = domain->dimension;
+  int cmax = (1 << INBIN_BITS) - 1;
+  std::vector<std::pair<uint64_t,int> > keys(n);
+  unsigned int c[3];
+
+  for (int k = 0; k < n; k++) {
+    int i = list[k];
+    for (int d = 0; d < 3; d++) {
+      int cd = static_cast<int> ((x[i][d]-lo[d])*scale[d]);
+      c[d] = MIN(MAX(cd,0),cmax);
+    }
+    keys[k].first = interleave(c,dim,INBIN_BITS);
+    keys[k].second = k;
+  }
+  std::sort(keys.begin(),keys.end());
+
+  std::vector<int> old(list,list+n);
+  for (int k = 0; k < n; k++) list[k] = old[keys[k].second];
 }
 
 /* ----------------------------------------------------------------------
@@ -1608,9 +1849,10 @@ bigint Atom::memory_usage()
   if (map_style == 1)
     bytes += memory->usage(map_array,map_tag_max+1);
   else if (map_style == 2) {
-    bytes += map_nbucket*sizeof(int);
-    bytes += map_nhash*sizeof(HashElem);
+    bytes += map_nblock*sizeof(int);
+    bytes += map_nbucket*sizeof(HashElem);
   }
+  bytes += 6*nmax_soa*sizeof(double);
   if (maxnext) {
     bytes += memory->usage(next,maxnext);
     bytes += memory->usage(permute,maxnext);
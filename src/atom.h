@@ -140,6 +140,14 @@ class Atom : protected Pointers {
   int sortfreq;             // sort atoms every this many steps, 0 = off
   bigint nextsort;          // next timestep to sort on
 
+  // optional aligned structure-of-arrays mirror of x and v
+  // requested by pair styles that set Pair::soa_flag
+  // refreshed for owned+ghost atoms by Comm::forward_comm() and Neighbor::build()
+
+  int soaflag;                  // 1 if mirror is maintained this run
+  int nmax_soa;                 // length of each mirror component
+  double *xsoa[3],*vsoa[3];     // xsoa[k][i] = x[i][k], same for v
+
   // indices of atoms with same ID
 
   int *sametag;      // sametag[I] = next atom with same ID, -1 if no more
@@ -163,7 +171,7 @@ class Atom : protected Pointers {
   int parse_data(const char *);
   int count_words(const char *);
 
-  void data_atoms(int, char *);
+  void data_atoms(int, char *, int);
   void data_vels(int, char *);
   void data_bonus(int, char *, class AtomVec *);
   void data_bodies(int, char *, class AtomVecBody *);
@@ -183,6 +191,8 @@ class Atom : protected Pointers {
   int radius_consistency(int, double &);
   int shape_consistency(int, double &, double &, double &);
 
+  void update_soa(int first = 0, int last = -1);
+
   void first_reorder();
   virtual void sort_local();
 
@@ -217,7 +227,18 @@ class Atom : protected Pointers {
   virtual void map_set();
   virtual void map_one(int, int);
   virtual void map_delete();
-  virtual int map_find_hash(int);
+
+  // lookup global ID in hash table, return local index
+  // linear probing from home slot until key or an empty slot is found
+
+  inline int map_find_hash(int global) {
+    int index = map_hash_home(global);
+    while (map_hash[index].global) {
+      if (map_hash[index].global == global) return map_hash[index].local;
+      index = map_hash_next(index);
+    }
+    return -1;
+  };
 
  private:
 
@@ -226,18 +247,34 @@ class Atom : protected Pointers {
   int *map_array;       // direct map of length map_tag_max + 1
   int smax;             // max size of sametag
 
+  // hash table is open addressing with linear probing
+  // slots are split into blocks, a probe wraps around within its block,
+  //   so blocks can be filled independently by different threads
+
   struct HashElem {
-    int global;                   // key to search on = global ID
+    int global;                   // key to search on = global ID, 0 if empty
     int local;                    // value associated with key = local index
-    int next;                     // next entry in this bucket, -1 if last
   };
-  int map_nhash;                  // # of entries hash table can hold
+  int map_nhash;                  // # of entries hash table is sized for
   int map_nused;                  // # of actual entries in hash table
-  int map_free;                   // ptr to 1st unused entry in hash table
-  int map_nbucket;                // # of hash buckets
-  int *map_bucket;                // ptr to 1st entry in each bucket
+  int map_nbucket;                // # of slots, power of 2
+  int map_shift;                  // 32 - log2 of map_nbucket
+  int map_nblock;                 // # of blocks of slots
+  int map_blockbits;              // log2 of # of slots per block
+  int map_blockmask;              // # of slots per block - 1
+  int *map_blockcount;            // # of used slots in each block
   HashElem *map_hash;             // hash table
 
+  // home slot of a global ID = top bits of multiplicative hash
+  // next slot wraps around to start of block
+
+  inline int map_hash_home(int global) {
+    return ((unsigned int) global * 2654435761U) >> map_shift;
+  };
+  inline int map_hash_next(int index) {
+    return (index & ~map_blockmask) | ((index+1) & map_blockmask);
+  };
+
   // spatial sorting of atoms
 
   int nbins;                      // # of sorting bins
@@ -248,14 +285,25 @@ class Atom : protected Pointers {
   int *next;                      // next atom in bin
   int *permute;                   // permutation vector
   double userbinsize;             // requested sort bin size
+  int sortcurve;                  // order of bins, LINEAR, MORTON or HILBERT
+  int sortinbin;                  // 1 if also order atoms inside each bin
+  int *binorder;                  // binorder[m] = Mth bin along the curve
   double bininvx,bininvy,bininvz; // inverse actual bin sizes
   double bboxlo[3],bboxhi[3];     // bounding box of my sub-domain
 
+  // storage of the SoA mirror
+
+  double *soa_block;              // unaligned block behind xsoa and vsoa
+
   int memlength;                  // allocated size of memstr
   char *memstr;                   // string of array names already counted
 
   void setup_sort_bins();
-  int next_prime(int);
+  void sort_inbin(int *, int, int);
+  void map_hash_alloc(int);
+  void map_hash_reset();
+  int map_hash_insert(int, int);
+  int map_hash_remove(int);
 };
 
 }
@@ -17,9 +17,15 @@
 #include "memory.h"
 #include "error.h"
 
+#if defined(_OPENMP)
+#include "omp.h"
+#endif
+
 using namespace LAMMPS_NS;
 
 #define EXTRA 1000
+#define NBLOCKBITS 6      // hash table is split into 2^6 blocks
+#define MINBITS 12        // hash table has at least 2^12 slots
 
 /* ----------------------------------------------------------------------
    allocate and initialize array or hash table for global -> local map
@@ -28,9 +34,9 @@ using namespace LAMMPS_NS;
      array length = 1 to largest tag of any atom
      set entire array to -1 as initial values
    for hash option:
-     map_nhash = length of hash table
-     map_nbucket = # of hash buckets, prime larger than map_nhash
-       so buckets will only be filled with 0 or 1 atoms on average
+     map_nhash = # of atoms the hash table is sized for
+     map_nbucket = # of slots, power of 2 at least twice map_nhash
+       so hash table is at most half full
 ------------------------------------------------------------------------- */
 
 void Atom::map_init()
@@ -57,76 +63,35 @@ void Atom::map_init()
     // map_nhash = max # of atoms that can be hashed on this proc
     // set to max of ave atoms/proc or atoms I can store
     // multiply by 2, require at least 1000
-    // doubling means hash table will be re-init only rarely
+    // doubling means hash table will be re-allocated only rarely
 
     int nper = static_cast<int> (natoms/comm->nprocs);
-    map_nhash = MAX(nper,nmax);
-    map_nhash *= 2;
-    map_nhash = MAX(map_nhash,1000);
-
-    // map_nbucket = prime just larger than map_nhash
-
-    map_nbucket = next_prime(map_nhash);
-
-    // set all buckets to empty
-    // set hash to map_nhash in length
-    // put all hash entries in free list and point them to each other
-
-    map_bucket = new int[map_nbucket];
-    for (int i = 0; i < map_nbucket; i++) map_bucket[i] = -1;
-
-    map_hash = new HashElem[map_nhash];
-    map_nused = 0;
-    map_free = 0;
-    for (int i = 0; i < map_nhash; i++) map_hash[i].next = i+1;
-    map_hash[map_nhash-1].next = -1;
+    int nhash = MAX(nper,nmax);
+    map_hash_alloc(2*nhash);
   }
 }
 
 /* ----------------------------------------------------------------------
    clear global -> local map for all of my own and ghost atoms
    for hash table option:
+     when many atoms are cleared, empty the entire table instead,
+       since a sweep over all slots is cheaper than one probe per atom
      global ID may not be in table if image atom was already cleared
 ------------------------------------------------------------------------- */
 
 void Atom::map_clear()
 {
+  int nall = nlocal + nghost;
+  for (int i = 0; i < nall; i++) sametag[i] = -1;
+
   if (map_style == 1) {
-    int nall = nlocal + nghost;
-    for (int i = 0; i < nall; i++) {
-      sametag[i] = -1;
-      map_array[tag[i]] = -1;
-    }
+    for (int i = 0; i < nall; i++) map_array[tag[i]] = -1;
 
   } else {
-    int previous,global,ibucket,index;
-    int nall = nlocal + nghost;
-    for (int i = 0; i < nall; i++) {
-      sametag[i] = -1;
-
-      // search for key
-      // if don't find it, done
-
-      previous = -1;
-      global = tag[i];
-      ibucket = global % map_nbucket;
-      index = map_bucket[ibucket];
-      while (index > -1) {
-        if (map_hash[index].global == global) break;
-        previous = index;
-        index = map_hash[index].next;
-      }
-      if (index == -1) continue;
-
-      // delete the hash entry and add it to free list
-      // special logic if entry is 1st in the bucket
-
-      if (previous == -1) map_bucket[ibucket] = map_hash[index].next;
-      else map_hash[previous].next = map_hash[index].next;
-
-      map_hash[index].next = map_free;
-      map_free = index;
-      map_nused--;
+    if (nall >= map_nbucket/16) map_hash_reset();
+    else {
+      for (int i = 0; i < nall; i++)
+        if (map_hash_remove(tag[i])) map_nused--;
     }
   }
 }
@@ -137,8 +102,12 @@ void Atom::map_clear()
      and owned atoms take precedence over images
    this enables valid lookups of bond topology atoms
    for hash table option:
-     if hash table too small, re-init
+     if hash table too small, re-allocate it
      global ID may already be in table if image atom was set
+     each thread fills its own range of blocks, looping over all atoms
+       in reverse order and skipping atoms that hash to other blocks,
+       so map and sametag are identical to those of a serial loop
+     if a block fills up, remove partial result, grow table and redo
 ------------------------------------------------------------------------- */
 
 void Atom::map_set()
@@ -155,48 +124,55 @@ void Atom::map_set()
       sametag[i] = map_array[tag[i]];
       map_array[tag[i]] = i;
     }
-  } else {
-    int previous,global,ibucket,index;
-    if (nall > map_nhash) map_init();
 
-    for (int i = nall-1; i >= 0 ; i--) {
-      sametag[i] = map_find_hash(tag[i]);
-
-      // search for key
-      // if found it, just overwrite local value with index
-
-      previous = -1;
-      global = tag[i];
-      ibucket = global % map_nbucket;
-      index = map_bucket[ibucket];
-      while (index > -1) {
-        if (map_hash[index].global == global) break;
-        previous = index;
-        index = map_hash[index].next;
-      }
-      if (index > -1) {
-        map_hash[index].local = i;
-        continue;
+  } else {
+    if (nall > map_nhash) map_hash_alloc(2*nall);
+
+    int overflow;
+    while (1) {
+      overflow = 0;
+
+#if defined(_OPENMP)
+#pragma omp parallel default(shared) reduction(+:overflow)
+#endif
+      {
+#if defined(_OPENMP)
+        const int tid = omp_get_thread_num();
+        const int nthr = omp_get_num_threads();
+#else
+        const int tid = 0;
+        const int nthr = 1;
+#endif
+        const int bfrom = tid*map_nblock/nthr;
+        const int bto = (tid+1)*map_nblock/nthr;
+        int iblock,previous;
+
+        for (int i = nall-1; i >= 0; i--) {
+          iblock = map_hash_home(tag[i]) >> map_blockbits;
+          if (iblock < bfrom || iblock >= bto) continue;
+          previous = map_hash_insert(tag[i],i);
+          if (previous == -2) {
+            overflow++;
+            break;
+          }
+          sametag[i] = previous;
+        }
       }
 
-      // take one entry from free list
-      // add the new global/local pair as entry at end of bucket list
-      // special logic if this entry is 1st in bucket
-
-      index = map_free;
-      map_free = map_hash[map_free].next;
-      if (previous == -1) map_bucket[ibucket] = index;
-      else map_hash[previous].next = index;
-      map_hash[index].global = global;
-      map_hash[index].local = i;
-      map_hash[index].next = -1;
-      map_nused++;
+      if (!overflow) break;
+      for (int i = 0; i < nall; i++) map_hash_remove(tag[i]);
+      map_hash_alloc(2*map_nhash);
     }
+
+    map_nused = 0;
+    for (int iblock = 0; iblock < map_nblock; iblock++)
+      map_nused += map_blockcount[iblock];
   }
 }
 
 /* ----------------------------------------------------------------------
    set global to local map for one atom
+   local = -1 removes global ID from map
    for hash table option:
      global ID may already be in table if atom was already set
    called by Special class
@@ -205,35 +181,15 @@ void Atom::map_set()
 void Atom::map_one(int global, int local)
 {
   if (map_style == 1) map_array[global] = local;
-  else {
-    // search for key
-    // if found it, just overwrite local value with index
-
-    int previous = -1;
-    int ibucket = global % map_nbucket;
-    int index = map_bucket[ibucket];
-    while (index > -1) {
-      if (map_hash[index].global == global) break;
-      previous = index;
-      index = map_hash[index].next;
-    }
-    if (index > -1) {
-      map_hash[index].local = local;
-      return;
+  else if (local < 0) {
+    if (map_hash_remove(global)) map_nused--;
+  } else {
+    int previous = map_hash_insert(global,local);
+    if (previous == -2) {
+      map_hash_alloc(2*map_nhash);
+      previous = map_hash_insert(global,local);
     }
-
-    // take one entry from free list
-    // add the new global/local pair as entry at end of bucket list
-    // special logic if this entry is 1st in bucket
-
-    index = map_free;
-    map_free = map_hash[map_free].next;
-    if (previous == -1) map_bucket[ibucket] = index;
-    else map_hash[previous].next = index;
-    map_hash[index].global = global;
-    map_hash[index].local = local;
-    map_hash[index].next = -1;
-    map_nused++;
+    if (previous == -1) map_nused++;
   }
 }
 
@@ -251,53 +207,145 @@ void Atom::map_delete()
     map_array = NULL;
   } else {
     if (map_nhash) {
-      delete [] map_bucket;
+      delete [] map_blockcount;
       delete [] map_hash;
-      map_bucket = NULL;
+      map_blockcount = NULL;
       map_hash = NULL;
     }
     map_nhash = 0;
+    map_nbucket = map_nblock = 0;
   }
   map_tag_max = 0;
 }
 
 /* ----------------------------------------------------------------------
-   lookup global ID in hash table, return local index
-   called by map() in atom.h
+   allocate hash table with room for at least N atoms
+   entries of current hash table, if any, are copied into new one
+   if a block of new table overflows, double its size and try again
+------------------------------------------------------------------------- */
+
+void Atom::map_hash_alloc(int n)
+{
+  HashElem *oldhash = map_hash;
+  int *oldcount = map_blockcount;
+  int noldbucket = map_nbucket;
+
+  map_nhash = MAX(n,1000);
+  map_hash = NULL;
+  map_blockcount = NULL;
+
+  while (1) {
+    int nbits = MINBITS;
+    while ((1 << nbits) < 2*map_nhash) nbits++;
+    map_nbucket = 1 << nbits;
+    map_shift = 32 - nbits;
+    map_nblock = 1 << NBLOCKBITS;
+    map_blockbits = nbits - NBLOCKBITS;
+    map_blockmask = (1 << map_blockbits) - 1;
+
+    delete [] map_blockcount;
+    delete [] map_hash;
+    map_blockcount = new int[map_nblock];
+    map_hash = new HashElem[map_nbucket];
+    map_hash_reset();
+
+    int i;
+    for (i = 0; i < noldbucket; i++)
+      if (oldhash[i].global &&
+          map_hash_insert(oldhash[i].global,oldhash[i].local) == -2) break;
+    if (i == noldbucket) break;
+    map_nhash *= 2;
+  }
+
+  map_nused = 0;
+  for (int iblock = 0; iblock < map_nblock; iblock++)
+    map_nused += map_blockcount[iblock];
+
+  delete [] oldcount;
+  delete [] oldhash;
+}
+
+/* ----------------------------------------------------------------------
+   set all slots of hash table to empty
+------------------------------------------------------------------------- */
+
+void Atom::map_hash_reset()
+{
+  HashElem *hash = map_hash;
+  const int nbucket = map_nbucket;
+
+#if defined(_OPENMP)
+#pragma omp parallel for default(shared) schedule(static)
+#endif
+  for (int i = 0; i < nbucket; i++) {
+    hash[i].global = 0;
+    hash[i].local = -1;
+  }
+
+  for (int iblock = 0; iblock < map_nblock; iblock++)
+    map_blockcount[iblock] = 0;
+  map_nused = 0;
+}
+
+/* ----------------------------------------------------------------------
+   add global/local pair to hash table, or overwrite local if global exists
+   only touches the block global hashes to, so threads can fill
+     different blocks at the same time
+   a block always keeps one empty slot so every probe terminates
+   return previous local value of global ID, -1 if it is a new entry
+   return -2 if block is full and global ID could not be added
 ------------------------------------------------------------------------- */
 
-int Atom::map_find_hash(int global)
+int Atom::map_hash_insert(int global, int local)
 {
-  int local = -1;
-  int index = map_bucket[global % map_nbucket];
-  while (index > -1) {
+  int index = map_hash_home(global);
+  while (map_hash[index].global) {
     if (map_hash[index].global == global) {
-      local = map_hash[index].local;
-      break;
+      int previous = map_hash[index].local;
+      map_hash[index].local = local;
+      return previous;
     }
-    index = map_hash[index].next;
+    index = map_hash_next(index);
   }
-  return local;
+
+  int iblock = index >> map_blockbits;
+  if (map_blockcount[iblock] == map_blockmask) return -2;
+  map_blockcount[iblock]++;
+  map_hash[index].global = global;
+  map_hash[index].local = local;
+  return -1;
 }
 
 /* ----------------------------------------------------------------------
-   return next prime larger than n
+   remove global ID from hash table
+   entries further along the probe sequence are shifted back into the hole,
+     unless their home slot lies cyclically between the hole and them
+   return 1 if global ID was in table, 0 if not
 ------------------------------------------------------------------------- */
 
-int Atom::next_prime(int n)
+int Atom::map_hash_remove(int global)
 {
-  int factor;
-
-  int nprime = n+1;
-  if (nprime % 2 == 0) nprime++;
-  int root = static_cast<int> (sqrt(1.0*n)) + 2;
+  int index = map_hash_home(global);
+  while (map_hash[index].global != global) {
+    if (map_hash[index].global == 0) return 0;
+    index = map_hash_next(index);
+  }
 
-  while (nprime <= MAXSMALLINT) {
-    for (factor = 3; factor < root; factor++)
-      if (nprime % factor == 0) break;
-    if (factor == root) return nprime;
-    nprime += 2;
+  int hole = index;
+  int dhome,dj;
+  while (1) {
+    index = map_hash_next(index);
+    if (map_hash[index].global == 0) break;
+    dhome = (map_hash_home(map_hash[index].global) - hole) & map_blockmask;
+    dj = (index - hole) & map_blockmask;
+    if (dhome == 0 || dhome > dj) {
+      map_hash[hole] = map_hash[index];
+      hole = index;
+    }
   }
 
-  return MAXSMALLINT;
+  map_hash[hole].global = 0;
+  map_hash[hole].local = -1;
+  map_blockcount[hole >> map_blockbits]--;
+  return 1;
 }
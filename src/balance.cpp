@@ -20,9 +20,14 @@
 #include "atom.h"
 #include "comm.h"
 #include "irregular.h"
+#include "rcb.h"
 #include "domain.h"
 #include "force.h"
 #include "update.h"
+#include "modify.h"
+#include "compute.h"
+#include "input.h"
+#include "variable.h"
 #include "memory.h"
 #include "error.h"
 
@@ -31,6 +36,8 @@ using namespace LAMMPS_NS;
 enum{NONE,UNIFORM,USER,DYNAMIC};
 enum{X,Y,Z};
 
+#define INVOKED_PERATOM 8
+
 //#define BALANCE_DEBUG 1
 
 /* ---------------------------------------------------------------------- */
@@ -42,9 +49,24 @@ Balance::Balance(LAMMPS *lmp) : Pointers(lmp)
 
   memory->create(proccount,nprocs,"balance:proccount");
   memory->create(allproccount,nprocs,"balance:allproccount");
+  memory->create(procweight,nprocs,"balance:procweight");
+  memory->create(allprocweight,nprocs,"balance:allprocweight");
 
   user_xsplit = user_ysplit = user_zsplit = NULL;
   dflag = 0;
+  rflag = 0;
+  rcb = NULL;
+
+  wtflag = 0;
+  wttype = NULL;
+  wtbonded = 0.0;
+  id_wtcompute = id_wtvariable = NULL;
+  weight = wtvariable = NULL;
+  maxweight = 0;
+  wtstore = NULL;
+  maxwtstore = 0;
+  wtstore_step = -1;
+  wtstore_nlocal = 0;
 
   fp = NULL;
   firststep = 1;
@@ -56,6 +78,15 @@ Balance::~Balance()
 {
   memory->destroy(proccount);
   memory->destroy(allproccount);
+  memory->destroy(procweight);
+  memory->destroy(allprocweight);
+
+  delete [] wttype;
+  delete [] id_wtcompute;
+  delete [] id_wtvariable;
+  memory->destroy(weight);
+  memory->destroy(wtvariable);
+  memory->destroy(wtstore);
 
   delete [] user_xsplit;
   delete [] user_ysplit;
@@ -73,6 +104,8 @@ Balance::~Balance()
     delete [] hisum;
   }
 
+  delete rcb;
+
   if (fp) fclose(fp);
 }
 
@@ -95,6 +128,7 @@ void Balance::command(int narg, char **arg)
   int *procgrid = comm->procgrid;
   xflag = yflag = zflag = NONE;
   dflag = 0;
+  rflag = 0;
   outflag = 0;
 
   int iarg = 0;
@@ -169,6 +203,14 @@ void Balance::command(int narg, char **arg)
       if (thresh < 1.0) error->all(FLERR,"Illegal balance command");
       iarg += 4;
 
+    } else if (strcmp(arg[iarg],"rcb") == 0) {
+      rflag = 1;
+      iarg++;
+
+    } else if (strcmp(arg[iarg],"weight") == 0) {
+      iarg++;
+      iarg += weight_setup(narg-iarg,&arg[iarg]);
+
     } else if (strcmp(arg[iarg],"out") == 0) {
       if (iarg+2 > narg) error->all(FLERR,"Illegal balance command");
       if (outflag) error->all(FLERR,"Illegal balance command");
@@ -183,6 +225,9 @@ void Balance::command(int narg, char **arg)
 
   // error check
 
+  if (rflag && (xflag != NONE || yflag != NONE || zflag != NONE))
+    error->all(FLERR,"Balance rcb cannot be used with x, y, z, or dynamic");
+
   if (zflag && dimension == 2)
     error->all(FLERR,"Cannot balance in z dimension for 2d simulation");
 
@@ -222,6 +267,8 @@ void Balance::command(int narg, char **arg)
   // imbinit = initial imbalance
   // use current splits instead of nlocal since atoms may not be in sub-box
 
+  weight_init();
+  set_weights();
   domain->x2lamda(atom->nlocal);
   int maxinit;
   double imbinit = imbalance_splits(maxinit);
@@ -235,6 +282,12 @@ void Balance::command(int narg, char **arg)
 
   int niter = 0;
 
+  // recursive bisection into tiles replaces the 3d grid of procs
+  // any other balancing reverts to the 3d grid
+
+  if (rflag) niter = bisection();
+  else comm->tiled = 0;
+
   // explicit setting of sub-domain sizes
 
   if (xflag == UNIFORM) {
@@ -296,29 +349,21 @@ void Balance::command(int narg, char **arg)
   domain->set_local_box();
 
   // move atoms to new processors via irregular()
-
-  if (domain->triclinic) domain->x2lamda(atom->nlocal);
-  Irregular *irregular = new Irregular(lmp);
-  irregular->migrate_atoms();
-  delete irregular;
-  if (domain->triclinic) domain->lamda2x(atom->nlocal);
-
-  // check if any atoms were lost
-
-  bigint natoms;
-  bigint nblocal = atom->nlocal;
-  MPI_Allreduce(&nblocal,&natoms,1,MPI_LMP_BIGINT,MPI_SUM,world);
-  if (natoms != atom->natoms) {
-    char str[128];
-    sprintf(str,"Lost atoms via balance: original " BIGINT_FORMAT
-            " current " BIGINT_FORMAT,atom->natoms,natoms);
-    error->all(FLERR,str);
-  }
-
-  // imbfinal = final imbalance based on final nlocal
+  // weights are only known for atoms on their current procs,
+  //   so weighted final imbalance uses new splits before atoms move,
+  //   else final imbalance is based on final nlocal
 
   int maxfinal;
-  double imbfinal = imbalance_nlocal(maxfinal);
+  double imbfinal;
+  if (wtflag) {
+    domain->x2lamda(atom->nlocal);
+    imbfinal = imbalance_splits(maxfinal);
+    domain->lamda2x(atom->nlocal);
+    migrate();
+  } else {
+    migrate();
+    imbfinal = imbalance_nlocal(maxfinal);
+  }
 
   if (me == 0) {
     if (screen) {
@@ -337,7 +382,7 @@ void Balance::command(int narg, char **arg)
     }
   }
 
-  if (me == 0) {
+  if (me == 0 && !comm->tiled) {
     if (screen) {
       fprintf(screen,"  x cuts:");
       for (int i = 0; i <= comm->procgrid[0]; i++)
@@ -369,15 +414,54 @@ void Balance::command(int narg, char **arg)
   }
 }
 
+/* ----------------------------------------------------------------------
+   move atoms to new processors via irregular()
+   check that no atoms were lost
+------------------------------------------------------------------------- */
+
+void Balance::migrate()
+{
+  if (domain->triclinic) domain->x2lamda(atom->nlocal);
+  Irregular *irregular = new Irregular(lmp);
+  irregular->migrate_atoms();
+  delete irregular;
+  if (domain->triclinic) domain->lamda2x(atom->nlocal);
+
+  bigint natoms;
+  bigint nblocal = atom->nlocal;
+  MPI_Allreduce(&nblocal,&natoms,1,MPI_LMP_BIGINT,MPI_SUM,world);
+  if (natoms != atom->natoms) {
+    char str[128];
+    sprintf(str,"Lost atoms via balance: original " BIGINT_FORMAT
+            " current " BIGINT_FORMAT,atom->natoms,natoms);
+    error->all(FLERR,str);
+  }
+}
+
 /* ----------------------------------------------------------------------
    calculate imbalance based on nlocal
    return max = max atom per proc
    return imbalance factor = max atom per proc / ave atom per proc
+   if atoms are weighted, factor = max weight per proc / ave weight per proc
 ------------------------------------------------------------------------- */
 
 double Balance::imbalance_nlocal(int &max)
 {
   MPI_Allreduce(&atom->nlocal,&max,1,MPI_INT,MPI_MAX,world);
+
+  if (wtflag) {
+    set_weights();
+    double wt[2],wtall[2];
+    wt[0] = 0.0;
+    for (int i = 0; i < atom->nlocal; i++) wt[0] += weight[i];
+    wt[1] = -wt[0];
+    MPI_Allreduce(&wt[0],&wtall[0],1,MPI_DOUBLE,MPI_MAX,world);
+    MPI_Allreduce(&wt[1],&wtall[1],1,MPI_DOUBLE,MPI_SUM,world);
+    double imbalance = 1.0;
+    if (wtall[0] > 0.0) imbalance = wtall[0] / (-wtall[1] / nprocs);
+    return imbalance;
+  }
+
   double imbalance = 1.0;
   if (max) imbalance = max / (1.0 * atom->natoms / nprocs);
   return imbalance;
@@ -386,7 +470,9 @@ double Balance::imbalance_nlocal(int &max)
 /* ----------------------------------------------------------------------
    calculate imbalance based on processor splits in 3 dims
    atoms must be in lamda coords (0-1) before called
-   map atoms to 3d grid of procs
+   map atoms to 3d grid of procs, or to RCB tiles if comm is tiled
+   if atoms are weighted, set_weights() must have been called for them
+     and factor = max weight per proc / ave weight per proc
    return max = max atom per proc
    return imbalance factor = max atom per proc / ave atom per proc
 ------------------------------------------------------------------------- */
@@ -401,24 +487,42 @@ double Balance::imbalance_splits(int &max)
   int ny = comm->procgrid[1];
   int nz = comm->procgrid[2];
 
-  for (int i = 0; i < nprocs; i++) proccount[i] = 0;
+  for (int i = 0; i < nprocs; i++) {
+    proccount[i] = 0;
+    procweight[i] = 0.0;
+  }
 
   double **x = atom->x;
   int nlocal = atom->nlocal;
-  int ix,iy,iz;
+  int ix,iy,iz,iproc;
 
   for (int i = 0; i < nlocal; i++) {
-    ix = binary(x[i][0],nx,xsplit);
-    iy = binary(x[i][1],ny,ysplit);
-    iz = binary(x[i][2],nz,zsplit);
-    proccount[iz*nx*ny + iy*nx + ix]++;
+    if (comm->tiled) iproc = comm->coord2tile(x[i],1);
+    else {
+      ix = binary(x[i][0],nx,xsplit);
+      iy = binary(x[i][1],ny,ysplit);
+      iz = binary(x[i][2],nz,zsplit);
+      iproc = iz*nx*ny + iy*nx + ix;
+    }
+    proccount[iproc]++;
+    if (wtflag) procweight[iproc] += weight[i];
   }
 
   MPI_Allreduce(proccount,allproccount,nprocs,MPI_INT,MPI_SUM,world);
   max = 0;
   for (int i = 0; i < nprocs; i++) max = MAX(max,allproccount[i]);
+
   double imbalance = 1.0;
-  if (max) imbalance = max / (1.0 * atom->natoms / nprocs);
+  if (wtflag) {
+    MPI_Allreduce(procweight,allprocweight,nprocs,MPI_DOUBLE,MPI_SUM,world);
+    double wtmax = 0.0;
+    double wtsum = 0.0;
+    for (int i = 0; i < nprocs; i++) {
+      wtmax = MAX(wtmax,allprocweight[i]);
+      wtsum += allprocweight[i];
+    }
+    if (wtmax > 0.0) imbalance = wtmax / (wtsum / nprocs);
+  } else if (max) imbalance = max / (1.0 * atom->natoms / nprocs);
   return imbalance;
 }
 
@@ -442,14 +546,14 @@ void Balance::static_setup(char *str)
   int max = MAX(comm->procgrid[0],comm->procgrid[1]);
   max = MAX(max,comm->procgrid[2]);
 
-  count = new bigint[max];
-  onecount = new bigint[max];
-  sum = new bigint[max+1];
-  target = new bigint[max+1];
+  count = new double[max];
+  onecount = new double[max];
+  sum = new double[max+1];
+  target = new double[max+1];
   lo = new double[max+1];
   hi = new double[max+1];
-  losum = new bigint[max+1];
-  hisum = new bigint[max+1];
+  losum = new double[max+1];
+  hisum = new double[max+1];
 
   rho = 0;
 }
@@ -486,6 +590,17 @@ int Balance::dynamic()
   bigint natoms = atom->natoms;
   if (natoms == 0) return 0;
 
+  // total = # of atoms or total weight of atoms to divide between slices
+
+  double total = natoms;
+  set_weights();
+  if (wtflag) {
+    double mytotal = 0.0;
+    for (i = 0; i < atom->nlocal; i++) mytotal += weight[i];
+    MPI_Allreduce(&mytotal,&total,1,MPI_DOUBLE,MPI_SUM,world);
+    if (total == 0.0) return 0;
+  }
+
   // set delta for 1d balancing = root of threshhold
   // root = # of dimensions being balanced on
 
@@ -514,17 +629,19 @@ int Balance::dynamic()
 
     // target[i] = desired sum at split I
 
-    for (i = 0; i < np; i++)
-      target[i] = static_cast<int> (1.0*natoms/np * i + 0.5);
-    target[np] = natoms;
+    for (i = 0; i < np; i++) {
+      if (wtflag) target[i] = total/np * i;
+      else target[i] = static_cast<int> (1.0*natoms/np * i + 0.5);
+    }
+    target[np] = total;
 
     // lo[i] = closest split <= split[i] with a sum <= target
     // hi[i] = closest split >= split[i] with a sum >= target
 
     lo[0] = hi[0] = 0.0;
     lo[np] = hi[np] = 1.0;
-    losum[0] = hisum[0] = 0;
-    losum[np] = hisum[np] = natoms;
+    losum[0] = hisum[0] = 0.0;
+    losum[np] = hisum[np] = total;
 
     for (i = 1; i < np; i++) {
       for (j = i; j >= 0; j--)
@@ -633,8 +750,32 @@ int Balance::dynamic()
   return niter;
 }
 
+/* ----------------------------------------------------------------------
+   load balance by recursive coordinate bisection of atoms into tiles
+   tiles are passed to Comm, which then uses them instead of xyz splits
+   called one time from input script command or many times from fix balance
+   return # of levels of cuts
+------------------------------------------------------------------------- */
+
+int Balance::bisection()
+{
+  if (rcb == NULL) rcb = new RCB(lmp);
+
+  // all balancing done in lamda coords
+
+  double *wt = set_weights();
+  domain->x2lamda(atom->nlocal);
+  int nlevel = rcb->compute(atom->nlocal,atom->x,wt);
+  domain->lamda2x(atom->nlocal);
+
+  comm->set_tiles(rcb->cutdim,rcb->cut,rcb->lo,rcb->hi);
+
+  return nlevel;
+}
+
 /* ----------------------------------------------------------------------
    count atoms in each slice, based on their dim coordinate
+   atoms count by their weight if atoms are weighted
    N = # of slices
    split = N+1 cuts between N slices
    return updated count = particles per slice
@@ -644,7 +785,7 @@ int Balance::dynamic()
 
 void Balance::tally(int dim, int n, double *split)
 {
-  for (int i = 0; i < n; i++) onecount[i] = 0;
+  for (int i = 0; i < n; i++) onecount[i] = 0.0;
 
   double **x = atom->x;
   int nlocal = atom->nlocal;
@@ -652,12 +793,13 @@ void Balance::tally(int dim, int n, double *split)
 
   for (int i = 0; i < nlocal; i++) {
     index = binary(x[i][dim],n,split);
-    onecount[index]++;
+    if (wtflag) onecount[index] += weight[i];
+    else onecount[index] += 1.0;
   }
 
-  MPI_Allreduce(onecount,count,n,MPI_LMP_BIGINT,MPI_SUM,world);
+  MPI_Allreduce(onecount,count,n,MPI_DOUBLE,MPI_SUM,world);
 
-  sum[0] = 0;
+  sum[0] = 0.0;
   for (int i = 1; i < n+1; i++)
     sum[i] = sum[i-1] + count[i-1];
 }
@@ -712,7 +854,7 @@ int Balance::adjust(int n, double *split)
   for (int i = 1; i < n; i++)
     if (sum[i] != target[i]) {
       change = 1;
-      if (rho == 0) split[i] = 0.5 * (lo[i]+hi[i]);
+      if (rho == 0 || hisum[i] == losum[i]) split[i] = 0.5 * (lo[i]+hi[i]);
       else {
         fraction = 1.0*(target[i]-losum[i]) / (hisum[i]-losum[i]);
         split[i] = lo[i] + fraction * (hi[i]-lo[i]);
@@ -731,7 +873,7 @@ int Balance::adjust(int n, double *split)
      by moving cut closer to sender, further from receiver
 ------------------------------------------------------------------------- */
 
-void Balance::old_adjust(int iter, int n, bigint *count, double *split)
+void Balance::old_adjust(int iter, int n, double *count, double *split)
 {
   // need to allocate this if start using it again
 
@@ -747,7 +889,7 @@ void Balance::old_adjust(int iter, int n, bigint *count, double *split)
   // for a cut between 2 slices, only slice with larger count adjusts it
   // special treatment of end slices with only 1 neighbor
 
-  bigint leftcount,mycount,rightcount;
+  double leftcount,mycount,rightcount;
   double rho,target,targetleft,targetright;
 
   for (int i = 0; i < n; i++) {
@@ -865,6 +1007,244 @@ int Balance::binary(double value, int n, double *vec)
   return index;
 }
 
+/* ----------------------------------------------------------------------
+   parse one weight keyword of balance or fix balance command
+   arg[0] = style, followed by its values
+   weights of several styles are multiplied together
+   return # of args used
+------------------------------------------------------------------------- */
+
+int Balance::weight_setup(int narg, char **arg)
+{
+  if (narg < 2) error->all(FLERR,"Illegal balance weight option");
+
+  if (strcmp(arg[0],"type") == 0) {
+    int ntypes = atom->ntypes;
+    if (narg < 1+ntypes) error->all(FLERR,"Illegal balance weight option");
+    delete [] wttype;
+    wttype = new double[ntypes+1];
+    for (int i = 1; i <= ntypes; i++) {
+      wttype[i] = force->numeric(FLERR,arg[i]);
+      if (wttype[i] < 0.0)
+        error->all(FLERR,"Balance weight cannot be negative");
+    }
+    return 1+ntypes;
+
+  } else if (strcmp(arg[0],"bonded") == 0) {
+    wtbonded = force->numeric(FLERR,arg[1]);
+    if (wtbonded < 0.0) error->all(FLERR,"Balance weight cannot be negative");
+    return 2;
+
+  } else if (strcmp(arg[0],"compute") == 0) {
+    delete [] id_wtcompute;
+    int n = strlen(arg[1]) + 1;
+    id_wtcompute = new char[n];
+    strcpy(id_wtcompute,arg[1]);
+    return 2;
+
+  } else if (strcmp(arg[0],"variable") == 0) {
+    delete [] id_wtvariable;
+    int n = strlen(arg[1]) + 1;
+    id_wtvariable = new char[n];
+    strcpy(id_wtvariable,arg[1]);
+    return 2;
+  }
+
+  error->all(FLERR,"Illegal balance weight option");
+  return 0;
+}
+
+/* ----------------------------------------------------------------------
+   look up compute and variable used for weights
+   called before first use of weights by balance, from init() by fix balance
+------------------------------------------------------------------------- */
+
+void Balance::weight_init()
+{
+  wtflag = 0;
+  if (wttype || wtbonded > 0.0 || id_wtcompute || id_wtvariable) wtflag = 1;
+
+  if (id_wtcompute) {
+    iwtcompute = modify->find_compute(id_wtcompute);
+    if (iwtcompute < 0)
+      error->all(FLERR,"Compute ID for balance weight does not exist");
+    Compute *compute = modify->compute[iwtcompute];
+    if (compute->peratom_flag == 0 || compute->size_peratom_cols)
+      error->all(FLERR,
+                 "Balance weight compute does not calculate a per-atom vector");
+  }
+
+  if (id_wtvariable) {
+    iwtvariable = input->variable->find(id_wtvariable);
+    if (iwtvariable < 0)
+      error->all(FLERR,"Variable name for balance weight does not exist");
+    if (input->variable->atomstyle(iwtvariable) == 0)
+      error->all(FLERR,"Balance weight variable is not atom-style variable");
+  }
+}
+
+/* ----------------------------------------------------------------------
+   return 1 if the weight compute tallies per-atom energy or virial
+   its values only exist after the force computation of a step it was
+   scheduled for, so fix balance stores them on the step before it
+   rebalances, see weight_store()
+------------------------------------------------------------------------- */
+
+int Balance::weight_tally()
+{
+  if (!id_wtcompute) return 0;
+  Compute *compute = modify->compute[iwtcompute];
+  if (compute->peatomflag || compute->pressatomflag) return 1;
+  return 0;
+}
+
+/* ----------------------------------------------------------------------
+   return 1 if set_weights() can get values of the weight compute now:
+   stored on the previous step, invoked on this step,
+   or invoked now during a run if the compute does not tally
+------------------------------------------------------------------------- */
+
+int Balance::weight_current()
+{
+  if (!id_wtcompute) return 1;
+  Compute *compute = modify->compute[iwtcompute];
+  if (wtstore_step >= 0 && wtstore_step == update->ntimestep-1) return 1;
+  if (compute->invoked_peratom == update->ntimestep) return 1;
+  if (update->whichflag && !weight_tally()) return 1;
+  return 0;
+}
+
+/* ----------------------------------------------------------------------
+   tell a tallying weight compute to tally on step ntimestep
+------------------------------------------------------------------------- */
+
+void Balance::weight_schedule(bigint ntimestep)
+{
+  if (!weight_tally()) return;
+  modify->compute[iwtcompute]->addstep(ntimestep);
+}
+
+/* ----------------------------------------------------------------------
+   invoke a tallying weight compute at the end of a step, store its values
+   called by fix balance on the step before it rebalances,
+     which it scheduled the compute for via weight_schedule()
+   atoms do not migrate until the next pre_exchange, so the values
+     are still those of the owned atoms when set_weights() uses them
+------------------------------------------------------------------------- */
+
+void Balance::weight_store()
+{
+  if (!weight_tally()) return;
+
+  Compute *compute = modify->compute[iwtcompute];
+  if (!(compute->invoked_flag & INVOKED_PERATOM)) {
+    compute->compute_peratom();
+    compute->invoked_flag |= INVOKED_PERATOM;
+  }
+
+  int nlocal = atom->nlocal;
+  if (nlocal > maxwtstore) {
+    maxwtstore = atom->nmax;
+    memory->destroy(wtstore);
+    memory->create(wtstore,maxwtstore,"balance:wtstore");
+  }
+
+  double *vector = compute->vector_atom;
+  for (int i = 0; i < nlocal; i++) wtstore[i] = vector[i];
+  wtstore_step = update->ntimestep;
+  wtstore_nlocal = nlocal;
+}
+
+/* ----------------------------------------------------------------------
+   stored values are invalid once atoms migrate
+------------------------------------------------------------------------- */
+
+void Balance::weight_clear()
+{
+  wtstore_step = -1;
+}
+
+/* ----------------------------------------------------------------------
+   set weight of each owned atom = product of all weight styles
+   bonded weight = 1 + factor * # of bonds,angles,dihedrals,impropers
+     stored with the atom, which is the # of those terms it computes
+   weights are only valid until atoms migrate
+   return weight vector, NULL if atoms are not weighted
+------------------------------------------------------------------------- */
+
+double *Balance::set_weights()
+{
+  if (!wtflag) return NULL;
+
+  int nlocal = atom->nlocal;
+  if (nlocal > maxweight) {
+    maxweight = atom->nmax;
+    memory->destroy(weight);
+    memory->destroy(wtvariable);
+    memory->create(weight,maxweight,"balance:weight");
+    if (id_wtvariable) memory->create(wtvariable,maxweight,"balance:wtvariable");
+  }
+
+  int i;
+  for (i = 0; i < nlocal; i++) weight[i] = 1.0;
+
+  if (wttype) {
+    int *type = atom->type;
+    for (i = 0; i < nlocal; i++) weight[i] *= wttype[type[i]];
+  }
+
+  if (wtbonded > 0.0) {
+    int *num_bond = atom->num_bond;
+    int *num_angle = atom->num_angle;
+    int *num_dihedral = atom->num_dihedral;
+    int *num_improper = atom->num_improper;
+    int nterm;
+    for (i = 0; i < nlocal; i++) {
+      nterm = 0;
+      if (num_bond) nterm += num_bond[i];
+      if (num_angle) nterm += num_angle[i];
+      if (num_dihedral) nterm += num_dihedral[i];
+      if (num_improper) nterm += num_improper[i];
+      weight[i] *= 1.0 + wtbonded*nterm;
+    }
+  }
+
+  // compute values in order of preference, see weight_current():
+  //   stored on the previous step, invoked on this step,
+  //   invoked now if during a run and the compute does not tally
+
+  if (id_wtcompute) {
+    Compute *compute = modify->compute[iwtcompute];
+    double *vector = NULL;
+    if (wtstore_step >= 0 && wtstore_step == update->ntimestep-1) {
+      if (wtstore_nlocal != nlocal)
+        error->one(FLERR,"Balance weight compute is not current");
+      vector = wtstore;
+    } else if (compute->invoked_peratom == update->ntimestep) {
+      vector = compute->vector_atom;
+    } else if (update->whichflag && !weight_tally()) {
+      if (!(compute->invoked_flag & INVOKED_PERATOM)) {
+        compute->compute_peratom();
+        compute->invoked_flag |= INVOKED_PERATOM;
+      }
+      vector = compute->vector_atom;
+    } else error->all(FLERR,"Balance weight compute is not current");
+    for (i = 0; i < nlocal; i++) weight[i] *= vector[i];
+  }
+
+  if (id_wtvariable) {
+    input->variable->compute_atom(iwtvariable,0,wtvariable,1,0);
+    for (i = 0; i < nlocal; i++) weight[i] *= wtvariable[i];
+  }
+
+  int flag = 0;
+  for (i = 0; i < nlocal; i++)
+    if (weight[i] < 0.0) flag = 1;
+  if (flag) error->one(FLERR,"Balance weight cannot be negative");
+
+  return weight;
+}
+
 /* ----------------------------------------------------------------------
    write dump snapshot of line segments in Pizza.py mdump mesh format
    write xy lines around each proc's sub-domain for 2d
@@ -876,6 +1256,11 @@ void Balance::dumpout(bigint tstep, FILE *bfp)
 {
   int dimension = domain->dimension;
 
+  if (comm->tiled) {
+    dumpout_tiles(tstep,bfp);
+    return;
+  }
+
   // write out one square/cube per processor for 2d/3d
   // only write once since topology is static
 
@@ -972,6 +1357,74 @@ void Balance::dumpout(bigint tstep, FILE *bfp)
   }
 }
 
+/* ----------------------------------------------------------------------
+   same as dumpout() for RCB tiles of last bisection()
+   tiles do not share corners, so each has its own 4 or 8 nodes
+------------------------------------------------------------------------- */
+
+void Balance::dumpout_tiles(bigint tstep, FILE *bfp)
+{
+  int dimension = domain->dimension;
+  int nper = 1 << dimension;
+
+  if (firststep) {
+    firststep = 0;
+    fprintf(bfp,"ITEM: TIMESTEP\n");
+    fprintf(bfp,BIGINT_FORMAT "\n",tstep);
+    if (dimension == 2) fprintf(bfp,"ITEM: NUMBER OF SQUARES\n");
+    else fprintf(bfp,"ITEM: NUMBER OF CUBES\n");
+    fprintf(bfp,"%d\n",nprocs);
+    if (dimension == 2) fprintf(bfp,"ITEM: SQUARES\n");
+    else fprintf(bfp,"ITEM: CUBES\n");
+
+    for (int m = 0; m < nprocs; m++) {
+      int c = m*nper + 1;
+      if (dimension == 2)
+        fprintf(bfp,"%d %d %d %d %d %d\n",m+1,m+1,c,c+1,c+2,c+3);
+      else
+        fprintf(bfp,"%d %d %d %d %d %d %d %d %d %d\n",
+                m+1,m+1,c,c+1,c+2,c+3,c+4,c+5,c+6,c+7);
+    }
+  }
+
+  double *boxlo = domain->boxlo;
+  double *boxhi = domain->boxhi;
+  double *prd = domain->prd;
+
+  fprintf(bfp,"ITEM: TIMESTEP\n");
+  fprintf(bfp,BIGINT_FORMAT "\n",tstep);
+  fprintf(bfp,"ITEM: NUMBER OF NODES\n");
+  fprintf(bfp,"%d\n",nper*nprocs);
+  fprintf(bfp,"ITEM: BOX BOUNDS\n");
+  fprintf(bfp,"%g %g\n",boxlo[0],boxhi[0]);
+  fprintf(bfp,"%g %g\n",boxlo[1],boxhi[1]);
+  fprintf(bfp,"%g %g\n",boxlo[2],boxhi[2]);
+  fprintf(bfp,"ITEM: NODES\n");
+
+  // corners in same order as dumpout(): lo-lo, hi-lo, hi-hi, lo-hi in xy
+
+  double xlo,xhi,ylo,yhi,zlo,zhi;
+  int m = 0;
+  for (int i = 0; i < nprocs; i++) {
+    xlo = boxlo[0] + prd[0]*rcb->lo[i][0];
+    xhi = boxlo[0] + prd[0]*rcb->hi[i][0];
+    ylo = boxlo[1] + prd[1]*rcb->lo[i][1];
+    yhi = boxlo[1] + prd[1]*rcb->hi[i][1];
+    zlo = zhi = 0.0;
+    if (dimension == 3) {
+      zlo = boxlo[2] + prd[2]*rcb->lo[i][2];
+      zhi = boxlo[2] + prd[2]*rcb->hi[i][2];
+    }
+    for (int k = 0; k < nper/4; k++) {
+      double z = k ? zhi : zlo;
+      fprintf(bfp,"%d %d %g %g %g\n",++m,1,xlo,ylo,z);
+      fprintf(bfp,"%d %d %g %g %g\n",++m,1,xhi,ylo,z);
+      fprintf(bfp,"%d %d %g %g %g\n",++m,1,xhi,yhi,z);
+      fprintf(bfp,"%d %d %g %g %g\n",++m,1,xlo,yhi,z);
+    }
+  }
+}
+
 /* ----------------------------------------------------------------------
    debug output for Idim and count
    only called by proc 0
@@ -991,13 +1444,13 @@ void Balance::debug_output(int idim, int m, int np, double *split)
   printf("Dimension %s, Iteration %d\n",dim,m);
 
   printf("  Count:");
-  for (i = 0; i < np; i++) printf(" " BIGINT_FORMAT,count[i]);
+  for (i = 0; i < np; i++) printf(" %g",count[i]);
   printf("\n");
   printf("  Sum:");
-  for (i = 0; i <= np; i++) printf(" " BIGINT_FORMAT,sum[i]);
+  for (i = 0; i <= np; i++) printf(" %g",sum[i]);
   printf("\n");
   printf("  Target:");
-  for (i = 0; i <= np; i++) printf(" " BIGINT_FORMAT,target[i]);
+  for (i = 0; i <= np; i++) printf(" %g",target[i]);
   printf("\n");
   printf("  Actual cut:");
   for (i = 0; i <= np; i++)
@@ -1010,13 +1463,13 @@ void Balance::debug_output(int idim, int m, int np, double *split)
   for (i = 0; i <= np; i++) printf(" %g",lo[i]);
   printf("\n");
   printf("  Low-sum:");
-  for (i = 0; i <= np; i++) printf(" " BIGINT_FORMAT,losum[i]);
+  for (i = 0; i <= np; i++) printf(" %g",losum[i]);
   printf("\n");
   printf("  Hi:");
   for (i = 0; i <= np; i++) printf(" %g",hi[i]);
   printf("\n");
   printf("  Hi-sum:");
-  for (i = 0; i <= np; i++) printf(" " BIGINT_FORMAT,hisum[i]);
+  for (i = 0; i <= np; i++) printf(" %g",hisum[i]);
   printf("\n");
   printf("  Delta:");
   for (i = 0; i < np; i++) printf(" %g",split[i+1]-split[i]);
@@ -32,44 +32,75 @@ class Balance : protected Pointers {
   void command(int, char **);
   void dynamic_setup(char *, int, double);
   int dynamic();
+  int bisection();
   double imbalance_nlocal(int &);
+  double imbalance_splits(int &);
   void dumpout(bigint, FILE *);
 
+  int weight_setup(int, char **);
+  void weight_init();
+  int weight_tally();
+  int weight_current();
+  void weight_schedule(bigint);
+  void weight_store();
+  void weight_clear();
+
+  int wtflag;                // 1 if atoms are weighted, set by weight_init()
+
  private:
   int me,nprocs;
 
+  double *wttype;            // weight of each atom type, NULL if not used
+  double wtbonded;           // added weight per bonded term, 0.0 if not used
+  char *id_wtcompute;        // per-atom compute for weights, NULL if not used
+  char *id_wtvariable;       // atom-style variable for weights
+  int iwtcompute,iwtvariable;
+  double *weight;            // per-atom weight, product of all weight styles
+  double *wtvariable;        // values of weight variable
+  int maxweight;
+  double *wtstore;           // weight compute values stored by weight_store()
+  int maxwtstore;
+  bigint wtstore_step;       // timestep they were stored on, -1 if none
+  int wtstore_nlocal;        // nlocal they were stored for
+
   int xflag,yflag,zflag;                            // xyz LB flags
   double *user_xsplit,*user_ysplit,*user_zsplit;    // params for xyz LB
 
   int dflag;                 // dynamic LB flag
+  int rflag;                 // RCB LB flag
+  class RCB *rcb;            // RCB tiling of procs
   int nitermax;              // params for dynamic LB
   double thresh;
   char bstr[4];
 
   int ndim;                  // length of balance string bstr
   int *bdim;                 // XYZ for each character in bstr
-  bigint *count;             // counts for slices in one dim
-  bigint *onecount;          // work vector of counts in one dim
-  bigint *sum;               // cummulative count for slices in one dim
-  bigint *target;            // target sum for slices in one dim
+  double *count;             // weights of slices in one dim
+  double *onecount;          // work vector of weights in one dim
+  double *sum;               // cummulative weight for slices in one dim
+  double *target;            // target sum for slices in one dim
   double *lo,*hi;            // lo/hi split coords that bound each target
-  bigint *losum,*hisum;      // cummulative counts at lo/hi coords
+  double *losum,*hisum;      // cummulative weights at lo/hi coords
   int rho;                   // 0 for geometric recursion
                              // 1 for density weighted recursion
 
   int *proccount;            // particle count per processor
   int *allproccount;
+  double *procweight;        // particle weight per processor
+  double *allprocweight;
 
   int outflag;               // for output of balance results to file
   FILE *fp;
   int firststep;
 
   void static_setup(char *);
-  double imbalance_splits(int &);
+  double *set_weights();
+  void migrate();
   void tally(int, int, double *);
   int adjust(int, double *);
-  void old_adjust(int, int, bigint *, double *);
+  void old_adjust(int, int, double *, double *);
   int binary(double, int, double *);
+  void dumpout_tiles(bigint, FILE *);
   void debug_output(int, int, int, double *);
 };
 
@@ -107,6 +138,45 @@ E: Lost atoms via balance: original %ld current %ld
 
 This should not occur.  Report the problem to the developers.
 
+E: Balance rcb cannot be used with x, y, z, or dynamic
+
+The rcb style replaces the 3d grid of processors, so it cannot be
+combined with styles that adjust cuts in the grid.
+
+E: Illegal balance weight option
+
+The weight keyword of the balance and fix balance commands takes a
+style of type, bonded, compute, or variable, followed by its values.
+
+E: Compute ID for balance weight does not exist
+
+Self-explanatory.
+
+E: Balance weight compute does not calculate a per-atom vector
+
+Self-explanatory.
+
+E: Variable name for balance weight does not exist
+
+Self-explanatory.
+
+E: Balance weight variable is not atom-style variable
+
+Self-explanatory.
+
+E: Balance weight compute is not current
+
+The balance command can only use a per-atom compute that was invoked
+on the current timestep, e.g. by a preceding run that output it.  Fix
+balance uses the values of a compute that tallies per-atom energy or
+virial from the step before each rebalance, atoms must not be added or
+removed in between.
+
+E: Balance weight cannot be negative
+
+A weight from the weight keyword of the balance or fix balance command
+was < 0.0.
+
 E: Balance produced bad splits
 
 This should not occur.  It means two or more cutting plane locations
@@ -0,0 +1,174 @@
+/* ----------------------------------------------------------------------
+   LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+   http://lammps.sandia.gov, Sandia National Laboratories
+   Steve Plimpton, sjplimp@sandia.gov
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+
+   See the README file in the top-level LAMMPS directory.
+------------------------------------------------------------------------- */
+
+/* ----------------------------------------------------------------------
+   threaded variant of bond_style fene
+   each OpenMP thread takes a contiguous chunk of the bond list and
+   accumulates into its own force slab via ThrAccum
+   the chunk is processed in blocks of THR_BLOCK bonds, whose bond vectors
+   and coeffs are packed as SoA so the force math vectorizes
+------------------------------------------------------------------------- */
+
+#include "math.h"
+#include "stdio.h"
+#include "bond_fene_fast.h"
+#include "atom.h"
+#include "neighbor.h"
+#include "update.h"
+#include "force.h"
+#include "error.h"
+
+using namespace LAMMPS_NS;
+
+/* ---------------------------------------------------------------------- */
+
+BondFENEFast::BondFENEFast(LAMMPS *lmp) :
+  BondFENE(lmp), ThrAccum(lmp) {}
+
+/* ---------------------------------------------------------------------- */
+
+void BondFENEFast::compute(int eflag, int vflag)
+{
+  if (eflag || vflag) ev_setup(eflag,vflag);
+  else evflag = 0;
+
+  // threads only flag a bad bond, error is raised by the master thread
+
+  int flag = thr_compute(this,neighbor->nbondlist);
+  if (flag) error->one(FLERR,"Bad FENE bond");
+}
+
+/* ----------------------------------------------------------------------
+   evaluate one block of bonds with the matching instance of eval()
+------------------------------------------------------------------------- */
+
+int BondFENEFast::thr_eval(int nfrom, int nto, ThrAccumData *thr)
+{
+  if (evflag) {
+    if (eflag_either) {
+      if (force->newton_bond) return eval<1,1,1>(nfrom,nto,thr);
+      else return eval<1,1,0>(nfrom,nto,thr);
+    } else {
+      if (force->newton_bond) return eval<1,0,1>(nfrom,nto,thr);
+      else return eval<1,0,0>(nfrom,nto,thr);
+    }
+  } else {
+    if (force->newton_bond) return eval<0,0,1>(nfrom,nto,thr);
+    else return eval<0,0,0>(nfrom,nto,thr);
+  }
+}
+
+/* ---------------------------------------------------------------------- */
+
+template <int EVFLAG, int EFLAG, int NEWTON_BOND>
+int BondFENEFast::eval(int nfrom, int nto, ThrAccumData *thr)
+{
+  int m,i1,i2,type;
+  double delx[THR_BLOCK],dely[THR_BLOCK],delz[THR_BLOCK],rsq[THR_BLOCK];
+  double kb[THR_BLOCK],r0b[THR_BLOCK],epsb[THR_BLOCK],sigb[THR_BLOCK];
+  double fbond[THR_BLOCK],ebond[THR_BLOCK];
+
+  double **x = atom->x;
+  double **f = thr->f;
+  int **bondlist = neighbor->bondlist;
+  int nlocal = atom->nlocal;
+
+  const int nn = nto - nfrom;
+  int flag = 0;
+
+  // pack bond vectors and coeffs of the block
+
+  for (m = 0; m < nn; m++) {
+    i1 = bondlist[nfrom+m][0];
+    i2 = bondlist[nfrom+m][1];
+    type = bondlist[nfrom+m][2];
+
+    delx[m] = x[i1][0] - x[i2][0];
+    dely[m] = x[i1][1] - x[i2][1];
+    delz[m] = x[i1][2] - x[i2][2];
+    rsq[m] = delx[m]*delx[m] + dely[m]*dely[m] + delz[m]*delz[m];
+    kb[m] = k[type];
+    r0b[m] = r0[type];
+    epsb[m] = epsilon[type];
+    sigb[m] = sigma[type];
+  }
+
+  // if r -> r0, then rlogarg < 0.0 which is an error
+  // issue a warning, rlogarg is reset to epsilon below
+  // if r > 2*r0 something serious is wrong, flag it for compute() to abort
+
+  for (m = 0; m < nn; m++) {
+    const double rlogarg = 1.0 - rsq[m]/(r0b[m]*r0b[m]);
+    if (rlogarg < 0.1) {
+      i1 = bondlist[nfrom+m][0];
+      i2 = bondlist[nfrom+m][1];
+      char str[128];
+      sprintf(str,"FENE bond too long: " BIGINT_FORMAT " %d %d %g",
+              update->ntimestep,atom->tag[i1],atom->tag[i2],sqrt(rsq[m]));
+#if defined(_OPENMP)
+#pragma omp critical
+#endif
+      error->warning(FLERR,str,0);
+      if (rlogarg <= -3.0) flag = 1;
+    }
+  }
+
+  // force & energy from log and LJ term, no dependence between bonds
+
+#if defined(_OPENMP) && _OPENMP >= 201307
+#pragma omp simd
+#endif
+  for (m = 0; m < nn; m++) {
+    const double r0sq = r0b[m] * r0b[m];
+    double rlogarg = 1.0 - rsq[m]/r0sq;
+    if (rlogarg < 0.1) rlogarg = 0.1;
+
+    double fb = -kb[m]/rlogarg;
+    double elj = 0.0;
+
+    if (rsq[m] < TWO_1_3*sigb[m]*sigb[m]) {
+      const double sr2 = sigb[m]*sigb[m]/rsq[m];
+      const double sr6 = sr2*sr2*sr2;
+      fb += 48.0*epsb[m]*sr6*(sr6-0.5)/rsq[m];
+      if (EFLAG) elj = 4.0*epsb[m]*sr6*(sr6-1.0) + epsb[m];
+    }
+
+    fbond[m] = fb;
+    if (EFLAG) ebond[m] = -0.5 * kb[m]*r0sq*log(rlogarg) + elj;
+  }
+
+  // apply force to each of 2 atoms
+
+  for (m = 0; m < nn; m++) {
+    i1 = bondlist[nfrom+m][0];
+    i2 = bondlist[nfrom+m][1];
+
+    if (NEWTON_BOND || i1 < nlocal) {
+      f[i1][0] += delx[m]*fbond[m];
+      f[i1][1] += dely[m]*fbond[m];
+      f[i1][2] += delz[m]*fbond[m];
+    }
+
+    if (NEWTON_BOND || i2 < nlocal) {
+      f[i2][0] -= delx[m]*fbond[m];
+      f[i2][1] -= dely[m]*fbond[m];
+      f[i2][2] -= delz[m]*fbond[m];
+    }
+
+    if (EVFLAG) ev_tally_thr(this,thr,i1,i2,nlocal,NEWTON_BOND,
+                             EFLAG ? ebond[m] : 0.0,fbond[m],
+                             delx[m],dely[m],delz[m]);
+  }
+
+  return flag;
+}
@@ -0,0 +1,57 @@
+/* -*- c++ -*- ----------------------------------------------------------
+   LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+   http://lammps.sandia.gov, Sandia National Laboratories
+   Steve Plimpton, sjplimp@sandia.gov
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+
+   See the README file in the top-level LAMMPS directory.
+------------------------------------------------------------------------- */
+
+#ifdef BOND_CLASS
+
+BondStyle(fene/fast,BondFENEFast)
+
+#else
+
+#ifndef LMP_BOND_FENE_FAST_H
+#define LMP_BOND_FENE_FAST_H
+
+#include "bond_fene.h"
+#include "thr_accum.h"
+
+namespace LAMMPS_NS {
+
+class BondFENEFast : public BondFENE, public ThrAccum {
+ public:
+  BondFENEFast(class LAMMPS *);
+  virtual ~BondFENEFast() {}
+  virtual void compute(int, int);
+
+ protected:
+  int thr_eval(int, int, ThrAccumData *);
+  template <int EVFLAG, int EFLAG, int NEWTON_BOND>
+  int eval(int, int, ThrAccumData *);
+};
+
+}
+
+#endif
+#endif
+
+/* ERROR/WARNING messages:
+
+W: FENE bond too long: %ld %d %d %g
+
+A FENE bond has stretched dangerously far.  It's interaction strength
+will be truncated to attempt to prevent the bond from blowing up.
+
+E: Bad FENE bond
+
+Two atoms in a FENE bond have become so far apart that the bond cannot
+be computed.
+
+*/
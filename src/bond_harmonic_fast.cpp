@@ -0,0 +1,133 @@
+/* ----------------------------------------------------------------------
+   LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+   http://lammps.sandia.gov, Sandia National Laboratories
+   Steve Plimpton, sjplimp@sandia.gov
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+
+   See the README file in the top-level LAMMPS directory.
+------------------------------------------------------------------------- */
+
+/* ----------------------------------------------------------------------
+   threaded variant of bond_style harmonic
+   each OpenMP thread takes a contiguous chunk of the bond list and
+   accumulates into its own force slab via ThrAccum
+   the chunk is processed in blocks of THR_BLOCK bonds, whose bond vectors
+   and coeffs are packed as SoA so the force math vectorizes
+------------------------------------------------------------------------- */
+
+#include "math.h"
+#include "bond_harmonic_fast.h"
+#include "atom.h"
+#include "neighbor.h"
+#include "force.h"
+
+using namespace LAMMPS_NS;
+
+/* ---------------------------------------------------------------------- */
+
+BondHarmonicFast::BondHarmonicFast(LAMMPS *lmp) :
+  BondHarmonic(lmp), ThrAccum(lmp) {}
+
+/* ---------------------------------------------------------------------- */
+
+void BondHarmonicFast::compute(int eflag, int vflag)
+{
+  if (eflag || vflag) ev_setup(eflag,vflag);
+  else evflag = 0;
+
+  thr_compute(this,neighbor->nbondlist);
+}
+
+/* ----------------------------------------------------------------------
+   evaluate one block of bonds with the matching instance of eval()
+------------------------------------------------------------------------- */
+
+int BondHarmonicFast::thr_eval(int nfrom, int nto, ThrAccumData *thr)
+{
+  if (evflag) {
+    if (eflag_either) {
+      if (force->newton_bond) eval<1,1,1>(nfrom,nto,thr);
+      else eval<1,1,0>(nfrom,nto,thr);
+    } else {
+      if (force->newton_bond) eval<1,0,1>(nfrom,nto,thr);
+      else eval<1,0,0>(nfrom,nto,thr);
+    }
+  } else {
+    if (force->newton_bond) eval<0,0,1>(nfrom,nto,thr);
+    else eval<0,0,0>(nfrom,nto,thr);
+  }
+  return 0;
+}
+
+/* ---------------------------------------------------------------------- */
+
+template <int EVFLAG, int EFLAG, int NEWTON_BOND>
+void BondHarmonicFast::eval(int nfrom, int nto, ThrAccumData *thr)
+{
+  int m,i1,i2,type;
+  double delx[THR_BLOCK],dely[THR_BLOCK],delz[THR_BLOCK];
+  double kb[THR_BLOCK],r0b[THR_BLOCK],fbond[THR_BLOCK],ebond[THR_BLOCK];
+
+  double **x = atom->x;
+  double **f = thr->f;
+  int **bondlist = neighbor->bondlist;
+  int nlocal = atom->nlocal;
+
+  const int nn = nto - nfrom;
+
+  // pack bond vectors and coeffs of the block
+
+  for (m = 0; m < nn; m++) {
+    i1 = bondlist[nfrom+m][0];
+    i2 = bondlist[nfrom+m][1];
+    type = bondlist[nfrom+m][2];
+
+    delx[m] = x[i1][0] - x[i2][0];
+    dely[m] = x[i1][1] - x[i2][1];
+    delz[m] = x[i1][2] - x[i2][2];
+    kb[m] = k[type];
+    r0b[m] = r0[type];
+  }
+
+  // force & energy, no dependence between bonds
+
+#if defined(_OPENMP) && _OPENMP >= 201307
+#pragma omp simd
+#endif
+  for (m = 0; m < nn; m++) {
+    const double rsq = delx[m]*delx[m] + dely[m]*dely[m] + delz[m]*delz[m];
+    const double r = sqrt(rsq);
+    const double dr = r - r0b[m];
+    const double rk = kb[m] * dr;
+
+    fbond[m] = (r > 0.0) ? -2.0*rk/r : 0.0;
+    if (EFLAG) ebond[m] = rk*dr;
+  }
+
+  // apply force to each of 2 atoms
+
+  for (m = 0; m < nn; m++) {
+    i1 = bondlist[nfrom+m][0];
+    i2 = bondlist[nfrom+m][1];
+
+    if (NEWTON_BOND || i1 < nlocal) {
+      f[i1][0] += delx[m]*fbond[m];
+      f[i1][1] += dely[m]*fbond[m];
+      f[i1][2] += delz[m]*fbond[m];
+    }
+
+    if (NEWTON_BOND || i2 < nlocal) {
+      f[i2][0] -= delx[m]*fbond[m];
+      f[i2][1] -= dely[m]*fbond[m];
+      f[i2][2] -= delz[m]*fbond[m];
+    }
+
+    if (EVFLAG) ev_tally_thr(this,thr,i1,i2,nlocal,NEWTON_BOND,
+                             EFLAG ? ebond[m] : 0.0,fbond[m],
+                             delx[m],dely[m],delz[m]);
+  }
+}
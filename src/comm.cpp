@@ -86,6 +86,29 @@ Comm::Comm(LAMMPS *lmp) : Pointers(lmp)
   cutghostuser = 0.0;
   ghost_velocity = 0;
 
+  overlap = 0;
+  nstart = 0;
+  req_overlap = NULL;
+  buf_overlap_send = buf_overlap_recv = NULL;
+  maxoverlap_send = maxoverlap_recv = maxoverlap_swap = 0;
+
+  persist = 0;
+  npersist = 0;
+  req_forward = req_reverse = NULL;
+  persist_x = persist_f = persist_send = persist_recv = NULL;
+
+  tiled = 0;
+  rcbdim = NULL;
+  rcbcut = NULL;
+  tilelo = tilehi = NULL;
+  tboxlo = tboxhi = NULL;
+  proc2swap = NULL;
+  droplist = NULL;
+  candidate = NULL;
+  maxcandidate = 0;
+  leave = leaveswap = NULL;
+  maxleave = 0;
+
   // use of OpenMP threads
   // query OpenMP for number of threads/process set by user at run-time
   // if the OMP_NUM_THREADS environment variable is not set, we default
@@ -152,6 +175,22 @@ Comm::~Comm()
 
   memory->destroy(grid2proc);
 
+  memory->destroy(rcbdim);
+  memory->destroy(rcbcut);
+  memory->destroy(tilelo);
+  memory->destroy(tilehi);
+  memory->destroy(tboxlo);
+  memory->destroy(tboxhi);
+  memory->destroy(proc2swap);
+  memory->destroy(droplist);
+  memory->destroy(candidate);
+  memory->destroy(leave);
+  memory->destroy(leaveswap);
+
+  persist_free();
+  delete [] req_overlap;
+  memory->destroy(buf_overlap_send);
+  memory->destroy(buf_overlap_recv);
   free_swap();
   if (style == MULTI) {
     free_multi();
@@ -280,6 +319,9 @@ void Comm::set_proc_grid(int outflag)
   delete pmap;
 
   // set xsplit,ysplit,zsplit for uniform spacings
+  // a new grid replaces any RCB tiles
+
+  tiled = 0;
 
   memory->destroy(xsplit);
   memory->destroy(ysplit);
@@ -372,6 +414,9 @@ void Comm::init()
   if (force->newton == 0) maxreverse = 0;
   if (force->pair) maxreverse = MAX(maxreverse,force->pair->comm_reverse_off);
 
+  if (tiled && force->kspace)
+    error->all(FLERR,"Cannot use KSpace with RCB tiled sub-domains");
+
   // memory for multi-style communication
 
   if (style == MULTI && multilo == NULL) {
@@ -444,6 +489,11 @@ void Comm::setup()
     }
   }
 
+  if (tiled) {
+    setup_tiled();
+    return;
+  }
+
   // recvneed[idim][0/1] = # of procs away I recv atoms from, within cutghost
   //   0 = from left, 1 = from right
   //   do not cross non-periodic boundaries, need[2] = 0 for 2d
@@ -630,6 +680,227 @@ void Comm::setup()
   }
 }
 
+/* ----------------------------------------------------------------------
+   setup swaps between RCB tiles, called by setup() once cutghost is set
+   tile I needs ghosts from tile J if J, shifted by a periodic image S
+     of the box, overlaps I extended by cutghost
+   each such I,J,S is an edge, all procs find all edges in the same order
+     by walking the RCB tree, then color them greedily so no proc has
+     2 edges of the same color
+   each color is one swap where procs exchange with their partner in
+     both directions, so per-swap comm loops work as for a 3d grid
+   procs with no edge of a color swap 0 atoms with themselves
+   an edge of a tile with its own periodic image is a one-way self swap
+   all ghosts are owned atoms sent directly, never forwarded ghosts
+------------------------------------------------------------------------- */
+
+void Comm::setup_tiled()
+{
+  int i,j,k,m,d,n,c,ix,iy,iz;
+  double lo[3],hi[3];
+
+  // tile bounds in box coords for orthogonal, lamda coords for triclinic
+  // prd = box length in those coords
+
+  double *boxlo = domain->boxlo;
+  double *boxhi = domain->boxhi;
+  double prd[3];
+
+  for (d = 0; d < 3; d++) {
+    if (triclinic) prd[d] = 1.0;
+    else prd[d] = domain->prd[d];
+  }
+
+  for (i = 0; i < nprocs; i++)
+    for (d = 0; d < 3; d++) {
+      if (triclinic) {
+        tboxlo[i][d] = tilelo[i][d];
+        tboxhi[i][d] = tilehi[i][d];
+      } else {
+        tboxlo[i][d] = boxlo[d] + prd[d]*tilelo[i][d];
+        if (tilehi[i][d] < 1.0) tboxhi[i][d] = boxlo[d] + prd[d]*tilehi[i][d];
+        else tboxhi[i][d] = boxhi[d];
+      }
+    }
+
+  // # of periodic images in each dim that can be within cutghost
+
+  int *periodicity = domain->periodicity;
+  int nimage[3];
+  for (d = 0; d < 3; d++) {
+    if (periodicity[d])
+      nimage[d] = static_cast<int> (cutghost[d]/prd[d]) + 1;
+    else nimage[d] = 0;
+  }
+  if (domain->dimension == 2) nimage[2] = 0;
+
+  // edge = I,J,S with J > I, or J = I and S != 0
+  // ghosts flow J to I with image S and I to J with image -S
+
+  int nedge = 0;
+  int maxedge = 0;
+  int **edge = NULL;
+
+  for (i = 0; i < nprocs; i++)
+    for (iz = -nimage[2]; iz <= nimage[2]; iz++)
+      for (iy = -nimage[1]; iy <= nimage[1]; iy++)
+        for (ix = -nimage[0]; ix <= nimage[0]; ix++) {
+          lo[0] = tboxlo[i][0] - cutghost[0] - ix*prd[0];
+          hi[0] = tboxhi[i][0] + cutghost[0] - ix*prd[0];
+          lo[1] = tboxlo[i][1] - cutghost[1] - iy*prd[1];
+          hi[1] = tboxhi[i][1] + cutghost[1] - iy*prd[1];
+          lo[2] = tboxlo[i][2] - cutghost[2] - iz*prd[2];
+          hi[2] = tboxhi[i][2] + cutghost[2] - iz*prd[2];
+
+          n = 0;
+          tile_drop(0,nprocs,lo,hi,n);
+
+          for (m = 0; m < n; m++) {
+            j = droplist[m];
+            if (j < i || (j == i && ix == 0 && iy == 0 && iz == 0)) continue;
+            if (nedge == maxedge) {
+              maxedge += BUFMIN;
+              memory->grow(edge,maxedge,6,"comm:edge");
+            }
+            edge[nedge][0] = i;
+            edge[nedge][1] = j;
+            edge[nedge][2] = ix;
+            edge[nedge][3] = iy;
+            edge[nedge][4] = iz;
+            nedge++;
+          }
+        }
+
+  // greedy edge coloring, color of each edge is stored in edge[][5]
+  // colors used by proc K are stored at vcolor[first[K]], nused[K] of them
+
+  int *first,*nused,*vcolor,*flag;
+  memory->create(first,nprocs+1,"comm:first");
+  memory->create(nused,nprocs,"comm:nused");
+
+  for (k = 0; k < nprocs; k++) nused[k] = 0;
+  for (m = 0; m < nedge; m++) {
+    nused[edge[m][0]]++;
+    if (edge[m][1] != edge[m][0]) nused[edge[m][1]]++;
+  }
+  int maxdegree = 0;
+  first[0] = 0;
+  for (k = 0; k < nprocs; k++) {
+    maxdegree = MAX(maxdegree,nused[k]);
+    first[k+1] = first[k] + nused[k];
+    nused[k] = 0;
+  }
+
+  memory->create(vcolor,MAX(first[nprocs],1),"comm:vcolor");
+  memory->create(flag,2*maxdegree+1,"comm:flag");
+  for (c = 0; c <= 2*maxdegree; c++) flag[c] = 0;
+
+  int ncolor = 0;
+  for (m = 0; m < nedge; m++) {
+    i = edge[m][0];
+    j = edge[m][1];
+    for (k = 0; k < nused[i]; k++) flag[vcolor[first[i]+k]] = 1;
+    for (k = 0; k < nused[j]; k++) flag[vcolor[first[j]+k]] = 1;
+    for (c = 0; flag[c]; c++);
+    for (k = 0; k < nused[i]; k++) flag[vcolor[first[i]+k]] = 0;
+    for (k = 0; k < nused[j]; k++) flag[vcolor[first[j]+k]] = 0;
+
+    edge[m][5] = c;
+    ncolor = MAX(ncolor,c+1);
+    vcolor[first[i] + nused[i]++] = c;
+    if (j != i) vcolor[first[j] + nused[j]++] = c;
+  }
+
+  memory->destroy(first);
+  memory->destroy(nused);
+  memory->destroy(vcolor);
+  memory->destroy(flag);
+
+  // allocate comm memory, one swap per color
+
+  nswap = ncolor;
+  if (nswap > maxswap) grow_swap(nswap);
+
+  // default swap is with self with an empty send box
+
+  for (int iswap = 0; iswap < nswap; iswap++) {
+    sendproc[iswap] = recvproc[iswap] = me;
+    pbc_flag[iswap] = 0;
+    for (k = 0; k < 6; k++) pbc[iswap][k] = 0;
+    for (d = 0; d < 3; d++) {
+      sendboxlo[iswap][d] = BIG;
+      sendboxhi[iswap][d] = -BIG;
+    }
+  }
+  for (k = 0; k < nprocs; k++) proc2swap[k] = -1;
+
+  // setup my swaps from my edges
+  // send box = receiver's tile shifted by -S, S = image receiver sees me in
+  // proc2swap = 1st swap with each partner, both procs agree on it
+
+  int partner,shift[3];
+
+  for (m = 0; m < nedge; m++) {
+    i = edge[m][0];
+    j = edge[m][1];
+    if (i != me && j != me) continue;
+    c = edge[m][5];
+
+    if (me == j) {
+      partner = i;
+      for (d = 0; d < 3; d++) shift[d] = edge[m][2+d];
+    } else {
+      partner = j;
+      for (d = 0; d < 3; d++) shift[d] = -edge[m][2+d];
+    }
+
+    sendproc[c] = recvproc[c] = partner;
+    for (d = 0; d < 3; d++) {
+      sendboxlo[c][d] = tboxlo[partner][d] - shift[d]*prd[d];
+      sendboxhi[c][d] = tboxhi[partner][d] - shift[d]*prd[d];
+    }
+
+    pbc[c][0] = shift[0];
+    pbc[c][1] = shift[1];
+    pbc[c][2] = shift[2];
+    if (triclinic) {
+      pbc[c][5] = shift[1];
+      pbc[c][4] = pbc[c][3] = shift[2];
+    }
+    if (shift[0] || shift[1] || shift[2]) pbc_flag[c] = 1;
+
+    if (partner != me && (proc2swap[partner] < 0 || c < proc2swap[partner]))
+      proc2swap[partner] = c;
+  }
+
+  memory->destroy(edge);
+}
+
+/* ----------------------------------------------------------------------
+   walk the RCB tree of procs plo to plo+np-1 to find tiles that overlap
+     box lo/hi, in box or lamda coords
+   add each found proc to droplist, n = current length of droplist
+------------------------------------------------------------------------- */
+
+void Comm::tile_drop(int plo, int np, double *lo, double *hi, int &n)
+{
+  if (np == 1) {
+    for (int d = 0; d < 3; d++)
+      if (lo[d] > tboxhi[plo][d] || hi[d] < tboxlo[plo][d]) return;
+    droplist[n++] = plo;
+    return;
+  }
+
+  int mid = plo + np/2;
+  int d = rcbdim[mid];
+  double cut;
+  if (triclinic) cut = rcbcut[mid];
+  else cut = domain->boxlo[d] + domain->prd[d]*rcbcut[mid];
+
+  if (lo[d] <= cut) tile_drop(plo,mid-plo,lo,hi,n);
+  if (hi[d] >= cut) tile_drop(mid,plo+np-mid,lo,hi,n);
+}
+
 /* ----------------------------------------------------------------------
    walk up/down the extent of nearby processors in dim and dir
    loc = myloc of proc to start at
@@ -693,6 +964,14 @@ void Comm::forward_comm(int dummy)
 	double **x = atom->x;
 	double *buf;
 
+	// persistent requests created in borders() for x-only comm
+
+	if (persist && comm_x_only) {
+		forward_comm_persist();
+		if (atom->soaflag) atom->update_soa();
+		return;
+	}
+
 	// exchange data with another proc
 	// if other proc is self, just copy
 	// if comm_x_only set, exchange or copy directly to x, don't unpack
@@ -761,6 +1040,10 @@ void Comm::forward_comm(int dummy)
 			}
 		}
 	}
+
+	// refresh SoA mirror with new owned and ghost coords
+
+	if (atom->soaflag) atom->update_soa();
 }
 
 /* ----------------------------------------------------------------------
@@ -777,6 +1060,13 @@ void Comm::reverse_comm()
   double **f = atom->f;
   double *buf;
 
+  // persistent requests created in borders() for f-only comm
+
+  if (persist && comm_f_only) {
+    reverse_comm_persist();
+    return;
+  }
+
   // exchange data with another proc
   // if other proc is self, just copy
   // if comm_f_only set, exchange or copy directly from f, don't pack
@@ -856,6 +1146,11 @@ void Comm::exchange()
   if (bufextra > bufextra_old)
     memory->grow(buf_send,maxsend+bufextra,"comm:buf_send");
 
+  if (tiled) {
+    exchange_tiled();
+    return;
+  }
+
   // subbox bounds for orthogonal or triclinic
 
   if (triclinic == 0) {
@@ -938,6 +1233,111 @@ void Comm::exchange()
   if (atom->firstgroupname) atom->first_reorder();
 }
 
+/* ----------------------------------------------------------------------
+   exchange for RCB tiles, called by exchange() after map is cleared
+   owner of an atom that left my tile is found by walking the RCB tree
+   atom is sent in the 1st swap with its new owner
+   atoms will be lost if their new owner is not one of my swap partners
+     can happen if atom moves outside of non-periodic bounary
+     or if atom moves further than to a tile within cutghost of mine
+------------------------------------------------------------------------- */
+
+void Comm::exchange_tiled()
+{
+  int i,k,m,d,p,iswap,nsend,nrecv,nlocal;
+  double *sublo,*subhi;
+  MPI_Request request;
+  MPI_Status status;
+  AtomVec *avec = atom->avec;
+
+  if (triclinic == 0) {
+    sublo = domain->sublo;
+    subhi = domain->subhi;
+  } else {
+    sublo = domain->sublo_lamda;
+    subhi = domain->subhi_lamda;
+  }
+
+  // list atoms leaving my tile, using < and >=, and the swap they go in
+  // swap = -1 if atom will be lost, also if it is outside the box
+  //   so that it is lost as it would be with a 3d grid of procs
+
+  double *boxlo,*boxhi;
+  double unitlo[3] = {0.0, 0.0, 0.0};
+  double unithi[3] = {1.0, 1.0, 1.0};
+  if (triclinic == 0) {
+    boxlo = domain->boxlo;
+    boxhi = domain->boxhi;
+  } else {
+    boxlo = unitlo;
+    boxhi = unithi;
+  }
+
+  double **x = atom->x;
+  nlocal = atom->nlocal;
+
+  if (nlocal > maxleave) {
+    maxleave = static_cast<int> (BUFFACTOR * nlocal);
+    memory->destroy(leave);
+    memory->destroy(leaveswap);
+    memory->create(leave,maxleave,"comm:leave");
+    memory->create(leaveswap,maxleave,"comm:leaveswap");
+  }
+
+  int nleave = 0;
+  for (i = 0; i < nlocal; i++) {
+    for (d = 0; d < 3; d++)
+      if (x[i][d] < sublo[d] || x[i][d] >= subhi[d]) break;
+    if (d == 3) continue;
+    for (d = 0; d < 3; d++)
+      if (x[i][d] < boxlo[d] || x[i][d] >= boxhi[d]) break;
+    if (d == 3) {
+      p = coord2tile(x[i],triclinic);
+      if (p == me) continue;
+      leaveswap[nleave] = proc2swap[p];
+    } else leaveswap[nleave] = -1;
+    leave[nleave++] = i;
+  }
+
+  // send leaving atoms to each partner in my 1st swap with it
+  // received atoms are added at end of my atoms, so leave[] stays valid
+
+  for (iswap = 0; iswap < nswap; iswap++) {
+    if (sendproc[iswap] == me || proc2swap[sendproc[iswap]] != iswap)
+      continue;
+
+    nsend = 0;
+    for (k = 0; k < nleave; k++) {
+      if (leaveswap[k] != iswap) continue;
+      if (nsend > maxsend) grow_send(nsend,1);
+      nsend += avec->pack_exchange(leave[k],&buf_send[nsend]);
+    }
+
+    MPI_Sendrecv(&nsend,1,MPI_INT,sendproc[iswap],0,
+                 &nrecv,1,MPI_INT,recvproc[iswap],0,world,&status);
+    if (nrecv > maxrecv) grow_recv(nrecv);
+    if (nrecv) MPI_Irecv(buf_recv,nrecv,MPI_DOUBLE,recvproc[iswap],0,
+                         world,&request);
+    if (nsend) MPI_Send(buf_send,nsend,MPI_DOUBLE,sendproc[iswap],0,world);
+    if (nrecv) MPI_Wait(&request,&status);
+
+    m = 0;
+    while (m < nrecv) m += avec->unpack_exchange(&buf_recv[m]);
+  }
+
+  // delete leaving atoms from last to first
+  // so the atom filling each hole is never one that also left
+
+  nlocal = atom->nlocal;
+  for (k = nleave-1; k >= 0; k--) {
+    avec->copy(nlocal-1,leave[k],1);
+    nlocal--;
+  }
+  atom->nlocal = nlocal;
+
+  if (atom->firstgroupname) atom->first_reorder();
+}
+
 /* ----------------------------------------------------------------------
    borders: list nearby atoms to send to neighboring procs at every timestep
    one list is created for every swap that will be made
@@ -960,6 +1360,11 @@ void Comm::borders()
   MPI_Status status;
   AtomVec *avec = atom->avec;
 
+  if (tiled) {
+    borders_tiled();
+    return;
+  }
+
   // do swaps over all 3 dimensions
 
   iswap = 0;
@@ -1095,6 +1500,13 @@ void Comm::borders()
       }
       // set all pointers & counters
 
+      sendowned[iswap] = 1;
+      for (i = 0; i < nsend; i++)
+        if (sendlist[iswap][i] >= atom->nlocal) {
+          sendowned[iswap] = 0;
+          break;
+        }
+
       smax = MAX(smax,nsend);
       rmax = MAX(rmax,nrecv);
       sendnum[iswap] = nsend;
@@ -1115,11 +1527,460 @@ void Comm::borders()
   max = MAX(maxforward*rmax,maxreverse*smax);
   if (max > maxrecv) grow_recv(max);
 
+  // swap lists and buffers are now fixed until next reneighboring
+
+  if (persist) persist_setup();
+
   // reset global->local map
 
   if (map_style) atom->map_set();
 }
 
+/* ----------------------------------------------------------------------
+   borders for RCB tiles, called by borders()
+   each swap sends my owned atoms within cutghost of the send box
+     that setup_tiled() assigned to it, no ghosts are forwarded
+   only owned atoms within cutghost of a face of my tile are checked
+   for triclinic, atoms must be in lamda coords (0-1) before borders is called
+------------------------------------------------------------------------- */
+
+void Comm::borders_tiled()
+{
+  int i,k,n,d,iswap,nsend,nrecv,smax,rmax;
+  double *sublo,*subhi,*lo,*hi,*cut,*buf;
+  double **x;
+  MPI_Request request;
+  MPI_Status status;
+  AtomVec *avec = atom->avec;
+  int *type = atom->type;
+  int dimension = domain->dimension;
+
+  if (triclinic == 0) {
+    sublo = domain->sublo;
+    subhi = domain->subhi;
+  } else {
+    sublo = domain->sublo_lamda;
+    subhi = domain->subhi_lamda;
+  }
+
+  // candidate atoms, only ones in bordergroup if it is set
+
+  x = atom->x;
+  int nowned = atom->nlocal;
+  if (bordergroup) nowned = atom->nfirst;
+
+  if (nowned > maxcandidate) {
+    maxcandidate = static_cast<int> (BUFFACTOR * nowned);
+    memory->destroy(candidate);
+    memory->create(candidate,maxcandidate,"comm:candidate");
+  }
+
+  int ncandidate = 0;
+  for (i = 0; i < nowned; i++) {
+    for (d = 0; d < dimension; d++)
+      if (x[i][d] < sublo[d] + cutghost[d] ||
+          x[i][d] >= subhi[d] - cutghost[d]) break;
+    if (d < dimension) candidate[ncandidate++] = i;
+  }
+
+  smax = rmax = 0;
+
+  for (iswap = 0; iswap < nswap; iswap++) {
+
+    // find atoms within cutghost of send box using <= and >=
+    // store sent atom indices in list for use in future timesteps
+
+    x = atom->x;
+    lo = sendboxlo[iswap];
+    hi = sendboxhi[iswap];
+    cut = cutghost;
+
+    nsend = 0;
+    for (k = 0; k < ncandidate; k++) {
+      i = candidate[k];
+      if (style == MULTI) cut = cutghostmulti[type[i]];
+      if (x[i][0] >= lo[0]-cut[0] && x[i][0] <= hi[0]+cut[0] &&
+          x[i][1] >= lo[1]-cut[1] && x[i][1] <= hi[1]+cut[1] &&
+          x[i][2] >= lo[2]-cut[2] && x[i][2] <= hi[2]+cut[2]) {
+        if (nsend == maxsendlist[iswap]) grow_list(iswap,nsend);
+        sendlist[iswap][nsend++] = i;
+      }
+    }
+
+    // pack up list of border atoms
+
+    if (nsend*size_border > maxsend) grow_send(nsend*size_border,0);
+    if (ghost_velocity)
+      n = avec->pack_border_vel(nsend,sendlist[iswap],buf_send,
+                                pbc_flag[iswap],pbc[iswap]);
+    else
+      n = avec->pack_border(nsend,sendlist[iswap],buf_send,
+                            pbc_flag[iswap],pbc[iswap]);
+
+    // swap atoms with partner proc, or copy if swapping with self
+
+    if (sendproc[iswap] != me) {
+      MPI_Sendrecv(&nsend,1,MPI_INT,sendproc[iswap],0,
+                   &nrecv,1,MPI_INT,recvproc[iswap],0,world,&status);
+      if (nrecv*size_border > maxrecv) grow_recv(nrecv*size_border);
+      if (nrecv) MPI_Irecv(buf_recv,nrecv*size_border,MPI_DOUBLE,
+                           recvproc[iswap],0,world,&request);
+      if (n) MPI_Send(buf_send,n,MPI_DOUBLE,sendproc[iswap],0,world);
+      if (nrecv) MPI_Wait(&request,&status);
+      buf = buf_recv;
+    } else {
+      nrecv = nsend;
+      buf = buf_send;
+    }
+
+    // unpack buffer
+
+    if (ghost_velocity)
+      avec->unpack_border_vel(nrecv,atom->nlocal+atom->nghost,buf);
+    else
+      avec->unpack_border(nrecv,atom->nlocal+atom->nghost,buf);
+
+    // set all pointers & counters
+
+    sendowned[iswap] = 1;
+    smax = MAX(smax,nsend);
+    rmax = MAX(rmax,nrecv);
+    sendnum[iswap] = nsend;
+    recvnum[iswap] = nrecv;
+    size_forward_recv[iswap] = nrecv*size_forward;
+    size_reverse_send[iswap] = nrecv*size_reverse;
+    size_reverse_recv[iswap] = nsend*size_reverse;
+    firstrecv[iswap] = atom->nlocal + atom->nghost;
+    atom->nghost += nrecv;
+  }
+
+  // insure send/recv buffers are long enough for all forward & reverse comm
+
+  int max = MAX(maxforward*smax,maxreverse*rmax);
+  if (max > maxsend) grow_send(max,0);
+  max = MAX(maxforward*rmax,maxreverse*smax);
+  if (max > maxrecv) grow_recv(max);
+
+  // swap lists and buffers are now fixed until next reneighboring
+
+  if (persist) persist_setup();
+
+  // reset global->local map
+
+  if (map_style) atom->map_set();
+}
+
+/* ----------------------------------------------------------------------
+   first half of forward_comm() for overlapping it with pair compute
+   post recvs of all swaps, each into its own slot of a recv buffer,
+     or directly into ghost x if comm_x_only is set
+   pack and send leading swaps whose send atoms are all owned,
+     later swaps forward ghosts received by earlier ones and must wait
+   caller may then compute with owned coords, but not with ghost coords,
+     until forward_comm_finish()
+------------------------------------------------------------------------- */
+
+void Comm::forward_comm_start()
+{
+  double **x = atom->x;
+
+  int nsendall = 0;
+  int nrecvall = 0;
+  for (int iswap = 0; iswap < nswap; iswap++) {
+    nsendall += sendnum[iswap]*size_forward;
+    if (!comm_x_only) nrecvall += size_forward_recv[iswap];
+  }
+  if (nsendall > maxoverlap_send) {
+    maxoverlap_send = static_cast<int> (BUFFACTOR * nsendall);
+    memory->destroy(buf_overlap_send);
+    memory->create(buf_overlap_send,maxoverlap_send,"comm:buf_overlap_send");
+  }
+  if (nrecvall > maxoverlap_recv) {
+    maxoverlap_recv = static_cast<int> (BUFFACTOR * nrecvall);
+    memory->destroy(buf_overlap_recv);
+    memory->create(buf_overlap_recv,maxoverlap_recv,"comm:buf_overlap_recv");
+  }
+  if (nswap > maxoverlap_swap) {
+    maxoverlap_swap = nswap;
+    delete [] req_overlap;
+    req_overlap = new MPI_Request[2*maxoverlap_swap];
+  }
+
+  // swaps are told apart by tag, so any number can be in flight
+
+  int offset = 0;
+  for (int iswap = 0; iswap < nswap; iswap++) {
+    MPI_Request *req = &req_overlap[2*iswap];
+    req[0] = req[1] = MPI_REQUEST_NULL;
+    if (sendproc[iswap] == me || size_forward_recv[iswap] == 0) continue;
+    double *buf;
+    if (comm_x_only) buf = x[firstrecv[iswap]];
+    else {
+      buf = &buf_overlap_recv[offset];
+      offset += size_forward_recv[iswap];
+    }
+    MPI_Irecv(buf,size_forward_recv[iswap],MPI_DOUBLE,
+              recvproc[iswap],iswap,world,&req[0]);
+  }
+
+  // own coords must be current in SoA mirror for the bulk compute
+
+  offset = 0;
+  for (nstart = 0; nstart < nswap; nstart++) {
+    if (!sendowned[nstart]) break;
+    overlap_send(nstart,&buf_overlap_send[offset]);
+    offset += sendnum[nstart]*size_forward;
+  }
+
+  if (atom->soaflag) atom->update_soa(0,atom->nlocal);
+}
+
+/* ----------------------------------------------------------------------
+   second half of forward_comm(), complete all swaps in order
+   result is the same as forward_comm()
+------------------------------------------------------------------------- */
+
+void Comm::forward_comm_finish()
+{
+  AtomVec *avec = atom->avec;
+
+  int sendoffset = 0;
+  int recvoffset = 0;
+  for (int iswap = 0; iswap < nswap; iswap++) {
+    if (iswap >= nstart) overlap_send(iswap,&buf_overlap_send[sendoffset]);
+    sendoffset += sendnum[iswap]*size_forward;
+    if (sendproc[iswap] == me) continue;
+
+    MPI_Wait(&req_overlap[2*iswap],MPI_STATUS_IGNORE);
+    if (comm_x_only || size_forward_recv[iswap] == 0) continue;
+    double *buf = &buf_overlap_recv[recvoffset];
+    if (ghost_velocity)
+      avec->unpack_comm_vel(recvnum[iswap],firstrecv[iswap],buf);
+    else avec->unpack_comm(recvnum[iswap],firstrecv[iswap],buf);
+    recvoffset += size_forward_recv[iswap];
+  }
+
+  for (int iswap = 0; iswap < nswap; iswap++)
+    MPI_Wait(&req_overlap[2*iswap+1],MPI_STATUS_IGNORE);
+
+  if (atom->soaflag) atom->update_soa(atom->nlocal);
+}
+
+/* ----------------------------------------------------------------------
+   pack one swap into buf and send it, or copy it if other proc is self
+------------------------------------------------------------------------- */
+
+void Comm::overlap_send(int iswap, double *buf)
+{
+  AtomVec *avec = atom->avec;
+  double **x = atom->x;
+  int n;
+
+  if (sendproc[iswap] != me) {
+    if (ghost_velocity)
+      n = avec->pack_comm_vel(sendnum[iswap],sendlist[iswap],
+                              buf,pbc_flag[iswap],pbc[iswap]);
+    else n = avec->pack_comm(sendnum[iswap],sendlist[iswap],
+                             buf,pbc_flag[iswap],pbc[iswap]);
+    if (n) MPI_Isend(buf,n,MPI_DOUBLE,sendproc[iswap],iswap,world,
+                     &req_overlap[2*iswap+1]);
+  } else if (comm_x_only) {
+    if (sendnum[iswap])
+      avec->pack_comm(sendnum[iswap],sendlist[iswap],
+                      x[firstrecv[iswap]],pbc_flag[iswap],pbc[iswap]);
+  } else if (ghost_velocity) {
+    avec->pack_comm_vel(sendnum[iswap],sendlist[iswap],
+                        buf,pbc_flag[iswap],pbc[iswap]);
+    avec->unpack_comm_vel(recvnum[iswap],firstrecv[iswap],buf);
+  } else {
+    avec->pack_comm(sendnum[iswap],sendlist[iswap],
+                    buf,pbc_flag[iswap],pbc[iswap]);
+    avec->unpack_comm(recvnum[iswap],firstrecv[iswap],buf);
+  }
+}
+
+/* ----------------------------------------------------------------------
+   create persistent send/recv requests for each swap with another proc
+   forward: recv directly into ghost x, send from buf_send
+   reverse: recv into buf_recv, send directly from ghost f
+   swaps are done in order, so all sends can share buf_send
+------------------------------------------------------------------------- */
+
+void Comm::persist_setup()
+{
+  persist_free();
+
+  double **x = atom->x;
+  double **f = atom->f;
+
+  npersist = nswap;
+  req_forward = new MPI_Request[2*nswap];
+  req_reverse = new MPI_Request[2*nswap];
+
+  for (int iswap = 0; iswap < nswap; iswap++) {
+    MPI_Request *fwd = &req_forward[2*iswap];
+    MPI_Request *rev = &req_reverse[2*iswap];
+    fwd[0] = fwd[1] = rev[0] = rev[1] = MPI_REQUEST_NULL;
+    if (sendproc[iswap] == me) continue;
+
+    if (comm_x_only) {
+      if (size_forward_recv[iswap])
+        MPI_Recv_init(x[firstrecv[iswap]],size_forward_recv[iswap],MPI_DOUBLE,
+                      recvproc[iswap],0,world,&fwd[0]);
+      if (sendnum[iswap])
+        MPI_Send_init(buf_send,sendnum[iswap]*size_forward,MPI_DOUBLE,
+                      sendproc[iswap],0,world,&fwd[1]);
+    }
+
+    if (comm_f_only) {
+      if (size_reverse_recv[iswap])
+        MPI_Recv_init(buf_recv,size_reverse_recv[iswap],MPI_DOUBLE,
+                      sendproc[iswap],0,world,&rev[0]);
+      if (size_reverse_send[iswap])
+        MPI_Send_init(f[firstrecv[iswap]],size_reverse_send[iswap],MPI_DOUBLE,
+                      recvproc[iswap],0,world,&rev[1]);
+    }
+  }
+
+  persist_x = x ? x[0] : NULL;
+  persist_f = f ? f[0] : NULL;
+  persist_send = buf_send;
+  persist_recv = buf_recv;
+}
+
+/* ---------------------------------------------------------------------- */
+
+void Comm::persist_free()
+{
+  for (int i = 0; i < 2*npersist; i++) {
+    if (req_forward[i] != MPI_REQUEST_NULL) MPI_Request_free(&req_forward[i]);
+    if (req_reverse[i] != MPI_REQUEST_NULL) MPI_Request_free(&req_reverse[i]);
+  }
+  delete [] req_forward;
+  delete [] req_reverse;
+  req_forward = req_reverse = NULL;
+  npersist = 0;
+}
+
+/* ----------------------------------------------------------------------
+   requests are bound to buffer addresses, recreate them if any of
+     x, f, or the comm buffers were reallocated since borders()
+------------------------------------------------------------------------- */
+
+void Comm::persist_check()
+{
+  double *x = atom->x ? atom->x[0] : NULL;
+  double *f = atom->f ? atom->f[0] : NULL;
+  if (npersist != nswap || x != persist_x || f != persist_f ||
+      buf_send != persist_send || buf_recv != persist_recv)
+    persist_setup();
+}
+
+/* ----------------------------------------------------------------------
+   forward comm of x with persistent requests, same result as forward_comm()
+------------------------------------------------------------------------- */
+
+void Comm::forward_comm_persist()
+{
+  persist_check();
+
+  double **x = atom->x;
+
+  for (int iswap = 0; iswap < nswap; iswap++) {
+    if (sendproc[iswap] != me) {
+      MPI_Request *req = &req_forward[2*iswap];
+      if (req[0] != MPI_REQUEST_NULL) MPI_Start(&req[0]);
+      if (req[1] != MPI_REQUEST_NULL) {
+        gather_x(iswap,buf_send);
+        MPI_Start(&req[1]);
+      }
+      MPI_Waitall(2,req,MPI_STATUSES_IGNORE);
+    } else if (sendnum[iswap]) gather_x(iswap,x[firstrecv[iswap]]);
+  }
+}
+
+/* ----------------------------------------------------------------------
+   reverse comm of f with persistent requests, same result as reverse_comm()
+------------------------------------------------------------------------- */
+
+void Comm::reverse_comm_persist()
+{
+  persist_check();
+
+  double **f = atom->f;
+
+  for (int iswap = nswap-1; iswap >= 0; iswap--) {
+    if (sendproc[iswap] != me) {
+      MPI_Request *req = &req_reverse[2*iswap];
+      if (req[0] != MPI_REQUEST_NULL) MPI_Start(&req[0]);
+      if (req[1] != MPI_REQUEST_NULL) MPI_Start(&req[1]);
+      MPI_Waitall(2,req,MPI_STATUSES_IGNORE);
+      if (sendnum[iswap]) scatter_f(iswap,buf_recv);
+    } else if (sendnum[iswap]) scatter_f(iswap,f[firstrecv[iswap]]);
+  }
+}
+
+/* ----------------------------------------------------------------------
+   pack x of send atoms of a swap into buf, with PBC shift
+   same as AtomVec::pack_comm() for styles with comm_x_only set
+   buf never overlaps x of send atoms, so the gather can be vectorized
+------------------------------------------------------------------------- */
+
+void Comm::gather_x(int iswap, double *buf)
+{
+  double dx = 0.0, dy = 0.0, dz = 0.0;
+  if (pbc_flag[iswap]) {
+    int *pbc_one = pbc[iswap];
+    if (domain->triclinic == 0) {
+      dx = pbc_one[0]*domain->xprd;
+      dy = pbc_one[1]*domain->yprd;
+      dz = pbc_one[2]*domain->zprd;
+    } else {
+      dx = pbc_one[0]*domain->xprd + pbc_one[5]*domain->xy +
+        pbc_one[4]*domain->xz;
+      dy = pbc_one[1]*domain->yprd + pbc_one[3]*domain->yz;
+      dz = pbc_one[2]*domain->zprd;
+    }
+  }
+
+  const int n = sendnum[iswap];
+  const int *list = sendlist[iswap];
+  const double *x = atom->x[0];
+
+#if defined(_OPENMP) && _OPENMP >= 201307
+#pragma omp simd
+#endif
+  for (int i = 0; i < n; i++) {
+    const int j = 3*list[i];
+    buf[3*i] = x[j] + dx;
+    buf[3*i+1] = x[j+1] + dy;
+    buf[3*i+2] = x[j+2] + dz;
+  }
+}
+
+/* ----------------------------------------------------------------------
+   sum f in buf into send atoms of a swap
+   same as AtomVec::unpack_reverse() for styles with comm_f_only set
+   atoms in a send list are unique, so the scatter can be vectorized
+------------------------------------------------------------------------- */
+
+void Comm::scatter_f(int iswap, double *buf)
+{
+  const int n = sendnum[iswap];
+  const int *list = sendlist[iswap];
+  double *f = atom->f[0];
+
+#if defined(_OPENMP) && _OPENMP >= 201307
+#pragma omp simd
+#endif
+  for (int i = 0; i < n; i++) {
+    const int j = 3*list[i];
+    f[j] += buf[3*i];
+    f[j+1] += buf[3*i+1];
+    f[j+2] += buf[3*i+2];
+  }
+}
+
 /* ----------------------------------------------------------------------
    forward communication invoked by a Pair
 ------------------------------------------------------------------------- */
@@ -1694,6 +2555,9 @@ void Comm::allocate_swap(int n)
   memory->create(firstrecv,n,"comm:firstrecv");
   memory->create(pbc_flag,n,"comm:pbc_flag");
   memory->create(pbc,n,6,"comm:pbc");
+  memory->create(sendowned,n,"comm:sendowned");
+  memory->create(sendboxlo,n,3,"comm:sendboxlo");
+  memory->create(sendboxhi,n,3,"comm:sendboxhi");
 }
 
 /* ----------------------------------------------------------------------
@@ -1724,6 +2588,9 @@ void Comm::free_swap()
   memory->destroy(firstrecv);
   memory->destroy(pbc_flag);
   memory->destroy(pbc);
+  memory->destroy(sendowned);
+  memory->destroy(sendboxlo);
+  memory->destroy(sendboxhi);
 }
 
 /* ----------------------------------------------------------------------
@@ -1772,8 +2639,24 @@ void Comm::set(int narg, char **arg)
       else if (strcmp(arg[iarg+1],"no") == 0) ghost_velocity = 0;
       else error->all(FLERR,"Illegal communicate command");
       iarg += 2;
+    } else if (strcmp(arg[iarg],"overlap") == 0) {
+      if (iarg+2 > narg) error->all(FLERR,"Illegal communicate command");
+      if (strcmp(arg[iarg+1],"yes") == 0) overlap = 1;
+      else if (strcmp(arg[iarg+1],"no") == 0) overlap = 0;
+      else error->all(FLERR,"Illegal communicate command");
+      iarg += 2;
+    } else if (strcmp(arg[iarg],"persist") == 0) {
+      if (iarg+2 > narg) error->all(FLERR,"Illegal communicate command");
+      if (strcmp(arg[iarg+1],"yes") == 0) persist = 1;
+      else if (strcmp(arg[iarg+1],"no") == 0) persist = 0;
+      else error->all(FLERR,"Illegal communicate command");
+      iarg += 2;
     } else error->all(FLERR,"Illegal communicate command");
   }
+
+  // requests are created at next borders()
+
+  persist_free();
 }
 
 /* ----------------------------------------------------------------------
@@ -1910,6 +2793,74 @@ void Comm::set_processors(int narg, char **arg)
                "Processors part option and grid style are incompatible");
 }
 
+/* ----------------------------------------------------------------------
+   replace 3d grid of procs with RCB tiles, one per proc
+   dim,cut = cut dim and fractional coord of cut that proc I is first above
+   lo,hi = fractional bounds of each proc's tile
+   invoked by balance command and fix balance
+------------------------------------------------------------------------- */
+
+void Comm::set_tiles(int *dim, double *cut, double **lo, double **hi)
+{
+  if (rcbdim == NULL) {
+    memory->create(rcbdim,nprocs,"comm:rcbdim");
+    memory->create(rcbcut,nprocs,"comm:rcbcut");
+    memory->create(tilelo,nprocs,3,"comm:tilelo");
+    memory->create(tilehi,nprocs,3,"comm:tilehi");
+    memory->create(tboxlo,nprocs,3,"comm:tboxlo");
+    memory->create(tboxhi,nprocs,3,"comm:tboxhi");
+    memory->create(proc2swap,nprocs,"comm:proc2swap");
+    memory->create(droplist,nprocs,"comm:droplist");
+  }
+
+  for (int i = 0; i < nprocs; i++) {
+    rcbdim[i] = dim[i];
+    rcbcut[i] = cut[i];
+    for (int d = 0; d < 3; d++) {
+      tilelo[i][d] = lo[i][d];
+      tilehi[i][d] = hi[i][d];
+    }
+  }
+
+  for (int d = 0; d < 3; d++) {
+    mysplit[d][0] = tilelo[me][d];
+    mysplit[d][1] = tilehi[me][d];
+  }
+
+  tiled = 1;
+}
+
+/* ----------------------------------------------------------------------
+   return proc whose RCB tile contains point x
+   x is in lamda coords if lamdaflag is set, else in box coords
+   uses same arithmetic as Domain::set_local_box() so a point is owned
+     by the proc whose sub-domain it is in
+------------------------------------------------------------------------- */
+
+int Comm::coord2tile(double *x, int lamdaflag)
+{
+  double *boxlo = domain->boxlo;
+  double *prd = domain->prd;
+  double cut;
+
+  int plo = 0;
+  int np = nprocs;
+
+  while (np > 1) {
+    int mid = plo + np/2;
+    int d = rcbdim[mid];
+    if (lamdaflag) cut = rcbcut[mid];
+    else cut = boxlo[d] + prd[d]*rcbcut[mid];
+    if (x[d] < cut) np = mid - plo;
+    else {
+      np -= mid - plo;
+      plo = mid;
+    }
+  }
+
+  return plo;
+}
+
 /* ----------------------------------------------------------------------
    return # of bytes of allocated memory
 ------------------------------------------------------------------------- */
@@ -1918,6 +2869,9 @@ bigint Comm::memory_usage()
 {
   bigint bytes = 0;
   bytes += nprocs * sizeof(int);    // grid2proc
+  if (rcbdim) bytes += (bigint) nprocs * (3*sizeof(int) + 13*sizeof(double));
+  bytes += memory->usage(candidate,maxcandidate);
+  bytes += 2*memory->usage(leave,maxleave);
   for (int i = 0; i < nswap; i++)
     bytes += memory->usage(sendlist[i],maxsendlist[i]);
   bytes += memory->usage(buf_send,maxsend+bufextra);
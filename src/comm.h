@@ -39,6 +39,9 @@ class Comm : protected Pointers {
   int maxexchange_atom;             // max contribution to exchange from AtomVec
   int maxexchange_fix;              // max contribution to exchange from Fixes
   int nthreads;                     // OpenMP threads per MPI process
+  int overlap;                      // 1 if pair bulk overlaps forward comm
+  int tiled;                        // 1 = RCB tiles, 0 = 3d grid of bricks
+  double mysplit[3][2];             // fractional (0-1) bounds of my tile
 
   Comm(class LAMMPS *);
   virtual ~Comm();
@@ -62,6 +65,8 @@ class Comm : protected Pointers {
   virtual void forward_comm_dump(class Dump *);    // forward comm from a Dump
   virtual void reverse_comm_dump(class Dump *);    // reverse comm from a Dump
   void forward_comm_array(int, double **);         // forward comm of array
+  void forward_comm_start();                       // split forward_comm()
+  void forward_comm_finish();                      //   to overlap compute
 
   void ring(int, int, void *, int, void (*)(int, char *),   // ring comm
             void *, int self = 1);
@@ -69,6 +74,8 @@ class Comm : protected Pointers {
 
   virtual void set(int, char **);         // set communication style
   void set_processors(int, char **);      // set 3d processor grid attributes
+  void set_tiles(int *, double *, double **, double **); // setup RCB tiles
+  int coord2tile(double *, int);          // which proc's tile owns a point
 
   virtual bigint memory_usage();
 
@@ -122,6 +129,21 @@ class Comm : protected Pointers {
   int maxexchange;                  // max # of datums/atom in exchange comm 
   int bufextra;                     // extra space beyond maxsend in send buffer
 
+  int persist;                      // 1 if x,f comm uses persistent requests
+  int npersist;                     // # of swaps requests were created for
+  MPI_Request *req_forward;         // recv,send request per swap for x
+  MPI_Request *req_reverse;         // recv,send request per swap for f
+  double *persist_x,*persist_f;     // buffers the requests were created with
+  double *persist_send,*persist_recv;
+
+  int *sendowned;                   // 1 if swap only sends owned atoms
+  int nstart;                       // # of swaps sent by forward_comm_start()
+  MPI_Request *req_overlap;         // recv,send request per swap
+  double *buf_overlap_send;         // all sends of split forward comm
+  double *buf_overlap_recv;         // all recvs of split forward comm
+  int maxoverlap_send,maxoverlap_recv;
+  int maxoverlap_swap;
+
   int updown(int, int, int, double, int, double *);
                                             // compare cutoff to procs
   virtual void grow_send(int, int);         // reallocate send buffer
@@ -132,6 +154,32 @@ class Comm : protected Pointers {
   virtual void allocate_multi(int);         // allocate multi arrays
   virtual void free_swap();                 // free swap arrays
   virtual void free_multi();                // free multi arrays
+
+  void persist_setup();                     // create persistent requests
+  void persist_free();                      // free persistent requests
+  void persist_check();                     // recreate if buffers moved
+  void forward_comm_persist();
+  void reverse_comm_persist();
+  void gather_x(int, double *);             // pack x of one swap
+  void scatter_f(int, double *);            // sum f of one swap
+  void overlap_send(int, double *);         // pack and send one swap
+
+  int *rcbdim;                      // cut dim that proc I is first above
+  double *rcbcut;                   // fractional coord of that cut
+  double **tilelo,**tilehi;         // fractional bounds of each proc's tile
+  double **tboxlo,**tboxhi;         // tile bounds in box or lamda coords
+  double **sendboxlo,**sendboxhi;   // region to send atoms from at each swap
+  int *proc2swap;                   // 1st swap with each proc, -1 if none
+  int *candidate;                   // owned atoms near a tile face
+  int maxcandidate;
+  int *leave,*leaveswap;            // atoms leaving my tile and their swap
+  int maxleave;
+  int *droplist;                    // procs whose tiles overlap a box
+
+  void setup_tiled();               // setup swaps between RCB tiles
+  void tile_drop(int, int, double *, double *, int &);
+  void borders_tiled();
+  void exchange_tiled();
 };
 
 }
@@ -203,4 +251,9 @@ E: Processors part option and grid style are incompatible
 
 Cannot use gstyle numa or custom with the part option.
 
+E: Cannot use KSpace with RCB tiled sub-domains
+
+KSpace solvers assume a 3d grid of processors.  Use the balance
+command with its x/y/z/dynamic styles instead of rcb.
+
 */
@@ -177,7 +177,21 @@ void CreateAtoms::command(int narg, char **arg)
     sublo[2] = domain->sublo_lamda[2]; subhi[2] = domain->subhi_lamda[2];
   }
 
-  if (style == BOX || style == REGION) {
+  if ((style == BOX || style == REGION) && comm->tiled) {
+    double (*mysplit)[2] = comm->mysplit;
+    if (domain->xperiodic) {
+      if (mysplit[0][0] == 0.0) sublo[0] -= epsilon[0];
+      if (mysplit[0][1] == 1.0) subhi[0] -= 2.0*epsilon[0];
+    }
+    if (domain->yperiodic) {
+      if (mysplit[1][0] == 0.0) sublo[1] -= epsilon[1];
+      if (mysplit[1][1] == 1.0) subhi[1] -= 2.0*epsilon[1];
+    }
+    if (domain->zperiodic) {
+      if (mysplit[2][0] == 0.0) sublo[2] -= epsilon[2];
+      if (mysplit[2][1] == 1.0) subhi[2] -= 2.0*epsilon[2];
+    }
+  } else if (style == BOX || style == REGION) {
     if (domain->xperiodic) {
       if (comm->myloc[0] == 0) sublo[0] -= epsilon[0];
       if (comm->myloc[0] == comm->procgrid[0]-1) subhi[0] -= 2.0*epsilon[0];
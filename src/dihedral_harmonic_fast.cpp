@@ -0,0 +1,290 @@
+/* ----------------------------------------------------------------------
+   LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+   http://lammps.sandia.gov, Sandia National Laboratories
+   Steve Plimpton, sjplimp@sandia.gov
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+
+   See the README file in the top-level LAMMPS directory.
+------------------------------------------------------------------------- */
+
+/* ----------------------------------------------------------------------
+   threaded variant of dihedral_style harmonic
+   each OpenMP thread takes a contiguous chunk of the dihedral list and
+   accumulates into its own force slab via ThrAccum
+   the chunk is processed in blocks of THR_BLOCK dihedrals, whose bond vectors
+   and coeffs are packed as SoA so the force math vectorizes
+------------------------------------------------------------------------- */
+
+#include "mpi.h"
+#include "math.h"
+#include "stdio.h"
+#include "dihedral_harmonic_fast.h"
+#include "atom.h"
+#include "neighbor.h"
+#include "force.h"
+#include "update.h"
+#include "error.h"
+
+using namespace LAMMPS_NS;
+
+#define TOLERANCE 0.05
+
+/* ---------------------------------------------------------------------- */
+
+DihedralHarmonicFast::DihedralHarmonicFast(LAMMPS *lmp) :
+  DihedralHarmonic(lmp), ThrAccum(lmp) {}
+
+/* ---------------------------------------------------------------------- */
+
+void DihedralHarmonicFast::compute(int eflag, int vflag)
+{
+  if (eflag || vflag) ev_setup(eflag,vflag);
+  else evflag = 0;
+
+  thr_compute(this,neighbor->ndihedrallist);
+}
+
+/* ----------------------------------------------------------------------
+   evaluate one block of dihedrals with the matching instance of eval()
+------------------------------------------------------------------------- */
+
+int DihedralHarmonicFast::thr_eval(int nfrom, int nto, ThrAccumData *thr)
+{
+  if (evflag) {
+    if (eflag_either) {
+      if (force->newton_bond) eval<1,1,1>(nfrom,nto,thr);
+      else eval<1,1,0>(nfrom,nto,thr);
+    } else {
+      if (force->newton_bond) eval<1,0,1>(nfrom,nto,thr);
+      else eval<1,0,0>(nfrom,nto,thr);
+    }
+  } else {
+    if (force->newton_bond) eval<0,0,1>(nfrom,nto,thr);
+    else eval<0,0,0>(nfrom,nto,thr);
+  }
+  return 0;
+}
+
+/* ---------------------------------------------------------------------- */
+
+template <int EVFLAG, int EFLAG, int NEWTON_BOND>
+void DihedralHarmonicFast::eval(int nfrom, int nto, ThrAccumData *thr)
+{
+  int m,i1,i2,i3,i4,type;
+  double f1[3],f2[3],f3[3],f4[3];
+  double vb1x[THR_BLOCK],vb1y[THR_BLOCK],vb1z[THR_BLOCK];
+  double vb2x[THR_BLOCK],vb2y[THR_BLOCK],vb2z[THR_BLOCK];
+  double vb3x[THR_BLOCK],vb3y[THR_BLOCK],vb3z[THR_BLOCK];
+  double kd[THR_BLOCK],cos_shiftd[THR_BLOCK],sin_shiftd[THR_BLOCK];
+  int multd[THR_BLOCK];
+  double cd[THR_BLOCK],edihedral[THR_BLOCK];
+  double f1x[THR_BLOCK],f1y[THR_BLOCK],f1z[THR_BLOCK];
+  double f2x[THR_BLOCK],f2y[THR_BLOCK],f2z[THR_BLOCK];
+  double f3x[THR_BLOCK],f3y[THR_BLOCK],f3z[THR_BLOCK];
+  double f4x[THR_BLOCK],f4y[THR_BLOCK],f4z[THR_BLOCK];
+
+  double **x = atom->x;
+  double **f = thr->f;
+  int **dihedrallist = neighbor->dihedrallist;
+  int nlocal = atom->nlocal;
+
+  const int nn = nto - nfrom;
+
+  // pack bond vectors and coeffs of the block
+
+  for (m = 0; m < nn; m++) {
+    i1 = dihedrallist[nfrom+m][0];
+    i2 = dihedrallist[nfrom+m][1];
+    i3 = dihedrallist[nfrom+m][2];
+    i4 = dihedrallist[nfrom+m][3];
+    type = dihedrallist[nfrom+m][4];
+
+    vb1x[m] = x[i1][0] - x[i2][0];
+    vb1y[m] = x[i1][1] - x[i2][1];
+    vb1z[m] = x[i1][2] - x[i2][2];
+    vb2x[m] = x[i3][0] - x[i2][0];
+    vb2y[m] = x[i3][1] - x[i2][1];
+    vb2z[m] = x[i3][2] - x[i2][2];
+    vb3x[m] = x[i4][0] - x[i3][0];
+    vb3y[m] = x[i4][1] - x[i3][1];
+    vb3z[m] = x[i4][2] - x[i3][2];
+    kd[m] = k[type];
+    cos_shiftd[m] = cos_shift[type];
+    sin_shiftd[m] = sin_shift[type];
+    multd[m] = multiplicity[type];
+  }
+
+  // force & energy, no dependence between dihedrals
+
+#if defined(_OPENMP) && _OPENMP >= 201307
+#pragma omp simd
+#endif
+  for (m = 0; m < nn; m++) {
+    const double vb2xm = -vb2x[m];
+    const double vb2ym = -vb2y[m];
+    const double vb2zm = -vb2z[m];
+
+    // c,s calculation
+
+    const double ax = vb1y[m]*vb2zm - vb1z[m]*vb2ym;
+    const double ay = vb1z[m]*vb2xm - vb1x[m]*vb2zm;
+    const double az = vb1x[m]*vb2ym - vb1y[m]*vb2xm;
+    const double bx = vb3y[m]*vb2zm - vb3z[m]*vb2ym;
+    const double by = vb3z[m]*vb2xm - vb3x[m]*vb2zm;
+    const double bz = vb3x[m]*vb2ym - vb3y[m]*vb2xm;
+
+    const double rasq = ax*ax + ay*ay + az*az;
+    const double rbsq = bx*bx + by*by + bz*bz;
+    const double rgsq = vb2xm*vb2xm + vb2ym*vb2ym + vb2zm*vb2zm;
+    const double rg = sqrt(rgsq);
+
+    double rginv,ra2inv,rb2inv;
+    rginv = ra2inv = rb2inv = 0.0;
+    if (rg > 0) rginv = 1.0/rg;
+    if (rasq > 0) ra2inv = 1.0/rasq;
+    if (rbsq > 0) rb2inv = 1.0/rbsq;
+    const double rabinv = sqrt(ra2inv*rb2inv);
+
+    double c = (ax*bx + ay*by + az*bz)*rabinv;
+    const double s = rg*rabinv*(ax*vb3x[m] + ay*vb3y[m] + az*vb3z[m]);
+
+    // unclamped c is kept for the error check
+
+    cd[m] = c;
+    if (c > 1.0) c = 1.0;
+    if (c < -1.0) c = -1.0;
+
+    const int mult = multd[m];
+    double p = 1.0;
+    double df1 = 0.0;
+    double ddf1 = 0.0;
+
+    for (int i = 0; i < mult; i++) {
+      ddf1 = p*c - df1*s;
+      df1 = p*s + df1*c;
+      p = ddf1;
+    }
+
+    p = p*cos_shiftd[m] + df1*sin_shiftd[m];
+    df1 = df1*cos_shiftd[m] - ddf1*sin_shiftd[m];
+    df1 *= -mult;
+    p += 1.0;
+
+    if (mult == 0) {
+      p = 1.0 + cos_shiftd[m];
+      df1 = 0.0;
+    }
+
+    if (EFLAG) edihedral[m] = kd[m] * p;
+
+    const double fg = vb1x[m]*vb2xm + vb1y[m]*vb2ym + vb1z[m]*vb2zm;
+    const double hg = vb3x[m]*vb2xm + vb3y[m]*vb2ym + vb3z[m]*vb2zm;
+    const double fga = fg*ra2inv*rginv;
+    const double hgb = hg*rb2inv*rginv;
+    const double gaa = -ra2inv*rg;
+    const double gbb = rb2inv*rg;
+
+    const double df = -kd[m] * df1;
+
+    const double sx2 = df*(fga*ax - hgb*bx);
+    const double sy2 = df*(fga*ay - hgb*by);
+    const double sz2 = df*(fga*az - hgb*bz);
+
+    f1x[m] = df*(gaa*ax);
+    f1y[m] = df*(gaa*ay);
+    f1z[m] = df*(gaa*az);
+
+    f2x[m] = sx2 - f1x[m];
+    f2y[m] = sy2 - f1y[m];
+    f2z[m] = sz2 - f1z[m];
+
+    f4x[m] = df*(gbb*bx);
+    f4y[m] = df*(gbb*by);
+    f4z[m] = df*(gbb*bz);
+
+    f3x[m] = -sx2 - f4x[m];
+    f3y[m] = -sy2 - f4y[m];
+    f3z[m] = -sz2 - f4z[m];
+  }
+
+  // error check
+
+  for (m = 0; m < nn; m++) {
+    if (cd[m] > 1.0 + TOLERANCE || cd[m] < (-1.0 - TOLERANCE)) {
+      i1 = dihedrallist[nfrom+m][0];
+      i2 = dihedrallist[nfrom+m][1];
+      i3 = dihedrallist[nfrom+m][2];
+      i4 = dihedrallist[nfrom+m][3];
+#if defined(_OPENMP)
+#pragma omp critical
+#endif
+      {
+        int me;
+        MPI_Comm_rank(world,&me);
+        if (screen) {
+          char str[128];
+          sprintf(str,"Dihedral problem: %d " BIGINT_FORMAT " %d %d %d %d",
+                  me,update->ntimestep,
+                  atom->tag[i1],atom->tag[i2],atom->tag[i3],atom->tag[i4]);
+          error->warning(FLERR,str,0);
+          fprintf(screen,"  1st atom: %d %g %g %g\n",
+                  me,x[i1][0],x[i1][1],x[i1][2]);
+          fprintf(screen,"  2nd atom: %d %g %g %g\n",
+                  me,x[i2][0],x[i2][1],x[i2][2]);
+          fprintf(screen,"  3rd atom: %d %g %g %g\n",
+                  me,x[i3][0],x[i3][1],x[i3][2]);
+          fprintf(screen,"  4th atom: %d %g %g %g\n",
+                  me,x[i4][0],x[i4][1],x[i4][2]);
+        }
+      }
+    }
+  }
+
+  // apply force to each of 4 atoms
+
+  for (m = 0; m < nn; m++) {
+    i1 = dihedrallist[nfrom+m][0];
+    i2 = dihedrallist[nfrom+m][1];
+    i3 = dihedrallist[nfrom+m][2];
+    i4 = dihedrallist[nfrom+m][3];
+
+    f1[0] = f1x[m]; f1[1] = f1y[m]; f1[2] = f1z[m];
+    f2[0] = f2x[m]; f2[1] = f2y[m]; f2[2] = f2z[m];
+    f3[0] = f3x[m]; f3[1] = f3y[m]; f3[2] = f3z[m];
+    f4[0] = f4x[m]; f4[1] = f4y[m]; f4[2] = f4z[m];
+
+    if (NEWTON_BOND || i1 < nlocal) {
+      f[i1][0] += f1[0];
+      f[i1][1] += f1[1];
+      f[i1][2] += f1[2];
+    }
+
+    if (NEWTON_BOND || i2 < nlocal) {
+      f[i2][0] += f2[0];
+      f[i2][1] += f2[1];
+      f[i2][2] += f2[2];
+    }
+
+    if (NEWTON_BOND || i3 < nlocal) {
+      f[i3][0] += f3[0];
+      f[i3][1] += f3[1];
+      f[i3][2] += f3[2];
+    }
+
+    if (NEWTON_BOND || i4 < nlocal) {
+      f[i4][0] += f4[0];
+      f[i4][1] += f4[1];
+      f[i4][2] += f4[2];
+    }
+
+    if (EVFLAG)
+      ev_tally_thr(this,thr,i1,i2,i3,i4,nlocal,NEWTON_BOND,
+                   EFLAG ? edihedral[m] : 0.0,f1,f3,f4,
+                   vb1x[m],vb1y[m],vb1z[m],vb2x[m],vb2y[m],vb2z[m],
+                   vb3x[m],vb3y[m],vb3z[m]);
+  }
+}
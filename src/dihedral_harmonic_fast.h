@@ -0,0 +1,52 @@
+/* -*- c++ -*- ----------------------------------------------------------
+   LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+   http://lammps.sandia.gov, Sandia National Laboratories
+   Steve Plimpton, sjplimp@sandia.gov
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+
+   See the README file in the top-level LAMMPS directory.
+------------------------------------------------------------------------- */
+
+#ifdef DIHEDRAL_CLASS
+
+DihedralStyle(harmonic/fast,DihedralHarmonicFast)
+
+#else
+
+#ifndef LMP_DIHEDRAL_HARMONIC_FAST_H
+#define LMP_DIHEDRAL_HARMONIC_FAST_H
+
+#include "dihedral_harmonic.h"
+#include "thr_accum.h"
+
+namespace LAMMPS_NS {
+
+class DihedralHarmonicFast : public DihedralHarmonic, public ThrAccum {
+ public:
+  DihedralHarmonicFast(class LAMMPS *);
+  virtual ~DihedralHarmonicFast() {}
+  virtual void compute(int, int);
+
+ protected:
+  int thr_eval(int, int, ThrAccumData *);
+  template <int EVFLAG, int EFLAG, int NEWTON_BOND>
+  void eval(int, int, ThrAccumData *);
+};
+
+}
+
+#endif
+#endif
+
+/* ERROR/WARNING messages:
+
+W: Dihedral problem: %d %ld %d %d %d %d
+
+Conformation of the 4 listed dihedral atoms is extreme; you may want
+to check your simulation geometry.
+
+*/
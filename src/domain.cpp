@@ -243,6 +243,14 @@ void Domain::set_global_box()
 
 void Domain::set_lamda_box()
 {
+  if (comm->tiled) {
+    for (int d = 0; d < 3; d++) {
+      sublo_lamda[d] = comm->mysplit[d][0];
+      subhi_lamda[d] = comm->mysplit[d][1];
+    }
+    return;
+  }
+
   int *myloc = comm->myloc;
   double *xsplit = comm->xsplit;
   double *ysplit = comm->ysplit;
@@ -261,7 +269,8 @@ void Domain::set_lamda_box()
 /* ----------------------------------------------------------------------
    set local subbox params for orthogonal boxes
    assumes global box is defined and proc assignment has been made
-   uses comm->xyz_split to define subbox boundaries in consistent manner
+   uses comm->xyz_split or RCB tile to define subbox boundaries
+     in consistent manner
    insure subhi[max] = boxhi
 ------------------------------------------------------------------------- */
 
@@ -273,7 +282,15 @@ void Domain::set_local_box()
   double *ysplit = comm->ysplit;
   double *zsplit = comm->zsplit;
 
-  if (triclinic == 0) {
+  if (triclinic == 0 && comm->tiled) {
+    double (*mysplit)[2] = comm->mysplit;
+    for (int d = 0; d < 3; d++) {
+      sublo[d] = boxlo[d] + prd[d]*mysplit[d][0];
+      if (mysplit[d][1] < 1.0) subhi[d] = boxlo[d] + prd[d]*mysplit[d][1];
+      else subhi[d] = boxhi[d];
+    }
+
+  } else if (triclinic == 0) {
     sublo[0] = boxlo[0] + xprd*xsplit[myloc[0]];
     if (myloc[0] < procgrid[0]-1)
       subhi[0] = boxlo[0] + xprd*xsplit[myloc[0]+1];
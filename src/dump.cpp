@@ -19,6 +19,7 @@
 #include "dump.h"
 #include "atom.h"
 #include "irregular.h"
+#include "async_writer.h"
 #include "update.h"
 #include "domain.h"
 #include "group.h"
@@ -36,6 +37,10 @@ Dump *Dump::dumpptr;
 #define BIG 1.0e20
 #define IBIG 2147483647
 #define EPSILON 1.0e-6
+#define NSAMPLE 64          // values per proc that pick sample sort splitters
+#define RADIXBITS 11        // bits per radix sort digit
+#define RADIX (1 << RADIXBITS)
+#define NPASS 6             // digits per 64-bit key
 
 enum{ASCEND,DESCEND};
 
@@ -72,11 +77,20 @@ Dump::Dump(LAMMPS *lmp, int narg, char **arg) : Pointers(lmp)
   sort_flag = 0;
   append_flag = 0;
   padflag = 0;
+  async_flag = 0;
+  async_allow = 1;
 
   maxbuf = maxids = maxsort = maxproc = 0;
   buf = bufsort = NULL;
   ids = idsort = index = proclist = NULL;
   irregular = NULL;
+  maxradix = 0;
+  radixbuf = NULL;
+
+  writer = NULL;
+  maxbufasync = 0;
+  bufasync = NULL;
+  asynclines = NULL;
 
   // parse filename for special syntax
   // if contains '%', write one file per proc and replace % with proc-ID
@@ -124,6 +138,13 @@ Dump::Dump(LAMMPS *lmp, int narg, char **arg) : Pointers(lmp)
 
 Dump::~Dump()
 {
+  // derived styles must call drain() before freeing what write_data() uses,
+  // Output does so before deleting a dump
+
+  delete writer;
+  memory->destroy(bufasync);
+  memory->destroy(asynclines);
+
   delete [] id;
   delete [] style;
   delete [] filename;
@@ -139,6 +160,7 @@ Dump::~Dump()
   memory->destroy(idsort);
   memory->destroy(index);
   memory->destroy(proclist);
+  memory->sfree(radixbuf);
   delete irregular;
 
   if (multiproc) MPI_Comm_free(&clustercomm);
@@ -158,19 +180,34 @@ Dump::~Dump()
 
 void Dump::init()
 {
+  drain();
+
   init_style();
 
+  if (async_flag) {
+    if (!async_allow)
+      error->all(FLERR,"Dump style does not support dump_modify async");
+    if (filewriter) {
+      if (writer == NULL) writer = new AsyncWriter(lmp,1);
+      memory->destroy(asynclines);
+      memory->create(asynclines,nclusterprocs,"dump:asynclines");
+    }
+  }
+
   if (!sort_flag) {
     memory->destroy(bufsort);
     memory->destroy(ids);
     memory->destroy(idsort);
     memory->destroy(index);
     memory->destroy(proclist);
+    memory->sfree(radixbuf);
     delete irregular;
 
     maxids = maxsort = maxproc = 0;
+    maxradix = 0;
     bufsort = NULL;
     ids = idsort = index = proclist = NULL;
+    radixbuf = NULL;
     irregular = NULL;
   }
 
@@ -252,6 +289,11 @@ int Dump::count()
 
 void Dump::write()
 {
+  // with async output, wait until writer is done with previous snapshot
+  // before fp or anything write_data() uses is touched again
+
+  if (async_flag) drain();
+
   // if file per timestep, open new file
 
   if (multifile) openfile();
@@ -332,6 +374,35 @@ void Dump::write()
   MPI_Status status;
   MPI_Request request;
 
+  // async: gather my cluster into bufasync and let writer thread format it,
+  //   writer also flushes and closes fp
+
+  if (filewriter && async_flag) {
+    bigint nasync = 0;
+    for (int iproc = 0; iproc < nclusterprocs; iproc++) {
+      if (nasync + (bigint) maxbuf*size_one > MAXSMALLINT)
+        error->one(FLERR,"Too much buffered info for async dump");
+      if (nasync + maxbuf*size_one > maxbufasync) {
+        maxbufasync = nasync + maxbuf*size_one;
+        memory->grow(bufasync,maxbufasync,"dump:bufasync");
+      }
+      if (iproc) {
+	MPI_Irecv(&bufasync[nasync],maxbuf*size_one,MPI_DOUBLE,
+                  me+iproc,0,world,&request);
+	MPI_Send(&tmp,0,MPI_INT,me+iproc,0,world);
+	MPI_Wait(&request,&status);
+	MPI_Get_count(&status,MPI_DOUBLE,&nlines);
+      } else {
+        nlines = nme*size_one;
+        memcpy(bufasync,buf,nlines*sizeof(double));
+      }
+      asynclines[iproc] = nlines/size_one;
+      nasync += nlines;
+    }
+    writer->submit(&Dump::write_async,this);
+    return;
+  }
+
   if (filewriter) {
     for (int iproc = 0; iproc < nclusterprocs; iproc++) {
       if (iproc) {
@@ -344,7 +415,7 @@ void Dump::write()
       
       write_data(nlines,buf);
     }
-    if (flush_flag) fflush(fp);
+    if (flush_flag && fp) fflush(fp);
     
   } else {
     MPI_Recv(&tmp,0,MPI_INT,fileproc,0,world,&status);
@@ -352,8 +423,9 @@ void Dump::write()
   }
 
   // if file per timestep, close file if I am filewriter
+  // fp is NULL if a derived class handed the file to a writer thread
 
-  if (multifile) {
+  if (multifile && fp) {
     if (compressed) {
       if (filewriter) pclose(fp);
     } else {
@@ -362,6 +434,36 @@ void Dump::write()
   }
 }
 
+/* ----------------------------------------------------------------------
+   write a snapshot gathered by write(), runs on the writer thread
+------------------------------------------------------------------------- */
+
+void Dump::write_async(void *ptr)
+{
+  Dump *dump = (Dump *) ptr;
+
+  double *mybuf = dump->bufasync;
+  for (int iproc = 0; iproc < dump->nclusterprocs; iproc++) {
+    dump->write_data(dump->asynclines[iproc],mybuf);
+    mybuf += (bigint) dump->asynclines[iproc] * dump->size_one;
+  }
+  if (dump->flush_flag) fflush(dump->fp);
+
+  if (dump->multifile) {
+    if (dump->compressed) pclose(dump->fp);
+    else fclose(dump->fp);
+  }
+}
+
+/* ----------------------------------------------------------------------
+   wait for the writer thread to finish all pending snapshots
+------------------------------------------------------------------------- */
+
+void Dump::drain()
+{
+  if (writer) writer->drain();
+}
+
 /* ----------------------------------------------------------------------
    generic opening of a dump file
    ASCII or binary or gzipped
@@ -489,24 +591,54 @@ void Dump::sort()
         proclist[i] = iproc;
       }
 
+    // sample sort on a column: splitters are evenly spaced values of
+    //   a sorted sample from every proc, so skewed distributions still
+    //   give each proc a similar share
+    // procs hold ascending value ranges, reversed for DESCEND so that
+    //   gathering procs in order keeps the global order
+
     } else {
-      double min = BIG;
-      double max = -BIG;
-      for (i = 0; i < nme; i++) {
-        value = buf[i*size_one + sortcolm1];
-        min = MIN(min,value);
-        max = MAX(max,value);
+      int nsample = MIN(nme,NSAMPLE);
+      double sample[NSAMPLE];
+      for (i = 0; i < nsample; i++)
+        sample[i] = buf[((bigint) i*nme/nsample)*size_one + sortcolm1];
+
+      int *recvcounts,*displs;
+      memory->create(recvcounts,nprocs,"dump:recvcounts");
+      memory->create(displs,nprocs,"dump:displs");
+      MPI_Allgather(&nsample,1,MPI_INT,recvcounts,1,MPI_INT,world);
+      int nall = 0;
+      for (iproc = 0; iproc < nprocs; iproc++) {
+        displs[iproc] = nall;
+        nall += recvcounts[iproc];
       }
-      double minall,maxall;
-      MPI_Allreduce(&min,&minall,1,MPI_DOUBLE,MPI_MIN,world);
-      MPI_Allreduce(&max,&maxall,1,MPI_DOUBLE,MPI_MAX,world);
-      double range = maxall-minall + EPSILON*(maxall-minall);
-      if (range == 0.0) range = EPSILON;
+
+      double *allsample,*splitter;
+      memory->create(allsample,MAX(nall,1),"dump:allsample");
+      memory->create(splitter,nprocs,"dump:splitter");
+      MPI_Allgatherv(sample,nsample,MPI_DOUBLE,allsample,recvcounts,displs,
+                     MPI_DOUBLE,world);
+      qsort(allsample,nall,sizeof(double),compare_double);
+      for (iproc = 1; iproc < nprocs; iproc++)
+        splitter[iproc-1] = allsample[(bigint) iproc*nall/nprocs];
+
       for (i = 0; i < nme; i++) {
         value = buf[i*size_one + sortcolm1];
-        iproc = static_cast<int> ((value-minall)/range * nprocs);
-        proclist[i] = iproc;
+        int lo = 0;
+        int hi = nprocs-1;
+        while (lo < hi) {
+          int mid = (lo+hi) / 2;
+          if (value < splitter[mid]) hi = mid;
+          else lo = mid+1;
+        }
+        if (sortorder == DESCEND) lo = nprocs-1 - lo;
+        proclist[i] = lo;
       }
+
+      memory->destroy(recvcounts);
+      memory->destroy(displs);
+      memory->destroy(allsample);
+      memory->destroy(splitter);
     }
 
     // create comm plan, grow recv bufs if necessary,
@@ -536,7 +668,7 @@ void Dump::sort()
 
   // if reorder flag is set & total/per-proc counts match pre-computed values,
   // then create index directly from idsort
-  // else quicksort of index using IDs or buf column as comparator
+  // else radix sort of index on IDs or on buf column mapped to ordered keys
 
   if (reorderflag) {
     if (ntotal != ntotal_reorder) reorderflag = 0;
@@ -552,11 +684,32 @@ void Dump::sort()
   }
 
   if (!reorderflag) {
-    dumpptr = this;
-    for (i = 0; i < nme; i++) index[i] = i;
-    if (sortcol == 0) qsort(index,nme,sizeof(int),idcompare);
-    else if (sortorder == ASCEND) qsort(index,nme,sizeof(int),bufcompare);
-    else qsort(index,nme,sizeof(int),bufcompare_reverse);
+    bigint nbytes = (bigint) nme * (2*sizeof(uint64_t) + sizeof(int));
+    if (nbytes > maxradix) {
+      maxradix = nbytes;
+      radixbuf = (char *)
+        memory->srealloc(radixbuf,maxradix,"dump:radixbuf");
+    }
+    uint64_t *key = (uint64_t *) radixbuf;
+
+    // IDs are non-negative, doubles map to keys with the same order
+    // by flipping all bits of negatives and the sign bit of positives
+
+    if (sortcol == 0) {
+      for (i = 0; i < nme; i++) key[i] = idsort[i];
+    } else {
+      uint64_t signbit = ((uint64_t) 1) << 63;
+      uint64_t flip = (sortorder == DESCEND) ? ~((uint64_t) 0) : 0;
+      for (i = 0; i < nme; i++) {
+        uint64_t u;
+        memcpy(&u,&bufsort[i*size_one + sortcolm1],sizeof(uint64_t));
+        if (u & signbit) u = ~u;
+        else u |= signbit;
+        key[i] = u ^ flip;
+      }
+    }
+
+    radix_sort(nme,key);
   }
 
   // reset buf size and maxbuf to largest of any post-sort nme values
@@ -574,67 +727,80 @@ void Dump::sort()
   // copy data from bufsort to buf using index
 
   int nbytes = size_one*sizeof(double);
+#if defined(_OPENMP)
+#pragma omp parallel for default(shared) schedule(static)
+#endif
   for (i = 0; i < nme; i++)
     memcpy(&buf[i*size_one],&bufsort[index[i]*size_one],nbytes);
 }
 
 /* ----------------------------------------------------------------------
-   compare two atom IDs
-   called via qsort() in sort() method
-   is a static method so access data via dumpptr
+   stable LSD radix sort of index[0..n) by key, key is overwritten
+   radixbuf holds key, a second key array and a second index array
+   digits on which all keys agree are skipped, so small IDs need few passes
 ------------------------------------------------------------------------- */
 
-int Dump::idcompare(const void *pi, const void *pj)
+void Dump::radix_sort(int n, uint64_t *key)
 {
-  int *idsort = dumpptr->idsort;
+  int i,pass,digit;
+  uint64_t *keytmp = key + n;
+  int *ilist = index;
+  int *itmp = (int *) (keytmp + n);
+
+  for (i = 0; i < n; i++) ilist[i] = i;
+  if (n < 2) return;
+
+  // one read of the keys builds the histograms of all digits
+
+  int (*count)[RADIX] = new int[NPASS][RADIX];
+  memset(&count[0][0],0,NPASS*RADIX*sizeof(int));
+  for (i = 0; i < n; i++) {
+    uint64_t k = key[i];
+    for (pass = 0; pass < NPASS; pass++)
+      count[pass][(k >> (pass*RADIXBITS)) & (RADIX-1)]++;
+  }
 
-  int i = *((int *) pi);
-  int j = *((int *) pj);
+  for (pass = 0; pass < NPASS; pass++) {
+    int shift = pass*RADIXBITS;
+    int *offset = count[pass];
+    if (offset[(key[0] >> shift) & (RADIX-1)] == n) continue;
 
-  if (idsort[i] < idsort[j]) return -1;
-  if (idsort[i] > idsort[j]) return 1;
-  return 0;
-}
-
-/* ----------------------------------------------------------------------
-   compare two buffer values with size_one stride
-   called via qsort() in sort() method
-   is a static method so access data via dumpptr
-   sort in ASCENDing order
-------------------------------------------------------------------------- */
+    int sum = 0;
+    for (digit = 0; digit < RADIX; digit++) {
+      int m = offset[digit];
+      offset[digit] = sum;
+      sum += m;
+    }
 
-int Dump::bufcompare(const void *pi, const void *pj)
-{
-  double *bufsort = dumpptr->bufsort;
-  int size_one = dumpptr->size_one;
-  int sortcolm1 = dumpptr->sortcolm1;
+    for (i = 0; i < n; i++) {
+      int j = offset[(key[i] >> shift) & (RADIX-1)]++;
+      keytmp[j] = key[i];
+      itmp[j] = ilist[i];
+    }
 
-  int i = *((int *) pi)*size_one + sortcolm1;
-  int j = *((int *) pj)*size_one + sortcolm1;
+    uint64_t *kswap = key;
+    key = keytmp;
+    keytmp = kswap;
+    int *iswap = ilist;
+    ilist = itmp;
+    itmp = iswap;
+  }
 
-  if (bufsort[i] < bufsort[j]) return -1;
-  if (bufsort[i] > bufsort[j]) return 1;
-  return 0;
+  if (ilist != index) memcpy(index,ilist,n*sizeof(int));
+  delete [] count;
 }
 
 /* ----------------------------------------------------------------------
-   compare two buffer values with size_one stride
-   called via qsort() in sort() method
-   is a static method so access data via dumpptr
-   sort in DESCENDing order
+   compare two doubles, called via qsort() on the sample sort sample
 ------------------------------------------------------------------------- */
 
-int Dump::bufcompare_reverse(const void *pi, const void *pj)
+int Dump::compare_double(const void *pi, const void *pj)
 {
-  double *bufsort = dumpptr->bufsort;
-  int size_one = dumpptr->size_one;
-  int sortcolm1 = dumpptr->sortcolm1;
-
-  int i = *((int *) pi)*size_one + sortcolm1;
-  int j = *((int *) pj)*size_one + sortcolm1;
+  double vi = *((double *) pi);
+  double vj = *((double *) pj);
 
-  if (bufsort[i] > bufsort[j]) return -1;
-  if (bufsort[i] < bufsort[j]) return 1;
+  if (vi < vj) return -1;
+  if (vi > vj) return 1;
   return 0;
 }
 
@@ -647,6 +813,8 @@ void Dump::modify_params(int narg, char **arg)
 {
   if (narg == 0) error->all(FLERR,"Illegal dump_modify command");
 
+  drain();
+
   int iarg = 0;
   while (iarg < narg) {
     if (strcmp(arg[iarg],"append") == 0) {
@@ -655,6 +823,12 @@ void Dump::modify_params(int narg, char **arg)
       else if (strcmp(arg[iarg+1],"no") == 0) append_flag = 0;
       else error->all(FLERR,"Illegal dump_modify command");
       iarg += 2;
+    } else if (strcmp(arg[iarg],"async") == 0) {
+      if (iarg+2 > narg) error->all(FLERR,"Illegal dump_modify command");
+      if (strcmp(arg[iarg+1],"yes") == 0) async_flag = 1;
+      else if (strcmp(arg[iarg+1],"no") == 0) async_flag = 0;
+      else error->all(FLERR,"Illegal dump_modify command");
+      iarg += 2;
     } else if (strcmp(arg[iarg],"every") == 0) {
       if (iarg+2 > narg) error->all(FLERR,"Illegal dump_modify command");
       int idump;
@@ -798,12 +972,14 @@ void Dump::modify_params(int narg, char **arg)
 bigint Dump::memory_usage()
 {
   bigint bytes = memory->usage(buf,size_one*maxbuf);
+  bytes += memory->usage(bufasync,maxbufasync);
   if (sort_flag) {
     if (sortcol == 0) bytes += memory->usage(ids,maxids);
     bytes += memory->usage(bufsort,size_one*maxsort);
     if (sortcol == 0) bytes += memory->usage(idsort,maxsort);
     bytes += memory->usage(index,maxsort);
     bytes += memory->usage(proclist,maxproc);
+    bytes += maxradix;
     if (irregular) bytes += irregular->memory_usage();
   }
   return bytes;
@@ -47,6 +47,7 @@ class Dump : protected Pointers {
   virtual void unpack_reverse_comm(int, int *, double *) {}
 
   void modify_params(int, char **);
+  void drain();
   virtual bigint memory_usage();
 
  protected:
@@ -74,6 +75,8 @@ class Dump : protected Pointers {
   int sortcol;               // 0 to sort on ID, 1-N on columns
   int sortcolm1;             // sortcol - 1
   int sortorder;             // ASCEND or DESCEND
+  int async_flag;            // 1 if write_data() runs on a writer thread
+  int async_allow;           // 1 if style's write_data() is safe for that
 
   char boundstr[9];          // encoding of boundary flags
   char *format_default;      // default format string
@@ -103,9 +106,16 @@ class Dump : protected Pointers {
   int *ids;                  // list of atom IDs, if sorting on IDs
   double *bufsort;
   int *idsort,*index,*proclist;
+  bigint maxradix;           // size of radixbuf in bytes
+  char *radixbuf;            // radix sort keys and scratch
 
   class Irregular *irregular;
 
+  class AsyncWriter *writer;  // background writer, only on filewriter procs
+  int maxbufasync;           // size of bufasync
+  double *bufasync;          // snapshot of my cluster handed to writer
+  int *asynclines;           // # of lines from each cluster proc in bufasync
+
   virtual void init_style() = 0;
   virtual void openfile();
   virtual int modify_param(int, char **) {return 0;}
@@ -115,9 +125,9 @@ class Dump : protected Pointers {
   virtual void write_data(int, double *) = 0;
 
   void sort();
-  static int idcompare(const void *, const void *);
-  static int bufcompare(const void *, const void *);
-  static int bufcompare_reverse(const void *, const void *);
+  void radix_sort(int, uint64_t *);
+  static int compare_double(const void *, const void *);
+  static void write_async(void *);
 };
 
 }
@@ -138,6 +148,16 @@ E: Dump sort column is invalid
 
 Self-explanatory.
 
+E: Dump style does not support dump_modify async
+
+The style either writes its own output or needs simulation state while
+formatting a snapshot.
+
+E: Too much buffered info for async dump
+
+A snapshot written by one proc is too large to buffer for the writer
+thread.
+
 E: Too many atoms to dump sort
 
 Cannot sort when running with more than 2^31 atoms.
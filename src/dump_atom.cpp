@@ -13,6 +13,7 @@
 
 #include "string.h"
 #include "dump_atom.h"
+#include "text_format.h"
 #include "domain.h"
 #include "atom.h"
 #include "update.h"
@@ -30,6 +31,14 @@ DumpAtom::DumpAtom(LAMMPS *lmp, int narg, char **arg) : Dump(lmp, narg, arg)
   scale_flag = 1;
   image_flag = 0;
   format_default = NULL;
+  textformat = NULL;
+}
+
+/* ---------------------------------------------------------------------- */
+
+DumpAtom::~DumpAtom()
+{
+  delete textformat;
 }
 
 /* ---------------------------------------------------------------------- */
@@ -57,6 +66,21 @@ void DumpAtom::init_style()
     strcat(format,"\n");
   }
 
+  // default format is converted by TextFormat, user format by fprintf()
+
+  if (binary || format_user) {
+    delete textformat;
+    textformat = NULL;
+  } else {
+    int coltype[8] = {TextFormat::INT,TextFormat::INT,TextFormat::DOUBLE,
+                      TextFormat::DOUBLE,TextFormat::DOUBLE,TextFormat::INT,
+                      TextFormat::INT,TextFormat::INT};
+    const char *colformat[8] = {"%d ","%d ","%g ","%g ","%g","%d ","%d ","%d"};
+    if (image_flag == 1) colformat[4] = "%g ";
+    if (textformat == NULL) textformat = new TextFormat(lmp);
+    textformat->setup(size_one,coltype,(char **) colformat,NULL);
+  }
+
   // setup boundary string
 
   domain->boundary_string(boundstr);
@@ -97,6 +121,7 @@ void DumpAtom::init_style()
     pack_choice = &DumpAtom::pack_noscale_image;
 
   if (binary) write_choice = &DumpAtom::write_binary;
+  else if (textformat) write_choice = &DumpAtom::write_text;
   else if (image_flag == 0) write_choice = &DumpAtom::write_noimage;
   else if (image_flag == 1) write_choice = &DumpAtom::write_image;
 
@@ -423,3 +448,10 @@ void DumpAtom::write_noimage(int n, double *mybuf)
     m += size_one;
   }
 }
+
+/* ---------------------------------------------------------------------- */
+
+void DumpAtom::write_text(int n, double *mybuf)
+{
+  textformat->write(fp,n,mybuf);
+}
@@ -27,12 +27,14 @@ namespace LAMMPS_NS {
 class DumpAtom : public Dump {
  public:
   DumpAtom(LAMMPS *, int, char**);
+  ~DumpAtom();
 
  private:
   int scale_flag;            // 1 if atom coords are scaled, 0 if no
   int image_flag;            // 1 if append box count to atom coords, 0 if no
 
   char *columns;             // column labels
+  class TextFormat *textformat;  // default text format, NULL if format_user
 
   void init_style();
   int modify_param(int, char **);
@@ -61,6 +63,7 @@ class DumpAtom : public Dump {
   void write_binary(int, double *);
   void write_image(int, double *);
   void write_noimage(int, double *);
+  void write_text(int, double *);
 };
 
 }
@@ -62,6 +62,10 @@ DumpCFG::DumpCFG(LAMMPS *lmp, int narg, char **arg) :
   rbuf = NULL;
   nchosen = nlines = 0;
 
+  // write_data() reads per-atom masses from Atom
+
+  async_allow = 0;
+
   // setup auxiliary property name strings
   // convert 'X_ID[m]' (X=c,f,v) to 'ID_m'
 
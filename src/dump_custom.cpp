@@ -15,6 +15,7 @@
 #include "stdlib.h"
 #include "string.h"
 #include "dump_custom.h"
+#include "text_format.h"
 #include "atom.h"
 #include "force.h"
 #include "domain.h"
@@ -115,6 +116,7 @@ DumpCustom::DumpCustom(LAMMPS *lmp, int narg, char **arg) :
   // setup format strings
 
   vformat = new char*[size_one];
+  textformat = NULL;
 
   format_default = new char[3*size_one+1];
   format_default[0] = '\0';
@@ -177,6 +179,7 @@ DumpCustom::~DumpCustom()
 
   for (int i = 0; i < size_one; i++) delete [] vformat[i];
   delete [] vformat;
+  delete textformat;
 
   delete [] columns;
 }
@@ -217,6 +220,20 @@ void DumpCustom::init_style()
     vformat[i] = strcat(vformat[i]," ");
   }
 
+  // text output formats whole rows, mapped to TextFormat column types
+
+  if (!binary) {
+    if (textformat == NULL) textformat = new TextFormat(lmp);
+    int *coltype = new int[size_one];
+    for (int i = 0; i < size_one; i++) {
+      if (vtype[i] == INT) coltype[i] = TextFormat::INT;
+      else if (vtype[i] == DOUBLE) coltype[i] = TextFormat::DOUBLE;
+      else coltype[i] = TextFormat::STRING;
+    }
+    textformat->setup(size_one,coltype,vformat,typenames);
+    delete [] coltype;
+  }
+
   // setup boundary string
 
   domain->boundary_string(boundstr);
@@ -922,19 +939,7 @@ void DumpCustom::write_binary(int n, double *mybuf)
 
 void DumpCustom::write_text(int n, double *mybuf)
 {
-  int i,j;
-
-  int m = 0;
-  for (i = 0; i < n; i++) {
-    for (j = 0; j < size_one; j++) {
-      if (vtype[j] == INT) fprintf(fp,vformat[j],static_cast<int> (mybuf[m]));
-      else if (vtype[j] == DOUBLE) fprintf(fp,vformat[j],mybuf[m]);
-      else if (vtype[j] == STRING)
-        fprintf(fp,vformat[j],typenames[(int) mybuf[m]]);
-      m++;
-    }
-    fprintf(fp,"\n");
-  }
+  textformat->write(fp,n,mybuf);
 }
 
 /* ---------------------------------------------------------------------- */
@@ -40,6 +40,7 @@ class DumpCustom : public Dump {
 
   int *vtype;                // type of each vector (INT, DOUBLE)
   char **vformat;            // format string for each vector element
+  class TextFormat *textformat;  // converts packed rows to text
 
   char *columns;             // column labels
 
@@ -65,6 +65,10 @@ DumpDCD::DumpDCD(LAMMPS *lmp, int narg, char **arg) : Dump(lmp, narg, arg)
   unwrap_flag = 0;
   format_default = NULL;
 
+  // write_frame() needs the current timestep
+
+  async_allow = 0;
+
   // allocate global array for atom coords
 
   bigint n = group->count(igroup);
@@ -50,6 +50,7 @@ DumpImage::DumpImage(LAMMPS *lmp, int narg, char **arg) :
   // force binary flag on to avoid corrupted output on Windows
 
   binary = 1;
+  async_allow = 0;
 
   // set filetype based on filename suffix
 
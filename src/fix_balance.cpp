@@ -21,6 +21,7 @@
 #include "comm.h"
 #include "irregular.h"
 #include "force.h"
+#include "modify.h"
 #include "kspace.h"
 #include "error.h"
 
@@ -32,7 +33,7 @@ using namespace FixConst;
 FixBalance::FixBalance(LAMMPS *lmp, int narg, char **arg) :
   Fix(lmp, narg, arg)
 {
-  if (narg < 7) error->all(FLERR,"Illegal fix balance command");
+  if (narg < 6) error->all(FLERR,"Illegal fix balance command");
 
   box_change_domain = 1;
   scalar_flag = 1;
@@ -43,47 +44,67 @@ FixBalance::FixBalance(LAMMPS *lmp, int narg, char **arg) :
   global_freq = 1;
 
   // parse arguments
+  // rcb style has no balance string or iteration count
 
   int dimension = domain->dimension;
 
   nevery = force->inumeric(FLERR,arg[3]);
-  if (strlen(arg[4]) > 3) error->all(FLERR,"Illegal fix balance command");
-  strcpy(bstr,arg[4]);
-  nitermax = force->inumeric(FLERR,arg[5]);
-  thresh = force->numeric(FLERR,arg[6]);
+
+  int iarg;
+  if (strcmp(arg[4],"rcb") == 0) {
+    rcbflag = 1;
+    nitermax = 1;
+    thresh = force->numeric(FLERR,arg[5]);
+    iarg = 6;
+  } else {
+    if (narg < 7) error->all(FLERR,"Illegal fix balance command");
+    rcbflag = 0;
+    if (strlen(arg[4]) > 3) error->all(FLERR,"Illegal fix balance command");
+    strcpy(bstr,arg[4]);
+    nitermax = force->inumeric(FLERR,arg[5]);
+    thresh = force->numeric(FLERR,arg[6]);
+    iarg = 7;
+  }
 
   if (nevery < 0 || nitermax <= 0 || thresh < 1.0)
     error->all(FLERR,"Illegal fix balance command");
 
-  for (int i = 0; i < strlen(bstr); i++) {
-    if (bstr[i] != 'x' && bstr[i] != 'y' && bstr[i] != 'z')
-      error->all(FLERR,"Fix balance string is invalid");
-    if (bstr[i] == 'z' && dimension == 2)
-      error->all(FLERR,"Fix balance string is invalid for 2d simulation");
-    for (int j = i+1; j < strlen(bstr); j++)
-      if (bstr[i] == bstr[j])
+  if (!rcbflag)
+    for (int i = 0; i < strlen(bstr); i++) {
+      if (bstr[i] != 'x' && bstr[i] != 'y' && bstr[i] != 'z')
         error->all(FLERR,"Fix balance string is invalid");
-  }
+      if (bstr[i] == 'z' && dimension == 2)
+        error->all(FLERR,"Fix balance string is invalid for 2d simulation");
+      for (int j = i+1; j < strlen(bstr); j++)
+        if (bstr[i] == bstr[j])
+          error->all(FLERR,"Fix balance string is invalid");
+    }
+
+  // create instance of Balance class
+  // optional weight args are stored in it
+
+  balance = new Balance(lmp);
 
   // optional args
 
   int outarg = 0;
   fp = NULL;
 
-  int iarg = 7;
   while (iarg < narg) {
     if (strcmp(arg[iarg],"out") == 0) {
       if (iarg+2 > narg) error->all(FLERR,"Illegal fix balance command");
       outarg = iarg+1;
       iarg += 2;
+    } else if (strcmp(arg[iarg],"weight") == 0) {
+      iarg++;
+      iarg += balance->weight_setup(narg-iarg,&arg[iarg]);
     } else error->all(FLERR,"Illegal fix balance command");
   }
 
-  // create instance of Balance class and initialize it with params
+  // initialize Balance with params
   // create instance of Irregular class
 
-  balance = new Balance(lmp);
-  balance->dynamic_setup(bstr,nitermax,thresh);
+  if (!rcbflag) balance->dynamic_setup(bstr,nitermax,thresh);
   irregular = new Irregular(lmp);
 
   // output file
@@ -98,6 +119,7 @@ FixBalance::FixBalance(LAMMPS *lmp, int narg, char **arg) :
   if (nevery) force_reneighbor = 1;
 
   // compute initial outputs
+  // weights are not yet set up, so this is an atom count imbalance
 
   imbfinal = imbprev = balance->imbalance_nlocal(maxperproc);
   itercount = 0;
@@ -120,6 +142,7 @@ int FixBalance::setmask()
   int mask = 0;
   mask |= PRE_EXCHANGE;
   mask |= PRE_NEIGHBOR;
+  mask |= END_OF_STEP;
   return mask;
 }
 
@@ -129,6 +152,14 @@ void FixBalance::init()
 {
   if (force->kspace) kspace_flag = 1;
   else kspace_flag = 0;
+
+  balance->weight_init();
+
+  // a tallying weight compute must be scheduled for the step before
+  //   a rebalance, which is unknown if rebalancing on reneighbor steps
+
+  if (nevery == 0 && balance->weight_tally())
+    error->all(FLERR,"Fix balance weight compute requires Nevery > 0");
 }
 
 /* ---------------------------------------------------------------------- */
@@ -137,8 +168,10 @@ void FixBalance::setup(int vflag)
 {
   // compute final imbalance factor if setup_pre_exchange() invoked balancer
   // this is called at end of run setup, before output
+  // store weights now if the next rebalance is on the next step
 
   pre_neighbor();
+  end_of_step();
 }
 
 /* ---------------------------------------------------------------------- */
@@ -154,13 +187,25 @@ void FixBalance::setup_pre_exchange()
   if (domain->triclinic) domain->lamda2x(atom->nlocal);
 
   // perform a rebalance if threshhold exceeded
+  // skip it if values of a weight compute are not available at setup,
+  //   i.e. it tallies and was not invoked on this step
 
-  imbnow = balance->imbalance_nlocal(maxperproc);
-  if (imbnow > thresh) rebalance();
+  modify->clearstep_compute();
+  if (balance->weight_current()) {
+    imbnow = balance->imbalance_nlocal(maxperproc);
+    if (imbnow > thresh) rebalance();
+  }
+  balance->weight_clear();
 
   // next_reneighbor = next time to force reneighboring
+  // a weight compute tallies on the step before it, see end_of_step()
+  //   if that is this step, it must be scheduled before setup forces
 
-  if (nevery) next_reneighbor = (update->ntimestep/nevery)*nevery + nevery;
+  if (nevery) {
+    next_reneighbor = (update->ntimestep/nevery)*nevery + nevery;
+    if (next_reneighbor-1 == update->ntimestep)
+      balance->weight_schedule(update->ntimestep);
+  }
 }
 
 /* ----------------------------------------------------------------------
@@ -182,20 +227,37 @@ void FixBalance::pre_exchange()
   if (domain->triclinic) domain->lamda2x(atom->nlocal);
 
   // return if imbalance < threshhold
+  // a weight compute has been stored on the step before, or is invoked now
 
+  modify->clearstep_compute();
   imbnow = balance->imbalance_nlocal(maxperproc);
-  if (imbnow <= thresh) {
-    if (nevery) next_reneighbor = (update->ntimestep/nevery)*nevery + nevery;
-    return;
-  }
-
-  rebalance();
+  if (imbnow > thresh) rebalance();
+  balance->weight_clear();
 
   // next timestep to rebalance
 
   if (nevery) next_reneighbor = (update->ntimestep/nevery)*nevery + nevery;
 }
 
+/* ----------------------------------------------------------------------
+   store values of a weight compute on the step before a rebalance,
+     after the force computation has tallied them
+   schedule the compute one step ahead, since ev_set() of a step
+     is called before its pre_exchange()
+   rebalance steps are multiples of nevery
+------------------------------------------------------------------------- */
+
+void FixBalance::end_of_step()
+{
+  if (!nevery) return;
+  bigint ntimestep = update->ntimestep;
+  if ((ntimestep+1) % nevery == 0) {
+    modify->clearstep_compute();
+    balance->weight_store();
+  }
+  if ((ntimestep+2) % nevery == 0) balance->weight_schedule(ntimestep+1);
+}
+
 /* ----------------------------------------------------------------------
    compute final imbalance factor based on nlocal after comm->exchange()
    only do this if rebalancing just occured
@@ -215,7 +277,11 @@ void FixBalance::pre_neighbor()
 void FixBalance::rebalance()
 {
   imbprev = imbnow;
-  itercount = balance->dynamic();
+  if (rcbflag) itercount = balance->bisection();
+  else {
+    comm->tiled = 0;
+    itercount = balance->dynamic();
+  }
 
   // output of final result
 
@@ -223,13 +289,22 @@ void FixBalance::rebalance()
 
   // reset comm->uniform flag
 
-  comm->uniform = 0;
+  if (!rcbflag) comm->uniform = 0;
 
   // reset proc sub-domains
 
   if (domain->triclinic) domain->set_lamda_box();
   domain->set_local_box();
 
+  // weights are only valid for current owners of atoms,
+  //   so weighted final imbalance factor is computed from new sub-domains
+
+  if (balance->wtflag) {
+    domain->x2lamda(atom->nlocal);
+    imbfinal = balance->imbalance_splits(maxperproc);
+    domain->lamda2x(atom->nlocal);
+  }
+
   // if splits moved further than neighboring processor
   // move atoms to new processors via irregular()
   // only needed if migrate_check() says an atom moves to far,
@@ -246,7 +321,8 @@ void FixBalance::rebalance()
   // pending triggers pre_neighbor() to compute final imbalance factor
   // can only be done after atoms migrate in caller's comm->exchange()
 
-  pending = 1;
+  if (balance->wtflag) pending = 0;
+  else pending = 1;
 }
 
 /* ----------------------------------------------------------------------
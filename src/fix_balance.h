@@ -35,12 +35,14 @@ class FixBalance : public Fix {
   void setup_pre_exchange();
   void pre_exchange();
   void pre_neighbor();
+  void end_of_step();
   double compute_scalar();
   double compute_vector(int);
   double memory_usage();
 
  private:
   int nevery,nitermax;
+  int rcbflag;                  // 1 for RCB tiles, 0 for xyz splits
   char bstr[3];
   double thresh;
   FILE *fp;
@@ -84,4 +86,10 @@ E: Cannot open fix balance output file
 
 Self-explanatory.
 
+E: Fix balance weight compute requires Nevery > 0
+
+A compute that tallies per-atom energy or virial must be scheduled for
+the step before each rebalance, which is not known in advance when
+balancing on reneighboring steps only.
+
 */
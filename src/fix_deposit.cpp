@@ -323,16 +323,25 @@ void FixDeposit::pre_exchange()
       newcoord = lamda;
     } else newcoord = coord;
 
+    int ztop,ytop;                // 1 if my sub-box is at top of box in z,y
+    if (comm->tiled) {
+      ztop = comm->mysplit[2][1] == 1.0;
+      ytop = comm->mysplit[1][1] == 1.0;
+    } else {
+      ztop = comm->myloc[2] == comm->procgrid[2]-1;
+      ytop = comm->myloc[1] == comm->procgrid[1]-1;
+    }
+
     flag = 0;
     if (newcoord[0] >= sublo[0] && newcoord[0] < subhi[0] &&
         newcoord[1] >= sublo[1] && newcoord[1] < subhi[1] &&
         newcoord[2] >= sublo[2] && newcoord[2] < subhi[2]) flag = 1;
     else if (domain->dimension == 3 && newcoord[2] >= domain->boxhi[2] &&
-             comm->myloc[2] == comm->procgrid[2]-1 &&
+             ztop &&
              newcoord[0] >= sublo[0] && newcoord[0] < subhi[0] &&
              newcoord[1] >= sublo[1] && newcoord[1] < subhi[1]) flag = 1;
     else if (domain->dimension == 2 && newcoord[1] >= domain->boxhi[1] &&
-             comm->myloc[1] == comm->procgrid[1]-1 &&
+             ytop &&
              newcoord[0] >= sublo[0] && newcoord[0] < subhi[0]) flag = 1;
 
     if (flag) {
@@ -283,7 +283,7 @@ void FixShake::init()
 
   int count = 0;
   for (i = 0; i < modify->nfix; i++)
-    if (strcmp(modify->fix[i]->style,"shake") == 0) count++;
+    if (strncmp(modify->fix[i]->style,"shake",5) == 0) count++;
   if (count > 1) error->all(FLERR,"More than one fix shake");
 
   // cannot use with minimization since SHAKE turns off bonds
@@ -300,7 +300,7 @@ void FixShake::init()
   }
   if (i < modify->nfix) {
     for (int j = i; j < modify->nfix; j++)
-      if (strcmp(modify->fix[j]->style,"shake") == 0)
+      if (strncmp(modify->fix[j]->style,"shake",5) == 0)
         error->all(FLERR,"Shake fix must come before NPT/NPH fix");
   }
 
@@ -48,7 +48,7 @@ class FixShake : public Fix {
   int dof(int);
   void reset_dt();
 
- private:
+ protected:
   int me,nprocs;
   double tolerance;                      // SHAKE tolerance
   int max_iter;                          // max # of SHAKE iterations
@@ -0,0 +1,755 @@
+/* ----------------------------------------------------------------------
+   LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+   http://lammps.sandia.gov, Sandia National Laboratories
+   Steve Plimpton, sjplimp@sandia.gov
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+
+   See the README file in the top-level LAMMPS directory.
+------------------------------------------------------------------------- */
+
+/* ----------------------------------------------------------------------
+   batched variant of fix shake
+   the cluster list is sorted by kind of cluster and solved in blocks of
+     BLOCK clusters of one kind, constraint vectors, masses and matrix
+     coeffs of a block are packed as SoA so the solve vectorizes
+   all kinds use the matrix iteration of shake3/shake4/shake3angle,
+     2-atom clusters the exact quadratic solution of shake
+   clusters share no atoms, so OpenMP threads take whole blocks
+     and add constraint forces without conflicts
+   optional keyword: fixed N = N iterations for all clusters, no
+     convergence test, else iterate until all clusters of a block converge
+------------------------------------------------------------------------- */
+
+#include "mpi.h"
+#include "math.h"
+#include "string.h"
+#include "fix_shake_fast.h"
+#include "atom.h"
+#include "update.h"
+#include "domain.h"
+#include "force.h"
+#include "comm.h"
+#include "memory.h"
+#include "error.h"
+
+using namespace LAMMPS_NS;
+
+#define BLOCK 64
+#define BIG 1.0e20
+
+enum{BOND2,BOND3,BOND4,ANGLE3,NKIND};
+
+// atoms in each kind of cluster, central atom is 0
+// constraint K of a cluster is between atoms ca[K] and cb[K]
+
+static const int natoms_kind[NKIND] = {2,3,4,3};
+static const int ncons_kind[NKIND] = {1,2,3,3};
+static const int ca_kind[NKIND][3] = {{0,0,0},{0,0,0},{0,0,0},{0,0,1}};
+static const int cb_kind[NKIND][3] = {{1,0,0},{1,2,0},{1,2,3},{1,2,2}};
+
+// SoA data of a block, index of a cluster in the block is last
+
+struct FixShakeFast::Block {
+  int n;                        // # of clusters in block
+  int iatom[4][BLOCK];          // local atom indices
+  double im[4][BLOCK];          // inverse masses
+  double r[3][3][BLOCK];        // constraint vecs, with PBC
+  double s[3][3][BLOCK];        // constraint vecs after unconstrained update
+  double rhs[3][BLOCK];         // rhs of lamda equations w/out quad terms
+  double a[9][BLOCK];           // matrix of lamda equations, then inverse
+  double q[18][BLOCK];          // quadratic correction coeffs
+  double lamda[3][BLOCK];
+};
+
+static inline double dot(const double v[3][BLOCK], const double w[3][BLOCK],
+                         int m)
+{
+  return v[0][m]*w[0][m] + v[1][m]*w[1][m] + v[2][m]*w[2][m];
+}
+
+/* ---------------------------------------------------------------------- */
+
+FixShakeFast::FixShakeFast(LAMMPS *lmp, int narg, char **arg) :
+  FixShake(lmp, trim_args(narg,arg), arg)
+{
+  niter_fixed = 0;
+
+  int iarg = trim_args(narg,arg);
+  if (iarg < narg) {
+    if (iarg+2 != narg) error->all(FLERR,"Illegal fix shake/fast command");
+    niter_fixed = force->inumeric(FLERR,arg[iarg+1]);
+    if (niter_fixed <= 0) error->all(FLERR,"Illegal fix shake/fast command");
+  }
+
+  for (int k = 0; k <= NKIND; k++) kindfirst[k] = 0;
+  maxsort = 0;
+  sortlist = NULL;
+}
+
+/* ---------------------------------------------------------------------- */
+
+FixShakeFast::~FixShakeFast()
+{
+  memory->destroy(sortlist);
+}
+
+/* ----------------------------------------------------------------------
+   # of args that are parsed by FixShake, fixed keyword must come last
+------------------------------------------------------------------------- */
+
+int FixShakeFast::trim_args(int narg, char **arg)
+{
+  for (int i = 6; i < narg; i++)
+    if (strcmp(arg[i],"fixed") == 0) return i;
+  return narg;
+}
+
+/* ----------------------------------------------------------------------
+   build list of SHAKE clusters as in FixShake, then sort it by kind
+   clusters of kind K are list[kindfirst[K]] to list[kindfirst[K+1]-1]
+------------------------------------------------------------------------- */
+
+void FixShakeFast::pre_neighbor()
+{
+  FixShake::pre_neighbor();
+
+  if (maxlist > maxsort) {
+    maxsort = maxlist;
+    memory->destroy(sortlist);
+    memory->create(sortlist,maxsort,"shake:sortlist");
+  }
+
+  int i,k;
+  int next[NKIND];
+
+  for (k = 0; k <= NKIND; k++) kindfirst[k] = 0;
+  for (i = 0; i < nlist; i++) {
+    k = (shake_flag[list[i]] == 1) ? ANGLE3 : shake_flag[list[i]] - 2;
+    kindfirst[k+1]++;
+  }
+  for (k = 0; k < NKIND; k++) {
+    kindfirst[k+1] += kindfirst[k];
+    next[k] = kindfirst[k];
+  }
+
+  for (i = 0; i < nlist; i++) {
+    k = (shake_flag[list[i]] == 1) ? ANGLE3 : shake_flag[list[i]] - 2;
+    sortlist[next[k]++] = list[i];
+  }
+  memcpy(list,sortlist,nlist*sizeof(int));
+}
+
+/* ----------------------------------------------------------------------
+   compute the force adjustment for SHAKE constraint
+------------------------------------------------------------------------- */
+
+void FixShakeFast::post_force(int vflag)
+{
+  if (update->ntimestep == next_output) stats();
+
+  // xshake = unconstrained move with current v,f
+  // communicate results if necessary
+
+  unconstrained_update();
+  if (nprocs > 1) comm->forward_comm_fix(this);
+
+  // virial setup
+
+  if (vflag) v_setup(vflag);
+  else evflag = 0;
+
+  shake_blocks();
+}
+
+/* ----------------------------------------------------------------------
+   enforce SHAKE constraints from rRESPA, same steps as FixShake
+------------------------------------------------------------------------- */
+
+void FixShakeFast::post_force_respa(int vflag, int ilevel, int iloop)
+{
+  if (ilevel == nlevels_respa-1 && update->ntimestep == next_output) stats();
+
+  unconstrained_update_respa(ilevel);
+  if (nprocs > 1) comm->forward_comm_fix(this);
+
+  if (ilevel == 0 && iloop == loop_respa[ilevel]-1 && vflag) v_setup(vflag);
+  if (iloop == loop_respa[ilevel]-1) evflag = 1;
+  else evflag = 0;
+
+  shake_blocks();
+}
+
+/* ----------------------------------------------------------------------
+   loop over blocks of clusters of all kinds to add constraint forces
+   blocks of kind K are blockfirst[K] to blockfirst[K+1]-1
+------------------------------------------------------------------------- */
+
+void FixShakeFast::shake_blocks()
+{
+  int blockfirst[NKIND+1];
+  blockfirst[0] = 0;
+  for (int k = 0; k < NKIND; k++)
+    blockfirst[k+1] = blockfirst[k] +
+      (kindfirst[k+1]-kindfirst[k] + BLOCK-1)/BLOCK;
+  const int nblock = blockfirst[NKIND];
+
+  int nneg = 0;
+  int nzero = 0;
+  double v0 = 0.0, v1 = 0.0, v2 = 0.0, v3 = 0.0, v4 = 0.0, v5 = 0.0;
+
+#if defined(_OPENMP)
+#pragma omp parallel for default(shared) schedule(static) \
+  reduction(+:nneg,nzero,v0,v1,v2,v3,v4,v5)
+#endif
+  for (int ib = 0; ib < nblock; ib++) {
+    int kind = 0;
+    while (ib >= blockfirst[kind+1]) kind++;
+    const int from = kindfirst[kind] + (ib-blockfirst[kind])*BLOCK;
+
+    Block blk;
+    blk.n = MIN(BLOCK,kindfirst[kind+1]-from);
+    gather(kind,from,blk);
+
+    // detmin = smallest determinant of the block, < 0.0 for shake,
+    //   0.0 for the matrix solves is an error
+
+    double detmin = BIG;
+    if (kind == BOND2) {
+      solve2(blk,detmin);
+      if (detmin < 0.0) nneg++;
+    } else {
+      if (kind == BOND3) setup3(blk);
+      else if (kind == BOND4) setup4(blk);
+      else setup3angle(blk);
+      if (kind == BOND3) iterate2(blk,detmin);
+      else iterate3(blk,detmin);
+      if (detmin == 0.0) nzero++;
+    }
+
+    double vblock[6] = {0.0, 0.0, 0.0, 0.0, 0.0, 0.0};
+    scatter(kind,blk,vblock);
+
+    v0 += vblock[0];
+    v1 += vblock[1];
+    v2 += vblock[2];
+    v3 += vblock[3];
+    v4 += vblock[4];
+    v5 += vblock[5];
+  }
+
+  if (nzero) error->one(FLERR,"Shake determinant = 0.0");
+  if (nneg) error->warning(FLERR,"Shake determinant < 0.0",0);
+
+  if (evflag && vflag_global) {
+    virial[0] += v0;
+    virial[1] += v1;
+    virial[2] += v2;
+    virial[3] += v3;
+    virial[4] += v4;
+    virial[5] += v5;
+  }
+}
+
+/* ----------------------------------------------------------------------
+   pack atoms, inverse masses and constraint vectors with PBC of
+     clusters list[from] to list[from+n-1], all of one kind
+   for orthogonal boxes, PBC are applied to all vectors of the block
+     in one pass instead of a minimum_image() call per vector
+   rhs = squared constraint distance, setup subtracts |s|^2
+------------------------------------------------------------------------- */
+
+void FixShakeFast::gather(int kind, int from, Block &b)
+{
+  const int na = natoms_kind[kind];
+  const int nc = ncons_kind[kind];
+  const int *ca = ca_kind[kind];
+  const int *cb = cb_kind[kind];
+  const int triclinic = domain->triclinic;
+  double del[3];
+
+  for (int m = 0; m < b.n; m++) {
+    const int ic = list[from+m];
+
+    for (int a = 0; a < na; a++) {
+      const int i = atom->map(shake_atom[ic][a]);
+      b.iatom[a][m] = i;
+      if (rmass) b.im[a][m] = 1.0/rmass[i];
+      else b.im[a][m] = 1.0/mass[type[i]];
+    }
+
+    for (int k = 0; k < nc; k++) {
+      const int i = b.iatom[ca[k]][m];
+      const int j = b.iatom[cb[k]][m];
+
+      del[0] = x[i][0] - x[j][0];
+      del[1] = x[i][1] - x[j][1];
+      del[2] = x[i][2] - x[j][2];
+      if (triclinic) domain->minimum_image(del);
+      b.r[k][0][m] = del[0];
+      b.r[k][1][m] = del[1];
+      b.r[k][2][m] = del[2];
+
+      del[0] = xshake[i][0] - xshake[j][0];
+      del[1] = xshake[i][1] - xshake[j][1];
+      del[2] = xshake[i][2] - xshake[j][2];
+      if (triclinic) domain->minimum_image(del);
+      b.s[k][0][m] = del[0];
+      b.s[k][1][m] = del[1];
+      b.s[k][2][m] = del[2];
+
+      double d;
+      if (kind == ANGLE3 && k == 2) d = angle_distance[shake_type[ic][2]];
+      else d = bond_distance[shake_type[ic][k]];
+      b.rhs[k][m] = d*d;
+    }
+  }
+
+  if (triclinic) return;
+
+  for (int dim = 0; dim < 3; dim++) {
+    if (!domain->periodicity[dim]) continue;
+    const double prd = domain->prd[dim];
+    const double prd_half = domain->prd_half[dim];
+
+    for (int k = 0; k < nc; k++) {
+      double *rk = b.r[k][dim];
+      double *sk = b.s[k][dim];
+
+#if defined(_OPENMP) && _OPENMP >= 201307
+#pragma omp simd
+#endif
+      for (int m = 0; m < b.n; m++) {
+        const int rhi = (rk[m] > prd_half);
+        const int rlo = (rk[m] < -prd_half);
+        const int shi = (sk[m] > prd_half);
+        const int slo = (sk[m] < -prd_half);
+        rk[m] += (rhi ? -prd : 0.0) + (rlo ? prd : 0.0);
+        sk[m] += (shi ? -prd : 0.0) + (slo ? prd : 0.0);
+      }
+    }
+  }
+}
+
+/* ----------------------------------------------------------------------
+   add constraint forces to owned atoms of the block
+   global virial is summed into vsum, per-atom virial is added directly
+     since no two clusters share an atom
+------------------------------------------------------------------------- */
+
+void FixShakeFast::scatter(int kind, Block &b, double *vsum)
+{
+  const int na = natoms_kind[kind];
+  const int nc = ncons_kind[kind];
+  const int *ca = ca_kind[kind];
+  const int *cb = cb_kind[kind];
+  const double fraction_atom = 1.0/na;
+
+  for (int m = 0; m < b.n; m++) {
+    double v[6] = {0.0, 0.0, 0.0, 0.0, 0.0, 0.0};
+
+    for (int k = 0; k < nc; k++) {
+      const double lamda = b.lamda[k][m]/dtfsq;
+      const double fx = lamda*b.r[k][0][m];
+      const double fy = lamda*b.r[k][1][m];
+      const double fz = lamda*b.r[k][2][m];
+      const int i = b.iatom[ca[k]][m];
+      const int j = b.iatom[cb[k]][m];
+
+      if (i < nlocal) {
+        f[i][0] += fx;
+        f[i][1] += fy;
+        f[i][2] += fz;
+      }
+
+      if (j < nlocal) {
+        f[j][0] -= fx;
+        f[j][1] -= fy;
+        f[j][2] -= fz;
+      }
+
+      v[0] += fx*b.r[k][0][m];
+      v[1] += fy*b.r[k][1][m];
+      v[2] += fz*b.r[k][2][m];
+      v[3] += fx*b.r[k][1][m];
+      v[4] += fx*b.r[k][2][m];
+      v[5] += fy*b.r[k][2][m];
+    }
+
+    if (!evflag) continue;
+
+    int nown = 0;
+    for (int a = 0; a < na; a++) {
+      const int i = b.iatom[a][m];
+      if (i >= nlocal) continue;
+      nown++;
+      if (vflag_atom)
+        for (int n = 0; n < 6; n++) vatom[i][n] += fraction_atom*v[n];
+    }
+
+    if (vflag_global) {
+      const double fraction = static_cast<double> (nown)/na;
+      for (int n = 0; n < 6; n++) vsum[n] += fraction*v[n];
+    }
+  }
+}
+
+/* ----------------------------------------------------------------------
+   exact quadratic solution for lamda of 2-atom clusters, as in shake
+------------------------------------------------------------------------- */
+
+void FixShakeFast::solve2(Block &b, double &detmin)
+{
+  double dmin = BIG;
+
+#if defined(_OPENMP) && _OPENMP >= 201307
+#pragma omp simd reduction(min:dmin)
+#endif
+  for (int m = 0; m < b.n; m++) {
+    const double invmass01 = b.im[0][m] + b.im[1][m];
+    const double r01sq = dot(b.r[0],b.r[0],m);
+    const double s01sq = dot(b.s[0],b.s[0],m);
+
+    const double qa = invmass01*invmass01 * r01sq;
+    const double qb = 2.0 * invmass01 * dot(b.s[0],b.r[0],m);
+    const double qc = s01sq - b.rhs[0][m];
+
+    // error check
+
+    double determ = qb*qb - 4.0*qa*qc;
+    dmin = MIN(dmin,determ);
+    determ = MAX(determ,0.0);
+
+    const double lamda1 = (-qb+sqrt(determ)) / (2.0*qa);
+    const double lamda2 = (-qb-sqrt(determ)) / (2.0*qa);
+    b.lamda[0][m] = (fabs(lamda1) <= fabs(lamda2)) ? lamda1 : lamda2;
+  }
+
+  detmin = dmin;
+}
+
+/* ----------------------------------------------------------------------
+   matrix coeffs, rhs and quadratic correction coeffs of 3-atom clusters
+   same equations as shake3, lamdas are for bonds 01,02
+------------------------------------------------------------------------- */
+
+void FixShakeFast::setup3(Block &b)
+{
+#if defined(_OPENMP) && _OPENMP >= 201307
+#pragma omp simd
+#endif
+  for (int m = 0; m < b.n; m++) {
+    const double invmass0 = b.im[0][m];
+    const double invmass1 = b.im[1][m];
+    const double invmass2 = b.im[2][m];
+
+    b.rhs[0][m] -= dot(b.s[0],b.s[0],m);
+    b.rhs[1][m] -= dot(b.s[1],b.s[1],m);
+
+    b.a[0][m] = 2.0 * (invmass0+invmass1) * dot(b.s[0],b.r[0],m);
+    b.a[1][m] = 2.0 * invmass0 * dot(b.s[0],b.r[1],m);
+    b.a[2][m] = 2.0 * invmass0 * dot(b.s[1],b.r[0],m);
+    b.a[3][m] = 2.0 * (invmass0+invmass2) * dot(b.s[1],b.r[1],m);
+
+    const double r01sq = dot(b.r[0],b.r[0],m);
+    const double r02sq = dot(b.r[1],b.r[1],m);
+    const double r0102 = dot(b.r[0],b.r[1],m);
+
+    b.q[0][m] = (invmass0+invmass1)*(invmass0+invmass1) * r01sq;
+    b.q[1][m] = invmass0*invmass0 * r02sq;
+    b.q[2][m] = 2.0 * (invmass0+invmass1)*invmass0 * r0102;
+
+    b.q[3][m] = invmass0*invmass0 * r01sq;
+    b.q[4][m] = (invmass0+invmass2)*(invmass0+invmass2) * r02sq;
+    b.q[5][m] = 2.0 * (invmass0+invmass2)*invmass0 * r0102;
+  }
+}
+
+/* ----------------------------------------------------------------------
+   matrix coeffs, rhs and quadratic correction coeffs of 4-atom clusters
+   same equations as shake4, lamdas are for bonds 01,02,03
+------------------------------------------------------------------------- */
+
+void FixShakeFast::setup4(Block &b)
+{
+#if defined(_OPENMP) && _OPENMP >= 201307
+#pragma omp simd
+#endif
+  for (int m = 0; m < b.n; m++) {
+    const double invmass0 = b.im[0][m];
+    const double invmass1 = b.im[1][m];
+    const double invmass2 = b.im[2][m];
+    const double invmass3 = b.im[3][m];
+
+    b.rhs[0][m] -= dot(b.s[0],b.s[0],m);
+    b.rhs[1][m] -= dot(b.s[1],b.s[1],m);
+    b.rhs[2][m] -= dot(b.s[2],b.s[2],m);
+
+    b.a[0][m] = 2.0 * (invmass0+invmass1) * dot(b.s[0],b.r[0],m);
+    b.a[1][m] = 2.0 * invmass0 * dot(b.s[0],b.r[1],m);
+    b.a[2][m] = 2.0 * invmass0 * dot(b.s[0],b.r[2],m);
+    b.a[3][m] = 2.0 * invmass0 * dot(b.s[1],b.r[0],m);
+    b.a[4][m] = 2.0 * (invmass0+invmass2) * dot(b.s[1],b.r[1],m);
+    b.a[5][m] = 2.0 * invmass0 * dot(b.s[1],b.r[2],m);
+    b.a[6][m] = 2.0 * invmass0 * dot(b.s[2],b.r[0],m);
+    b.a[7][m] = 2.0 * invmass0 * dot(b.s[2],b.r[1],m);
+    b.a[8][m] = 2.0 * (invmass0+invmass3) * dot(b.s[2],b.r[2],m);
+
+    const double r01sq = dot(b.r[0],b.r[0],m);
+    const double r02sq = dot(b.r[1],b.r[1],m);
+    const double r03sq = dot(b.r[2],b.r[2],m);
+    const double r0102 = dot(b.r[0],b.r[1],m);
+    const double r0103 = dot(b.r[0],b.r[2],m);
+    const double r0203 = dot(b.r[1],b.r[2],m);
+
+    b.q[0][m] = (invmass0+invmass1)*(invmass0+invmass1) * r01sq;
+    b.q[1][m] = invmass0*invmass0 * r02sq;
+    b.q[2][m] = invmass0*invmass0 * r03sq;
+    b.q[3][m] = 2.0 * (invmass0+invmass1)*invmass0 * r0102;
+    b.q[4][m] = 2.0 * (invmass0+invmass1)*invmass0 * r0103;
+    b.q[5][m] = 2.0 * invmass0*invmass0 * r0203;
+
+    b.q[6][m] = invmass0*invmass0 * r01sq;
+    b.q[7][m] = (invmass0+invmass2)*(invmass0+invmass2) * r02sq;
+    b.q[8][m] = invmass0*invmass0 * r03sq;
+    b.q[9][m] = 2.0 * (invmass0+invmass2)*invmass0 * r0102;
+    b.q[10][m] = 2.0 * invmass0*invmass0 * r0103;
+    b.q[11][m] = 2.0 * (invmass0+invmass2)*invmass0 * r0203;
+
+    b.q[12][m] = invmass0*invmass0 * r01sq;
+    b.q[13][m] = invmass0*invmass0 * r02sq;
+    b.q[14][m] = (invmass0+invmass3)*(invmass0+invmass3) * r03sq;
+    b.q[15][m] = 2.0 * invmass0*invmass0 * r0102;
+    b.q[16][m] = 2.0 * (invmass0+invmass3)*invmass0 * r0103;
+    b.q[17][m] = 2.0 * (invmass0+invmass3)*invmass0 * r0203;
+  }
+}
+
+/* ----------------------------------------------------------------------
+   matrix coeffs, rhs and quadratic correction coeffs of angle clusters
+   same equations as shake3angle, lamdas are for bonds 01,02,12
+------------------------------------------------------------------------- */
+
+void FixShakeFast::setup3angle(Block &b)
+{
+#if defined(_OPENMP) && _OPENMP >= 201307
+#pragma omp simd
+#endif
+  for (int m = 0; m < b.n; m++) {
+    const double invmass0 = b.im[0][m];
+    const double invmass1 = b.im[1][m];
+    const double invmass2 = b.im[2][m];
+
+    b.rhs[0][m] -= dot(b.s[0],b.s[0],m);
+    b.rhs[1][m] -= dot(b.s[1],b.s[1],m);
+    b.rhs[2][m] -= dot(b.s[2],b.s[2],m);
+
+    b.a[0][m] = 2.0 * (invmass0+invmass1) * dot(b.s[0],b.r[0],m);
+    b.a[1][m] = 2.0 * invmass0 * dot(b.s[0],b.r[1],m);
+    b.a[2][m] = - 2.0 * invmass1 * dot(b.s[0],b.r[2],m);
+    b.a[3][m] = 2.0 * invmass0 * dot(b.s[1],b.r[0],m);
+    b.a[4][m] = 2.0 * (invmass0+invmass2) * dot(b.s[1],b.r[1],m);
+    b.a[5][m] = 2.0 * invmass2 * dot(b.s[1],b.r[2],m);
+    b.a[6][m] = - 2.0 * invmass1 * dot(b.s[2],b.r[0],m);
+    b.a[7][m] = 2.0 * invmass2 * dot(b.s[2],b.r[1],m);
+    b.a[8][m] = 2.0 * (invmass1+invmass2) * dot(b.s[2],b.r[2],m);
+
+    const double r01sq = dot(b.r[0],b.r[0],m);
+    const double r02sq = dot(b.r[1],b.r[1],m);
+    const double r12sq = dot(b.r[2],b.r[2],m);
+    const double r0102 = dot(b.r[0],b.r[1],m);
+    const double r0112 = dot(b.r[0],b.r[2],m);
+    const double r0212 = dot(b.r[1],b.r[2],m);
+
+    b.q[0][m] = (invmass0+invmass1)*(invmass0+invmass1) * r01sq;
+    b.q[1][m] = invmass0*invmass0 * r02sq;
+    b.q[2][m] = invmass1*invmass1 * r12sq;
+    b.q[3][m] = 2.0 * (invmass0+invmass1)*invmass0 * r0102;
+    b.q[4][m] = - 2.0 * (invmass0+invmass1)*invmass1 * r0112;
+    b.q[5][m] = - 2.0 * invmass0*invmass1 * r0212;
+
+    b.q[6][m] = invmass0*invmass0 * r01sq;
+    b.q[7][m] = (invmass0+invmass2)*(invmass0+invmass2) * r02sq;
+    b.q[8][m] = invmass2*invmass2 * r12sq;
+    b.q[9][m] = 2.0 * (invmass0+invmass2)*invmass0 * r0102;
+    b.q[10][m] = 2.0 * invmass0*invmass2 * r0112;
+    b.q[11][m] = 2.0 * (invmass0+invmass2)*invmass2 * r0212;
+
+    b.q[12][m] = invmass1*invmass1 * r01sq;
+    b.q[13][m] = invmass2*invmass2 * r02sq;
+    b.q[14][m] = (invmass1+invmass2)*(invmass1+invmass2) * r12sq;
+    b.q[15][m] = - 2.0 * invmass1*invmass2 * r0102;
+    b.q[16][m] = - 2.0 * (invmass1+invmass2)*invmass1 * r0112;
+    b.q[17][m] = 2.0 * (invmass1+invmass2)*invmass2 * r0212;
+  }
+}
+
+/* ----------------------------------------------------------------------
+   invert 2x2 matrix and iterate lamdas of a block until all are
+     converged, or niter_fixed times
+------------------------------------------------------------------------- */
+
+void FixShakeFast::iterate2(Block &b, double &detmin)
+{
+  int m;
+  double dmin = BIG;
+
+#if defined(_OPENMP) && _OPENMP >= 201307
+#pragma omp simd reduction(min:dmin)
+#endif
+  for (m = 0; m < b.n; m++) {
+    const double a11 = b.a[0][m];
+    const double a12 = b.a[1][m];
+    const double a21 = b.a[2][m];
+    const double a22 = b.a[3][m];
+
+    const double determ = a11*a22 - a12*a21;
+    dmin = MIN(dmin,fabs(determ));
+    const double determinv = 1.0/determ;
+
+    b.a[0][m] = a22*determinv;
+    b.a[1][m] = -a12*determinv;
+    b.a[2][m] = -a21*determinv;
+    b.a[3][m] = a11*determinv;
+
+    b.lamda[0][m] = b.lamda[1][m] = 0.0;
+  }
+
+  detmin = dmin;
+
+  const int niter = niter_fixed ? niter_fixed : max_iter;
+
+  for (int iter = 0; iter < niter; iter++) {
+    double dlamda = 0.0;
+
+#if defined(_OPENMP) && _OPENMP >= 201307
+#pragma omp simd reduction(max:dlamda)
+#endif
+    for (m = 0; m < b.n; m++) {
+      const double lamda01 = b.lamda[0][m];
+      const double lamda02 = b.lamda[1][m];
+
+      const double quad1 = b.q[0][m] * lamda01*lamda01 +
+        b.q[1][m] * lamda02*lamda02 + b.q[2][m] * lamda01*lamda02;
+      const double quad2 = b.q[3][m] * lamda01*lamda01 +
+        b.q[4][m] * lamda02*lamda02 + b.q[5][m] * lamda01*lamda02;
+
+      const double b1 = b.rhs[0][m] - quad1;
+      const double b2 = b.rhs[1][m] - quad2;
+
+      const double lamda01_new = b.a[0][m]*b1 + b.a[1][m]*b2;
+      const double lamda02_new = b.a[2][m]*b1 + b.a[3][m]*b2;
+
+      dlamda = MAX(dlamda,fabs(lamda01_new-lamda01));
+      dlamda = MAX(dlamda,fabs(lamda02_new-lamda02));
+
+      b.lamda[0][m] = lamda01_new;
+      b.lamda[1][m] = lamda02_new;
+    }
+
+    if (!niter_fixed && dlamda <= tolerance) break;
+  }
+}
+
+/* ----------------------------------------------------------------------
+   invert 3x3 matrix and iterate lamdas of a block until all are
+     converged, or niter_fixed times
+------------------------------------------------------------------------- */
+
+void FixShakeFast::iterate3(Block &b, double &detmin)
+{
+  int m;
+  double dmin = BIG;
+
+#if defined(_OPENMP) && _OPENMP >= 201307
+#pragma omp simd reduction(min:dmin)
+#endif
+  for (m = 0; m < b.n; m++) {
+    const double a11 = b.a[0][m];
+    const double a12 = b.a[1][m];
+    const double a13 = b.a[2][m];
+    const double a21 = b.a[3][m];
+    const double a22 = b.a[4][m];
+    const double a23 = b.a[5][m];
+    const double a31 = b.a[6][m];
+    const double a32 = b.a[7][m];
+    const double a33 = b.a[8][m];
+
+    const double determ = a11*a22*a33 + a12*a23*a31 + a13*a21*a32 -
+      a11*a23*a32 - a12*a21*a33 - a13*a22*a31;
+    dmin = MIN(dmin,fabs(determ));
+    const double determinv = 1.0/determ;
+
+    b.a[0][m] = determinv * (a22*a33 - a23*a32);
+    b.a[1][m] = -determinv * (a12*a33 - a13*a32);
+    b.a[2][m] = determinv * (a12*a23 - a13*a22);
+    b.a[3][m] = -determinv * (a21*a33 - a23*a31);
+    b.a[4][m] = determinv * (a11*a33 - a13*a31);
+    b.a[5][m] = -determinv * (a11*a23 - a13*a21);
+    b.a[6][m] = determinv * (a21*a32 - a22*a31);
+    b.a[7][m] = -determinv * (a11*a32 - a12*a31);
+    b.a[8][m] = determinv * (a11*a22 - a12*a21);
+
+    b.lamda[0][m] = b.lamda[1][m] = b.lamda[2][m] = 0.0;
+  }
+
+  detmin = dmin;
+
+  const int niter = niter_fixed ? niter_fixed : max_iter;
+
+  for (int iter = 0; iter < niter; iter++) {
+    double dlamda = 0.0;
+
+#if defined(_OPENMP) && _OPENMP >= 201307
+#pragma omp simd reduction(max:dlamda)
+#endif
+    for (m = 0; m < b.n; m++) {
+      const double lamda1 = b.lamda[0][m];
+      const double lamda2 = b.lamda[1][m];
+      const double lamda3 = b.lamda[2][m];
+      const double l11 = lamda1*lamda1;
+      const double l22 = lamda2*lamda2;
+      const double l33 = lamda3*lamda3;
+      const double l12 = lamda1*lamda2;
+      const double l13 = lamda1*lamda3;
+      const double l23 = lamda2*lamda3;
+
+      const double quad1 = b.q[0][m]*l11 + b.q[1][m]*l22 + b.q[2][m]*l33 +
+        b.q[3][m]*l12 + b.q[4][m]*l13 + b.q[5][m]*l23;
+      const double quad2 = b.q[6][m]*l11 + b.q[7][m]*l22 + b.q[8][m]*l33 +
+        b.q[9][m]*l12 + b.q[10][m]*l13 + b.q[11][m]*l23;
+      const double quad3 = b.q[12][m]*l11 + b.q[13][m]*l22 + b.q[14][m]*l33 +
+        b.q[15][m]*l12 + b.q[16][m]*l13 + b.q[17][m]*l23;
+
+      const double b1 = b.rhs[0][m] - quad1;
+      const double b2 = b.rhs[1][m] - quad2;
+      const double b3 = b.rhs[2][m] - quad3;
+
+      const double lamda1_new = b.a[0][m]*b1 + b.a[1][m]*b2 + b.a[2][m]*b3;
+      const double lamda2_new = b.a[3][m]*b1 + b.a[4][m]*b2 + b.a[5][m]*b3;
+      const double lamda3_new = b.a[6][m]*b1 + b.a[7][m]*b2 + b.a[8][m]*b3;
+
+      dlamda = MAX(dlamda,fabs(lamda1_new-lamda1));
+      dlamda = MAX(dlamda,fabs(lamda2_new-lamda2));
+      dlamda = MAX(dlamda,fabs(lamda3_new-lamda3));
+
+      b.lamda[0][m] = lamda1_new;
+      b.lamda[1][m] = lamda2_new;
+      b.lamda[2][m] = lamda3_new;
+    }
+
+    if (!niter_fixed && dlamda <= tolerance) break;
+  }
+}
+
+/* ---------------------------------------------------------------------- */
+
+double FixShakeFast::memory_usage()
+{
+  double bytes = FixShake::memory_usage();
+  bytes += maxsort * sizeof(int);
+  return bytes;
+}
@@ -0,0 +1,80 @@
+/* -*- c++ -*- ----------------------------------------------------------
+   LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+   http://lammps.sandia.gov, Sandia National Laboratories
+   Steve Plimpton, sjplimp@sandia.gov
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+
+   See the README file in the top-level LAMMPS directory.
+------------------------------------------------------------------------- */
+
+#ifdef FIX_CLASS
+
+FixStyle(shake/fast,FixShakeFast)
+
+#else
+
+#ifndef LMP_FIX_SHAKE_FAST_H
+#define LMP_FIX_SHAKE_FAST_H
+
+#include "fix_shake.h"
+
+namespace LAMMPS_NS {
+
+class FixShakeFast : public FixShake {
+ public:
+  FixShakeFast(class LAMMPS *, int, char **);
+  ~FixShakeFast();
+  void pre_neighbor();
+  void post_force(int);
+  void post_force_respa(int, int, int);
+  double memory_usage();
+
+ protected:
+  int niter_fixed;              // # of iterations if fixed, else 0
+  int kindfirst[5];             // list is sorted by kind of cluster
+  int *sortlist;                // scratch for sorting list
+  int maxsort;
+
+  struct Block;                 // SoA data of a block of clusters
+
+  static int trim_args(int, char **);
+  void shake_blocks();
+  void gather(int, int, Block &);
+  void scatter(int, Block &, double *);
+  void solve2(Block &, double &);
+  void setup3(Block &);
+  void setup4(Block &);
+  void setup3angle(Block &);
+  void iterate2(Block &, double &);
+  void iterate3(Block &, double &);
+};
+
+}
+
+#endif
+#endif
+
+/* ERROR/WARNING messages:
+
+E: Illegal ... command
+
+Self-explanatory.  Check the input script syntax and compare to the
+documentation for the command.  You can use -echo screen as a
+command-line option when running LAMMPS to see the offending line.
+
+E: Shake determinant = 0.0
+
+The determinant of the matrix being solved for a single cluster
+specified by the fix shake command is numerically invalid.
+
+W: Shake determinant < 0.0
+
+The determinant of the quadratic equation being solved for a single
+cluster specified by the fix shake command is numerically suspect.  LAMMPS
+will set it to 0.0 and continue.
+
+*/
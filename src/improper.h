@@ -21,6 +21,7 @@ namespace LAMMPS_NS {
 
 class Improper : protected Pointers {
   friend class ThrOMP;
+  friend class ThrAccum;
   friend class FixOMP;
  public:
   int allocated;
@@ -164,10 +164,13 @@ void Irregular::migrate_atoms()
    atoms must be remapped to be inside simulation box before this is called
    for triclinic: atoms must be in lamda coords (0-1) before this is called
    return 1 if migrate required, 0 if not
+   always 1 for RCB tiles, which have no notion of one proc away
 ------------------------------------------------------------------------- */
 
 int Irregular::migrate_check()
 {
+  if (comm->tiled) return 1;
+
   // subbox bounds for orthogonal or triclinic box
   // other comm/domain data used by coord2proc()
 
@@ -696,12 +699,19 @@ void Irregular::destroy_data()
    x will be in box (orthogonal) or lamda coords (triclinic)
    for uniform = 1, directly calculate owning proc
    for non-uniform, iteratively find owning proc via binary search
+   for RCB tiles, walk the tree of cuts
    return owning proc ID via grid2proc
    return igx,igy,igz = logical grid loc of owing proc within 3d grid of procs
+     always 0 for RCB tiles
 ------------------------------------------------------------------------- */
 
 int Irregular::coord2proc(double *x, int &igx, int &igy, int &igz)
 {
+  if (comm->tiled) {
+    igx = igy = igz = 0;
+    return comm->coord2tile(x,triclinic);
+  }
+
   if (uniform) {
     if (triclinic == 0) {
       igx = static_cast<int> (procgrid[0] * (x[0]-boxlo[0]) / prd[0]);
@@ -0,0 +1,303 @@
+/* ----------------------------------------------------------------------
+   LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+   http://lammps.sandia.gov, Sandia National Laboratories
+   Steve Plimpton, sjplimp@sandia.gov
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+
+   See the README file in the top-level LAMMPS directory.
+------------------------------------------------------------------------- */
+
+/* ----------------------------------------------------------------------
+   topology lists that reuse the partner images of the last build
+   enabled by neigh_modify cache yes
+   a partner image of the last build is kept if it still holds the right
+     atom ID and is closer to the owned atom than half the smallest
+     periodic width of the box, since then it is the closest image
+   all other partners are looked up via atom->map() and closest_image()
+   owned atoms are split statically among OpenMP threads,
+   the lists are identical to the ones of bond_all(), angle_all(), etc
+------------------------------------------------------------------------- */
+
+#include "math.h"
+#include "neighbor.h"
+#include "atom.h"
+#include "comm.h"
+#include "force.h"
+#include "update.h"
+#include "domain.h"
+#include "memory.h"
+#include "error.h"
+
+using namespace LAMMPS_NS;
+
+#define BONDDELTA 10000
+#define BIG 1.0e20
+
+/* ---------------------------------------------------------------------- */
+
+void Neighbor::bond_cached()
+{
+  int **partner[1];
+  partner[0] = atom->bond_atom;
+  topo_cached(bond_cache,atom->num_bond,1,partner,atom->bond_type,1,
+              bondlist,nbondlist,maxbond,"Bond");
+
+  if (cluster_check) bond_check();
+}
+
+/* ---------------------------------------------------------------------- */
+
+void Neighbor::angle_cached()
+{
+  int **partner[3];
+  partner[0] = atom->angle_atom1;
+  partner[1] = atom->angle_atom2;
+  partner[2] = atom->angle_atom3;
+  topo_cached(angle_cache,atom->num_angle,3,partner,atom->angle_type,0,
+              anglelist,nanglelist,maxangle,"Angle");
+
+  if (cluster_check) angle_check();
+}
+
+/* ---------------------------------------------------------------------- */
+
+void Neighbor::dihedral_cached()
+{
+  int **partner[4];
+  partner[0] = atom->dihedral_atom1;
+  partner[1] = atom->dihedral_atom2;
+  partner[2] = atom->dihedral_atom3;
+  partner[3] = atom->dihedral_atom4;
+  topo_cached(dihedral_cache,atom->num_dihedral,4,partner,
+              atom->dihedral_type,0,dihedrallist,ndihedrallist,maxdihedral,
+              "Dihedral");
+
+  if (cluster_check) dihedral_check(ndihedrallist,dihedrallist);
+}
+
+/* ---------------------------------------------------------------------- */
+
+void Neighbor::improper_cached()
+{
+  int **partner[4];
+  partner[0] = atom->improper_atom1;
+  partner[1] = atom->improper_atom2;
+  partner[2] = atom->improper_atom3;
+  partner[3] = atom->improper_atom4;
+  topo_cached(improper_cache,atom->num_improper,4,partner,
+              atom->improper_type,0,improperlist,nimproperlist,maximproper,
+              "Improper");
+}
+
+/* ----------------------------------------------------------------------
+   build one topology list from the partner IDs of owned atoms
+   num = # of entries of each owned atom
+   npartner = # of partner IDs per entry, partner[k][i][m] = Kth ID
+   selfflag = 1 if owned atom is 1st column of list (bonds)
+   list rows = owned atom (if selfflag), partner images, type
+   an entry is stored if newton_bond is set or owned atom has lowest index
+   cache[0] = images of last build, cache[1] = images of this build,
+     swapped at end
+------------------------------------------------------------------------- */
+
+void Neighbor::topo_cached(TopoCache *cache, int *num, int npartner,
+                           int ***partner, int **type, int selfflag,
+                           int **&list, int &nlist, int &maxlist,
+                           const char *name)
+{
+  int i;
+
+  int nlocal = atom->nlocal;
+  int nall = nlocal + atom->nghost;
+  int *tag = atom->tag;
+  double **x = atom->x;
+  int newton_bond = force->newton_bond;
+  const int nthreads = comm->nthreads;
+
+  TopoCache *last = &cache[0];
+  TopoCache *now = &cache[1];
+
+  // entries of owned atom I start at first[I]
+
+  if (nlocal+1 > now->maxlocal) {
+    now->maxlocal = atom->nmax + 1;
+    memory->destroy(now->first);
+    memory->create(now->first,now->maxlocal,"neigh:topo_first");
+  }
+  int *first = now->first;
+  first[0] = 0;
+  for (i = 0; i < nlocal; i++) first[i+1] = first[i] + num[i];
+  now->nlocal = nlocal;
+
+  bigint nentry = (bigint) first[nlocal] * npartner;
+  if (nentry > MAXSMALLINT)
+    error->one(FLERR,"Too many topology list entries on proc");
+  if (nentry > now->maxentry) {
+    now->maxentry = nentry + BONDDELTA;
+    memory->destroy(now->image);
+    memory->create(now->image,now->maxentry,"neigh:topo_image");
+  }
+  int *image = now->image;
+
+  // cutsq = square of half the smallest width of box in a periodic dim
+  // the perpendicular width between 2 faces of a triclinic box is
+  //   the inverse length of a row of h_inv
+
+  double *h_inv = domain->h_inv;
+  double width[3];
+  width[0] = 1.0/sqrt(h_inv[0]*h_inv[0] + h_inv[5]*h_inv[5] +
+                      h_inv[4]*h_inv[4]);
+  width[1] = 1.0/sqrt(h_inv[1]*h_inv[1] + h_inv[3]*h_inv[3]);
+  width[2] = 1.0/h_inv[2];
+
+  double cutsq = BIG;
+  int *periodicity = domain->periodicity;
+  for (int d = 0; d < domain->dimension; d++)
+    if (periodicity[d]) cutsq = MIN(cutsq,0.25*width[d]*width[d]);
+
+  int *lastfirst = last->first;
+  int *lastimage = last->image;
+  int nlastlocal = last->nlocal;
+
+  // per-thread counts of stored entries and 1st entry with missing atoms
+  // owned atoms are split into nthreads fixed chunks, same in both passes,
+  //   so chunk offsets in list do not depend on the size of the team
+
+  int *nkeep = new int[nthreads+1];
+  int *missing = new int[nthreads];
+  const int idelta = nlocal/nthreads + 1;
+
+  // resolve the partner images of all entries and count stored entries
+
+#if defined(_OPENMP)
+#pragma omp parallel for default(shared) num_threads(nthreads) schedule(static,1)
+#endif
+  for (int tid = 0; tid < nthreads; tid++) {
+    const int ifrom = tid*idelta;
+    const int ito = MIN(ifrom+idelta,nlocal);
+
+    int i,j,k,m,n,global,nlast,keep;
+    double delx,dely,delz;
+    int *img;
+    int count = 0;
+    missing[tid] = -1;
+
+    for (i = ifrom; i < ito; i++) {
+      n = num[i];
+      if (i < nlastlocal) nlast = lastfirst[i+1] - lastfirst[i];
+      else nlast = 0;
+
+      for (m = 0; m < n; m++) {
+        img = &image[(first[i]+m)*npartner];
+        keep = 1;
+
+        for (k = 0; k < npartner; k++) {
+          global = partner[k][i][m];
+          j = -1;
+          if (m < nlast) {
+            j = lastimage[(lastfirst[i]+m)*npartner + k];
+            if (j < nall && tag[j] == global) {
+              delx = x[i][0] - x[j][0];
+              dely = x[i][1] - x[j][1];
+              delz = x[i][2] - x[j][2];
+              if (delx*delx + dely*dely + delz*delz >= cutsq) j = -1;
+            } else j = -1;
+          }
+          if (j < 0) {
+            j = atom->map(global);
+            if (j < 0) {
+              if (missing[tid] < 0) missing[tid] = first[i] + m;
+              img[k] = 0;
+              continue;
+            }
+            j = domain->closest_image(i,j);
+          }
+          img[k] = j;
+          if (j < i) keep = 0;
+        }
+
+        if (newton_bond || keep) count++;
+      }
+    }
+
+    nkeep[tid] = count;
+  }
+
+  // error if any partner atom is missing, report 1st one on this proc
+
+  int imissing = -1;
+  for (int t = 0; t < nthreads; t++)
+    if (missing[t] >= 0 && (imissing < 0 || missing[t] < imissing))
+      imissing = missing[t];
+
+  if (imissing >= 0) {
+    for (i = 0; first[i+1] <= imissing; i++);
+    int m = imissing - first[i];
+    char str[128];
+    int n = sprintf(str,"%s atoms",name);
+    if (selfflag) n += sprintf(&str[n]," %d",tag[i]);
+    for (int k = 0; k < npartner; k++)
+      n += sprintf(&str[n]," %d",partner[k][i][m]);
+    sprintf(&str[n]," missing on proc %d at step " BIGINT_FORMAT,
+            me,update->ntimestep);
+    error->one(FLERR,str);
+  }
+
+  // offset of each thread's entries in list
+
+  int total = 0;
+  for (int t = 0; t < nthreads; t++) {
+    int count = nkeep[t];
+    nkeep[t] = total;
+    total += count;
+  }
+
+  if (total > maxlist) {
+    maxlist = total + BONDDELTA;
+    memory->destroy(list);
+    memory->create(list,maxlist,selfflag+npartner+1,"neighbor:topolist");
+  }
+
+  // fill list in same order as serial build
+
+#if defined(_OPENMP)
+#pragma omp parallel for default(shared) num_threads(nthreads) schedule(static,1)
+#endif
+  for (int tid = 0; tid < nthreads; tid++) {
+    const int ifrom = tid*idelta;
+    const int ito = MIN(ifrom+idelta,nlocal);
+
+    int i,k,m,keep;
+    int *img,*row;
+    int n = nkeep[tid];
+
+    for (i = ifrom; i < ito; i++)
+      for (m = 0; m < num[i]; m++) {
+        img = &image[(first[i]+m)*npartner];
+        keep = 1;
+        for (k = 0; k < npartner; k++)
+          if (img[k] < i) keep = 0;
+        if (!newton_bond && !keep) continue;
+
+        row = list[n++];
+        if (selfflag) *row++ = i;
+        for (k = 0; k < npartner; k++) row[k] = img[k];
+        row[npartner] = type[i][m];
+      }
+  }
+
+  nlist = total;
+
+  delete [] nkeep;
+  delete [] missing;
+
+  // images of this build are the cache of the next one
+
+  TopoCache tmp = cache[0];
+  cache[0] = cache[1];
+  cache[1] = tmp;
+}
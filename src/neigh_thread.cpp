@@ -0,0 +1,523 @@
+/* ----------------------------------------------------------------------
+   LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+   http://lammps.sandia.gov, Sandia National Laboratories
+   Steve Plimpton, sjplimp@sandia.gov
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+
+   See the README file in the top-level LAMMPS directory.
+------------------------------------------------------------------------- */
+
+/* ----------------------------------------------------------------------
+   OpenMP threaded versions of the binned neighbor list builds
+   enabled by neigh_modify thread yes
+   owned atoms are split statically among threads,
+   each thread stores its neighbors in its own MyPage of the list,
+   the lists are identical to the ones of the serial builds
+------------------------------------------------------------------------- */
+
+#include "neighbor.h"
+#include "neigh_list.h"
+#include "atom.h"
+#include "comm.h"
+#include "domain.h"
+#include "group.h"
+#include "memory.h"
+#include "my_page.h"
+#include "error.h"
+
+#if defined(_OPENMP)
+#include "omp.h"
+#endif
+
+using namespace LAMMPS_NS;
+
+/* ----------------------------------------------------------------------
+   bin owned and ghost atoms with threads
+   each thread links a contiguous chunk of atoms into its own bin lists,
+   the chunks are then chained in order bin by bin,
+   so every bin list is in ascending atom order as in bin_atoms()
+------------------------------------------------------------------------- */
+
+void Neighbor::bin_atoms_thread()
+{
+  const int nthreads = comm->nthreads;
+  if (includegroup || nthreads == 1) {
+    bin_atoms();
+    return;
+  }
+
+  if (nthreads*mbins > maxhead_thread) {
+    maxhead_thread = nthreads*mbins;
+    memory->destroy(binhead_thread);
+    memory->destroy(bintail_thread);
+    memory->create(binhead_thread,maxhead_thread,"neigh:binhead_thread");
+    memory->create(bintail_thread,maxhead_thread,"neigh:bintail_thread");
+  }
+
+  double **x = atom->x;
+  const int nall = atom->nlocal + atom->nghost;
+
+#if defined(_OPENMP)
+#pragma omp parallel default(shared)
+#endif
+  {
+#if defined(_OPENMP)
+    const int tid = omp_get_thread_num();
+    const int nthr = omp_get_num_threads();
+#else
+    const int tid = 0;
+    const int nthr = 1;
+#endif
+    int *head = binhead_thread + tid*mbins;
+    int *tail = bintail_thread + tid*mbins;
+    for (int ibin = 0; ibin < mbins; ibin++) head[ibin] = tail[ibin] = -1;
+
+    const int idelta = nall/nthr + 1;
+    const int ifrom = tid*idelta;
+    const int ito = MIN(ifrom+idelta,nall);
+
+    for (int i = ito-1; i >= ifrom; i--) {
+      const int ibin = coord2bin(x[i]);
+      if (head[ibin] < 0) tail[ibin] = i;
+      bins[i] = head[ibin];
+      head[ibin] = i;
+    }
+
+#if defined(_OPENMP)
+#pragma omp barrier
+#pragma omp for schedule(static)
+#endif
+    for (int ibin = 0; ibin < mbins; ibin++) {
+      int last = -1;
+      binhead[ibin] = -1;
+      for (int t = 0; t < nthr; t++) {
+        const int first = binhead_thread[t*mbins+ibin];
+        if (first < 0) continue;
+        if (last < 0) binhead[ibin] = first;
+        else bins[last] = first;
+        last = bintail_thread[t*mbins+ibin];
+      }
+    }
+  }
+}
+
+/* ----------------------------------------------------------------------
+   threaded half_bin_no_newton()
+------------------------------------------------------------------------- */
+
+void Neighbor::half_bin_no_newton_thread(NeighList *list)
+{
+  bin_atoms_thread();
+
+  int **special = atom->special;
+  int **nspecial = atom->nspecial;
+  int *tag = atom->tag;
+
+  double **x = atom->x;
+  int *type = atom->type;
+  int *mask = atom->mask;
+  int *molecule = atom->molecule;
+  int nlocal = atom->nlocal;
+  if (includegroup) nlocal = atom->nfirst;
+  int molecular = atom->molecular;
+
+  int *ilist = list->ilist;
+  int *numneigh = list->numneigh;
+  int **firstneigh = list->firstneigh;
+  int nstencil = list->nstencil;
+  int *stencil = list->stencil;
+
+  int noverflow = 0;
+
+#if defined(_OPENMP)
+#pragma omp parallel default(shared) reduction(+:noverflow)
+#endif
+  {
+#if defined(_OPENMP)
+    const int tid = omp_get_thread_num();
+#else
+    const int tid = 0;
+#endif
+    MyPage<int> *ipage = &list->ipage[tid];
+    ipage->reset();
+
+#if defined(_OPENMP)
+#pragma omp for schedule(static)
+#endif
+    for (int i = 0; i < nlocal; i++) {
+      if (noverflow) continue;
+
+      int n = 0;
+      int *neighptr = ipage->vget();
+
+      const int itype = type[i];
+      const double xtmp = x[i][0];
+      const double ytmp = x[i][1];
+      const double ztmp = x[i][2];
+
+      // only store pair if i < j
+
+      const int ibin = coord2bin(x[i]);
+
+      for (int k = 0; k < nstencil; k++) {
+        for (int j = binhead[ibin+stencil[k]]; j >= 0; j = bins[j]) {
+          if (j <= i) continue;
+
+          const int jtype = type[j];
+          if (exclude && exclusion(i,j,itype,jtype,mask,molecule)) continue;
+
+          const double delx = xtmp - x[j][0];
+          const double dely = ytmp - x[j][1];
+          const double delz = ztmp - x[j][2];
+          const double rsq = delx*delx + dely*dely + delz*delz;
+
+          if (rsq <= cutneighsq[itype][jtype]) {
+            if (molecular) {
+              const int which = find_special(special[i],nspecial[i],tag[j]);
+              if (which == 0) neighptr[n++] = j;
+              else if (domain->minimum_image_check(delx,dely,delz))
+                neighptr[n++] = j;
+              else if (which > 0) neighptr[n++] = j ^ (which << SBBITS);
+            } else neighptr[n++] = j;
+          }
+        }
+      }
+
+      ilist[i] = i;
+      firstneigh[i] = neighptr;
+      numneigh[i] = n;
+      ipage->vgot(n);
+      if (ipage->status()) noverflow++;
+    }
+  }
+
+  if (noverflow)
+    error->one(FLERR,"Neighbor list overflow, boost neigh_modify one");
+
+  list->inum = nlocal;
+}
+
+/* ----------------------------------------------------------------------
+   threaded half_bin_newton()
+------------------------------------------------------------------------- */
+
+void Neighbor::half_bin_newton_thread(NeighList *list)
+{
+  bin_atoms_thread();
+
+  int **special = atom->special;
+  int **nspecial = atom->nspecial;
+  int *tag = atom->tag;
+
+  double **x = atom->x;
+  int *type = atom->type;
+  int *mask = atom->mask;
+  int *molecule = atom->molecule;
+  int nlocal = atom->nlocal;
+  if (includegroup) nlocal = atom->nfirst;
+  int molecular = atom->molecular;
+
+  int *ilist = list->ilist;
+  int *numneigh = list->numneigh;
+  int **firstneigh = list->firstneigh;
+  int nstencil = list->nstencil;
+  int *stencil = list->stencil;
+
+  int noverflow = 0;
+
+#if defined(_OPENMP)
+#pragma omp parallel default(shared) reduction(+:noverflow)
+#endif
+  {
+#if defined(_OPENMP)
+    const int tid = omp_get_thread_num();
+#else
+    const int tid = 0;
+#endif
+    MyPage<int> *ipage = &list->ipage[tid];
+    ipage->reset();
+
+#if defined(_OPENMP)
+#pragma omp for schedule(static)
+#endif
+    for (int i = 0; i < nlocal; i++) {
+      if (noverflow) continue;
+
+      int n = 0;
+      int *neighptr = ipage->vget();
+
+      const int itype = type[i];
+      const double xtmp = x[i][0];
+      const double ytmp = x[i][1];
+      const double ztmp = x[i][2];
+
+      // rest of atoms in i's bin, ghosts only if "above and to the right"
+
+      for (int j = bins[i]; j >= 0; j = bins[j]) {
+        if (j >= nlocal) {
+          if (x[j][2] < ztmp) continue;
+          if (x[j][2] == ztmp) {
+            if (x[j][1] < ytmp) continue;
+            if (x[j][1] == ytmp && x[j][0] < xtmp) continue;
+          }
+        }
+
+        const int jtype = type[j];
+        if (exclude && exclusion(i,j,itype,jtype,mask,molecule)) continue;
+
+        const double delx = xtmp - x[j][0];
+        const double dely = ytmp - x[j][1];
+        const double delz = ztmp - x[j][2];
+        const double rsq = delx*delx + dely*dely + delz*delz;
+
+        if (rsq <= cutneighsq[itype][jtype]) {
+          if (molecular) {
+            const int which = find_special(special[i],nspecial[i],tag[j]);
+            if (which == 0) neighptr[n++] = j;
+            else if (domain->minimum_image_check(delx,dely,delz))
+              neighptr[n++] = j;
+            else if (which > 0) neighptr[n++] = j ^ (which << SBBITS);
+          } else neighptr[n++] = j;
+        }
+      }
+
+      // all atoms in other bins in stencil
+
+      const int ibin = coord2bin(x[i]);
+      for (int k = 0; k < nstencil; k++) {
+        for (int j = binhead[ibin+stencil[k]]; j >= 0; j = bins[j]) {
+          const int jtype = type[j];
+          if (exclude && exclusion(i,j,itype,jtype,mask,molecule)) continue;
+
+          const double delx = xtmp - x[j][0];
+          const double dely = ytmp - x[j][1];
+          const double delz = ztmp - x[j][2];
+          const double rsq = delx*delx + dely*dely + delz*delz;
+
+          if (rsq <= cutneighsq[itype][jtype]) {
+            if (molecular) {
+              const int which = find_special(special[i],nspecial[i],tag[j]);
+              if (which == 0) neighptr[n++] = j;
+              else if (domain->minimum_image_check(delx,dely,delz))
+                neighptr[n++] = j;
+              else if (which > 0) neighptr[n++] = j ^ (which << SBBITS);
+            } else neighptr[n++] = j;
+          }
+        }
+      }
+
+      ilist[i] = i;
+      firstneigh[i] = neighptr;
+      numneigh[i] = n;
+      ipage->vgot(n);
+      if (ipage->status()) noverflow++;
+    }
+  }
+
+  if (noverflow)
+    error->one(FLERR,"Neighbor list overflow, boost neigh_modify one");
+
+  list->inum = nlocal;
+}
+
+/* ----------------------------------------------------------------------
+   threaded half_bin_newton_tri()
+------------------------------------------------------------------------- */
+
+void Neighbor::half_bin_newton_tri_thread(NeighList *list)
+{
+  bin_atoms_thread();
+
+  int **special = atom->special;
+  int **nspecial = atom->nspecial;
+  int *tag = atom->tag;
+
+  double **x = atom->x;
+  int *type = atom->type;
+  int *mask = atom->mask;
+  int *molecule = atom->molecule;
+  int nlocal = atom->nlocal;
+  if (includegroup) nlocal = atom->nfirst;
+  int molecular = atom->molecular;
+
+  int *ilist = list->ilist;
+  int *numneigh = list->numneigh;
+  int **firstneigh = list->firstneigh;
+  int nstencil = list->nstencil;
+  int *stencil = list->stencil;
+
+  int noverflow = 0;
+
+#if defined(_OPENMP)
+#pragma omp parallel default(shared) reduction(+:noverflow)
+#endif
+  {
+#if defined(_OPENMP)
+    const int tid = omp_get_thread_num();
+#else
+    const int tid = 0;
+#endif
+    MyPage<int> *ipage = &list->ipage[tid];
+    ipage->reset();
+
+#if defined(_OPENMP)
+#pragma omp for schedule(static)
+#endif
+    for (int i = 0; i < nlocal; i++) {
+      if (noverflow) continue;
+
+      int n = 0;
+      int *neighptr = ipage->vget();
+
+      const int itype = type[i];
+      const double xtmp = x[i][0];
+      const double ytmp = x[i][1];
+      const double ztmp = x[i][2];
+
+      // pairs for atoms j "below" i are excluded
+
+      const int ibin = coord2bin(x[i]);
+      for (int k = 0; k < nstencil; k++) {
+        for (int j = binhead[ibin+stencil[k]]; j >= 0; j = bins[j]) {
+          if (x[j][2] < ztmp) continue;
+          if (x[j][2] == ztmp) {
+            if (x[j][1] < ytmp) continue;
+            if (x[j][1] == ytmp) {
+              if (x[j][0] < xtmp) continue;
+              if (x[j][0] == xtmp && j <= i) continue;
+            }
+          }
+
+          const int jtype = type[j];
+          if (exclude && exclusion(i,j,itype,jtype,mask,molecule)) continue;
+
+          const double delx = xtmp - x[j][0];
+          const double dely = ytmp - x[j][1];
+          const double delz = ztmp - x[j][2];
+          const double rsq = delx*delx + dely*dely + delz*delz;
+
+          if (rsq <= cutneighsq[itype][jtype]) {
+            if (molecular) {
+              const int which = find_special(special[i],nspecial[i],tag[j]);
+              if (which == 0) neighptr[n++] = j;
+              else if (domain->minimum_image_check(delx,dely,delz))
+                neighptr[n++] = j;
+              else if (which > 0) neighptr[n++] = j ^ (which << SBBITS);
+            } else neighptr[n++] = j;
+          }
+        }
+      }
+
+      ilist[i] = i;
+      firstneigh[i] = neighptr;
+      numneigh[i] = n;
+      ipage->vgot(n);
+      if (ipage->status()) noverflow++;
+    }
+  }
+
+  if (noverflow)
+    error->one(FLERR,"Neighbor list overflow, boost neigh_modify one");
+
+  list->inum = nlocal;
+}
+
+/* ----------------------------------------------------------------------
+   threaded full_bin()
+------------------------------------------------------------------------- */
+
+void Neighbor::full_bin_thread(NeighList *list)
+{
+  bin_atoms_thread();
+
+  int **special = atom->special;
+  int **nspecial = atom->nspecial;
+  int *tag = atom->tag;
+
+  double **x = atom->x;
+  int *type = atom->type;
+  int *mask = atom->mask;
+  int *molecule = atom->molecule;
+  int nlocal = atom->nlocal;
+  int molecular = atom->molecular;
+  if (includegroup) nlocal = atom->nfirst;
+
+  int *ilist = list->ilist;
+  int *numneigh = list->numneigh;
+  int **firstneigh = list->firstneigh;
+  int nstencil = list->nstencil;
+  int *stencil = list->stencil;
+
+  int noverflow = 0;
+
+#if defined(_OPENMP)
+#pragma omp parallel default(shared) reduction(+:noverflow)
+#endif
+  {
+#if defined(_OPENMP)
+    const int tid = omp_get_thread_num();
+#else
+    const int tid = 0;
+#endif
+    MyPage<int> *ipage = &list->ipage[tid];
+    ipage->reset();
+
+#if defined(_OPENMP)
+#pragma omp for schedule(static)
+#endif
+    for (int i = 0; i < nlocal; i++) {
+      if (noverflow) continue;
+
+      int n = 0;
+      int *neighptr = ipage->vget();
+
+      const int itype = type[i];
+      const double xtmp = x[i][0];
+      const double ytmp = x[i][1];
+      const double ztmp = x[i][2];
+
+      // all atoms in surrounding bins in stencil including self, skip i = j
+
+      const int ibin = coord2bin(x[i]);
+      for (int k = 0; k < nstencil; k++) {
+        for (int j = binhead[ibin+stencil[k]]; j >= 0; j = bins[j]) {
+          if (i == j) continue;
+
+          const int jtype = type[j];
+          if (exclude && exclusion(i,j,itype,jtype,mask,molecule)) continue;
+
+          const double delx = xtmp - x[j][0];
+          const double dely = ytmp - x[j][1];
+          const double delz = ztmp - x[j][2];
+          const double rsq = delx*delx + dely*dely + delz*delz;
+
+          if (rsq <= cutneighsq[itype][jtype]) {
+            if (molecular) {
+              const int which = find_special(special[i],nspecial[i],tag[j]);
+              if (which == 0) neighptr[n++] = j;
+              else if (domain->minimum_image_check(delx,dely,delz))
+                neighptr[n++] = j;
+              else if (which > 0) neighptr[n++] = j ^ (which << SBBITS);
+            } else neighptr[n++] = j;
+          }
+        }
+      }
+
+      ilist[i] = i;
+      firstneigh[i] = neighptr;
+      numneigh[i] = n;
+      ipage->vgot(n);
+      if (ipage->status()) noverflow++;
+    }
+  }
+
+  if (noverflow)
+    error->one(FLERR,"Neighbor list overflow, boost neigh_modify one");
+
+  list->inum = nlocal;
+  list->gnum = 0;
+}
@@ -36,6 +36,7 @@
 #include "update.h"
 #include "respa.h"
 #include "output.h"
+#include "timer.h"
 #include "citeme.h"
 #include "memory.h"
 #include "error.h"
@@ -52,6 +53,13 @@ using namespace LAMMPS_NS;
 
 enum{NSQ,BIN,MULTI};     // also in neigh_list.cpp
 
+#define NSKIN 8            // candidate skins are k/NSKIN of neighbor skin
+#define SKIN_SAMPLE 2      // build intervals timed per candidate
+#define SKIN_REVISIT 16    // re-time a neighboring candidate this often
+#define SKIN_MEMORY 0.618  // weight of old cost in smoothed estimate
+#define SKIN_SAFETY 2.0    // atoms may move this multiple of fastest one seen
+#define EVERY_MAX 20       // max check interval chosen by the tuner
+
 static const char cite_neigh_multi[] =
   "neighbor multi command:\n\n"
   "@Article{Intveld08,\n"
@@ -83,6 +91,21 @@ Neighbor::Neighbor(LAMMPS *lmp) : Pointers(lmp)
   binsizeflag = 0;
   build_once = 0;
   cluster_check = 0;
+  threadflag = 0;
+  cacheflag = 0;
+
+  skinflag = 0;
+  skin_list = 0.0;
+  every_auto = 1;
+  drift = 0.0;
+  tune_skip = 0;
+  iskin = NSKIN-1;
+  nsample = ndecide = 0;
+  sample_sum = 0.0;
+  tune_time = 0.0;
+  tune_step = -1;
+  skin_cost = new double[NSKIN];
+  for (int k = 0; k < NSKIN; k++) skin_cost[k] = 0.0;
 
   cutneighsq = NULL;
   cutneighghostsq = NULL;
@@ -99,6 +122,8 @@ Neighbor::Neighbor(LAMMPS *lmp) : Pointers(lmp)
 
   maxhead = 0;
   binhead = NULL;
+  maxhead_thread = 0;
+  binhead_thread = bintail_thread = NULL;
   maxbin = 0;
   bins = NULL;
 
@@ -135,6 +160,7 @@ Neighbor::Neighbor(LAMMPS *lmp) : Pointers(lmp)
   old_triclinic = 0;
   old_pgsize = pgsize;
   old_oneatom = oneatom;
+  old_threadflag = threadflag;
   old_nrequest = 0;
   old_requests = NULL;
 
@@ -148,6 +174,14 @@ Neighbor::Neighbor(LAMMPS *lmp) : Pointers(lmp)
   dihedrallist = NULL;
   maximproper = 0;
   improperlist = NULL;
+
+  TopoCache *caches[4] = {bond_cache,angle_cache,dihedral_cache,
+                          improper_cache};
+  for (int k = 0; k < 4; k++)
+    for (int m = 0; m < 2; m++) {
+      caches[k][m].nlocal = caches[k][m].maxlocal = caches[k][m].maxentry = 0;
+      caches[k][m].first = caches[k][m].image = NULL;
+    }
 }
 
 /* ---------------------------------------------------------------------- */
@@ -159,10 +193,13 @@ Neighbor::~Neighbor()
   delete [] cuttype;
   delete [] cuttypesq;
   delete [] fixchecklist;
+  delete [] skin_cost;
 
   memory->destroy(xhold);
 
   memory->destroy(binhead);
+  memory->destroy(binhead_thread);
+  memory->destroy(bintail_thread);
   memory->destroy(bins);
 
   memory->destroy(ex1_type);
@@ -194,6 +231,25 @@ Neighbor::~Neighbor()
   memory->destroy(anglelist);
   memory->destroy(dihedrallist);
   memory->destroy(improperlist);
+
+  topo_cache_destroy(bond_cache);
+  topo_cache_destroy(angle_cache);
+  topo_cache_destroy(dihedral_cache);
+  topo_cache_destroy(improper_cache);
+}
+
+/* ----------------------------------------------------------------------
+   free both buffers of a topology image cache
+------------------------------------------------------------------------- */
+
+void Neighbor::topo_cache_destroy(TopoCache *cache)
+{
+  for (int m = 0; m < 2; m++) {
+    memory->destroy(cache[m].first);
+    memory->destroy(cache[m].image);
+    cache[m].first = cache[m].image = NULL;
+    cache[m].nlocal = cache[m].maxlocal = cache[m].maxentry = 0;
+  }
 }
 
 /* ---------------------------------------------------------------------- */
@@ -234,7 +290,11 @@ void Neighbor::init()
   //   even if pair = NULL and no neighbor lists are used
   // cutneigh = force cutoff + skin if cutforce > 0, else cutneigh = 0
 
-  triggersq = 0.25*skin*skin;
+  // skin_list starts at full skin, is kept from a previous run if tuning,
+  // and is reset if the neighbor command lowered skin below it
+
+  if (!skinflag || skin_list <= 0.0 || skin_list > skin) skin_list = skin;
+  triggersq = 0.25*skin_list*skin_list;
   boxcheck = 0;
   if (domain->box_change && (domain->xperiodic || domain->yperiodic ||
                              (dimension == 3 && domain->zperiodic)))
@@ -248,32 +308,20 @@ void Neighbor::init()
     cuttypesq = new double[n+1];
   }
 
-  double cutoff,delta,cut;
-  cutneighmin = BIG;
-  cutneighmax = 0.0;
-
-  for (i = 1; i <= n; i++) {
-    cuttype[i] = cuttypesq[i] = 0.0;
-    for (j = 1; j <= n; j++) {
-      if (force->pair) cutoff = sqrt(force->pair->cutsq[i][j]);
-      else cutoff = 0.0;
-      if (cutoff > 0.0) delta = skin;
-      else delta = 0.0;
-      cut = cutoff + delta;
+  set_cutneigh();
 
-      cutneighsq[i][j] = cut*cut;
-      cuttype[i] = MAX(cuttype[i],cut);
-      cuttypesq[i] = MAX(cuttypesq[i],cut*cut);
-      cutneighmin = MIN(cutneighmin,cut);
-      cutneighmax = MAX(cutneighmax,cut);
+  // tuner restarts its timings every run
 
-      if (force->pair && force->pair->ghostneigh) {
-        cut = force->pair->cutghost[i][j] + skin;
-        cutneighghostsq[i][j] = cut*cut;
-      }
-    }
+  if (skinflag) {
+    every_auto = 1;
+    drift = 0.0;
+    tune_skip = 0;
+    iskin = NSKIN-1;
+    nsample = ndecide = 0;
+    sample_sum = 0.0;
+    for (i = 0; i < NSKIN; i++) skin_cost[i] = 0.0;
+    tune_step = -1;
   }
-  cutneighmaxsq = cutneighmax * cutneighmax;
 
   // check other classes that can induce reneighboring in decide()
   // don't check if build_once is set
@@ -348,8 +396,9 @@ void Neighbor::init()
   // xhold, bins, exclusion lists
 
   // free xhold and bins if not needed for this run
+  // skin tuning checks distances even if dist_check is not set
 
-  if (dist_check == 0) {
+  if (dist_check == 0 && skinflag == 0) {
     memory->destroy(xhold);
     maxhold = 0;
     xhold = NULL;
@@ -358,14 +407,17 @@ void Neighbor::init()
   if (style == NSQ) {
     memory->destroy(bins);
     memory->destroy(binhead);
-    maxbin = maxhead = 0;
+    memory->destroy(binhead_thread);
+    memory->destroy(bintail_thread);
+    maxbin = maxhead = maxhead_thread = 0;
     binhead = NULL;
+    binhead_thread = bintail_thread = NULL;
     bins = NULL;
   }
 
   // 1st time allocation of xhold and bins
 
-  if (dist_check) {
+  if (dist_check || skinflag) {
     if (maxhold == 0) {
       maxhold = atom->nmax;
       memory->create(xhold,maxhold,3,"neigh:xhold");
@@ -441,6 +493,7 @@ void Neighbor::init()
   if (triclinic != old_triclinic) same = 0;
   if (pgsize != old_pgsize) same = 0;
   if (oneatom != old_oneatom) same = 0;
+  if (threadflag != old_threadflag) same = 0;
   if (nrequest != old_nrequest) same = 0;
   else
     for (i = 0; i < nrequest; i++)
@@ -713,6 +766,7 @@ void Neighbor::init()
   requests = NULL;
   old_style = style;
   old_triclinic = triclinic;
+  old_threadflag = threadflag;
 
   // ------------------------------------------------------------------
   // topology lists
@@ -753,7 +807,7 @@ void Neighbor::init()
   int bond_off = 0;
   int angle_off = 0;
   for (i = 0; i < modify->nfix; i++)
-    if (strcmp(modify->fix[i]->style,"shake") == 0)
+    if (strncmp(modify->fix[i]->style,"shake",5) == 0)
       bond_off = angle_off = 1;
   if (force->bond && force->bond_match("quartic")) bond_off = 1;
 
@@ -793,18 +847,29 @@ void Neighbor::init()
 
   // set ptrs to topology build functions
 
+  // cached builds reuse partner images of previous builds in this run
+
   if (bond_off) bond_build = &Neighbor::bond_partial;
+  else if (cacheflag) bond_build = &Neighbor::bond_cached;
   else bond_build = &Neighbor::bond_all;
 
   if (angle_off) angle_build = &Neighbor::angle_partial;
+  else if (cacheflag) angle_build = &Neighbor::angle_cached;
   else angle_build = &Neighbor::angle_all;
 
   if (dihedral_off) dihedral_build = &Neighbor::dihedral_partial;
+  else if (cacheflag) dihedral_build = &Neighbor::dihedral_cached;
   else dihedral_build = &Neighbor::dihedral_all;
 
   if (improper_off) improper_build = &Neighbor::improper_partial;
+  else if (cacheflag) improper_build = &Neighbor::improper_cached;
   else improper_build = &Neighbor::improper_all;
 
+  topo_cache_destroy(bond_cache);
+  topo_cache_destroy(angle_cache);
+  topo_cache_destroy(dihedral_cache);
+  topo_cache_destroy(improper_cache);
+
   // set topology neighbor list counts to 0
   // in case all are turned off but potential is still defined
 
@@ -960,6 +1025,19 @@ void Neighbor::choose_build(int index, NeighRequest *rq)
         error->all(FLERR,"Neighbor multi not yet enabled for rRESPA");
     }
 
+    // swap in threaded versions of the plain binned builds
+
+    if (threadflag) {
+      if (pb == &Neighbor::half_bin_no_newton)
+        pb = &Neighbor::half_bin_no_newton_thread;
+      else if (pb == &Neighbor::half_bin_newton)
+        pb = &Neighbor::half_bin_newton_thread;
+      else if (pb == &Neighbor::half_bin_newton_tri)
+        pb = &Neighbor::half_bin_newton_tri_thread;
+      else if (pb == &Neighbor::full_bin)
+        pb = &Neighbor::full_bin_thread;
+    }
+
   // OMP versions of build methods
 
   } else {
@@ -1211,6 +1289,142 @@ void Neighbor::print_lists_of_lists()
   }
 }
 
+/* ----------------------------------------------------------------------
+   set neighbor cutoffs from force cutoffs
+   pairwise lists use skin_list, cutneighmax always uses full skin
+   since it sets the ghost cutoff in Comm and the bin size
+------------------------------------------------------------------------- */
+
+void Neighbor::set_cutneigh()
+{
+  int n = atom->ntypes;
+  double cutoff,delta,cut;
+  cutneighmin = BIG;
+  cutneighmax = 0.0;
+
+  for (int i = 1; i <= n; i++) {
+    cuttype[i] = cuttypesq[i] = 0.0;
+    for (int j = 1; j <= n; j++) {
+      if (force->pair) cutoff = sqrt(force->pair->cutsq[i][j]);
+      else cutoff = 0.0;
+      if (cutoff > 0.0) delta = skin_list;
+      else delta = 0.0;
+      cut = cutoff + delta;
+
+      cutneighsq[i][j] = cut*cut;
+      cuttype[i] = MAX(cuttype[i],cut);
+      cuttypesq[i] = MAX(cuttypesq[i],cut*cut);
+      cutneighmin = MIN(cutneighmin,cut);
+      if (cutoff > 0.0) cut = cutoff + skin;
+      cutneighmax = MAX(cutneighmax,cut);
+
+      if (force->pair && force->pair->ghostneigh) {
+        cut = force->pair->cutghost[i][j] + skin;
+        cutneighghostsq[i][j] = cut*cut;
+      }
+    }
+  }
+  cutneighmaxsq = cutneighmax * cutneighmax;
+}
+
+/* ----------------------------------------------------------------------
+   skin tuning only during dynamics, minimizers set their own criteria
+------------------------------------------------------------------------- */
+
+int Neighbor::tuning()
+{
+  return skinflag && update->whichflag == 1;
+}
+
+/* ----------------------------------------------------------------------
+   called at every build while tuning
+   cost per step of the interval since the last build is the
+   TIME_NEIGHBOR + TIME_PAIR increase, max over procs so all agree
+   every candidate skin is timed once, starting from the full skin,
+   then the cheapest is kept and one of its neighbors is re-timed
+   every SKIN_REVISIT decisions in case the optimum has drifted
+   candidates are bounded below by drift = fastest atom seen per step:
+     SKIN_SAFETY*drift may cover at most half the trigger distance
+   check interval is set so SKIN_SAFETY*drift in the steps between
+     checks covers at most 1/4 of the trigger distance of the chosen skin,
+     since check_distance() rebuilds early by that margin
+------------------------------------------------------------------------- */
+
+void Neighbor::tune_skin()
+{
+  double now = timer->array[TIME_NEIGHBOR] + timer->array[TIME_PAIR];
+  bigint nsteps = update->ntimestep - tune_step;
+
+  int kmin = 0;
+  while (kmin < NSKIN-1 && 0.25*skin*(kmin+1)/NSKIN < SKIN_SAFETY*drift)
+    kmin++;
+
+  // timer is reset at the start of a run, skip intervals spanning it
+  // skip intervals that ended in a dangerous build, see check_distance()
+
+  if (tune_step >= 0 && nsteps > 0 && now >= tune_time && !tune_skip) {
+    double cost = (now-tune_time) / nsteps;
+    double costall;
+    MPI_Allreduce(&cost,&costall,1,MPI_DOUBLE,MPI_MAX,world);
+    sample_sum += costall;
+    nsample++;
+
+    if (nsample == SKIN_SAMPLE) {
+      cost = sample_sum/nsample;
+      if (skin_cost[iskin] > 0.0)
+        skin_cost[iskin] = SKIN_MEMORY*skin_cost[iskin] +
+          (1.0-SKIN_MEMORY)*cost;
+      else skin_cost[iskin] = cost;
+      nsample = 0;
+      sample_sum = 0.0;
+
+      int ibest = -1;
+      for (int k = NSKIN-1; k >= kmin; k--) {
+        if (skin_cost[k] == 0.0) {
+          ibest = -1;
+          iskin = k;
+          break;
+        }
+        if (ibest < 0 || skin_cost[k] < skin_cost[ibest]) ibest = k;
+      }
+
+      if (ibest >= 0) {
+        ndecide++;
+        if (ndecide % SKIN_REVISIT == 0) {
+          int up = ibest+1 < NSKIN ? ibest+1 : ibest-1;
+          int down = ibest > kmin ? ibest-1 : ibest+1;
+          iskin = (ndecide/SKIN_REVISIT) % 2 ? up : down;
+          if (iskin < kmin || iskin >= NSKIN) iskin = ibest;
+        } else iskin = ibest;
+      }
+    }
+  }
+  tune_skip = 0;
+
+  // drop a candidate that became unsafe, with its partial samples
+
+  if (iskin < kmin) {
+    iskin = kmin;
+    nsample = 0;
+    sample_sum = 0.0;
+  }
+
+  double skin_new = skin*(iskin+1)/NSKIN;
+  if (skin_new != skin_list) {
+    skin_list = skin_new;
+    triggersq = 0.25*skin_list*skin_list;
+    set_cutneigh();
+  }
+
+  if (drift > 0.0) {
+    double steps = 1.0 + 0.125*skin_list / (SKIN_SAFETY*drift);
+    every_auto = static_cast<int> (MIN(steps,1.0*EVERY_MAX));
+  } else every_auto = 1;
+
+  tune_time = now;
+  tune_step = update->ntimestep;
+}
+
 /* ---------------------------------------------------------------------- */
 
 int Neighbor::decide()
@@ -1223,6 +1437,14 @@ int Neighbor::decide()
   }
 
   ago++;
+
+  // while tuning, check every every_auto steps, see tune_skin()
+
+  if (tuning()) {
+    if (ago % every_auto == 0) return check_distance();
+    return 0;
+  }
+
   if (ago >= delay && ago % every == 0) {
     if (build_once) return 0;
     if (dist_check == 0) return 1;
@@ -1256,7 +1478,7 @@ int Neighbor::check_distance()
       dely = bboxhi[1] - boxhi_hold[1];
       delz = bboxhi[2] - boxhi_hold[2];
       delta2 = sqrt(delx*delx + dely*dely + delz*delz);
-      delta = 0.5 * (skin - (delta1+delta2));
+      delta = 0.5 * (skin_list - (delta1+delta2));
       deltasq = delta*delta;
     } else {
       domain->box_corners();
@@ -1269,7 +1491,7 @@ int Neighbor::check_distance()
         if (delta > delta1) delta1 = delta;
         else if (delta > delta2) delta2 = delta;
       }
-      delta = 0.5 * (skin - (delta1+delta2));
+      delta = 0.5 * (skin_list - (delta1+delta2));
       deltasq = delta*delta;
     }
   } else deltasq = triggersq;
@@ -1279,12 +1501,35 @@ int Neighbor::check_distance()
   if (includegroup) nlocal = atom->nfirst;
 
   int flag = 0;
+  double maxsq = 0.0;
   for (int i = 0; i < nlocal; i++) {
     delx = x[i][0] - xhold[i][0];
     dely = x[i][1] - xhold[i][1];
     delz = x[i][2] - xhold[i][2];
     rsq = delx*delx + dely*dely + delz*delz;
     if (rsq > deltasq) flag = 1;
+    if (rsq > maxsq) maxsq = rsq;
+  }
+
+  // while tuning, also rebuild if the fastest atom seen so far,
+  //   with a margin, could pass the trigger distance before the next check
+  // an atom that passed it between checks, or on the 1st step,
+  //   makes a dangerous build, whose interval is not used to time the skin
+
+  if (tuning()) {
+    double dmax;
+    maxsq = sqrt(maxsq);
+    MPI_Allreduce(&maxsq,&dmax,1,MPI_DOUBLE,MPI_MAX,world);
+    drift = MAX(drift,dmax/ago);
+    double trigger = sqrt(deltasq);
+    if (dmax > trigger) {
+      if (every_auto > 1 || ago == 1) {
+        ndanger++;
+        tune_skip = 1;
+      }
+      return 1;
+    }
+    return dmax + SKIN_SAFETY*drift*(every_auto-1) > trigger;
   }
 
   int flagall;
@@ -1303,13 +1548,15 @@ void Neighbor::build(int topoflag)
 {
   int i;
 
+  if (tuning()) tune_skin();
+
   ago = 0;
   ncalls++;
   lastcall = update->ntimestep;
 
   // store current atom positions and box size if needed
 
-  if (dist_check) {
+  if (dist_check || skinflag) {
     double **x = atom->x;
     int nlocal = atom->nlocal;
     if (includegroup) nlocal = atom->nfirst;
@@ -1343,6 +1590,10 @@ void Neighbor::build(int topoflag)
     }
   }
 
+  // refresh SoA mirror of owned and ghost atoms after borders()
+
+  if (atom->soaflag) atom->update_soa();
+
   // if any lists store neighbors of ghosts:
   // invoke grow() if nlocal+nghost exceeds previous list size
   // else only invoke grow() if nlocal exceeds previous list size
@@ -1713,6 +1964,24 @@ void Neighbor::modify_params(int narg, char **arg)
       else if (strcmp(arg[iarg+1],"no") == 0) cluster_check = 0;
       else error->all(FLERR,"Illegal neigh_modify command");
       iarg += 2;
+    } else if (strcmp(arg[iarg],"skin") == 0) {
+      if (iarg+2 > narg) error->all(FLERR,"Illegal neigh_modify command");
+      if (strcmp(arg[iarg+1],"auto") == 0) skinflag = 1;
+      else if (strcmp(arg[iarg+1],"fixed") == 0) skinflag = 0;
+      else error->all(FLERR,"Illegal neigh_modify command");
+      iarg += 2;
+    } else if (strcmp(arg[iarg],"thread") == 0) {
+      if (iarg+2 > narg) error->all(FLERR,"Illegal neigh_modify command");
+      if (strcmp(arg[iarg+1],"yes") == 0) threadflag = 1;
+      else if (strcmp(arg[iarg+1],"no") == 0) threadflag = 0;
+      else error->all(FLERR,"Illegal neigh_modify command");
+      iarg += 2;
+    } else if (strcmp(arg[iarg],"cache") == 0) {
+      if (iarg+2 > narg) error->all(FLERR,"Illegal neigh_modify command");
+      if (strcmp(arg[iarg+1],"yes") == 0) cacheflag = 1;
+      else if (strcmp(arg[iarg+1],"no") == 0) cacheflag = 0;
+      else error->all(FLERR,"Illegal neigh_modify command");
+      iarg += 2;
 
     } else if (strcmp(arg[iarg],"include") == 0) {
       if (iarg+2 > narg) error->all(FLERR,"Illegal neigh_modify command");
@@ -1940,6 +2209,7 @@ bigint Neighbor::memory_usage()
   if (style != NSQ) {
     bytes += memory->usage(bins,maxbin);
     bytes += memory->usage(binhead,maxhead);
+    bytes += 2*memory->usage(binhead_thread,maxhead_thread);
   }
 
   for (int i = 0; i < nlist; i++) bytes += lists[i]->memory_usage();
@@ -1949,6 +2219,14 @@ bigint Neighbor::memory_usage()
   bytes += memory->usage(dihedrallist,maxdihedral,5);
   bytes += memory->usage(improperlist,maximproper,5);
 
+  TopoCache *caches[4] = {bond_cache,angle_cache,dihedral_cache,
+                          improper_cache};
+  for (int k = 0; k < 4; k++)
+    for (int m = 0; m < 2; m++) {
+      bytes += memory->usage(caches[k][m].first,caches[k][m].maxlocal);
+      bytes += memory->usage(caches[k][m].image,caches[k][m].maxentry);
+    }
+
   return bytes;
 }
 
@@ -31,9 +31,12 @@ class Neighbor : protected Pointers {
   int oneatom;                     // max # of neighbors for one atom
   int includegroup;                // only build pairwise lists for this group
   int build_once;                  // 1 if only build lists once per run
+  int threadflag;                  // 1 if binned builds use OpenMP threads
+  int cacheflag;                   // 1 if topology builds reuse last images
   int cudable;                     // GPU <-> CPU communication flag for CUDA
 
   double skin;                     // skin distance
+  int skinflag;                    // 1 if skin and every are tuned at runtime
   double cutneighmin;              // min neighbor cutoff for all type pairs
   double cutneighmax;              // max neighbor cutoff for all type pairs
   double *cuttype;                 // for each type, max neigh cut w/ others
@@ -51,6 +54,7 @@ class Neighbor : protected Pointers {
   int old_triclinic;
   int old_pgsize;
   int old_oneatom;
+  int old_threadflag;
   class NeighRequest **old_requests;
 
   int nlist;                       // pairwise neighbor lists
@@ -106,6 +110,25 @@ class Neighbor : protected Pointers {
   double triggersq;                // trigger = build when atom moves this dist
   int cluster_check;               // 1 if check bond/angle/etc satisfies minimg
 
+  // runtime tuning of skin and check interval, neigh_modify skin auto
+  // ghost cutoff and bins always use the full skin, lists use skin_list
+
+  double skin_list;                // skin of current lists, <= skin
+  int every_auto;                  // check interval chosen by the tuner
+  double drift;                    // max displacement per step seen in checks
+  int tune_skip;                   // 1 if last interval ended dangerously
+  int iskin;                       // index of the skin being timed
+  int nsample;                     // # of build intervals timed for iskin
+  int ndecide;                     // # of skin choices after all were timed
+  double sample_sum;               // sum of their cost per step
+  double *skin_cost;               // smoothed cost per step of each skin
+  double tune_time;                // neighbor + pair time at last build
+  bigint tune_step;                // timestep of last build
+
+  int tuning();                    // 1 if tuner is active in this run
+  void set_cutneigh();             // set cutneighsq etc from skin_list
+  void tune_skin();                // time last interval, pick next skin
+
   double **xhold;                      // atom coords at last neighbor build
   int maxhold;                         // size of xhold array
   int boxcheck;                        // 1 if need to store box size
@@ -119,6 +142,10 @@ class Neighbor : protected Pointers {
   int *binhead;                    // ptr to 1st atom in each bin
   int maxhead;                     // size of binhead array
 
+  int *binhead_thread;             // per-thread bin heads and tails
+  int *bintail_thread;             // used by bin_atoms_thread()
+  int maxhead_thread;              // size of per-thread bin arrays
+
   int mbins;                       // # of local bins and offset
   int mbinx,mbiny,mbinz;
   int mbinxlo,mbinylo,mbinzlo;
@@ -171,6 +198,7 @@ class Neighbor : protected Pointers {
   int *slist;                  // lists to grow stencil arrays every reneigh
 
   void bin_atoms();                     // bin all atoms
+  void bin_atoms_thread();              // ditto with OpenMP threads
   double bin_distance(int, int, int);   // distance between binx
   int coord2bin(double *);              // mapping atom coord to a bin
   int coord2bin(double *, int &, int &, int&); // ditto
@@ -205,6 +233,11 @@ class Neighbor : protected Pointers {
   void full_bin_ghost(class NeighList *);
   void full_multi(class NeighList *);
 
+  void half_bin_no_newton_thread(class NeighList *);
+  void half_bin_newton_thread(class NeighList *);
+  void half_bin_newton_tri_thread(class NeighList *);
+  void full_bin_thread(class NeighList *);
+
   void half_from_full_no_newton(class NeighList *);
   void half_from_full_newton(class NeighList *);
   void skip_from(class NeighList *);
@@ -266,21 +299,41 @@ class Neighbor : protected Pointers {
   BondPtr bond_build;                 // ptr to bond list functions
   virtual void bond_all();                    // bond list with all bonds
   virtual void bond_partial();                // exclude certain bonds
+  virtual void bond_cached();                 // all bonds, reuse last images
   virtual void bond_check();
 
   BondPtr angle_build;                // ptr to angle list functions
   virtual void angle_all();                   // angle list with all angles
   virtual void angle_partial();               // exclude certain angles
+  virtual void angle_cached();                // all angles, reuse last images
   virtual void angle_check();
 
   BondPtr dihedral_build;             // ptr to dihedral list functions
   virtual void dihedral_all();                // dihedral list with all dihedrals
   virtual void dihedral_partial();            // exclude certain dihedrals
+  virtual void dihedral_cached();             // all dihedrals, reuse images
   virtual void dihedral_check(int, int **);
 
   BondPtr improper_build;             // ptr to improper list functions
   virtual void improper_all();                // improper list with all impropers
   virtual void improper_partial();            // exclude certain impropers
+  virtual void improper_cached();             // all impropers, reuse images
+
+  // partner images of each owned atom's topology entries, neigh_modify cache
+  // [0] = images of last build, [1] = filled by current build
+
+  struct TopoCache {
+    int nlocal;                       // # of owned atoms at build
+    int maxlocal;                     // size of first
+    int *first;                       // 1st entry of each owned atom
+    int maxentry;                     // size of image
+    int *image;                       // local index of each partner
+  };
+  TopoCache bond_cache[2],angle_cache[2],dihedral_cache[2],improper_cache[2];
+
+  void topo_cached(TopoCache *, int *, int, int ***, int **, int,
+                   int **&, int &, int &, const char *);
+  void topo_cache_destroy(TopoCache *);
 
   // find_special: determine if atom j is in special list of atom i
   // if it is not, return 0
@@ -409,4 +462,9 @@ E: Neigh_modify exclude molecule requires atom attribute molecule
 
 Self-explanatory.
 
+E: Too many topology list entries on proc
+
+The # of bond, angle, dihedral, or improper partners of owned atoms
+cached by neigh_modify cache yes exceeds the size of a 32-bit integer.
+
 */
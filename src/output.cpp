@@ -112,7 +112,10 @@ Output::~Output()
   for (int i = 0; i < ndump; i++) delete [] var_dump[i];
   memory->sfree(var_dump);
   memory->destroy(ivar_dump);
-  for (int i = 0; i < ndump; i++) delete dump[i];
+  for (int i = 0; i < ndump; i++) {
+    dump[i]->drain();
+    delete dump[i];
+  }
   memory->sfree(dump);
 
   delete [] restart1;
@@ -615,6 +618,7 @@ void Output::delete_dump(char *id)
     if (strcmp(id,dump[idump]->id) == 0) break;
   if (idump == ndump) error->all(FLERR,"Could not find undump ID");
 
+  dump[idump]->drain();
   delete dump[idump];
   delete [] var_dump[idump];
 
@@ -61,6 +61,12 @@ Pair::Pair(LAMMPS *lmp) : Pointers(lmp)
   no_virial_fdotr_compute = 0;
   writedata = 0;
   ghostneigh = 0;
+  soa_flag = 0;
+  split_flag = 0;
+
+  nsplit_all = nsplit_bulk = maxsplit = 0;
+  split_ilist = NULL;
+  split_ncalls = -1;
 
   nextra = 0;
   pvector = NULL;
@@ -99,6 +105,7 @@ Pair::~Pair()
 {
   memory->destroy(eatom);
   memory->destroy(vatom);
+  memory->destroy(split_ilist);
 }
 
 /* ----------------------------------------------------------------------
@@ -665,6 +672,113 @@ void Pair::compute_dummy(int eflag, int vflag)
   else evflag = 0;
 }
 
+/* ----------------------------------------------------------------------
+   compute() restricted to bulk atoms, whose neighbors are all owned,
+     so it can run before ghost coords of this step have arrived
+   default for CPU styles that set split_flag, such a style must only
+     loop over list->inum atoms of list->ilist in compute()
+   per-atom energy and virial are not supported, caller checks that
+   global energy and virial are kept and added in compute_border()
+------------------------------------------------------------------------- */
+
+void Pair::compute_bulk(int eflag, int vflag)
+{
+  if (split_ncalls != neighbor->ncalls || nsplit_all != list->inum)
+    split_list();
+
+  // virial via F dot r needs forces of all atoms, done in compute_border()
+
+  int vflag_bulk = vflag;
+  if (vflag % 4 == 2 && no_virial_fdotr_compute == 0) vflag_bulk = 0;
+
+  int inum = list->inum;
+  int *ilist = list->ilist;
+  list->inum = nsplit_bulk;
+  list->ilist = split_ilist;
+  compute(eflag,vflag_bulk);
+  list->inum = inum;
+  list->ilist = ilist;
+
+  split_eflag = eflag % 2;
+  split_vflag = vflag_bulk % 4;
+  if (split_eflag) {
+    split_eng_vdwl = eng_vdwl;
+    split_eng_coul = eng_coul;
+  }
+  if (split_vflag)
+    for (int i = 0; i < 6; i++) split_virial[i] = virial[i];
+}
+
+/* ----------------------------------------------------------------------
+   compute() restricted to border atoms, after compute_bulk()
+------------------------------------------------------------------------- */
+
+void Pair::compute_border(int eflag, int vflag)
+{
+  int inum = list->inum;
+  int *ilist = list->ilist;
+  list->inum = nsplit_all - nsplit_bulk;
+  list->ilist = split_ilist + nsplit_bulk;
+  compute(eflag,vflag);
+  list->inum = inum;
+  list->ilist = ilist;
+
+  if (split_eflag) {
+    eng_vdwl += split_eng_vdwl;
+    eng_coul += split_eng_coul;
+  }
+  if (split_vflag)
+    for (int i = 0; i < 6; i++) virial[i] += split_virial[i];
+}
+
+/* ----------------------------------------------------------------------
+   order atoms of list into bulk atoms, then border atoms
+   a border atom has at least one ghost neighbor
+   done once per neighbor list build
+------------------------------------------------------------------------- */
+
+void Pair::split_list()
+{
+  int inum = list->inum;
+  int *ilist = list->ilist;
+  int *numneigh = list->numneigh;
+  int **firstneigh = list->firstneigh;
+  int nlocal = atom->nlocal;
+
+  if (inum > maxsplit) {
+    maxsplit = MAX(atom->nmax,inum);
+    memory->destroy(split_ilist);
+    memory->create(split_ilist,maxsplit,"pair:split_ilist");
+  }
+
+  int nbulk = 0;
+  int nborder = 0;
+  int *border = split_ilist + inum;
+
+  for (int ii = 0; ii < inum; ii++) {
+    int i = ilist[ii];
+    int *jlist = firstneigh[i];
+    int jnum = numneigh[i];
+    int jj;
+    for (jj = 0; jj < jnum; jj++)
+      if ((jlist[jj] & NEIGHMASK) >= nlocal) break;
+    if (jj == jnum) split_ilist[nbulk++] = i;
+    else border[-(++nborder)] = i;
+  }
+
+  // border atoms were stored from the end backwards, restore their order
+
+  for (int k = 0; k < nborder/2; k++) {
+    int tmp = split_ilist[nbulk+k];
+    split_ilist[nbulk+k] = split_ilist[inum-1-k];
+    split_ilist[inum-1-k] = tmp;
+  }
+
+  nsplit_all = inum;
+  nsplit_bulk = nbulk;
+  split_ncalls = neighbor->ncalls;
+}
+
 /* ----------------------------------------------------------------------
    setup for energy, virial computation
    see integrate::ev_set() for values of eflag (0-3) and vflag (0-6)
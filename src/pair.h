@@ -28,6 +28,7 @@ class Pair : protected Pointers {
   friend class FixGPU;
   friend class FixOMP;
   friend class ThrOMP;
+  friend class ThrAccum;
 
  public:
   double eng_vdwl,eng_coul;      // accumulated energies
@@ -51,6 +52,7 @@ class Pair : protected Pointers {
   int no_virial_fdotr_compute;   // 1 if does not invoke virial_fdotr_compute()
   int writedata;                 // 1 if writes coeffs to data file
   int ghostneigh;                // 1 if pair style needs neighbors of ghosts
+  int soa_flag;                  // 1 if pair style reads Atom SoA mirror of x,v
   double **cutghost;             // cutoff for each ghost pair
 
   int ewaldflag;                 // 1 if compatible with Ewald solver
@@ -128,8 +130,8 @@ class Pair : protected Pointers {
   // general child-class methods
 
   virtual void compute(int, int) = 0;
-  virtual void compute_bulk(int, int) {}
-  virtual void compute_border(int, int) {}
+  virtual void compute_bulk(int, int);
+  virtual void compute_border(int, int);
   virtual void compute_inner() {}
   virtual void compute_middle() {}
   virtual void compute_outer(int, int) {}
@@ -198,6 +200,17 @@ class Pair : protected Pointers {
   int vflag_fdotr;
   int maxeatom,maxvatom;
 
+  // split of list into bulk and border atoms for compute_bulk/border()
+
+  int nsplit_all,nsplit_bulk;          // # of atoms in list, in bulk
+  int maxsplit;
+  int *split_ilist;                    // bulk atoms of ilist, then border
+  bigint split_ncalls;                 // neighbor build the split is for
+  int split_eflag,split_vflag;         // what compute_bulk() tallied
+  double split_eng_vdwl,split_eng_coul,split_virial[6];
+
+  void split_list();
+
   virtual void ev_setup(int, int);
   void ev_unset();
   void ev_tally_full(int, double, double, double, double, double, double);
@@ -18,6 +18,7 @@
 #include "math.h"
 #include "stdio.h"
 #include "stdlib.h"
+#include "string.h"
 #include "pair_dpd.h"
 #include "atom.h"
 #include "atom_vec.h"
@@ -27,6 +28,7 @@
 #include "neighbor.h"
 #include "neigh_list.h"
 #include "random_mars.h"
+#include "random_tea.h"
 #include "memory.h"
 #include "error.h"
 
@@ -34,11 +36,16 @@ using namespace LAMMPS_NS;
 
 #define EPSILON 1.0e-10
 
+enum{MARS,TEA};
+
 /* ---------------------------------------------------------------------- */
 
 PairDPD::PairDPD(LAMMPS *lmp) : Pair(lmp)
 {
   random = NULL;
+  rngflag = MARS;
+  nmax_key = 0;
+  rkey = NULL;
 }
 
 /* ---------------------------------------------------------------------- */
@@ -56,6 +63,7 @@ PairDPD::~PairDPD()
   }
 
   if (random) delete random;
+  memory->destroy(rkey);
 }
 
 /* ---------------------------------------------------------------------- */
@@ -86,6 +94,8 @@ void PairDPD::compute(int eflag, int vflag)
   numneigh = list->numneigh;
   firstneigh = list->firstneigh;
 
+  if (rngflag == TEA) setup_keys();
+
   // loop over neighbors of my atoms
 
   for (ii = 0; ii < inum; ii++) {
@@ -120,7 +130,8 @@ void PairDPD::compute(int eflag, int vflag)
         delvz = vztmp - v[j][2];
         dot = delx*delvx + dely*delvy + delz*delvz;
         wd = 1.0 - r/cut[itype][jtype];
-        randnum = random->gaussian();
+        if (rngflag == TEA) randnum = RandomTEA::gaussian<4>(rkey[i],rkey[j]);
+        else randnum = random->gaussian();
 
         // conservative force = a0 * wd
         // drag force = -gamma * wd^2 * (delx dot delv) / r
@@ -157,6 +168,32 @@ void PairDPD::compute(int eflag, int vflag)
   if (vflag_fdotr) virial_fdotr_compute();
 }
 
+/* ----------------------------------------------------------------------
+   per-atom keys of the stateless TEA generator for this timestep
+   random number of pair IJ is a hash of the keys of I and J,
+   so it does not depend on neighbor order, thread or processor count
+------------------------------------------------------------------------- */
+
+void PairDPD::setup_keys()
+{
+  int nall = atom->nlocal + atom->nghost;
+  if (nall > nmax_key) {
+    memory->destroy(rkey);
+    nmax_key = atom->nmax;
+    memory->create(rkey,nmax_key,"pair:rkey");
+  }
+
+  int *tag = atom->tag;
+  unsigned int seed_now =
+    RandomTEA::premix<64>(seed,(unsigned int) update->ntimestep);
+
+#if defined(_OPENMP)
+#pragma omp parallel for default(shared) schedule(static)
+#endif
+  for (int i = 0; i < nall; i++)
+    rkey[i] = RandomTEA::atom_key(tag[i],seed_now);
+}
+
 /* ----------------------------------------------------------------------
    allocate all arrays
 ------------------------------------------------------------------------- */
@@ -185,12 +222,27 @@ void PairDPD::allocate()
 
 void PairDPD::settings(int narg, char **arg)
 {
-  if (narg != 3) error->all(FLERR,"Illegal pair_style command");
+  if (narg != 3 && narg != 5) error->all(FLERR,"Illegal pair_style command");
 
   temperature = force->numeric(FLERR,arg[0]);
   cut_global = force->numeric(FLERR,arg[1]);
   seed = force->inumeric(FLERR,arg[2]);
 
+  // optional keyword selects the random number generator
+
+  rngflag = MARS;
+  if (narg == 5) {
+    if (strcmp(arg[3],"rng") != 0)
+      error->all(FLERR,"Illegal pair_style command");
+    if (strcmp(arg[4],"mars") == 0) rngflag = MARS;
+    else if (strcmp(arg[4],"tea") == 0) rngflag = TEA;
+    else error->all(FLERR,"Illegal pair_style command");
+  }
+
+  // only stateless random numbers do not depend on the order of pairs
+
+  split_flag = (rngflag == TEA);
+
   // initialize Marsaglia RNG with processor-unique seed
 
   if (seed <= 0) error->all(FLERR,"Illegal pair_style command");
@@ -327,14 +379,18 @@ void PairDPD::read_restart(FILE *fp)
 
 /* ----------------------------------------------------------------------
    proc 0 writes to restart file
+   layout is unchanged, rngflag = TEA is stored as mix_flag < 0
 ------------------------------------------------------------------------- */
 
 void PairDPD::write_restart_settings(FILE *fp)
 {
+  int mix_rng = mix_flag;
+  if (rngflag == TEA) mix_rng = -1 - mix_flag;
+
   fwrite(&temperature,sizeof(double),1,fp);
   fwrite(&cut_global,sizeof(double),1,fp);
   fwrite(&seed,sizeof(int),1,fp);
-  fwrite(&mix_flag,sizeof(int),1,fp);
+  fwrite(&mix_rng,sizeof(int),1,fp);
 }
 
 /* ----------------------------------------------------------------------
@@ -354,6 +410,14 @@ void PairDPD::read_restart_settings(FILE *fp)
   MPI_Bcast(&seed,1,MPI_INT,0,world);
   MPI_Bcast(&mix_flag,1,MPI_INT,0,world);
 
+  // restart files without the marker use the Marsaglia RNG
+
+  if (mix_flag < 0) {
+    rngflag = TEA;
+    mix_flag = -1 - mix_flag;
+  } else rngflag = MARS;
+  split_flag = (rngflag == TEA);
+
   // initialize Marsaglia RNG with processor-unique seed
   // same seed that pair_style command initially specified
 
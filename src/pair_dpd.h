@@ -47,7 +47,12 @@ class PairDPD : public Pair {
   double **sigma;
   class RanMars *random;
 
+  int rngflag;                  // MARS = per-proc stream, TEA = pair hash
+  int nmax_key;
+  unsigned int *rkey;           // per-atom TEA key of current step
+
   void allocate();
+  void setup_keys();
 };
 
 }
@@ -0,0 +1,239 @@
+/* ----------------------------------------------------------------------
+   LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+   http://lammps.sandia.gov, Sandia National Laboratories
+   Steve Plimpton, sjplimp@sandia.gov
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+
+   See the README file in the top-level LAMMPS directory.
+------------------------------------------------------------------------- */
+
+/* ----------------------------------------------------------------------
+   threaded variant of pair_style dpd with the stateless TEA generator
+   OpenMP threads over a full neighbor list, each I only updates itself,
+   so forces need no reduction between threads and the result does not
+   depend on the number of threads
+   coords and velocities are read from the SoA mirror in Atom
+------------------------------------------------------------------------- */
+
+#include "math.h"
+#include "stdio.h"
+#include "stdlib.h"
+#include "pair_dpd_fast.h"
+#include "atom.h"
+#include "comm.h"
+#include "update.h"
+#include "force.h"
+#include "neighbor.h"
+#include "neigh_list.h"
+#include "neigh_request.h"
+#include "random_tea.h"
+#include "error.h"
+
+using namespace LAMMPS_NS;
+
+#define EPSILON_SQ 1.0e-20
+
+enum{MARS,TEA};                 // same as in pair_dpd.cpp
+
+/* ---------------------------------------------------------------------- */
+
+PairDPDFast::PairDPDFast(LAMMPS *lmp) : PairDPD(lmp)
+{
+  no_virial_fdotr_compute = 1;
+  soa_flag = 1;
+  rngflag = TEA;
+  split_flag = 1;
+}
+
+/* ---------------------------------------------------------------------- */
+
+void PairDPDFast::compute(int eflag, int vflag)
+{
+  if (eflag || vflag) ev_setup(eflag,vflag);
+  else evflag = vflag_fdotr = 0;
+
+  setup_keys();
+
+  if (evflag) {
+    if (eflag) eval<1,1>();
+    else eval<1,0>();
+  } else eval<0,0>();
+}
+
+/* ---------------------------------------------------------------------- */
+
+template <int EVFLAG, int EFLAG>
+void PairDPDFast::eval()
+{
+  const double *xs = atom->xsoa[0], *ys = atom->xsoa[1], *zs = atom->xsoa[2];
+  const double *vxs = atom->vsoa[0], *vys = atom->vsoa[1], *vzs = atom->vsoa[2];
+  double **f = atom->f;
+  int *type = atom->type;
+  double *special_lj = force->special_lj;
+  double dtinvsqrt = 1.0/sqrt(update->dt);
+  const unsigned int *key = rkey;
+
+  int inum = list->inum;
+  int *ilist = list->ilist;
+  int *numneigh = list->numneigh;
+  int **firstneigh = list->firstneigh;
+
+  double evdwl_sum = 0.0;
+  double v0 = 0.0, v1 = 0.0, v2 = 0.0, v3 = 0.0, v4 = 0.0, v5 = 0.0;
+
+#if defined(_OPENMP)
+#pragma omp parallel for default(shared) schedule(static) \
+  reduction(+:evdwl_sum,v0,v1,v2,v3,v4,v5)
+#endif
+  for (int ii = 0; ii < inum; ii++) {
+    const int i = ilist[ii];
+    const double xtmp = xs[i];
+    const double ytmp = ys[i];
+    const double ztmp = zs[i];
+    const double vxtmp = vxs[i];
+    const double vytmp = vys[i];
+    const double vztmp = vzs[i];
+    const unsigned int keyi = key[i];
+    const int itype = type[i];
+    const double *cutsqi = cutsq[itype];
+    const double *cuti = cut[itype];
+    const double *a0i = a0[itype];
+    const double *gammai = gamma[itype];
+    const double *sigmai = sigma[itype];
+    const int *jlist = firstneigh[i];
+    const int jnum = numneigh[i];
+
+    double fx = 0.0, fy = 0.0, fz = 0.0;
+    double ei = 0.0;
+    double vi0 = 0.0, vi1 = 0.0, vi2 = 0.0, vi3 = 0.0, vi4 = 0.0, vi5 = 0.0;
+
+    // no data dependence between J, lanes are only masked by the cutoff
+
+#if defined(_OPENMP) && _OPENMP >= 201307
+#pragma omp simd reduction(+:fx,fy,fz,ei,vi0,vi1,vi2,vi3,vi4,vi5)
+#endif
+    for (int jj = 0; jj < jnum; jj++) {
+      int j = jlist[jj];
+      const double factor_dpd = special_lj[sbmask(j)];
+      j &= NEIGHMASK;
+
+      const double delx = xtmp - xs[j];
+      const double dely = ytmp - ys[j];
+      const double delz = ztmp - zs[j];
+      const double rsq = delx*delx + dely*dely + delz*delz;
+      const int jtype = type[j];
+
+      // r can be 0.0 in DPD systems
+
+      if (rsq < cutsqi[jtype] && rsq > EPSILON_SQ) {
+        const double r = sqrt(rsq);
+        const double rinv = 1.0/r;
+        const double delvx = vxtmp - vxs[j];
+        const double delvy = vytmp - vys[j];
+        const double delvz = vztmp - vzs[j];
+        const double dot = delx*delvx + dely*delvy + delz*delvz;
+        const double wd = 1.0 - r/cuti[jtype];
+        const double randnum = RandomTEA::gaussian<4>(keyi,key[j]);
+
+        double fpair = a0i[jtype]*wd;
+        fpair -= gammai[jtype]*wd*wd*dot*rinv;
+        fpair += sigmai[jtype]*wd*randnum*dtinvsqrt;
+        fpair *= factor_dpd*rinv;
+
+        fx += delx*fpair;
+        fy += dely*fpair;
+        fz += delz*fpair;
+
+        // each pair is visited from both sides, tally half
+
+        if (EVFLAG) {
+          if (EFLAG) ei += 0.25*a0i[jtype]*cuti[jtype]*wd*wd*factor_dpd;
+          vi0 += 0.5*delx*delx*fpair;
+          vi1 += 0.5*dely*dely*fpair;
+          vi2 += 0.5*delz*delz*fpair;
+          vi3 += 0.5*delx*dely*fpair;
+          vi4 += 0.5*delx*delz*fpair;
+          vi5 += 0.5*dely*delz*fpair;
+        }
+      }
+    }
+
+    f[i][0] += fx;
+    f[i][1] += fy;
+    f[i][2] += fz;
+
+    if (EVFLAG) {
+      if (EFLAG) {
+        evdwl_sum += ei;
+        if (eflag_atom) eatom[i] += ei;
+      }
+      if (vflag_either) {
+        v0 += vi0; v1 += vi1; v2 += vi2;
+        v3 += vi3; v4 += vi4; v5 += vi5;
+        if (vflag_atom) {
+          vatom[i][0] += vi0;
+          vatom[i][1] += vi1;
+          vatom[i][2] += vi2;
+          vatom[i][3] += vi3;
+          vatom[i][4] += vi4;
+          vatom[i][5] += vi5;
+        }
+      }
+    }
+  }
+
+  if (EFLAG && eflag_global) eng_vdwl += evdwl_sum;
+  if (EVFLAG && vflag_global) {
+    virial[0] += v0;
+    virial[1] += v1;
+    virial[2] += v2;
+    virial[3] += v3;
+    virial[4] += v4;
+    virial[5] += v5;
+  }
+}
+
+/* ----------------------------------------------------------------------
+   global settings, same arguments as pair_style dpd
+   the TEA generator is always used
+------------------------------------------------------------------------- */
+
+void PairDPDFast::settings(int narg, char **arg)
+{
+  if (narg != 3) error->all(FLERR,"Illegal pair_style command");
+  PairDPD::settings(narg,arg);
+  rngflag = TEA;
+  split_flag = 1;
+}
+
+/* ----------------------------------------------------------------------
+   proc 0 reads from restart file, bcasts
+   the TEA generator is always used, also for files written by pair dpd
+------------------------------------------------------------------------- */
+
+void PairDPDFast::read_restart_settings(FILE *fp)
+{
+  PairDPD::read_restart_settings(fp);
+  rngflag = TEA;
+  split_flag = 1;
+}
+
+/* ----------------------------------------------------------------------
+   init specific to this pair style
+------------------------------------------------------------------------- */
+
+void PairDPDFast::init_style()
+{
+  if (comm->ghost_velocity == 0)
+    error->all(FLERR,"Pair dpd/fast requires ghost atoms store velocity");
+
+  // full list, every pair is computed twice with the same random number
+
+  int irequest = neighbor->request(this);
+  neighbor->requests[irequest]->half = 0;
+  neighbor->requests[irequest]->full = 1;
+}
@@ -0,0 +1,57 @@
+/* -*- c++ -*- ----------------------------------------------------------
+   LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+   http://lammps.sandia.gov, Sandia National Laboratories
+   Steve Plimpton, sjplimp@sandia.gov
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+
+   See the README file in the top-level LAMMPS directory.
+------------------------------------------------------------------------- */
+
+#ifdef PAIR_CLASS
+
+PairStyle(dpd/fast,PairDPDFast)
+
+#else
+
+#ifndef LMP_PAIR_DPD_FAST_H
+#define LMP_PAIR_DPD_FAST_H
+
+#include "pair_dpd.h"
+
+namespace LAMMPS_NS {
+
+class PairDPDFast : public PairDPD {
+ public:
+  PairDPDFast(class LAMMPS *);
+  virtual ~PairDPDFast() {}
+  virtual void compute(int, int);
+  virtual void settings(int, char **);
+  void init_style();
+  void read_restart_settings(FILE *);
+
+ protected:
+  template <int EVFLAG, int EFLAG> void eval();
+};
+
+}
+
+#endif
+#endif
+
+/* ERROR/WARNING messages:
+
+E: Illegal ... command
+
+Self-explanatory.  Check the input script syntax and compare to the
+documentation for the command.  You can use -echo screen as a
+command-line option when running LAMMPS to see the offending line.
+
+E: Pair dpd/fast requires ghost atoms store velocity
+
+Use the communicate vel yes command to enable this.
+
+*/
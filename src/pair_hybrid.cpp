@@ -278,6 +278,7 @@ void PairHybrid::flags()
   // manybody_flag = 1 if any sub-style is set
   // no_virial_fdotr_compute = 1 if any sub-style is set
   // ghostneigh = 1 if any sub-style is set
+  // soa_flag = 1 if any sub-style is set
   // ewaldflag, pppmflag, msmflag, dispersionflag, tip4pflag = 1
   //   if any sub-style is set
 
@@ -288,6 +289,7 @@ void PairHybrid::flags()
     if (styles[m]->manybody_flag) manybody_flag = 1;
     if (styles[m]->no_virial_fdotr_compute) no_virial_fdotr_compute = 1;
     if (styles[m]->ghostneigh) ghostneigh = 1;
+    if (styles[m]->soa_flag) soa_flag = 1;
     if (styles[m]->ewaldflag) ewaldflag = 1;
     if (styles[m]->pppmflag) pppmflag = 1;
     if (styles[m]->msmflag) msmflag = 1;
@@ -42,6 +42,7 @@ PairLJCut::PairLJCut(LAMMPS *lmp) : Pair(lmp)
 {
   respa_enable = 1;
   writedata = 1;
+  split_flag = 1;
 }
 
 /* ---------------------------------------------------------------------- */
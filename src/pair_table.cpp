@@ -23,6 +23,7 @@
 #include "atom.h"
 #include "force.h"
 #include "comm.h"
+#include "neighbor.h"
 #include "neigh_list.h"
 #include "memory.h"
 #include "error.h"
@@ -32,6 +33,8 @@ using namespace LAMMPS_NS;
 enum{NONE,RLINEAR,RSQ,BMP};
 
 #define MAXLINE 1024
+#define PACK_ALIGN 64       // byte alignment of the packed tables
+#define SIMD_CHUNK 64       // neighbors per vector pass of eval_simd()
 
 /* ---------------------------------------------------------------------- */
 
@@ -39,6 +42,12 @@ PairTable::PairTable(LAMMPS *lmp) : Pair(lmp)
 {
   ntables = 0;
   tables = NULL;
+
+  simdflag = 0;
+  npack = 0;
+  ptable = ptable_e = ptable_block = NULL;
+  pparam = NULL;
+  ptabindex = NULL;
 }
 
 /* ---------------------------------------------------------------------- */
@@ -47,6 +56,7 @@ PairTable::~PairTable()
 {
   for (int m = 0; m < ntables; m++) free_table(&tables[m]);
   memory->sfree(tables);
+  free_packed();
 
   if (allocated) {
     memory->destroy(setflag);
@@ -72,6 +82,43 @@ void PairTable::compute(int eflag, int vflag)
   if (eflag || vflag) ev_setup(eflag,vflag);
   else evflag = vflag_fdotr = 0;
 
+  // LINEAR and SPLINE tables use a kernel on the packed tables,
+  // the vectorized one if requested by the simd keyword
+
+  if (ptable && simdflag) {
+    if (evflag) {
+      if (eflag) {
+        if (tabstyle == LINEAR) eval_simd<LINEAR,1,1>();
+        else eval_simd<SPLINE,1,1>();
+      } else {
+        if (tabstyle == LINEAR) eval_simd<LINEAR,1,0>();
+        else eval_simd<SPLINE,1,0>();
+      }
+    } else {
+      if (tabstyle == LINEAR) eval_simd<LINEAR,0,0>();
+      else eval_simd<SPLINE,0,0>();
+    }
+    if (vflag_fdotr) virial_fdotr_compute();
+    return;
+  }
+
+  if (ptable) {
+    if (evflag) {
+      if (eflag) {
+        if (tabstyle == LINEAR) eval_packed<LINEAR,1,1>();
+        else eval_packed<SPLINE,1,1>();
+      } else {
+        if (tabstyle == LINEAR) eval_packed<LINEAR,1,0>();
+        else eval_packed<SPLINE,1,0>();
+      }
+    } else {
+      if (tabstyle == LINEAR) eval_packed<LINEAR,0,0>();
+      else eval_packed<SPLINE,0,0>();
+    }
+    if (vflag_fdotr) virial_fdotr_compute();
+    return;
+  }
+
   double **x = atom->x;
   double **f = atom->f;
   int *type = atom->type;
@@ -172,6 +219,253 @@ void PairTable::compute(int eflag, int vflag)
   if (vflag_fdotr) virial_fdotr_compute();
 }
 
+/* ----------------------------------------------------------------------
+   compute with LINEAR or SPLINE tables from the packed layout
+   the table style is a template argument, so the lookup is index
+   arithmetic on one record per pair without a branch on tabstyle
+------------------------------------------------------------------------- */
+
+template <int TABSTYLE, int EVFLAG, int EFLAG>
+void PairTable::eval_packed()
+{
+  int i,j,ii,jj,jnum,itype,jtype,m,itable;
+  double xtmp,ytmp,ztmp,delx,dely,delz,evdwl,fpair;
+  double rsq,factor_lj,a,b,a3,b3,fxtmp,fytmp,fztmp;
+  int *ilist,*jlist,*numneigh,**firstneigh;
+  const double *p,*rec;
+
+  const int NPACK = (TABSTYLE == LINEAR) ? 2 : 4;
+
+  evdwl = 0.0;
+
+  double **x = atom->x;
+  double **f = atom->f;
+  int *type = atom->type;
+  int nlocal = atom->nlocal;
+  double *special_lj = force->special_lj;
+  int newton_pair = force->newton_pair;
+  const int nt = atom->ntypes + 1;
+  const int tlm1 = tablength - 1;
+
+  int inum = list->inum;
+  ilist = list->ilist;
+  numneigh = list->numneigh;
+  firstneigh = list->firstneigh;
+
+  for (ii = 0; ii < inum; ii++) {
+    i = ilist[ii];
+    xtmp = x[i][0];
+    ytmp = x[i][1];
+    ztmp = x[i][2];
+    itype = type[i];
+    const double *cutsqi = cutsq[itype];
+    const int *tabi = &ptabindex[itype*nt];
+    jlist = firstneigh[i];
+    jnum = numneigh[i];
+    fxtmp = fytmp = fztmp = 0.0;
+
+    for (jj = 0; jj < jnum; jj++) {
+      j = jlist[jj];
+      factor_lj = special_lj[sbmask(j)];
+      j &= NEIGHMASK;
+
+      delx = xtmp - x[j][0];
+      dely = ytmp - x[j][1];
+      delz = ztmp - x[j][2];
+      rsq = delx*delx + dely*dely + delz*delz;
+      jtype = type[j];
+
+      if (rsq < cutsqi[jtype]) {
+        m = tabi[jtype];
+        p = &pparam[4*m];
+        if (rsq < p[0])
+          error->one(FLERR,"Pair distance < table inner cutoff");
+        itable = static_cast<int> ((rsq - p[0]) * p[2]);
+        if (itable >= tlm1)
+          error->one(FLERR,"Pair distance > table outer cutoff");
+
+        // p[0] + itable*p[1] is the lower bin edge, as in compute_table()
+
+        const int irec = (m*tlm1 + itable)*NPACK;
+        rec = &ptable[irec];
+        b = (rsq - (p[0] + itable*p[1])) * p[2];
+        if (TABSTYLE == LINEAR) fpair = rec[0] + b*rec[1];
+        else {
+          a = 1.0 - b;
+          a3 = a*a*a - a;
+          b3 = b*b*b - b;
+          fpair = a*rec[0] + b*rec[1] + (a3*rec[2] + b3*rec[3]) * p[3];
+        }
+        fpair *= factor_lj;
+
+        fxtmp += delx*fpair;
+        fytmp += dely*fpair;
+        fztmp += delz*fpair;
+        if (newton_pair || j < nlocal) {
+          f[j][0] -= delx*fpair;
+          f[j][1] -= dely*fpair;
+          f[j][2] -= delz*fpair;
+        }
+
+        if (EFLAG) {
+          rec = &ptable_e[irec];
+          if (TABSTYLE == LINEAR) evdwl = rec[0] + b*rec[1];
+          else evdwl = a*rec[0] + b*rec[1] + (a3*rec[2] + b3*rec[3]) * p[3];
+          evdwl *= factor_lj;
+        }
+
+        if (EVFLAG) ev_tally(i,j,nlocal,newton_pair,
+                             evdwl,0.0,fpair,delx,dely,delz);
+      }
+    }
+
+    f[i][0] += fxtmp;
+    f[i][1] += fytmp;
+    f[i][2] += fztmp;
+  }
+}
+
+/* ----------------------------------------------------------------------
+   same as eval_packed() with the lookups of SIMD_CHUNK neighbors at once
+   vector pass: gather of x, type and table records, branch-free,
+     pairs outside the cutoff or the table get fpair = 0.0,
+     table range errors are flagged and raised after the loop
+   scalar pass: scatter of forces on j and tally of the pairs in range
+------------------------------------------------------------------------- */
+
+template <int TABSTYLE, int EVFLAG, int EFLAG>
+void PairTable::eval_simd()
+{
+  int i,ii,jfrom,k,n,jnum,itype;
+  double xtmp,ytmp,ztmp,fxtmp,fytmp,fztmp;
+  int *ilist,*jlist,*numneigh,**firstneigh;
+
+  const int NPACK = (TABSTYLE == LINEAR) ? 2 : 4;
+
+  int jv[SIMD_CHUNK],okv[SIMD_CHUNK];
+  double delxv[SIMD_CHUNK],delyv[SIMD_CHUNK],delzv[SIMD_CHUNK];
+  double fpairv[SIMD_CHUNK],evdwlv[SIMD_CHUNK];
+
+  const double * const x0 = &atom->x[0][0];
+  double **f = atom->f;
+  const int * const type = atom->type;
+  int nlocal = atom->nlocal;
+  const double * const special_lj = force->special_lj;
+  int newton_pair = force->newton_pair;
+  const int nt = atom->ntypes + 1;
+  const int tlm1 = tablength - 1;
+  const double * const pt = ptable;
+  const double * const pte = ptable_e;
+  const double * const pp = pparam;
+
+  int inner = 0;
+  int outer = 0;
+
+  int inum = list->inum;
+  ilist = list->ilist;
+  numneigh = list->numneigh;
+  firstneigh = list->firstneigh;
+
+  for (ii = 0; ii < inum; ii++) {
+    i = ilist[ii];
+    xtmp = x0[3*i];
+    ytmp = x0[3*i+1];
+    ztmp = x0[3*i+2];
+    itype = type[i];
+    const double *cutsqi = cutsq[itype];
+    const int *tabi = &ptabindex[itype*nt];
+    jlist = firstneigh[i];
+    jnum = numneigh[i];
+    fxtmp = fytmp = fztmp = 0.0;
+
+    for (jfrom = 0; jfrom < jnum; jfrom += SIMD_CHUNK) {
+      n = MIN(SIMD_CHUNK,jnum-jfrom);
+      const int *jl = &jlist[jfrom];
+
+      // comparisons go to ints first and select by multiplication,
+      //   so no lane branches or divides
+
+#if defined(_OPENMP) && _OPENMP >= 201307
+#pragma omp simd reduction(+:fxtmp,fytmp,fztmp) reduction(|:inner,outer)
+#endif
+      for (k = 0; k < n; k++) {
+        int j = jl[k];
+        const double factor_lj = special_lj[sbmask(j)];
+        j &= NEIGHMASK;
+
+        const double delx = xtmp - x0[3*j];
+        const double dely = ytmp - x0[3*j+1];
+        const double delz = ztmp - x0[3*j+2];
+        const double rsq = delx*delx + dely*dely + delz*delz;
+        const int jtype = type[j];
+        const int m = tabi[jtype];
+        const double innersq = pp[4*m];
+
+        const int incut = rsq < cutsqi[jtype];
+        const int below = rsq < innersq;
+        int itable = static_cast<int> ((rsq - innersq) * pp[4*m+2]);
+        const int above = itable >= tlm1;
+        const int ok = incut & !below & !above;
+        inner |= incut & below;
+        outer |= incut & above;
+        itable *= ok;
+
+        const int irec = (m*tlm1 + itable)*NPACK;
+        const double b = (rsq - (innersq + itable*pp[4*m+1])) * pp[4*m+2];
+        double a,a3,b3,fpair;
+        if (TABSTYLE == LINEAR) fpair = pt[irec] + b*pt[irec+1];
+        else {
+          a = 1.0 - b;
+          a3 = a*a*a - a;
+          b3 = b*b*b - b;
+          fpair = a*pt[irec] + b*pt[irec+1] +
+            (a3*pt[irec+2] + b3*pt[irec+3]) * pp[4*m+3];
+        }
+        fpair *= factor_lj * ok;
+
+        fxtmp += delx*fpair;
+        fytmp += dely*fpair;
+        fztmp += delz*fpair;
+
+        jv[k] = j;
+        okv[k] = ok;
+        delxv[k] = delx;
+        delyv[k] = dely;
+        delzv[k] = delz;
+        fpairv[k] = fpair;
+
+        if (EFLAG) {
+          double evdwl;
+          if (TABSTYLE == LINEAR) evdwl = pte[irec] + b*pte[irec+1];
+          else evdwl = a*pte[irec] + b*pte[irec+1] +
+                 (a3*pte[irec+2] + b3*pte[irec+3]) * pp[4*m+3];
+          evdwlv[k] = evdwl * factor_lj;
+        }
+      }
+
+      for (k = 0; k < n; k++) {
+        if (!okv[k]) continue;
+        const int j = jv[k];
+        if (newton_pair || j < nlocal) {
+          f[j][0] -= delxv[k]*fpairv[k];
+          f[j][1] -= delyv[k]*fpairv[k];
+          f[j][2] -= delzv[k]*fpairv[k];
+        }
+        if (EVFLAG) ev_tally(i,j,nlocal,newton_pair,
+                             EFLAG ? evdwlv[k] : 0.0,0.0,fpairv[k],
+                             delxv[k],delyv[k],delzv[k]);
+      }
+    }
+
+    f[i][0] += fxtmp;
+    f[i][1] += fytmp;
+    f[i][2] += fztmp;
+  }
+
+  if (inner) error->one(FLERR,"Pair distance < table inner cutoff");
+  if (outer) error->one(FLERR,"Pair distance > table outer cutoff");
+}
+
 /* ----------------------------------------------------------------------
    allocate all arrays
 ------------------------------------------------------------------------- */
@@ -211,7 +505,9 @@ void PairTable::settings(int narg, char **arg)
 
   // optional keywords
   // assert the tabulation is compatible with a specific long-range solver
+  // simd = vectorized lookups for LINEAR and SPLINE, not stored in restarts
 
+  simdflag = 0;
   int iarg = 2;
   while (iarg < narg) {
     if (strcmp(arg[iarg],"ewald") == 0) ewaldflag = 1;
@@ -219,6 +515,7 @@ void PairTable::settings(int narg, char **arg)
     else if (strcmp(arg[iarg],"msm") == 0) msmflag = 1;
     else if (strcmp(arg[iarg],"dispersion") == 0) dispersionflag = 1;
     else if (strcmp(arg[iarg],"tip4p") == 0) tip4pflag = 1;
+    else if (strcmp(arg[iarg],"simd") == 0) simdflag = 1;
     else error->all(FLERR,"Illegal pair_style command");
     iarg++;
   }
@@ -227,6 +524,7 @@ void PairTable::settings(int narg, char **arg)
 
   for (int m = 0; m < ntables; m++) free_table(&tables[m]);
   memory->sfree(tables);
+  free_packed();
 
   if (allocated) {
     memory->destroy(setflag);
@@ -317,6 +615,18 @@ void PairTable::coeff(int narg, char **arg)
   ntables++;
 }
 
+/* ----------------------------------------------------------------------
+   init specific to this pair style
+------------------------------------------------------------------------- */
+
+void PairTable::init_style()
+{
+  neighbor->request(this);
+
+  if (tabstyle == LINEAR || tabstyle == SPLINE) pack_tables();
+  else free_packed();
+}
+
 /* ----------------------------------------------------------------------
    init for one type pair i,j and corresponding j,i
 ------------------------------------------------------------------------- */
@@ -799,6 +1109,81 @@ void PairTable::free_table(Table *tb)
   memory->destroy(tb->f2);
 }
 
+/* ----------------------------------------------------------------------
+   copy LINEAR or SPLINE tables into aligned arrays of bin records
+   LINEAR bin K = f,df of K in ptable and e,de of K in ptable_e
+   SPLINE bin K = f,f,f2,f2 of K and K+1 in ptable, likewise e,e2,
+     so a lookup touches a single 32-byte record
+   tabindex is only set for I <= J until init_one(), so use that half
+------------------------------------------------------------------------- */
+
+void PairTable::pack_tables()
+{
+  free_packed();
+  if (ntables == 0) return;
+
+  int i,j,k,m;
+  const int tlm1 = tablength - 1;
+  npack = (tabstyle == LINEAR) ? 2 : 4;
+
+  int stride = PACK_ALIGN/sizeof(double);
+  bigint n = (bigint) ntables*tlm1*npack;
+  n = (n + stride-1)/stride * stride;
+  ptable_block = (double *)
+    memory->smalloc((2*n+stride)*sizeof(double),"pair:ptable");
+  ptable = (double *)
+    (((size_t) ptable_block + PACK_ALIGN-1) & ~((size_t) PACK_ALIGN-1));
+  ptable_e = ptable + n;
+  memory->create(pparam,4*ntables,"pair:pparam");
+
+  for (m = 0; m < ntables; m++) {
+    Table *tb = &tables[m];
+    double *p = &pparam[4*m];
+    p[0] = tb->innersq;
+    p[1] = tb->delta;
+    p[2] = tb->invdelta;
+    p[3] = (tabstyle == SPLINE) ? tb->deltasq6 : 0.0;
+
+    double *rec = &ptable[(bigint) m*tlm1*npack];
+    double *rece = &ptable_e[(bigint) m*tlm1*npack];
+    for (k = 0; k < tlm1; k++, rec += npack, rece += npack) {
+      if (tabstyle == LINEAR) {
+        rec[0] = tb->f[k];
+        rec[1] = tb->df[k];
+        rece[0] = tb->e[k];
+        rece[1] = tb->de[k];
+      } else {
+        rec[0] = tb->f[k];
+        rec[1] = tb->f[k+1];
+        rec[2] = tb->f2[k];
+        rec[3] = tb->f2[k+1];
+        rece[0] = tb->e[k];
+        rece[1] = tb->e[k+1];
+        rece[2] = tb->e2[k];
+        rece[3] = tb->e2[k+1];
+      }
+    }
+  }
+
+  const int nt = atom->ntypes + 1;
+  memory->create(ptabindex,nt*nt,"pair:ptabindex");
+  for (i = 0; i < nt; i++)
+    for (j = 0; j < nt; j++)
+      ptabindex[i*nt+j] = tabindex[MIN(i,j)][MAX(i,j)];
+}
+
+/* ---------------------------------------------------------------------- */
+
+void PairTable::free_packed()
+{
+  memory->sfree(ptable_block);
+  memory->destroy(pparam);
+  memory->destroy(ptabindex);
+  ptable = ptable_e = ptable_block = NULL;
+  pparam = NULL;
+  ptabindex = NULL;
+}
+
 /* ----------------------------------------------------------------------
    spline and splint routines modified from Numerical Recipes
 ------------------------------------------------------------------------- */
@@ -32,6 +32,7 @@ class PairTable : public Pair {
   virtual void compute(int, int);
   void settings(int, char **);
   void coeff(int, char **);
+  void init_style();
   double init_one(int, int);
   void write_restart(FILE *);
   void read_restart(FILE *);
@@ -58,6 +59,18 @@ class PairTable : public Pair {
 
   int **tabindex;
 
+  // packed copy of all LINEAR or SPLINE tables for eval_packed()
+  // bins of table M start at ptable + M*(tablength-1)*npack,
+  // energies are kept apart so force-only steps touch half the memory
+
+  int simdflag;                 // 1 to use eval_simd() on packed tables
+  int npack;                    // doubles per bin record
+  double *ptable;               // aligned force records of all tables
+  double *ptable_e;             // aligned energy records of all tables
+  double *ptable_block;         // allocation behind ptable
+  double *pparam;               // innersq,delta,invdelta,deltasq6 per table
+  int *ptabindex;               // table of each type pair, (ntypes+1)^2
+
   void allocate();
   void read_table(Table *, char *, char *);
   void param_extract(Table *, char *);
@@ -68,6 +81,11 @@ class PairTable : public Pair {
   void free_table(Table *);
   void spline(double *, double *, int, double, double, double *);
   double splint(double *, double *, double *, int, double);
+
+  void pack_tables();
+  void free_packed();
+  template <int TABSTYLE, int EVFLAG, int EFLAG> void eval_packed();
+  template <int TABSTYLE, int EVFLAG, int EFLAG> void eval_simd();
 };
 
 }
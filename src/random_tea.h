@@ -0,0 +1,97 @@
+/* ----------------------------------------------------------------------
+   LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+   http://lammps.sandia.gov, Sandia National Laboratories
+   Steve Plimpton, sjplimp@sandia.gov
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+
+   See the README file in the top-level LAMMPS directory.
+------------------------------------------------------------------------- */
+
+/* ----------------------------------------------------------------------
+   stateless pairwise random numbers from the Tiny Encryption Algorithm
+   host-side counterpart of premix_TEA/gaussian_TEA in USER-MESO/math_meso.h
+   a random number depends only on its keys, not on call order,
+   so it can be drawn from any thread and on any processor decomposition
+------------------------------------------------------------------------- */
+
+#ifndef LMP_RANDOM_TEA_H
+#define LMP_RANDOM_TEA_H
+
+#include "math.h"
+#include "math_const.h"
+
+namespace LAMMPS_NS {
+
+namespace RandomTEA {
+
+  static const unsigned int TEA_K0 = 0xA341316C;
+  static const unsigned int TEA_K1 = 0xC8013EA4;
+  static const unsigned int TEA_K2 = 0xAD90777D;
+  static const unsigned int TEA_K3 = 0x7E95761E;
+  static const unsigned int TEA_DT = 0x9E3779B9;
+
+  static const double TWO_TO_MINUS_31 = 4.6566128730773925781E-10;
+  static const double TWO_TO_MINUS_32 = 2.3283064365386962891E-10;
+
+  // N rounds of TEA mixing, v0 and v1 are scrambled in place
+
+  template<int N> inline void tea_core(unsigned int &v0, unsigned int &v1)
+  {
+    unsigned int sum = 0;
+    for (int n = 0; n < N; n++) {
+      sum += TEA_DT;
+      v0 += ((v1 << 4) + TEA_K0) ^ (v1 + sum) ^ ((v1 >> 5) + TEA_K1);
+      v1 += ((v0 << 4) + TEA_K2) ^ (v0 + sum) ^ ((v0 >> 5) + TEA_K3);
+    }
+  }
+
+  // hash two keys into one, e.g. seed and timestep, or seed and atom tag
+
+  template<int N> inline unsigned int premix(unsigned int v0, unsigned int v1)
+  {
+    tea_core<N>(v0,v1);
+    return v0 ^ v1;
+  }
+
+  // bit reversal, spreads consecutive atom tags over the whole key space
+
+  inline unsigned int brev(unsigned int v)
+  {
+    v = ((v >> 1) & 0x55555555) | ((v & 0x55555555) << 1);
+    v = ((v >> 2) & 0x33333333) | ((v & 0x33333333) << 2);
+    v = ((v >> 4) & 0x0F0F0F0F) | ((v & 0x0F0F0F0F) << 4);
+    v = ((v >> 8) & 0x00FF00FF) | ((v & 0x00FF00FF) << 8);
+    return (v >> 16) | (v << 16);
+  }
+
+  // per-atom key for one timestep, same recipe as dp2sp_merged() on GPU
+
+  inline unsigned int atom_key(int tag, unsigned int seed_now)
+  {
+    return premix<32>(brev(tag),seed_now);
+  }
+
+  // Box-Muller gaussian from a pair of per-atom keys
+  // symmetric in (u,v) so that I,J and J,I draw the same number
+  // clipped to +/- 4 like gaussian_TEA()
+
+  template<int N> inline double gaussian(unsigned int u, unsigned int v)
+  {
+    unsigned int v0 = u > v ? u : v;
+    unsigned int v1 = u > v ? v : u;
+    tea_core<N>(v0,v1);
+    double f = cos(MathConst::MY_PI * (v0 & 0x7FFFFFFF) * TWO_TO_MINUS_31);
+    if (!(v0 & 0x80000000)) f = -f;
+    double r = sqrt(-2.0 * log((v1 ? v1 : 1) * TWO_TO_MINUS_32));
+    double g = r * f;
+    return g < -4.0 ? -4.0 : (g > 4.0 ? 4.0 : g);
+  }
+}
+
+}
+
+#endif
@@ -0,0 +1,328 @@
+/* ----------------------------------------------------------------------
+   LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+   http://lammps.sandia.gov, Sandia National Laboratories
+   Steve Plimpton, sjplimp@sandia.gov
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+
+   See the README file in the top-level LAMMPS directory.
+------------------------------------------------------------------------- */
+
+#include "mpi.h"
+#include "rcb.h"
+#include "domain.h"
+#include "memory.h"
+
+using namespace LAMMPS_NS;
+
+#define NBIN 64             // bins per refinement of a cut interval
+#define NROUND 4            // refinements, cut is within 64^-4 of bbox
+#define SMALL 1.0e-10       // pad so max point is inside half-open interval
+#define BIG 1.0e20
+
+/* ---------------------------------------------------------------------- */
+
+RCB::RCB(LAMMPS *lmp) : Pointers(lmp)
+{
+  MPI_Comm_rank(world,&me);
+  MPI_Comm_size(world,&nprocs);
+
+  memory->create(cutdim,nprocs,"rcb:cutdim");
+  memory->create(cut,nprocs,"rcb:cut");
+  memory->create(lo,nprocs,3,"rcb:lo");
+  memory->create(hi,nprocs,3,"rcb:hi");
+
+  // at most nprocs/2 nodes are active at once
+
+  int n = nprocs/2 + 1;
+  memory->create(nodefirst,n,"rcb:nodefirst");
+  memory->create(nodenp,n,"rcb:nodenp");
+  memory->create(nodelo,n,3,"rcb:nodelo");
+  memory->create(nodehi,n,3,"rcb:nodehi");
+  memory->create(nodedim,n,"rcb:nodedim");
+  memory->create(wnode,n,"rcb:wnode");
+  memory->create(wall,n,"rcb:wall");
+  memory->create(bbox,6*n,"rcb:bbox");
+  memory->create(bboxall,6*n,"rcb:bboxall");
+  memory->create(target,n,"rcb:target");
+  memory->create(seglo,n,"rcb:seglo");
+  memory->create(seghi,n,"rcb:seghi");
+  memory->create(wseglo,n,"rcb:wseglo");
+  memory->create(wseghi,n,"rcb:wseghi");
+  memory->create(hist,n*(NBIN+1),"rcb:hist");
+  memory->create(histall,n*(NBIN+1),"rcb:histall");
+  memory->create(newfirst,n,"rcb:newfirst");
+  memory->create(newnp,n,"rcb:newnp");
+  memory->create(newlo,n,3,"rcb:newlo");
+  memory->create(newhi,n,3,"rcb:newhi");
+  memory->create(newnode,2*n,"rcb:newnode");
+
+  maxpoint = 0;
+  mynode = NULL;
+}
+
+/* ---------------------------------------------------------------------- */
+
+RCB::~RCB()
+{
+  memory->destroy(cutdim);
+  memory->destroy(cut);
+  memory->destroy(lo);
+  memory->destroy(hi);
+
+  memory->destroy(nodefirst);
+  memory->destroy(nodenp);
+  memory->destroy(nodelo);
+  memory->destroy(nodehi);
+  memory->destroy(nodedim);
+  memory->destroy(wnode);
+  memory->destroy(wall);
+  memory->destroy(bbox);
+  memory->destroy(bboxall);
+  memory->destroy(target);
+  memory->destroy(seglo);
+  memory->destroy(seghi);
+  memory->destroy(wseglo);
+  memory->destroy(wseghi);
+  memory->destroy(hist);
+  memory->destroy(histall);
+  memory->destroy(newfirst);
+  memory->destroy(newnp);
+  memory->destroy(newlo);
+  memory->destroy(newhi);
+  memory->destroy(newnode);
+
+  memory->destroy(mynode);
+}
+
+/* ----------------------------------------------------------------------
+   bisect N points with fractional (0-1) coords x and weights wt into tiles
+   wt = NULL means unit weights
+   each level cuts every node with 2 or more procs at once:
+     cut dim = longest extent of the node's points, scaled by box size
+     cut position is found by binning the points of an interval NROUND
+       times, each time zooming in on the bin where the target weight lies
+   return # of levels in tree
+------------------------------------------------------------------------- */
+
+int RCB::compute(int n, double **x, double *wt)
+{
+  int i,j,k,m,d;
+
+  int dimension = domain->dimension;
+  double *prd = domain->prd;
+
+  if (n > maxpoint) {
+    maxpoint = n;
+    memory->destroy(mynode);
+    memory->create(mynode,maxpoint,"rcb:mynode");
+  }
+
+  // root node is entire box
+
+  cutdim[0] = 0;
+  cut[0] = 0.0;
+  for (d = 0; d < 3; d++) {
+    lo[0][d] = 0.0;
+    hi[0][d] = 1.0;
+  }
+  if (nprocs == 1) return 0;
+
+  nnode = 1;
+  nodefirst[0] = 0;
+  nodenp[0] = nprocs;
+  for (d = 0; d < 3; d++) {
+    nodelo[0][d] = 0.0;
+    nodehi[0][d] = 1.0;
+  }
+  for (i = 0; i < n; i++) mynode[i] = 0;
+
+  int nlevel = 0;
+  double w;
+
+  while (nnode) {
+    nlevel++;
+
+    // total weight and bounding box of points in each node
+    // bbox stores -lo and hi so one MAX reduction finds both
+
+    for (k = 0; k < nnode; k++) {
+      wnode[k] = 0.0;
+      for (m = 0; m < 6; m++) bbox[6*k+m] = -BIG;
+    }
+
+    for (i = 0; i < n; i++) {
+      k = mynode[i];
+      if (k < 0) continue;
+      wnode[k] += wt ? wt[i] : 1.0;
+      for (d = 0; d < 3; d++) {
+        bbox[6*k+d] = MAX(bbox[6*k+d],-x[i][d]);
+        bbox[6*k+3+d] = MAX(bbox[6*k+3+d],x[i][d]);
+      }
+    }
+
+    MPI_Allreduce(wnode,wall,nnode,MPI_DOUBLE,MPI_SUM,world);
+    MPI_Allreduce(bbox,bboxall,6*nnode,MPI_DOUBLE,MPI_MAX,world);
+
+    // cut dim and initial interval [seglo,seghi) that holds all points
+    // node with no weight is cut geometrically in its longest dim
+
+    for (k = 0; k < nnode; k++) {
+      double extent,maxextent = -1.0;
+      for (d = 0; d < dimension; d++) {
+        if (wall[k] > 0.0) extent = bboxall[6*k+3+d] + bboxall[6*k+d];
+        else extent = nodehi[k][d] - nodelo[k][d];
+        extent *= prd[d];
+        if (extent > maxextent) {
+          maxextent = extent;
+          nodedim[k] = d;
+        }
+      }
+      d = nodedim[k];
+      target[k] = wall[k] * (nodenp[k]/2) / nodenp[k];
+      if (wall[k] > 0.0) {
+        seglo[k] = -bboxall[6*k+d];
+        seghi[k] = bboxall[6*k+3+d] + SMALL;
+      } else {
+        seglo[k] = nodelo[k][d];
+        seghi[k] = nodehi[k][d];
+      }
+      wseglo[k] = 0.0;
+      wseghi[k] = wall[k];
+    }
+
+    // zoom in on cut position
+    // hist[0] = weight below seglo, hist[1:NBIN] = weight in each bin
+
+    for (int iround = 0; iround < NROUND; iround++) {
+      for (m = 0; m < nnode*(NBIN+1); m++) hist[m] = 0.0;
+
+      for (i = 0; i < n; i++) {
+        k = mynode[i];
+        if (k < 0) continue;
+        double value = x[i][nodedim[k]];
+        w = wt ? wt[i] : 1.0;
+        double *h = &hist[k*(NBIN+1)];
+        if (value < seglo[k]) h[0] += w;
+        else if (value < seghi[k]) {
+          int ibin = static_cast<int>
+            ((value-seglo[k]) / (seghi[k]-seglo[k]) * NBIN);
+          if (ibin >= NBIN) ibin = NBIN-1;
+          h[ibin+1] += w;
+        }
+      }
+
+      MPI_Allreduce(hist,histall,nnode*(NBIN+1),MPI_DOUBLE,MPI_SUM,world);
+
+      for (k = 0; k < nnode; k++) {
+        if (wall[k] == 0.0) continue;
+        double *h = &histall[k*(NBIN+1)];
+        double sum = h[0];
+        for (j = 0; j < NBIN-1; j++) {
+          if (sum + h[j+1] >= target[k]) break;
+          sum += h[j+1];
+        }
+        double width = (seghi[k]-seglo[k]) / NBIN;
+        double newlo = seglo[k] + j*width;
+        if (j < NBIN-1) seghi[k] = newlo + width;
+        seglo[k] = newlo;
+        wseglo[k] = sum;
+        wseghi[k] = sum + h[j+1];
+      }
+    }
+
+    // place cut at whichever end of final interval is closer to target
+    // a cut must leave both children with a box of non-zero width
+    // nodes with 2 or more procs become next level's nodes
+
+    int nnew = 0;
+
+    for (k = 0; k < nnode; k++) {
+      d = nodedim[k];
+      int nlo = nodenp[k]/2;
+      int first = nodefirst[k];
+      int mid = first + nlo;
+
+      double onecut;
+      if (wall[k] > 0.0) {
+        if (target[k]-wseglo[k] <= wseghi[k]-target[k]) onecut = seglo[k];
+        else onecut = seghi[k];
+      } else onecut = nodelo[k][d];
+      if (onecut <= nodelo[k][d] || onecut >= nodehi[k][d])
+        onecut = nodelo[k][d] +
+          (nodehi[k][d]-nodelo[k][d]) * nlo / nodenp[k];
+
+      cutdim[mid] = d;
+      cut[mid] = onecut;
+
+      for (m = 0; m < 2; m++) {
+        int cfirst = m ? mid : first;
+        int cnp = m ? nodenp[k]-nlo : nlo;
+        double clo[3],chi[3];
+        for (int dd = 0; dd < 3; dd++) {
+          clo[dd] = nodelo[k][dd];
+          chi[dd] = nodehi[k][dd];
+        }
+        if (m) clo[d] = onecut;
+        else chi[d] = onecut;
+
+        if (cnp == 1) {
+          for (int dd = 0; dd < 3; dd++) {
+            lo[cfirst][dd] = clo[dd];
+            hi[cfirst][dd] = chi[dd];
+          }
+          newnode[2*k+m] = -1;
+        } else {
+          newfirst[nnew] = cfirst;
+          newnp[nnew] = cnp;
+          for (int dd = 0; dd < 3; dd++) {
+            newlo[nnew][dd] = clo[dd];
+            newhi[nnew][dd] = chi[dd];
+          }
+          newnode[2*k+m] = nnew++;
+        }
+      }
+    }
+
+    // assign points to child nodes, then children become the nodes
+
+    for (i = 0; i < n; i++) {
+      k = mynode[i];
+      if (k < 0) continue;
+      if (x[i][nodedim[k]] < cut[nodefirst[k]+nodenp[k]/2])
+        mynode[i] = newnode[2*k];
+      else mynode[i] = newnode[2*k+1];
+    }
+
+    int *itmp;
+    double **dtmp;
+    itmp = nodefirst; nodefirst = newfirst; newfirst = itmp;
+    itmp = nodenp; nodenp = newnp; newnp = itmp;
+    dtmp = nodelo; nodelo = newlo; newlo = dtmp;
+    dtmp = nodehi; nodehi = newhi; newhi = dtmp;
+    nnode = nnew;
+  }
+
+  return nlevel;
+}
+
+/* ----------------------------------------------------------------------
+   return # of bytes of allocated memory
+------------------------------------------------------------------------- */
+
+bigint RCB::memory_usage()
+{
+  int n = nprocs/2 + 1;
+  bigint bytes = 0;
+  bytes += memory->usage(cutdim,nprocs);
+  bytes += memory->usage(cut,nprocs);
+  bytes += 2*memory->usage(lo,nprocs,3);
+  bytes += 4*memory->usage(nodelo,n,3);
+  bytes += (bigint) n * (5*sizeof(int) + 22*sizeof(double));
+  bytes += (bigint) 2*n*(NBIN+1) * sizeof(double);
+  bytes += memory->usage(mynode,maxpoint);
+  return bytes;
+}
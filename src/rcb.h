@@ -0,0 +1,62 @@
+/* -*- c++ -*- ----------------------------------------------------------
+   LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+   http://lammps.sandia.gov, Sandia National Laboratories
+   Steve Plimpton, sjplimp@sandia.gov
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+
+   See the README file in the top-level LAMMPS directory.
+------------------------------------------------------------------------- */
+
+#ifndef LMP_RCB_H
+#define LMP_RCB_H
+
+#include "pointers.h"
+
+namespace LAMMPS_NS {
+
+// recursive coordinate bisection of weighted points into one tile per proc
+// a range of procs is cut in half, the cut is placed so the weight on
+//   each side is proportional to its # of procs, then each half recurses
+// all procs compute the same tree of cuts, one level at a time
+// cut P splits a range of procs into those below P and those >= P,
+//   so each proc > 0 stores exactly one cut of the tree
+
+class RCB : protected Pointers {
+ public:
+  int *cutdim;                  // dim of cut that proc I is first above
+  double *cut;                  // fractional coord of that cut
+  double **lo,**hi;             // fractional bounds of each proc's tile
+
+  RCB(class LAMMPS *);
+  ~RCB();
+  int compute(int, double **, double *);
+  bigint memory_usage();
+
+ private:
+  int me,nprocs;
+
+  int maxpoint;
+  int *mynode;                  // active node each point is in, -1 if leaf
+
+  int nnode;                    // # of active nodes (2 or more procs)
+  int *nodefirst,*nodenp;       // 1st proc and # of procs of each node
+  double **nodelo,**nodehi;     // fractional box of each node
+  int *nodedim;                 // cut dim of each node
+  double *wnode,*wall;          // weight of points in each node
+  double *bbox,*bboxall;        // -lo/hi bounding box of points per node
+  double *target;               // weight that belongs below the cut
+  double *seglo,*seghi;         // coord interval that contains the cut
+  double *wseglo,*wseghi;       // weight below seglo,seghi
+  double *hist,*histall;        // weight below seglo + weight per bin
+  int *newfirst,*newnp;         // same for nodes of next level
+  double **newlo,**newhi;
+  int *newnode;                 // node index of each child, -1 if leaf
+};
+
+}
+
+#endif
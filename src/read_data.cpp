@@ -35,6 +35,7 @@
 #include "dihedral.h"
 #include "improper.h"
 #include "special.h"
+#include "irregular.h"
 #include "error.h"
 #include "memory.h"
 
@@ -45,6 +46,10 @@ using namespace LAMMPS_NS;
 #define CHUNK 1024
 #define DELTA 4            // must be 2 or larger
 #define MAXBODY 20         // max # of lines in one body, also in Atom class
+#define NSAMPLE 100        // # of lines sampled to size parallel read windows
+#define MAXWINDOW 16777216 // max bytes one proc reads at a time in parallel
+
+enum{ATOMS,BONDS,ANGLES,DIHEDRALS,IMPROPERS};   // sections read in parallel
 
                            // customize for new sections
 #define NSECTIONS 25       // change when add to header::section_keywords
@@ -54,6 +59,7 @@ using namespace LAMMPS_NS;
 ReadData::ReadData(LAMMPS *lmp) : Pointers(lmp)
 {
   MPI_Comm_rank(world,&me);
+  MPI_Comm_size(world,&nprocs);
   line = new char[MAXLINE];
   keyword = new char[MAXLINE];
   buffer = new char[CHUNK*MAXLINE];
@@ -71,6 +77,15 @@ ReadData::ReadData(LAMMPS *lmp) : Pointers(lmp)
   avec_tri = (AtomVecTri *) atom->style_match("tri");
   nbodies = 0;
   avec_body = (AtomVecBody *) atom->style_match("body");
+
+  parallel = 0;
+#ifndef LAMMPS_MPIIO
+  pfp = NULL;
+#endif
+  pbuf = lbuf = tbuf = NULL;
+  maxpbuf = 0;
+  maxlbuf = maxtbuf = 0;
+  dir_owner = NULL;
 }
 
 /* ---------------------------------------------------------------------- */
@@ -82,6 +97,11 @@ ReadData::~ReadData()
   delete [] buffer;
   memory->sfree(arg);
 
+  memory->sfree(pbuf);
+  memory->sfree(lbuf);
+  memory->sfree(tbuf);
+  memory->destroy(dir_owner);
+
   for (int i = 0; i < nfix; i++) {
     delete [] fix_header[i];
     delete [] fix_section[i];
@@ -135,13 +155,31 @@ void ReadData::command(int narg, char **arg)
       strcpy(fix_section[nfix],arg[iarg+3]);
       nfix++;
       iarg += 4;
+    } else if (strcmp(arg[iarg],"parallel") == 0) {
+      if (iarg+2 > narg) error->all(FLERR,"Illegal read_data command");
+      if (strcmp(arg[iarg+1],"yes") == 0) parallel = 1;
+      else if (strcmp(arg[iarg+1],"no") == 0) parallel = 0;
+      else error->all(FLERR,"Illegal read_data command");
+      iarg += 2;
     } else error->all(FLERR,"Illegal read_data command");
   }
 
+  if (parallel) {
+    const char *suffix = arg[0] + strlen(arg[0]) - 3;
+    if (suffix > arg[0] && strcmp(suffix,".gz") == 0)
+      error->all(FLERR,"Read_data parallel cannot read a gzipped file");
+  }
+
   // scan data file to determine max topology needed per atom
   // allocate initial topology arrays
+  // parallel mode skips the scan, sections grow the arrays as they are read
 
-  if (atom->molecular) {
+  if (atom->molecular && parallel) {
+    atom->bond_per_atom = atom->extra_bond_per_atom;
+    atom->angle_per_atom = atom->dihedral_per_atom =
+      atom->improper_per_atom = 0;
+
+  } else if (atom->molecular) {
     if (me == 0) {
       if (screen) fprintf(screen,"Scanning data file ...\n");
       open(arg[0]);
@@ -170,6 +208,9 @@ void ReadData::command(int narg, char **arg)
   } else fp = NULL;
   header(1);
   domain->box_exist = 1;
+  if (atom->molecular && parallel && atom->natoms > MAXSMALLINT)
+    error->all(FLERR,"Molecular data file has too many atoms");
+  if (parallel) parallel_open(arg[0]);
 
   // problem setup using info from header
 
@@ -365,6 +406,7 @@ void ReadData::command(int narg, char **arg)
     if (compressed) pclose(fp);
     else fclose(fp);
   }
+  if (parallel) parallel_close();
 
   // error if natoms > 0 yet no atoms were read
 
@@ -569,12 +611,15 @@ void ReadData::atoms()
   bigint nread = 0;
   bigint natoms = atom->natoms;
 
-  while (nread < natoms) {
-    nchunk = MIN(natoms-nread,CHUNK);
-    eof = comm->read_lines_from_file(fp,nchunk,MAXLINE,buffer);
-    if (eof) error->all(FLERR,"Unexpected end of data file");
-    atom->data_atoms(nchunk,buffer);
-    nread += nchunk;
+  if (parallel) parallel_section(ATOMS,natoms);
+  else {
+    while (nread < natoms) {
+      nchunk = MIN(natoms-nread,CHUNK);
+      eof = comm->read_lines_from_file(fp,nchunk,MAXLINE,buffer);
+      if (eof) error->all(FLERR,"Unexpected end of data file");
+      atom->data_atoms(nchunk,buffer,0);
+      nread += nchunk;
+    }
   }
 
   // check that all atoms were assigned correctly
@@ -627,6 +672,17 @@ void ReadData::atoms()
     atom->map_init();
     atom->map_set();
   }
+
+  // in parallel mode atoms are still on the procs that parsed them
+  // migrate them to their owning procs, in lamda coords for triclinic
+
+  if (parallel) {
+    if (domain->triclinic) domain->x2lamda(atom->nlocal);
+    Irregular *irregular = new Irregular(lmp);
+    irregular->migrate_atoms();
+    delete irregular;
+    if (domain->triclinic) domain->lamda2x(atom->nlocal);
+  }
 }
 
 /* ----------------------------------------------------------------------
@@ -798,12 +854,15 @@ void ReadData::bonds()
 
   bigint natoms = atom->natoms;
 
-  while (nread < nbonds) {
-    nchunk = MIN(nbonds-nread,CHUNK);
-    eof = comm->read_lines_from_file(fp,nchunk,MAXLINE,buffer);
-    if (eof) error->all(FLERR,"Unexpected end of data file");
-    atom->data_bonds(nchunk,buffer);
-    nread += nchunk;
+  if (parallel) parallel_section(BONDS,nbonds);
+  else {
+    while (nread < nbonds) {
+      nchunk = MIN(nbonds-nread,CHUNK);
+      eof = comm->read_lines_from_file(fp,nchunk,MAXLINE,buffer);
+      if (eof) error->all(FLERR,"Unexpected end of data file");
+      atom->data_bonds(nchunk,buffer);
+      nread += nchunk;
+    }
   }
 
   // check that bonds were assigned correctly
@@ -833,12 +892,15 @@ void ReadData::angles()
   bigint nread = 0;
   bigint nangles = atom->nangles;
 
-  while (nread < nangles) {
-    nchunk = MIN(nangles-nread,CHUNK);
-    eof = comm->read_lines_from_file(fp,nchunk,MAXLINE,buffer);
-    if (eof) error->all(FLERR,"Unexpected end of data file");
-    atom->data_angles(nchunk,buffer);
-    nread += nchunk;
+  if (parallel) parallel_section(ANGLES,nangles);
+  else {
+    while (nread < nangles) {
+      nchunk = MIN(nangles-nread,CHUNK);
+      eof = comm->read_lines_from_file(fp,nchunk,MAXLINE,buffer);
+      if (eof) error->all(FLERR,"Unexpected end of data file");
+      atom->data_angles(nchunk,buffer);
+      nread += nchunk;
+    }
   }
 
   // check that ang
@@ -868,12 +930,15 @@ void ReadData::dihedrals()
   bigint nread = 0;
   bigint ndihedrals = atom->ndihedrals;
 
-  while (nread < ndihedrals) {
-    nchunk = MIN(ndihedrals-nread,CHUNK);
-    eof = comm->read_lines_from_file(fp,nchunk,MAXLINE,buffer);
-    if (eof) error->all(FLERR,"Unexpected end of data file");
-    atom->data_dihedrals(nchunk,buffer);
-    nread += nchunk;
+  if (parallel) parallel_section(DIHEDRALS,ndihedrals);
+  else {
+    while (nread < ndihedrals) {
+      nchunk = MIN(ndihedrals-nread,CHUNK);
+      eof = comm->read_lines_from_file(fp,nchunk,MAXLINE,buffer);
+      if (eof) error->all(FLERR,"Unexpected end of data file");
+      atom->data_dihedrals(nchunk,buffer);
+      nread += nchunk;
+    }
   }
 
   // check that dihedrals were assigned correctly
@@ -903,12 +968,15 @@ void ReadData::impropers()
   bigint nread = 0;
   bigint nimpropers = atom->nimpropers;
 
-  while (nread < nimpropers) {
-    nchunk = MIN(nimpropers-nread,CHUNK);
-    eof = comm->read_lines_from_file(fp,nchunk,MAXLINE,buffer);
-    if (eof) error->all(FLERR,"Unexpected end of data file");
-    atom->data_impropers(nchunk,buffer);
-    nread += nchunk;
+  if (parallel) parallel_section(IMPROPERS,nimpropers);
+  else {
+    while (nread < nimpropers) {
+      nchunk = MIN(nimpropers-nread,CHUNK);
+      eof = comm->read_lines_from_file(fp,nchunk,MAXLINE,buffer);
+      if (eof) error->all(FLERR,"Unexpected end of data file");
+      atom->data_impropers(nchunk,buffer);
+      nread += nchunk;
+    }
   }
 
   // check that impropers were assigned correctly
@@ -1557,3 +1625,468 @@ void ReadData::parse_coeffs(char *line, const char *addstr, int dupflag)
     word = strtok(NULL," \t\n\r\f");
   }
 }
+
+/* ----------------------------------------------------------------------
+   all procs open data file for parallel reads of large sections
+   proc 0 also keeps reading the rest of the file via fp
+------------------------------------------------------------------------- */
+
+void ReadData::parallel_open(char *file)
+{
+  if (me == 0) {
+    long offset = ftell(fp);
+    fseek(fp,0,SEEK_END);
+    filesize = ftell(fp);
+    fseek(fp,offset,SEEK_SET);
+  }
+  MPI_Bcast(&filesize,1,MPI_LMP_BIGINT,0,world);
+
+  char str[128];
+  sprintf(str,"Cannot open file %s",file);
+
+#ifdef LAMMPS_MPIIO
+  int err = MPI_File_open(world,file,MPI_MODE_RDONLY,MPI_INFO_NULL,&mpifp);
+  if (err != MPI_SUCCESS) error->all(FLERR,str);
+#else
+  pfp = fopen(file,"rb");
+  if (pfp == NULL) error->one(FLERR,str);
+#endif
+}
+
+/* ---------------------------------------------------------------------- */
+
+void ReadData::parallel_close()
+{
+#ifdef LAMMPS_MPIIO
+  MPI_File_close(&mpifp);
+#else
+  fclose(pfp);
+  pfp = NULL;
+#endif
+}
+
+/* ----------------------------------------------------------------------
+   read section of N lines in parallel, section starts at proc 0's fp
+   each pass, every proc reads its own window of the file and parses
+     the lines that start in it, until N lines have been seen
+   window size is estimated from the lines at the start of the section,
+     then from the lines seen in the previous pass
+   Atoms are kept by the proc that parsed them, caller migrates them
+   topology lines are routed to the procs that own their atoms
+   on return proc 0's fp is positioned after the section
+------------------------------------------------------------------------- */
+
+void ReadData::parallel_section(int section, bigint n)
+{
+  // start = file offset of 1st line of section
+  // avgline = average length of sampled lines
+
+  bigint start;
+  double avgline;
+
+  if (me == 0) {
+    start = ftell(fp);
+    bigint nbytes = 0;
+    int nsample = 0;
+    while (nsample < MIN(n,NSAMPLE) && fgets(line,MAXLINE,fp)) {
+      nbytes += strlen(line);
+      nsample++;
+    }
+    fseek(fp,start,SEEK_SET);
+    if (nsample) avgline = (double) nbytes / nsample;
+    else avgline = MAXLINE;
+  }
+  MPI_Bcast(&start,1,MPI_LMP_BIGINT,0,world);
+  MPI_Bcast(&avgline,1,MPI_DOUBLE,0,world);
+
+  ntlines = 0;
+  ntbuf = 0;
+
+  bigint base = start;
+  bigint nprev = 0;
+  bigint end = start;
+
+  while (nprev < n) {
+    if (base >= filesize) error->all(FLERR,"Unexpected end of data file");
+
+    // window is 10% larger than expected share of remaining lines
+
+    double estimate = 1.1 * avgline * (n-nprev) / nprocs + MAXLINE;
+    int window = static_cast<int> (MIN(estimate,MAXWINDOW));
+
+    bigint nall;
+    int nmine = read_window(base,window,start,nprev,n,nall,end);
+
+    if (section == ATOMS) {
+      if (nmine) atom->data_atoms(nmine,lbuf,1);
+    } else route_lines(section,nmine,lbuf);
+
+    nprev += nall;
+    base += (bigint) nprocs * window;
+
+    // line length measured in this pass sizes the next one
+
+    if (nall) avgline = (double) nprocs * window / nall;
+  }
+
+  if (section != ATOMS) store_lines(section);
+
+  bigint endall;
+  MPI_Allreduce(&end,&endall,1,MPI_LMP_BIGINT,MPI_MAX,world);
+  if (me == 0) fseek(fp,endall,SEEK_SET);
+}
+
+/* ----------------------------------------------------------------------
+   read my window [lo,hi) of a pass over file starting at base
+   a line belongs to the window it starts in
+   one byte before lo is read to know if a line starts at lo,
+     MAXLINE bytes after hi to finish the last line
+   copy my lines that are among 1st N lines of section into lbuf
+   nall = # of lines that start in windows of all procs in this pass
+   end = file offset after the section if its last line is mine
+   return # of lines in lbuf
+------------------------------------------------------------------------- */
+
+int ReadData::read_window(bigint base, int window, bigint start,
+                          bigint nprev, bigint n, bigint &nall, bigint &end)
+{
+  bigint lo = MIN(base + (bigint) me*window,filesize);
+  bigint hi = MIN(lo + window,filesize);
+  bigint rlo = lo > start ? lo-1 : lo;
+  bigint rhi = MIN(hi + MAXLINE,filesize);
+  int nread = rhi - rlo;
+
+  if (nread+1 > maxpbuf) {
+    maxpbuf = nread+1;
+    pbuf = (char *) memory->srealloc(pbuf,maxpbuf,"read_data:pbuf");
+  }
+  read_block(rlo,nread,pbuf);
+  pbuf[nread] = '\0';
+
+  // first = offset in pbuf of 1st line start at or after lo
+  // count line starts before hi
+
+  char *ptr;
+  int first = lo - rlo;
+  if (lo > start && pbuf[first-1] != '\n') {
+    ptr = (char *) memchr(&pbuf[first],'\n',nread-first);
+    first = ptr ? ptr - pbuf + 1 : nread;
+  }
+
+  int last = hi - rlo;
+  bigint ncount = 0;
+  int m = first;
+  while (m < last) {
+    ncount++;
+    ptr = (char *) memchr(&pbuf[m],'\n',nread-m);
+    if (ptr == NULL) break;
+    m = ptr - pbuf + 1;
+  }
+
+  bigint index;
+  MPI_Scan(&ncount,&index,1,MPI_LMP_BIGINT,MPI_SUM,world);
+  MPI_Allreduce(&ncount,&nall,1,MPI_LMP_BIGINT,MPI_SUM,world);
+  index += nprev - ncount;
+
+  // copy my lines of the section, each ending in a newline
+
+  int nmine = 0;
+  bigint nbytes = 0;
+  m = first;
+  while (m < last && index < n) {
+    ptr = (char *) memchr(&pbuf[m],'\n',nread-m);
+    int len = 0;
+    if (ptr) len = ptr - &pbuf[m];
+    else if (rhi == filesize) len = nread - m;
+    else error->one(FLERR,"Line in data file is too long");
+
+    if (nbytes + len + 2 > maxlbuf) {
+      maxlbuf = 2*(nbytes + len + 2);
+      lbuf = (char *) memory->srealloc(lbuf,maxlbuf,"read_data:lbuf");
+    }
+    memcpy(&lbuf[nbytes],&pbuf[m],len);
+    nbytes += len;
+    lbuf[nbytes++] = '\n';
+    nmine++;
+
+    m += len + 1;
+    if (index == n-1) end = MIN(rlo + m,filesize);
+    index++;
+  }
+
+  return nmine;
+}
+
+/* ----------------------------------------------------------------------
+   read N bytes of data file at offset into buf
+   collective if MPI-IO is used, so every proc calls, possibly with N = 0
+------------------------------------------------------------------------- */
+
+void ReadData::read_block(bigint offset, int n, char *buf)
+{
+#ifdef LAMMPS_MPIIO
+  MPI_Status status;
+  MPI_File_read_at_all(mpifp,(MPI_Offset) offset,buf,n,MPI_CHAR,&status);
+  int count;
+  MPI_Get_count(&status,MPI_CHAR,&count);
+  if (count != n) error->one(FLERR,"Unexpected end of data file");
+#else
+  if (n == 0) return;
+  fseek(pfp,offset,SEEK_SET);
+  if (fread(buf,1,n,pfp) != (size_t) n)
+    error->one(FLERR,"Unexpected end of data file");
+#endif
+}
+
+/* ----------------------------------------------------------------------
+   build distributed directory of which proc owns each atom ID
+   proc P stores IDs in block P of nprocs equal blocks of 1 to map_tag_max
+------------------------------------------------------------------------- */
+
+void ReadData::directory()
+{
+  int maxtag = atom->map_tag_max;
+  dir_lo = ((bigint) me*maxtag + nprocs-1) / nprocs + 1;
+  int dir_hi = ((bigint) (me+1)*maxtag + nprocs-1) / nprocs;
+  dir_n = dir_hi - dir_lo + 1;
+
+  memory->destroy(dir_owner);
+  memory->create(dir_owner,MAX(dir_n,1),"read_data:dir_owner");
+  for (int i = 0; i < dir_n; i++) dir_owner[i] = -1;
+
+  // send (ID,me) of each owned atom to proc storing that ID
+
+  int nlocal = atom->nlocal;
+  int *tag = atom->tag;
+  int *proclist = new int[nlocal];
+  int *sendbuf = new int[2*nlocal];
+
+  for (int i = 0; i < nlocal; i++) {
+    proclist[i] = ((bigint) (tag[i]-1)*nprocs) / maxtag;
+    sendbuf[2*i] = tag[i];
+    sendbuf[2*i+1] = me;
+  }
+
+  Irregular *irregular = new Irregular(lmp);
+  int nrecv = irregular->create_data(nlocal,proclist);
+  int *recvbuf = new int[2*nrecv];
+  irregular->exchange_data((char *) sendbuf,2*sizeof(int),(char *) recvbuf);
+  irregular->destroy_data();
+  delete irregular;
+
+  for (int i = 0; i < nrecv; i++)
+    dir_owner[recvbuf[2*i]-dir_lo] = recvbuf[2*i+1];
+
+  delete [] proclist;
+  delete [] sendbuf;
+  delete [] recvbuf;
+}
+
+/* ----------------------------------------------------------------------
+   send N topology lines in buf to procs that will store them
+   a line is stored with the atom that data_bonds() etc store it with,
+     which is all its atoms if newton_bond is off
+   owning procs are looked up in directory, each line is sent once
+     to each distinct owner, received lines are appended to tbuf
+------------------------------------------------------------------------- */
+
+void ReadData::route_lines(int section, int n, char *buf)
+{
+  if (dir_owner == NULL) directory();
+
+  int natom = 4;
+  if (section == BONDS) natom = 2;
+  else if (section == ANGLES) natom = 3;
+
+  // the atom storing a line is atom 1 for bonds, atom 2 for others
+
+  int nkey = force->newton_bond ? 1 : natom;
+  int ikey = (force->newton_bond && section != BONDS) ? 1 : 0;
+
+  const char *errstr;
+  if (section == BONDS)
+    errstr = "Invalid atom ID in Bonds section of data file";
+  else if (section == ANGLES)
+    errstr = "Invalid atom ID in Angles section of data file";
+  else if (section == DIHEDRALS)
+    errstr = "Invalid atom ID in Dihedrals section of data file";
+  else errstr = "Invalid atom ID in Impropers section of data file";
+
+  // parse atom IDs of each line, width = longest line incl newline
+
+  char **lines = new char*[n];
+  int *key = new int[n*nkey];
+  int maxtag = atom->map_tag_max;
+  int tmp,itype,atoms[4];
+  int width = 1;
+
+  char *ptr = buf;
+  for (int i = 0; i < n; i++) {
+    lines[i] = ptr;
+    char *next = strchr(ptr,'\n');
+    width = MAX(width,next-ptr+1);
+    atoms[0] = atoms[1] = atoms[2] = atoms[3] = 0;
+    *next = '\0';
+    sscanf(ptr,"%d %d %d %d %d %d",&tmp,&itype,
+           &atoms[0],&atoms[1],&atoms[2],&atoms[3]);
+    *next = '\n';
+    for (int j = 0; j < natom; j++)
+      if (atoms[j] <= 0 || atoms[j] > maxtag) error->one(FLERR,errstr);
+    for (int k = 0; k < nkey; k++) key[i*nkey+k] = atoms[ikey+k];
+    ptr = next + 1;
+  }
+
+  int widthall;
+  MPI_Allreduce(&width,&widthall,1,MPI_INT,MPI_MAX,world);
+  width = widthall;
+
+  // query directory for owner of each key atom
+  // query = (me,index,ID), reply = (index,owner)
+
+  int nquery = n*nkey;
+  int *proclist = new int[nquery];
+  int *query = new int[3*nquery];
+  for (int q = 0; q < nquery; q++) {
+    proclist[q] = ((bigint) (key[q]-1)*nprocs) / maxtag;
+    query[3*q] = me;
+    query[3*q+1] = q;
+    query[3*q+2] = key[q];
+  }
+
+  Irregular *irregular = new Irregular(lmp);
+  int nrecv = irregular->create_data(nquery,proclist);
+  int *qrecv = new int[3*nrecv];
+  irregular->exchange_data((char *) query,3*sizeof(int),(char *) qrecv);
+  irregular->destroy_data();
+
+  int *rproc = new int[nrecv];
+  int *reply = new int[2*nrecv];
+  for (int i = 0; i < nrecv; i++) {
+    rproc[i] = qrecv[3*i];
+    reply[2*i] = qrecv[3*i+1];
+    reply[2*i+1] = dir_owner[qrecv[3*i+2]-dir_lo];
+  }
+
+  irregular->create_data(nrecv,rproc);
+  irregular->exchange_data((char *) reply,2*sizeof(int),(char *) query);
+  irregular->destroy_data();
+
+  int *owner = proclist;
+  for (int q = 0; q < nquery; q++) {
+    owner[query[2*q]] = query[2*q+1];
+    if (query[2*q+1] < 0) error->one(FLERR,errstr);
+  }
+
+  delete [] qrecv;
+  delete [] rproc;
+  delete [] reply;
+
+  // send each line once to each distinct owner of its key atoms
+
+  int nsend = 0;
+  int *sendproc = new int[nquery];
+  char *sendbuf = new char[(bigint) nquery*width];
+
+  for (int i = 0; i < n; i++)
+    for (int k = 0; k < nkey; k++) {
+      int proc = owner[i*nkey+k];
+      int dup = 0;
+      for (int kk = 0; kk < k; kk++)
+        if (owner[i*nkey+kk] == proc) dup = 1;
+      if (dup) continue;
+      int len = strchr(lines[i],'\n') - lines[i] + 1;
+      memcpy(&sendbuf[(bigint) nsend*width],lines[i],len);
+      sendproc[nsend++] = proc;
+    }
+
+  nrecv = irregular->create_data(nsend,sendproc);
+  char *recvbuf = new char[(bigint) nrecv*width];
+  irregular->exchange_data(sendbuf,width,recvbuf);
+  irregular->destroy_data();
+  delete irregular;
+
+  // append received lines to tbuf
+
+  for (int i = 0; i < nrecv; i++) {
+    char *one = &recvbuf[(bigint) i*width];
+    int len = (char *) memchr(one,'\n',width) - one + 1;
+    if (ntbuf + len + 1 > maxtbuf) {
+      maxtbuf = 2*(ntbuf + len + 1);
+      tbuf = (char *) memory->srealloc(tbuf,maxtbuf,"read_data:tbuf");
+    }
+    memcpy(&tbuf[ntbuf],one,len);
+    ntbuf += len;
+    ntlines++;
+  }
+
+  delete [] lines;
+  delete [] key;
+  delete [] proclist;
+  delete [] query;
+  delete [] sendproc;
+  delete [] sendbuf;
+  delete [] recvbuf;
+}
+
+/* ----------------------------------------------------------------------
+   store topology lines routed to me with their owned atoms
+   count entries per atom first and grow per-atom topology arrays if needed,
+     they are still empty for this section so nothing is lost by grow()
+------------------------------------------------------------------------- */
+
+void ReadData::store_lines(int section)
+{
+  int nlocal = atom->nlocal;
+  int natom = 4;
+  if (section == BONDS) natom = 2;
+  else if (section == ANGLES) natom = 3;
+
+  int *count = new int[nlocal];
+  for (int i = 0; i < nlocal; i++) count[i] = 0;
+
+  int tmp,itype,atoms[4],m;
+  char *ptr = tbuf;
+  for (int i = 0; i < ntlines; i++) {
+    char *next = strchr(ptr,'\n');
+    *next = '\0';
+    sscanf(ptr,"%d %d %d %d %d %d",&tmp,&itype,
+           &atoms[0],&atoms[1],&atoms[2],&atoms[3]);
+    *next = '\n';
+    if (force->newton_bond) {
+      m = atom->map(section == BONDS ? atoms[0] : atoms[1]);
+      if (m >= 0 && m < nlocal) count[m]++;
+    } else {
+      for (int j = 0; j < natom; j++) {
+        m = atom->map(atoms[j]);
+        if (m >= 0 && m < nlocal) count[m]++;
+      }
+    }
+    ptr = next + 1;
+  }
+
+  int maxcount = 0;
+  for (int i = 0; i < nlocal; i++) maxcount = MAX(maxcount,count[i]);
+  int maxall;
+  MPI_Allreduce(&maxcount,&maxall,1,MPI_INT,MPI_MAX,world);
+  delete [] count;
+
+  int *per_atom;
+  if (section == BONDS) {
+    per_atom = &atom->bond_per_atom;
+    maxall += atom->extra_bond_per_atom;
+  } else if (section == ANGLES) per_atom = &atom->angle_per_atom;
+  else if (section == DIHEDRALS) per_atom = &atom->dihedral_per_atom;
+  else per_atom = &atom->improper_per_atom;
+
+  if (maxall > *per_atom) {
+    *per_atom = maxall;
+    atom->avec->grow(atom->nmax);
+  }
+
+  if (ntlines) {
+    if (section == BONDS) atom->data_bonds(ntlines,tbuf);
+    else if (section == ANGLES) atom->data_angles(ntlines,tbuf);
+    else if (section == DIHEDRALS) atom->data_dihedrals(ntlines,tbuf);
+    else atom->data_impropers(ntlines,tbuf);
+  }
+}
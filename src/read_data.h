@@ -32,12 +32,31 @@ class ReadData : protected Pointers {
   void command(int, char **);
 
  private:
-  int me;
+  int me,nprocs;
   char *line,*keyword,*buffer;
   FILE *fp;
   int narg,maxarg,compressed;
   char **arg;
 
+  // parallel mode, each proc reads and parses part of large sections
+
+  int parallel;             // 1 if parallel mode is on
+  bigint filesize;          // size of data file in bytes
+#ifdef LAMMPS_MPIIO
+  MPI_File mpifp;           // all procs' shared handle on data file
+#else
+  FILE *pfp;                // this proc's own handle on data file
+#endif
+  char *pbuf;               // bytes read from data file by this proc
+  int maxpbuf;
+  char *lbuf;               // lines of a section this proc parses
+  bigint maxlbuf;
+  char *tbuf;               // topology lines routed to this proc
+  bigint ntbuf,maxtbuf;
+  int ntlines;
+  int dir_lo,dir_n;         // block of atom IDs in my part of directory
+  int *dir_owner;           // owning proc of each of those atom IDs
+
   int nfix;           // # of extra fixes that process/store info in data file
   int *fix_index;
   char **fix_header;
@@ -79,6 +98,15 @@ class ReadData : protected Pointers {
   void impropercoeffs(int);
 
   void fix(int, char *);
+
+  void parallel_open(char *);
+  void parallel_close();
+  void parallel_section(int, bigint);
+  int read_window(bigint, int, bigint, bigint, bigint, bigint &, bigint &);
+  void read_block(bigint, int, char *);
+  void directory();
+  void route_lines(int, int, char *);
+  void store_lines(int);
 };
 
 }
@@ -94,6 +122,16 @@ Self-explanatory.  Check the input script syntax and compare to the
 documentation for the command.  You can use -echo screen as a
 command-line option when running LAMMPS to see the offending line.
 
+E: Read_data parallel cannot read a gzipped file
+
+Each processor reads its own part of the file, which requires an
+uncompressed file.
+
+E: Line in data file is too long
+
+In parallel mode a line of a section spans more than the maximum line
+length of a data file.
+
 E: Cannot read_data after simulation box is defined
 
 The read_data command cannot be used after a read_data,
@@ -17,6 +17,9 @@
 #include "stdlib.h"
 //#include "sys/types.h"
 #include "dirent.h"
+#include "fcntl.h"
+#include "unistd.h"
+#include "sys/mman.h"
 #include "read_restart.h"
 #include "atom.h"
 #include "atom_vec.h"
@@ -90,12 +93,18 @@ void ReadRestart::command(int narg, char **arg)
     MPI_Bcast(file,n,MPI_CHAR,0,world);
   } else strcpy(file,arg[0]);
 
-  // check if filename contains "%"
+  // check if filename contains "%" or ends in ".mpiio"
 
   int multiproc;
   if (strchr(file,'%')) multiproc = 1;
   else multiproc = 0;
 
+  int mpiioflag = 0;
+  int nlen = strlen(file);
+  if (nlen > 6 && strcmp(&file[nlen-6],".mpiio") == 0) mpiioflag = 1;
+  if (multiproc && mpiioflag)
+    error->all(FLERR,"Restart file MPI-IO input not allowed with % in filename");
+
   // open single restart file or base file for multiproc case
   // auto-detect whether byte swapping needs to be done as file is read
 
@@ -166,7 +175,7 @@ void ReadRestart::command(int narg, char **arg)
   double *buf = NULL;
   int m;
 
-  if (multiproc == 0) {
+  if (multiproc == 0 && mpiioflag == 0) {
     int triclinic = domain->triclinic;
     double *x,lamda[3];
     double *coord,*sublo,*subhi;
@@ -210,43 +219,49 @@ void ReadRestart::command(int narg, char **arg)
 
     if (me == 0) fclose(fp);
 
+  // MPI-IO file:
+  // nprocs_file = # of chunks in file
+  // each proc maps a contiguous range of chunks, keeping all atoms in them
   // one file per proc:
   // nprocs_file = # of files
   // each proc reads 1/P fraction of files, keeping all atoms in the files
-  // perform irregular comm to migrate atoms to correct procs
+  // for both, perform irregular comm to migrate atoms to correct procs
   // close restart file when done
 
   } else {
-    if (me == 0) fclose(fp);
-    char *perproc = new char[strlen(file) + 16];
-    char *ptr = strchr(file,'%');
+    if (mpiioflag) read_mpiio(file);
+    else {
+      if (me == 0) fclose(fp);
+      char *perproc = new char[strlen(file) + 16];
+      char *ptr = strchr(file,'%');
 
-    for (int iproc = me; iproc < nprocs_file; iproc += nprocs) {
-      *ptr = '\0';
-      sprintf(perproc,"%s%d%s",file,iproc,ptr+1);
-      *ptr = '%';
-      fp = fopen(perproc,"rb");
-      if (fp == NULL) {
-        char str[128];
-        sprintf(str,"Cannot open restart file %s",perproc);
-        error->one(FLERR,str);
-      }
+      for (int iproc = me; iproc < nprocs_file; iproc += nprocs) {
+        *ptr = '\0';
+        sprintf(perproc,"%s%d%s",file,iproc,ptr+1);
+        *ptr = '%';
+        fp = fopen(perproc,"rb");
+        if (fp == NULL) {
+          char str[128];
+          sprintf(str,"Cannot open restart file %s",perproc);
+          error->one(FLERR,str);
+        }
 
-      nread_int(&n,1,fp);
-      if (n > maxbuf) {
-        maxbuf = n;
-        memory->destroy(buf);
-        memory->create(buf,maxbuf,"read_restart:buf");
+        nread_int(&n,1,fp);
+        if (n > maxbuf) {
+          maxbuf = n;
+          memory->destroy(buf);
+          memory->create(buf,maxbuf,"read_restart:buf");
+        }
+        if (n > 0) nread_double(buf,n,fp);
+
+        m = 0;
+        while (m < n) m += avec->unpack_restart(&buf[m]);
+        fclose(fp);
       }
-      if (n > 0) nread_double(buf,n,fp);
 
-      m = 0;
-      while (m < n) m += avec->unpack_restart(&buf[m]);
-      fclose(fp);
+      delete [] perproc;
     }
 
-    delete [] perproc;
-
     // create a temporary fix to hold and migrate extra atom info
     // necessary b/c irregular will migrate atoms
 
@@ -447,6 +462,86 @@ void ReadRestart::file_search(char *infile, char *outfile)
   delete [] end;
 }
 
+/* ----------------------------------------------------------------------
+   read atoms from chunks of an MPI-IO restart file, see write_restart
+   proc 0 reads index of chunks that follows the fix section, closes file
+   chunks are split into nprocs contiguous ranges of ~equal # of doubles,
+     so any # of procs can read any file
+   each proc maps its range read-only and unpacks all atoms in it,
+     caller migrates them to the procs that own them
+------------------------------------------------------------------------- */
+
+void ReadRestart::read_mpiio(char *file)
+{
+  int nchunk;
+  if (me == 0) nread_int(&nchunk,1,fp);
+  MPI_Bcast(&nchunk,1,MPI_INT,0,world);
+  if (nchunk != nprocs_file)
+    error->all(FLERR,"Invalid chunk index in MPI-IO restart file");
+
+  bigint *offset = new bigint[nchunk];
+  int *size = new int[nchunk];
+  if (me == 0) {
+    fread(offset,sizeof(bigint),nchunk,fp);
+    nread_int(size,nchunk,fp);
+    fclose(fp);
+  }
+  MPI_Bcast(offset,nchunk,MPI_LMP_BIGINT,0,world);
+  MPI_Bcast(size,nchunk,MPI_INT,0,world);
+
+  // my chunks = those whose first double is in my 1/P share of all doubles
+
+  bigint total = 0;
+  for (int i = 0; i < nchunk; i++) total += size[i];
+
+  int first = nchunk;
+  int last = -1;
+  bigint sum = 0;
+  for (int i = 0; i < nchunk; i++) {
+    if (size[i] && (sum*nprocs)/total == me) {
+      first = MIN(first,i);
+      last = i;
+    }
+    sum += size[i];
+  }
+
+  if (last >= first) {
+    char str[128];
+    int fd = open(file,O_RDONLY);
+    if (fd < 0) {
+      sprintf(str,"Cannot open restart file %s",file);
+      error->one(FLERR,str);
+    }
+
+    // map from page boundary at or before 1st chunk to end of last chunk
+    // private mapping lets unpack_restart() use a non-const buf
+
+    bigint pagesize = sysconf(_SC_PAGESIZE);
+    bigint lo = offset[first] / pagesize * pagesize;
+    bigint hi = offset[last] + (bigint) size[last]*sizeof(double);
+    void *ptr = mmap(NULL,hi-lo,PROT_READ | PROT_WRITE,MAP_PRIVATE,fd,lo);
+    if (ptr == MAP_FAILED) {
+      sprintf(str,"Cannot map restart file %s",file);
+      error->one(FLERR,str);
+    }
+    close(fd);
+    madvise(ptr,hi-lo,MADV_SEQUENTIAL);
+
+    AtomVec *avec = atom->avec;
+    for (int i = first; i <= last; i++) {
+      double *buf = (double *) ((char *) ptr + (offset[i]-lo));
+      int n = size[i];
+      int m = 0;
+      while (m < n) m += avec->unpack_restart(&buf[m]);
+    }
+
+    munmap(ptr,hi-lo);
+  }
+
+  delete [] offset;
+  delete [] size;
+}
+
 /* ----------------------------------------------------------------------
    read header of restart file
 ------------------------------------------------------------------------- */
@@ -40,6 +40,7 @@ class ReadRestart : protected Pointers {
   void header();
   void type_arrays();
   void force_fields();
+  void read_mpiio(char *);
 
   void nread_int(int *, int, FILE *);
   void nread_double(double *, int, FILE *);
@@ -69,10 +70,24 @@ E: Cannot read_restart after simulation box is defined
 The read_restart command cannot be used after a read_data,
 read_restart, or create_box command.
 
+E: Restart file MPI-IO input not allowed with % in filename
+
+A file ending in .mpiio is a single file written by all processors.
+
 E: Cannot open restart file %s
 
 Self-explanatory.
 
+E: Invalid chunk index in MPI-IO restart file
+
+The # of atom chunks in the file does not match the # of processors
+it was written on.  The file is likely corrupted.
+
+E: Cannot map restart file %s
+
+The operating system could not memory-map the atom chunks of an
+MPI-IO restart file.
+
 E: Did not assign all atoms correctly
 
 Atoms read in from a data file were not assigned correctly to
@@ -1,3 +1,4 @@
+#include "angle_area_volume.h"
 #include "angle_area_volume_meso.h"
 #include "angle_charmm.h"
 #include "angle_cosine_delta.h"
@@ -5,6 +6,7 @@
 #include "angle_cosine_periodic.h"
 #include "angle_cosine_squared.h"
 #include "angle_harmonic.h"
+#include "angle_harmonic_fast.h"
 #include "angle_harmonic_meso.h"
 #include "angle_hybrid.h"
 #include "angle_null_meso.h"
@@ -16,8 +16,10 @@
 #include "atom_vec_hybrid.h"
 #include "atom_vec_line.h"
 #include "atom_vec_molecular.h"
+#include "atom_vec_rbc.h"
 #include "atom_vec_sph_atomic_meso.h"
 #include "atom_vec_sphere.h"
 #include "atom_vec_tdpd_atomic_meso.h"
+#include "atom_vec_tdpd.h"
 #include "atom_vec_tdpd_rbc_meso.h"
 #include "atom_vec_tri.h"
@@ -1,7 +1,9 @@
 #include "bond_fene_expand.h"
 #include "bond_fene.h"
+#include "bond_fene_fast.h"
 #include "bond_fene_meso.h"
 #include "bond_harmonic.h"
+#include "bond_harmonic_fast.h"
 #include "bond_harmonic_meso.h"
 #include "bond_hybrid.h"
 #include "bond_morse.h"
@@ -10,4 +12,5 @@
 #include "bond_table.h"
 #include "bond_wlc_edpd_meso.h"
 #include "bond_wlc_meso.h"
+#include "bond_wlc_pow_all_visc.h"
 #include "bond_wlc_pow_all_visc_meso.h"
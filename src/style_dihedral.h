@@ -1,6 +1,8 @@
+#include "dihedral_bend.h"
 #include "dihedral_bend_meso.h"
 #include "dihedral_charmm.h"
 #include "dihedral_harmonic.h"
+#include "dihedral_harmonic_fast.h"
 #include "dihedral_helix.h"
 #include "dihedral_hybrid.h"
 #include "dihedral_multi_harmonic.h"
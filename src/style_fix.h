@@ -51,6 +51,7 @@
 #include "fix_nve_meso.h"
 #include "fix_nve_noforce.h"
 #include "fix_nve_sphere.h"
+#include "fix_nve_tdpd.h"
 #include "fix_nve_tdpd_meso.h"
 #include "fix_nvt.h"
 #include "fix_nvt_sllod.h"
@@ -73,6 +74,7 @@
 #include "fix_rg_meso.h"
 #include "fix_setforce.h"
 #include "fix_shake.h"
+#include "fix_shake_fast.h"
 #include "fix_shear_history.h"
 #include "fix_solid_bound_meso.h"
 #include "fix_sph_rho_meso.h"
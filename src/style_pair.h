@@ -7,6 +7,7 @@
 #include "pair_coul_debye.h"
 #include "pair_coul_dsf.h"
 #include "pair_coul_wolf.h"
+#include "pair_dpd_fast.h"
 #include "pair_dpd_fast_meso.h"
 #include "pair_dpd.h"
 #include "pair_dpd_meso.h"
@@ -42,6 +43,7 @@
 #include "pair_soft.h"
 #include "pair_sph_meso.h"
 #include "pair_table.h"
+#include "pair_tdpd.h"
 #include "pair_tdpd_meso.h"
 #include "pair_tip4p_cut.h"
 #include "pair_yukawa.h"
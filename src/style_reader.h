@@ -1,2 +1,3 @@
 #include "reader_native.h"
+#include "reader_tdpd.h"
 #include "reader_xyz.h"
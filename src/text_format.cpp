@@ -0,0 +1,316 @@
+/* ----------------------------------------------------------------------
+   LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+   http://lammps.sandia.gov, Sandia National Laboratories
+   Steve Plimpton, sjplimp@sandia.gov
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+
+   See the README file in the top-level LAMMPS directory.
+------------------------------------------------------------------------- */
+
+#include "math.h"
+#include "string.h"
+#include "text_format.h"
+#include "comm.h"
+#include "memory.h"
+
+#if defined(_OPENMP)
+#include "omp.h"
+#endif
+
+using namespace LAMMPS_NS;
+
+#define BLOCK 16384         // rows formatted by one thread at a time
+#define MAXFAST 16          // max chars of a dedicated %d or %g conversion
+#define MAXSLOW 64          // first guess for a snprintf() conversion
+#define TIETOL 1.0e-8       // closer than this to a rounding tie -> snprintf
+
+// exact powers of ten, 10^22 is the largest that is a double
+
+static const double pow10tab[23] = {
+  1e0,1e1,1e2,1e3,1e4,1e5,1e6,1e7,1e8,1e9,1e10,1e11,
+  1e12,1e13,1e14,1e15,1e16,1e17,1e18,1e19,1e20,1e21,1e22};
+
+/* ---------------------------------------------------------------------- */
+
+TextFormat::TextFormat(LAMMPS *lmp) : Pointers(lmp)
+{
+  ncol = 0;
+  coltype = fast = suffixlen = NULL;
+  colformat = suffix = NULL;
+  typenames = NULL;
+
+  nthreads = comm->nthreads;
+  tbuf = new char*[nthreads];
+  maxtbuf = new bigint[nthreads];
+  for (int t = 0; t < nthreads; t++) {
+    tbuf[t] = NULL;
+    maxtbuf[t] = 0;
+  }
+}
+
+/* ---------------------------------------------------------------------- */
+
+TextFormat::~TextFormat()
+{
+  clear();
+  for (int t = 0; t < nthreads; t++) memory->sfree(tbuf[t]);
+  delete [] tbuf;
+  delete [] maxtbuf;
+}
+
+/* ---------------------------------------------------------------------- */
+
+void TextFormat::clear()
+{
+  for (int i = 0; i < ncol; i++) {
+    delete [] colformat[i];
+    delete [] suffix[i];
+  }
+  delete [] colformat;
+  delete [] suffix;
+  delete [] coltype;
+  delete [] fast;
+  delete [] suffixlen;
+  ncol = 0;
+}
+
+/* ----------------------------------------------------------------------
+   set N columns with their type and printf format
+   names = strings indexed by value for STRING columns
+------------------------------------------------------------------------- */
+
+void TextFormat::setup(int n, int *type, char **format, char **names)
+{
+  clear();
+
+  ncol = n;
+  coltype = new int[ncol];
+  fast = new int[ncol];
+  suffixlen = new int[ncol];
+  colformat = new char*[ncol];
+  suffix = new char*[ncol];
+  typenames = names;
+
+  for (int i = 0; i < ncol; i++) {
+    coltype[i] = type[i];
+    colformat[i] = new char[strlen(format[i]) + 1];
+    strcpy(colformat[i],format[i]);
+
+    const char *conv = "%g";
+    if (type[i] == INT) conv = "%d";
+    else if (type[i] == STRING) conv = "%s";
+
+    fast[i] = (strncmp(format[i],conv,2) == 0 &&
+               strchr(format[i]+2,'%') == NULL);
+    const char *rest = fast[i] ? format[i]+2 : "";
+    suffix[i] = new char[strlen(rest) + 1];
+    strcpy(suffix[i],rest);
+    suffixlen[i] = strlen(rest);
+  }
+}
+
+/* ----------------------------------------------------------------------
+   write N rows of mybuf, ncol values per row, each row ends in a newline
+------------------------------------------------------------------------- */
+
+void TextFormat::write(FILE *fp, int n, double *mybuf)
+{
+  bigint *len = new bigint[nthreads];
+
+  for (int start = 0; start < n; start += nthreads*BLOCK) {
+    int nrows = MIN(nthreads*BLOCK,n-start);
+    double *rows = mybuf + (bigint) start*ncol;
+
+#if defined(_OPENMP)
+#pragma omp parallel default(shared) num_threads(nthreads)
+#endif
+    {
+#if defined(_OPENMP)
+      const int tid = omp_get_thread_num();
+#else
+      const int tid = 0;
+#endif
+      const int idelta = nrows/nthreads + 1;
+      const int ifrom = MIN(tid*idelta,nrows);
+      const int ito = MIN(ifrom+idelta,nrows);
+      len[tid] = format_rows(tid,ito-ifrom,rows + (bigint) ifrom*ncol,ncol);
+    }
+
+    for (int t = 0; t < nthreads; t++)
+      if (len[t]) fwrite(tbuf[t],1,len[t],fp);
+  }
+
+  delete [] len;
+}
+
+/* ----------------------------------------------------------------------
+   format N rows into tbuf[tid], return # of chars
+------------------------------------------------------------------------- */
+
+bigint TextFormat::format_rows(int tid, int n, double *rows, int stride)
+{
+  bigint pos = 0;
+  double *row = rows;
+
+  for (int i = 0; i < n; i++, row += stride) {
+    for (int j = 0; j < ncol; j++) {
+      bigint need = pos + MAXFAST + suffixlen[j] + 2;
+      if (coltype[j] == STRING) need += strlen(typenames[(int) row[j]]);
+      if (!fast[j]) need += MAXSLOW;
+      if (need > maxtbuf[tid]) {
+        maxtbuf[tid] = 2*need;
+        tbuf[tid] = (char *)
+          memory->srealloc(tbuf[tid],maxtbuf[tid],"dump:tbuf");
+      }
+      char *ptr = tbuf[tid] + pos;
+
+      if (fast[j]) {
+        if (coltype[j] == INT) pos += format_int(ptr,static_cast<int> (row[j]));
+        else if (coltype[j] == DOUBLE) pos += format_g(ptr,row[j]);
+        else {
+          const char *str = typenames[(int) row[j]];
+          int m = strlen(str);
+          memcpy(ptr,str,m);
+          pos += m;
+        }
+        memcpy(tbuf[tid]+pos,suffix[j],suffixlen[j]);
+        pos += suffixlen[j];
+        continue;
+      }
+
+      // general format, grow buffer and redo if it did not fit
+
+      while (1) {
+        bigint avail = maxtbuf[tid] - pos;
+        int m;
+        if (coltype[j] == INT)
+          m = snprintf(ptr,avail,colformat[j],static_cast<int> (row[j]));
+        else if (coltype[j] == DOUBLE)
+          m = snprintf(ptr,avail,colformat[j],row[j]);
+        else m = snprintf(ptr,avail,colformat[j],typenames[(int) row[j]]);
+        if (m+2 < avail) {
+          pos += m;
+          break;
+        }
+        maxtbuf[tid] = 2*(pos + m + 2);
+        tbuf[tid] = (char *)
+          memory->srealloc(tbuf[tid],maxtbuf[tid],"dump:tbuf");
+        ptr = tbuf[tid] + pos;
+      }
+    }
+    tbuf[tid][pos++] = '\n';
+  }
+
+  return pos;
+}
+
+/* ----------------------------------------------------------------------
+   write value as printf("%d") does, return # of chars, no terminator
+------------------------------------------------------------------------- */
+
+int TextFormat::format_int(char *str, int value)
+{
+  char digits[12];
+  unsigned int u = value;
+  int n = 0;
+  int m = 0;
+
+  if (value < 0) {
+    str[m++] = '-';
+    u = 0U - u;
+  }
+  do {
+    digits[n++] = '0' + u % 10;
+    u /= 10;
+  } while (u);
+  while (n) str[m++] = digits[--n];
+  return m;
+}
+
+/* ----------------------------------------------------------------------
+   write value as printf("%g") does, return # of chars, no terminator
+   6 significant digits come from one exact scaling by a power of ten,
+   values outside the exact range, non-finite values, and values whose
+   rounding is within TIETOL of a tie go through snprintf()
+------------------------------------------------------------------------- */
+
+int TextFormat::format_g(char *str, double value)
+{
+  if (value == 0.0) {
+    if (1.0/value < 0.0) {
+      str[0] = '-';
+      str[1] = '0';
+      return 2;
+    }
+    str[0] = '0';
+    return 1;
+  }
+
+  double a = fabs(value);
+  if (!(a >= 1.0e-15 && a < 1.0e25)) return snprintf(str,MAXFAST,"%g",value);
+
+  // scaled = a * 10^(5-expo) rounds to 6 digits, expo is then the
+  // exponent printf would use since it is chosen after rounding
+
+  int expo = static_cast<int> (floor(log10(a)));
+  double scaled = 0.0;
+  for (int iter = 0; iter < 4; iter++) {
+    if (expo > 5) scaled = a / pow10tab[expo-5];
+    else scaled = a * pow10tab[5-expo];
+    if (scaled < 99999.5) expo--;
+    else if (scaled >= 999999.5) expo++;
+    else break;
+  }
+  if (scaled < 99999.5 || scaled >= 999999.5)
+    return snprintf(str,MAXFAST,"%g",value);
+
+  double whole = floor(scaled);
+  double frac = scaled - whole;
+  if (fabs(frac-0.5) < TIETOL) return snprintf(str,MAXFAST,"%g",value);
+  int digits = static_cast<int> (whole);
+  if (frac > 0.5) digits++;
+
+  // strip trailing zeros of the 6 significant digits
+
+  char d[6];
+  for (int k = 5; k >= 0; k--) {
+    d[k] = '0' + digits % 10;
+    digits /= 10;
+  }
+  int nd = 6;
+  while (nd > 1 && d[nd-1] == '0') nd--;
+
+  int m = 0;
+  if (value < 0.0) str[m++] = '-';
+
+  if (expo < -4 || expo >= 6) {
+    str[m++] = d[0];
+    if (nd > 1) {
+      str[m++] = '.';
+      for (int k = 1; k < nd; k++) str[m++] = d[k];
+    }
+    str[m++] = 'e';
+    str[m++] = expo < 0 ? '-' : '+';
+    int e = expo < 0 ? -expo : expo;
+    if (e >= 100) str[m++] = '0' + e/100;
+    str[m++] = '0' + (e/10) % 10;
+    str[m++] = '0' + e % 10;
+  } else if (expo >= 0) {
+    for (int k = 0; k <= expo; k++) str[m++] = k < nd ? d[k] : '0';
+    if (nd > expo+1) {
+      str[m++] = '.';
+      for (int k = expo+1; k < nd; k++) str[m++] = d[k];
+    }
+  } else {
+    str[m++] = '0';
+    str[m++] = '.';
+    for (int k = 0; k < -expo-1; k++) str[m++] = '0';
+    for (int k = 0; k < nd; k++) str[m++] = d[k];
+  }
+
+  return m;
+}
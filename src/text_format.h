@@ -0,0 +1,60 @@
+/* -*- c++ -*- ----------------------------------------------------------
+   LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+   http://lammps.sandia.gov, Sandia National Laboratories
+   Steve Plimpton, sjplimp@sandia.gov
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+
+   See the README file in the top-level LAMMPS directory.
+------------------------------------------------------------------------- */
+
+#ifndef LMP_TEXT_FORMAT_H
+#define LMP_TEXT_FORMAT_H
+
+#include "stdio.h"
+#include "pointers.h"
+
+namespace LAMMPS_NS {
+
+// converts rows of a packed dump buffer to text
+// rows are formatted by OpenMP threads in blocks into per-thread buffers,
+//   each block of all threads is written in order with fwrite()
+// a column format that is "%d" or "%g" or "%s" plus literal text uses
+//   dedicated conversions whose output is identical to printf's,
+//   any other format is passed to snprintf()
+
+class TextFormat : protected Pointers {
+ public:
+  enum{INT,DOUBLE,STRING};
+
+  TextFormat(class LAMMPS *);
+  ~TextFormat();
+  void setup(int, int *, char **, char **);
+  void write(FILE *, int, double *);
+
+  static int format_int(char *, int);
+  static int format_g(char *, double);
+
+ private:
+  int ncol;
+  int *coltype;                 // INT, DOUBLE, STRING per column
+  int *fast;                    // 1 if column uses a dedicated conversion
+  char **colformat;             // printf format per column
+  char **suffix;                // literal text after %d/%g/%s if fast
+  int *suffixlen;
+  char **typenames;             // strings for STRING columns
+
+  int nthreads;
+  char **tbuf;                  // per-thread text buffer
+  bigint *maxtbuf;              // size of each tbuf
+
+  void clear();
+  bigint format_rows(int, int, double *, int);
+};
+
+}
+
+#endif
@@ -0,0 +1,440 @@
+/* ----------------------------------------------------------------------
+   LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+   http://lammps.sandia.gov, Sandia National Laboratories
+   Steve Plimpton, sjplimp@sandia.gov
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+
+   See the README file in the top-level LAMMPS directory.
+------------------------------------------------------------------------- */
+
+/* ----------------------------------------------------------------------
+   thread-private accumulation of forces, energies and virials
+   thread T writes into slab T of f, eatom and vatom,
+   slab 0 is the regular storage, the others are summed into it
+   by all threads together in thr_reduce()
+------------------------------------------------------------------------- */
+
+#include "mpi.h"
+#include "string.h"
+#include "thr_accum.h"
+#include "lammps.h"
+#include "atom.h"
+#include "comm.h"
+#include "force.h"
+#include "pair.h"
+#include "bond.h"
+#include "angle.h"
+#include "dihedral.h"
+#include "improper.h"
+
+#if defined(_OPENMP)
+#include "omp.h"
+#endif
+
+using namespace LAMMPS_NS;
+
+#define CHUNK 8        // reduction chunks are multiples of this many doubles
+
+/* ---------------------------------------------------------------------- */
+
+ThrAccum::ThrAccum(LAMMPS *lmp) : lmp_thr(lmp)
+{
+  nthr_data = lmp->comm->nthreads;
+  thr_data = new ThrAccumData[nthr_data];
+  memset(thr_data,0,nthr_data*sizeof(ThrAccumData));
+}
+
+/* ---------------------------------------------------------------------- */
+
+ThrAccum::~ThrAccum()
+{
+  delete [] thr_data;
+}
+
+/* ----------------------------------------------------------------------
+   point thread tid at its slabs and clear its accumulators
+   called by every thread at the start of the parallel region
+   slab 0 is cleared by force_clear() and ev_setup() as usual
+------------------------------------------------------------------------- */
+
+ThrAccumData *ThrAccum::setup(int tid, double *eatom, int maxeatom,
+                              double **vatom, int maxvatom,
+                              int eflag_global, int eflag_atom,
+                              int vflag_global, int vflag_atom)
+{
+  Atom *atom = lmp_thr->atom;
+  const int nmax = atom->nmax;
+  const int nall = atom->nlocal + atom->nghost;
+
+  ThrAccumData *thr = &thr_data[tid];
+  thr->eflag_global = eflag_global;
+  thr->eflag_atom = eflag_atom;
+  thr->vflag_global = vflag_global;
+  thr->vflag_atom = vflag_atom;
+
+  thr->f = atom->f + tid*nmax;
+  thr->eatom = eflag_atom ? eatom + tid*maxeatom : NULL;
+  thr->vatom = vflag_atom ? vatom + tid*maxvatom : NULL;
+
+  thr->eng_vdwl = thr->eng_coul = 0.0;
+  for (int k = 0; k < 6; k++) thr->virial[k] = 0.0;
+
+  if (tid > 0 && nall > 0) {
+    memset(&thr->f[0][0],0,3*nall*sizeof(double));
+    if (eflag_atom) memset(thr->eatom,0,nall*sizeof(double));
+    if (vflag_atom) memset(&thr->vatom[0][0],0,6*nall*sizeof(double));
+  }
+
+  return thr;
+}
+
+/* ---------------------------------------------------------------------- */
+
+ThrAccumData *ThrAccum::thr_setup(int tid, Pair *style)
+{
+  const int ev = style->evflag;
+  return setup(tid,style->eatom,style->maxeatom,style->vatom,style->maxvatom,
+               ev && style->eflag_global,ev && style->eflag_atom,
+               ev && style->vflag_global,ev && style->vflag_atom);
+}
+
+ThrAccumData *ThrAccum::thr_setup(int tid, Bond *style)
+{
+  const int ev = style->evflag;
+  return setup(tid,style->eatom,style->maxeatom,style->vatom,style->maxvatom,
+               ev && style->eflag_global,ev && style->eflag_atom,
+               ev && style->vflag_global,ev && style->vflag_atom);
+}
+
+ThrAccumData *ThrAccum::thr_setup(int tid, Angle *style)
+{
+  const int ev = style->evflag;
+  return setup(tid,style->eatom,style->maxeatom,style->vatom,style->maxvatom,
+               ev && style->eflag_global,ev && style->eflag_atom,
+               ev && style->vflag_global,ev && style->vflag_atom);
+}
+
+ThrAccumData *ThrAccum::thr_setup(int tid, Dihedral *style)
+{
+  const int ev = style->evflag;
+  return setup(tid,style->eatom,style->maxeatom,style->vatom,style->maxvatom,
+               ev && style->eflag_global,ev && style->eflag_atom,
+               ev && style->vflag_global,ev && style->vflag_atom);
+}
+
+ThrAccumData *ThrAccum::thr_setup(int tid, Improper *style)
+{
+  const int ev = style->evflag;
+  return setup(tid,style->eatom,style->maxeatom,style->vatom,style->maxvatom,
+               ev && style->eflag_global,ev && style->eflag_atom,
+               ev && style->vflag_global,ev && style->vflag_atom);
+}
+
+/* ----------------------------------------------------------------------
+   contiguous chunk nfrom to nto-1 of N items for the calling thread
+   return tid = its thread ID
+------------------------------------------------------------------------- */
+
+void ThrAccum::thr_range(int n, int &tid, int &nfrom, int &nto)
+{
+#if defined(_OPENMP)
+  tid = omp_get_thread_num();
+  const int nthr = omp_get_num_threads();
+#else
+  tid = 0;
+  const int nthr = 1;
+#endif
+  const int idelta = n/nthr + 1;
+  nfrom = MIN(tid*idelta,n);
+  nto = MIN(nfrom+idelta,n);
+}
+
+/* ----------------------------------------------------------------------
+   sum slabs 1..nthr-1 into slab 0, must be called by all threads
+   each thread owns a CHUNK-aligned range of the flattened arrays,
+   so the sum is vectorized, conflict free and in fixed slab order
+------------------------------------------------------------------------- */
+
+void ThrAccum::thr_reduce(ThrAccumData *thr)
+{
+#if defined(_OPENMP)
+  const int nthr = omp_get_num_threads();
+  if (nthr == 1) return;
+  const int tid = thr - thr_data;
+
+  Atom *atom = lmp_thr->atom;
+  int nall = atom->nlocal;
+  if (lmp_thr->force->newton) nall += atom->nghost;
+
+#pragma omp barrier
+
+  for (int m = 0; m < 3; m++) {
+    int n,flag;
+    if (m == 0) {
+      n = 3*nall;
+      flag = 1;
+    } else if (m == 1) {
+      n = nall;
+      flag = thr->eflag_atom;
+    } else {
+      n = 6*nall;
+      flag = thr->vflag_atom;
+    }
+    if (!flag) continue;
+
+    int idelta = n/nthr + 1;
+    idelta = (idelta + CHUNK-1)/CHUNK * CHUNK;
+    const int ifrom = MIN(tid*idelta,n);
+    const int ito = MIN(ifrom+idelta,n);
+
+    double *dst;
+    if (m == 0) dst = &thr_data[0].f[0][0];
+    else if (m == 1) dst = thr_data[0].eatom;
+    else dst = &thr_data[0].vatom[0][0];
+
+    for (int t = 1; t < nthr; t++) {
+      const double *src;
+      if (m == 0) src = &thr_data[t].f[0][0];
+      else if (m == 1) src = thr_data[t].eatom;
+      else src = &thr_data[t].vatom[0][0];
+#if _OPENMP >= 201307
+#pragma omp simd
+#endif
+      for (int i = ifrom; i < ito; i++) dst[i] += src[i];
+    }
+  }
+
+#pragma omp barrier
+#endif
+}
+
+/* ----------------------------------------------------------------------
+   add per-thread global energies and virial to the style
+   called by one thread after the parallel region
+------------------------------------------------------------------------- */
+
+void ThrAccum::finish(double *eng_vdwl, double *eng_coul, double *virial)
+{
+  for (int t = 0; t < nthr_data; t++) {
+    ThrAccumData *thr = &thr_data[t];
+    if (thr->eflag_global) {
+      *eng_vdwl += thr->eng_vdwl;
+      if (eng_coul) *eng_coul += thr->eng_coul;
+    }
+    if (thr->vflag_global)
+      for (int k = 0; k < 6; k++) virial[k] += thr->virial[k];
+    thr->eng_vdwl = thr->eng_coul = 0.0;
+    for (int k = 0; k < 6; k++) thr->virial[k] = 0.0;
+  }
+}
+
+void ThrAccum::thr_finish(Pair *style)
+{
+  finish(&style->eng_vdwl,&style->eng_coul,style->virial);
+}
+
+void ThrAccum::thr_finish(Bond *style)
+{
+  finish(&style->energy,NULL,style->virial);
+}
+
+void ThrAccum::thr_finish(Angle *style)
+{
+  finish(&style->energy,NULL,style->virial);
+}
+
+void ThrAccum::thr_finish(Dihedral *style)
+{
+  finish(&style->energy,NULL,style->virial);
+}
+
+void ThrAccum::thr_finish(Improper *style)
+{
+  finish(&style->energy,NULL,style->virial);
+}
+
+/* ----------------------------------------------------------------------
+   tally energy and virial of an n-body term into thread accumulators
+   with newton off, each owned atom of the term gets 1/n of it,
+   the same split as Pair/Bond/Angle/Dihedral/Improper::ev_tally()
+   v = NULL if no virial is needed
+------------------------------------------------------------------------- */
+
+void ThrAccum::tally(ThrAccumData *thr, int n, const int *list,
+                     int nlocal, int newton,
+                     double e1, double e2, const double *v)
+{
+  const double frac = 1.0/n;
+  int k,m;
+
+  if (thr->eflag_global) {
+    if (newton) {
+      thr->eng_vdwl += e1;
+      thr->eng_coul += e2;
+    } else {
+      for (k = 0; k < n; k++)
+        if (list[k] < nlocal) {
+          thr->eng_vdwl += frac*e1;
+          thr->eng_coul += frac*e2;
+        }
+    }
+  }
+  if (thr->eflag_atom) {
+    const double efrac = frac*(e1+e2);
+    for (k = 0; k < n; k++)
+      if (newton || list[k] < nlocal) thr->eatom[list[k]] += efrac;
+  }
+
+  if (v == NULL) return;
+
+  if (thr->vflag_global) {
+    if (newton) {
+      for (m = 0; m < 6; m++) thr->virial[m] += v[m];
+    } else {
+      for (k = 0; k < n; k++)
+        if (list[k] < nlocal)
+          for (m = 0; m < 6; m++) thr->virial[m] += frac*v[m];
+    }
+  }
+  if (thr->vflag_atom) {
+    for (k = 0; k < n; k++)
+      if (newton || list[k] < nlocal)
+        for (m = 0; m < 6; m++) thr->vatom[list[k]][m] += frac*v[m];
+  }
+}
+
+/* ----------------------------------------------------------------------
+   thread versions of the ev_tally() of each style
+   same arguments as the serial ones plus the thread accumulators
+------------------------------------------------------------------------- */
+
+void ThrAccum::ev_tally_thr(Pair *, ThrAccumData *thr,
+                            int i, int j, int nlocal, int newton_pair,
+                            double evdwl, double ecoul, double fpair,
+                            double delx, double dely, double delz)
+{
+  int list[2] = {i,j};
+  double v[6];
+  double *vptr = NULL;
+
+  if (thr->vflag_global || thr->vflag_atom) {
+    v[0] = delx*delx*fpair;
+    v[1] = dely*dely*fpair;
+    v[2] = delz*delz*fpair;
+    v[3] = delx*dely*fpair;
+    v[4] = delx*delz*fpair;
+    v[5] = dely*delz*fpair;
+    vptr = v;
+  }
+
+  tally(thr,2,list,nlocal,newton_pair,evdwl,ecoul,vptr);
+}
+
+/* ---------------------------------------------------------------------- */
+
+void ThrAccum::ev_tally_thr(Bond *, ThrAccumData *thr,
+                            int i, int j, int nlocal, int newton_bond,
+                            double ebond, double fbond,
+                            double delx, double dely, double delz)
+{
+  int list[2] = {i,j};
+  double v[6];
+  double *vptr = NULL;
+
+  if (thr->vflag_global || thr->vflag_atom) {
+    v[0] = delx*delx*fbond;
+    v[1] = dely*dely*fbond;
+    v[2] = delz*delz*fbond;
+    v[3] = delx*dely*fbond;
+    v[4] = delx*delz*fbond;
+    v[5] = dely*delz*fbond;
+    vptr = v;
+  }
+
+  tally(thr,2,list,nlocal,newton_bond,ebond,0.0,vptr);
+}
+
+/* ---------------------------------------------------------------------- */
+
+void ThrAccum::ev_tally_thr(Angle *, ThrAccumData *thr,
+                            int i, int j, int k, int nlocal, int newton_bond,
+                            double eangle, double *f1, double *f3,
+                            double delx1, double dely1, double delz1,
+                            double delx2, double dely2, double delz2)
+{
+  int list[3] = {i,j,k};
+  double v[6];
+  double *vptr = NULL;
+
+  if (thr->vflag_global || thr->vflag_atom) {
+    v[0] = delx1*f1[0] + delx2*f3[0];
+    v[1] = dely1*f1[1] + dely2*f3[1];
+    v[2] = delz1*f1[2] + delz2*f3[2];
+    v[3] = delx1*f1[1] + delx2*f3[1];
+    v[4] = delx1*f1[2] + delx2*f3[2];
+    v[5] = dely1*f1[2] + dely2*f3[2];
+    vptr = v;
+  }
+
+  tally(thr,3,list,nlocal,newton_bond,eangle,0.0,vptr);
+}
+
+/* ---------------------------------------------------------------------- */
+
+void ThrAccum::ev_tally_thr(Dihedral *, ThrAccumData *thr,
+                            int i1, int i2, int i3, int i4,
+                            int nlocal, int newton_bond,
+                            double edihedral, double *f1, double *f3,
+                            double *f4,
+                            double vb1x, double vb1y, double vb1z,
+                            double vb2x, double vb2y, double vb2z,
+                            double vb3x, double vb3y, double vb3z)
+{
+  int list[4] = {i1,i2,i3,i4};
+  double v[6];
+  double *vptr = NULL;
+
+  if (thr->vflag_global || thr->vflag_atom) {
+    v[0] = vb1x*f1[0] + vb2x*f3[0] + (vb3x+vb2x)*f4[0];
+    v[1] = vb1y*f1[1] + vb2y*f3[1] + (vb3y+vb2y)*f4[1];
+    v[2] = vb1z*f1[2] + vb2z*f3[2] + (vb3z+vb2z)*f4[2];
+    v[3] = vb1x*f1[1] + vb2x*f3[1] + (vb3x+vb2x)*f4[1];
+    v[4] = vb1x*f1[2] + vb2x*f3[2] + (vb3x+vb2x)*f4[2];
+    v[5] = vb1y*f1[2] + vb2y*f3[2] + (vb3y+vb2y)*f4[2];
+    vptr = v;
+  }
+
+  tally(thr,4,list,nlocal,newton_bond,edihedral,0.0,vptr);
+}
+
+/* ---------------------------------------------------------------------- */
+
+void ThrAccum::ev_tally_thr(Improper *, ThrAccumData *thr,
+                            int i1, int i2, int i3, int i4,
+                            int nlocal, int newton_bond,
+                            double eimproper, double *f1, double *f3,
+                            double *f4,
+                            double vb1x, double vb1y, double vb1z,
+                            double vb2x, double vb2y, double vb2z,
+                            double vb3x, double vb3y, double vb3z)
+{
+  int list[4] = {i1,i2,i3,i4};
+  double v[6];
+  double *vptr = NULL;
+
+  if (thr->vflag_global || thr->vflag_atom) {
+    v[0] = vb1x*f1[0] + vb2x*f3[0] + (vb3x+vb2x)*f4[0];
+    v[1] = vb1y*f1[1] + vb2y*f3[1] + (vb3y+vb2y)*f4[1];
+    v[2] = vb1z*f1[2] + vb2z*f3[2] + (vb3z+vb2z)*f4[2];
+    v[3] = vb1x*f1[1] + vb2x*f3[1] + (vb3x+vb2x)*f4[1];
+    v[4] = vb1x*f1[2] + vb2x*f3[2] + (vb3x+vb2x)*f4[2];
+    v[5] = vb1y*f1[2] + vb2y*f3[2] + (vb3y+vb2y)*f4[2];
+    vptr = v;
+  }
+
+  tally(thr,4,list,nlocal,newton_bond,eimproper,0.0,vptr);
+}
@@ -0,0 +1,137 @@
+/* -*- c++ -*- ----------------------------------------------------------
+   LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+   http://lammps.sandia.gov, Sandia National Laboratories
+   Steve Plimpton, sjplimp@sandia.gov
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+
+   See the README file in the top-level LAMMPS directory.
+------------------------------------------------------------------------- */
+
+#ifndef LMP_THR_ACCUM_H
+#define LMP_THR_ACCUM_H
+
+#include "pointers.h"
+
+namespace LAMMPS_NS {
+
+// accumulators of one thread
+// f, eatom, vatom point to the thread's slab of the per-atom arrays,
+// which AtomVec, Pair, Bond, etc already size for comm->nthreads threads
+
+struct ThrAccumData {
+  double **f;                   // force slab
+  double *eatom;                // per-atom energy slab
+  double **vatom;               // per-atom virial slab
+  double eng_vdwl,eng_coul;     // global energies, bonded styles use eng_vdwl
+  double virial[6];             // global virial
+  int eflag_global,eflag_atom;  // copies of the style's ev flags
+  int vflag_global,vflag_atom;
+  double pad[8];                // keep threads off each other's cache line
+};
+
+#define THR_BLOCK 64            // max terms per thr_eval() call
+
+// thread-private force/energy/virial accumulation
+// a threaded style derives from its serial base and ThrAccum, then
+//   #pragma omp parallel
+//   {
+//     ThrAccumData *thr = thr_setup(tid,this);
+//     ... omp for loop, forces into thr->f, ev_tally_thr(this,thr,...)
+//     thr_reduce(thr);
+//   }
+//   thr_finish(this);
+// ev_tally_thr() has the arguments of the style's ev_tally() plus thr
+// a bonded style can instead override thr_eval() and call
+//   thr_compute(this,n), which does all of the above for a list of n terms
+
+class ThrAccum {
+ public:
+  ThrAccum(class LAMMPS *);
+  virtual ~ThrAccum();
+
+ protected:
+  class LAMMPS *lmp_thr;
+  ThrAccumData *thr_data;       // one entry per thread
+  int nthr_data;
+
+  ThrAccumData *thr_setup(int, class Pair *);
+  ThrAccumData *thr_setup(int, class Bond *);
+  ThrAccumData *thr_setup(int, class Angle *);
+  ThrAccumData *thr_setup(int, class Dihedral *);
+  ThrAccumData *thr_setup(int, class Improper *);
+
+  void thr_reduce(ThrAccumData *);
+  void thr_range(int, int &, int &, int &);
+
+  template <class STYLE> int thr_compute(STYLE *, int);
+  virtual int thr_eval(int, int, ThrAccumData *) {return 0;}
+
+  void thr_finish(class Pair *);
+  void thr_finish(class Bond *);
+  void thr_finish(class Angle *);
+  void thr_finish(class Dihedral *);
+  void thr_finish(class Improper *);
+
+  void ev_tally_thr(class Pair *, ThrAccumData *, int, int, int, int,
+                    double, double, double, double, double, double);
+  void ev_tally_thr(class Bond *, ThrAccumData *, int, int, int, int,
+                    double, double, double, double, double);
+  void ev_tally_thr(class Angle *, ThrAccumData *, int, int, int, int, int,
+                    double, double *, double *, double, double, double,
+                    double, double, double);
+  void ev_tally_thr(class Dihedral *, ThrAccumData *,
+                    int, int, int, int, int, int,
+                    double, double *, double *, double *,
+                    double, double, double, double, double, double,
+                    double, double, double);
+  void ev_tally_thr(class Improper *, ThrAccumData *,
+                    int, int, int, int, int, int,
+                    double, double *, double *, double *,
+                    double, double, double, double, double, double,
+                    double, double, double);
+
+ private:
+  ThrAccumData *setup(int, double *, int, double **, int,
+                      int, int, int, int);
+  void finish(double *, double *, double *);
+  void tally(ThrAccumData *, int, const int *, int, int,
+             double, double, const double *);
+};
+
+/* ----------------------------------------------------------------------
+   evaluate n terms of a style's topology list with all threads
+   each thread takes a contiguous chunk of the list, split by thr_range(),
+   and passes it to thr_eval() in blocks of at most THR_BLOCK terms
+   return OR of thr_eval() return values, for errors the caller raises
+     after the parallel region
+------------------------------------------------------------------------- */
+
+template <class STYLE>
+int ThrAccum::thr_compute(STYLE *style, int n)
+{
+  int flag = 0;
+
+#if defined(_OPENMP)
+#pragma omp parallel default(shared) reduction(|:flag)
+#endif
+  {
+    int tid,nfrom,nto;
+    thr_range(n,tid,nfrom,nto);
+
+    ThrAccumData *thr = thr_setup(tid,style);
+    for (int nb = nfrom; nb < nto; nb += THR_BLOCK)
+      flag |= thr_eval(nb,MIN(nb+THR_BLOCK,nto),thr);
+    thr_reduce(thr);
+  }
+
+  thr_finish(style);
+  return flag;
+}
+
+}
+
+#endif
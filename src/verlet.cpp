@@ -212,7 +212,7 @@ void Verlet::setup_minimal(int flag)
 void Verlet::run(int n)
 {
   bigint ntimestep;
-  int nflag,sortflag;
+  int nflag,sortflag,splitflag;
 
   int n_post_integrate = modify->n_post_integrate;
   int n_pre_exchange = modify->n_pre_exchange;
@@ -224,6 +224,13 @@ void Verlet::run(int n)
   if (atom->sortfreq > 0) sortflag = 1;
   else sortflag = 0;
 
+  // overlap forward comm with pair forces of bulk atoms if requested
+  // only if nothing needs ghost coords before the pair compute
+
+  int overlap = 0;
+  if (comm->overlap && pair_compute_flag && force->pair->split_flag &&
+      n_pre_force == 0) overlap = 1;
+
   for (int i = 0; i < n; i++) {
 
     ntimestep = ++update->ntimestep;
@@ -236,12 +243,29 @@ void Verlet::run(int n)
 
     // regular communication vs neighbor list rebuild
 
+    // if split, pair forces of bulk atoms are computed while ghost
+    //   coords are in flight, forces of border atoms follow below
+    // per-atom energy/virial steps are not split
+
     nflag = neighbor->decide();
+    splitflag = 0;
 
     if (nflag == 0) {
-      timer->stamp();
-      comm->forward_comm();
-      timer->stamp(TIME_COMM);
+      if (overlap && eflag < 2 && vflag < 4) splitflag = 1;
+      if (splitflag) {
+        force_clear();
+        timer->stamp();
+        comm->forward_comm_start();
+        timer->stamp(TIME_COMM);
+        force->pair->compute_bulk(eflag,vflag);
+        timer->stamp(TIME_PAIR);
+        comm->forward_comm_finish();
+        timer->stamp(TIME_COMM);
+      } else {
+        timer->stamp();
+        comm->forward_comm();
+        timer->stamp(TIME_COMM);
+      }
     } else {
       if (n_pre_exchange) modify->pre_exchange();
       if (triclinic) domain->x2lamda(atom->nlocal);
@@ -267,13 +291,14 @@ void Verlet::run(int n)
     // since some bonded potentials tally pairwise energy/virial
     // and Pair:ev_tally() needs to be called before any tallying
 
-    force_clear();
+    if (!splitflag) force_clear();
     if (n_pre_force) modify->pre_force(vflag);
 
     timer->stamp();
 
     if (pair_compute_flag) {
-      force->pair->compute(eflag,vflag);
+      if (splitflag) force->pair->compute_border(eflag,vflag);
+      else force->pair->compute(eflag,vflag);
       timer->stamp(TIME_PAIR);
     }
 
@@ -137,12 +137,18 @@ void WriteRestart::write(char *file)
   if (natoms != atom->natoms && output->thermo->lostflag == ERROR)
     error->all(FLERR,"Atom count is inconsistent, cannot write restart file");
 
-  // check if filename contains "%"
+  // check if filename contains "%" or ends in ".mpiio"
 
   int multiproc;
   if (strchr(file,'%')) multiproc = 1;
   else multiproc = 0;
 
+  int mpiioflag = 0;
+  int n = strlen(file);
+  if (n > 6 && strcmp(&file[n-6],".mpiio") == 0) mpiioflag = 1;
+  if (multiproc && mpiioflag)
+    error->all(FLERR,"Restart file MPI-IO output not allowed with % in filename");
+
   // open single restart file or base file for multiproc case
 
   if (me == 0) {
@@ -189,7 +195,7 @@ void WriteRestart::write(char *file)
   // pack my atom data into buf
 
   AtomVec *avec = atom->avec;
-  int n = 0;
+  n = 0;
   for (int i = 0; i < atom->nlocal; i++) n += avec->pack_restart(i,&buf[n]);
 
   // if any fix requires it, remap each atom's coords via PBC
@@ -241,6 +247,8 @@ void WriteRestart::write(char *file)
     }
   }
 
+  // if MPI-IO file:
+  //   write index and one chunk of atoms per proc at its offset in file
   // if single file:
   //   write one chunk of atoms per proc to file
   //   proc 0 pings each proc, receives its chunk, writes to file
@@ -248,7 +256,9 @@ void WriteRestart::write(char *file)
   // else if one file per proc:
   //   each proc opens its own file and writes its chunk directly
 
-  if (multiproc == 0) {
+  if (mpiioflag) write_mpiio(file,send_size,buf);
+
+  else if (multiproc == 0) {
     int tmp,recv_size;
     MPI_Status status;
     MPI_Request request;
@@ -301,6 +311,70 @@ void WriteRestart::write(char *file)
       modify->fix[ifix]->write_restart_file(file);
 }
 
+/* ----------------------------------------------------------------------
+   write chunk of N doubles in buf from every proc to MPI-IO restart file
+   proc 0 appends index of chunk offsets and sizes to what it has written,
+     chunks follow, first one aligned to a double, in order of procs
+   file layout does not depend on how it is read back, see read_restart
+------------------------------------------------------------------------- */
+
+void WriteRestart::write_mpiio(char *file, int n, double *buf)
+{
+  // offset = byte offset of my chunk in file
+
+  int *size = NULL;
+  if (me == 0) size = new int[nprocs];
+  MPI_Gather(&n,1,MPI_INT,size,1,MPI_INT,0,world);
+
+  bigint start;
+  if (me == 0) {
+    start = ftell(fp) + sizeof(int) + nprocs*(sizeof(bigint)+sizeof(int));
+    start = (start + sizeof(double)-1) / sizeof(double) * sizeof(double);
+
+    bigint *offset = new bigint[nprocs];
+    offset[0] = start;
+    for (int iproc = 1; iproc < nprocs; iproc++)
+      offset[iproc] = offset[iproc-1] + (bigint) size[iproc-1]*sizeof(double);
+
+    fwrite(&nprocs,sizeof(int),1,fp);
+    fwrite(offset,sizeof(bigint),nprocs,fp);
+    fwrite(size,sizeof(int),nprocs,fp);
+    char pad[sizeof(double)] = {0};
+    fwrite(pad,sizeof(char),start-ftell(fp),fp);
+    fclose(fp);
+
+    delete [] offset;
+    delete [] size;
+  }
+
+  // bcast also guarantees proc 0 has closed file
+
+  MPI_Bcast(&start,1,MPI_LMP_BIGINT,0,world);
+
+  bigint nb = n;
+  bigint offset;
+  MPI_Scan(&nb,&offset,1,MPI_LMP_BIGINT,MPI_SUM,world);
+  offset = start + (offset-nb)*sizeof(double);
+
+  char str[128];
+  sprintf(str,"Cannot open restart file %s",file);
+
+#ifdef LAMMPS_MPIIO
+  MPI_File fh;
+  int err = MPI_File_open(world,file,MPI_MODE_WRONLY,MPI_INFO_NULL,&fh);
+  if (err != MPI_SUCCESS) error->one(FLERR,str);
+  MPI_Status status;
+  MPI_File_write_at_all(fh,(MPI_Offset) offset,buf,n,MPI_DOUBLE,&status);
+  MPI_File_close(&fh);
+#else
+  FILE *fh = fopen(file,"r+b");
+  if (fh == NULL) error->one(FLERR,str);
+  fseek(fh,offset,SEEK_SET);
+  fwrite(buf,sizeof(double),n,fh);
+  fclose(fh);
+#endif
+}
+
 /* ----------------------------------------------------------------------
    proc 0 writes out problem description
 ------------------------------------------------------------------------- */
@@ -39,6 +39,7 @@ class WriteRestart : protected Pointers {
   void header();
   void type_arrays();
   void force_fields();
+  void write_mpiio(char *, int, double *);
 
   void write_int(int, int);
   void write_double(int, double);
@@ -69,6 +70,10 @@ E: Atom count is inconsistent, cannot write restart file
 Sum of atoms across processors does not equal initial total count.
 This is probably because you have lost some atoms.
 
+E: Restart file MPI-IO output not allowed with % in filename
+
+A file ending in .mpiio is a single file written by all processors.
+
 E: Cannot open restart file %s
 
 Self-explanatory.